@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <atomic>
 #include <string>
@@ -23,6 +24,9 @@
 class StateManager;
 class EventManager;
 class WebSocketServer;
+class SessionManager;
+class AdminServer;
+class ReplicationStandby;
 
 /**
  * 游戏引擎主类
@@ -38,7 +42,12 @@ private:
     // 核心子系统
     std::unique_ptr<StateManager> stateManager;     // 状态管理器
     std::unique_ptr<EventManager> eventManager;     // 事件管理器
+    std::unique_ptr<SessionManager> sessionManager; // 会话管理器
     std::unique_ptr<WebSocketServer> webSocketServer; // 网络通信服务器
+    std::unique_ptr<AdminServer> adminServer;       // 本机管理接口
+    std::unique_ptr<ReplicationStandby> standby;    // 备用模式下接收主服务器的会话变更
+    int takeoverAttempts;                           // 接管端口的尝试次数（端口仍被占用时按退避间隔重试）
+    std::chrono::steady_clock::time_point nextTakeoverAttempt;
     
     // 引擎状态控制
     std::atomic<bool> initialized;  // 是否已初始化
@@ -142,6 +151,13 @@ public:
      */
     WebSocketServer* getWebSocketServer() const;
     
+    /**
+     * 获取会话管理器
+     * 【作用】：允许访问所有玩家会话
+     * 【返回】：会话管理器指针，如果未初始化则返回nullptr
+     */
+    SessionManager* getSessionManager() const;
+    
     /**
      * 设置目标帧率
      * 【参数】：fps - 目标每秒帧数
@@ -187,4 +203,17 @@ private:
      * 【作用】：响应系统关闭、错误等重要事件
      */
     void handleSystemEvents();
+    
+    /**
+     * 生成并发布管理接口快照
+     * 【作用】：只在管理接口有请求等待时由主循环调用，读取各子系统的状态
+     */
+    void publishAdminSnapshot();
+    
+    /**
+     * 备用模式接管
+     * 【作用】：主服务器失效后把复制来的会话标记为断线并开始监听端口，
+     *          端口仍被占用时按退避间隔（100毫秒起，每次翻倍，最多2秒）重试
+     */
+    void takeOverFromPrimary();
 };
@@ -5,11 +5,51 @@
  */
 
 #include "APIHandler.h"
+#include "WorldData.h"
+#include "ChoiceStatistics.h"
+#include "PrefetchPlanner.h"
+#include "ContentStore.h"
+#include "RegionPager.h"
+#include "Metrics.h"
+#include "Events.h"
+#include "utils/SimpleJson.h"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <chrono>
 
-APIHandler::APIHandler() {
+namespace {
+
+    bool meetsRequirement(const Requirement& requirement, const std::map<std::string, int>& attributes) {
+        if (requirement.attribute.empty()) {
+            return true;
+        }
+        auto it = attributes.find(requirement.attribute);
+        return it != attributes.end() && it->second >= requirement.threshold;
+    }
+
+    // 每个会话最多记住的客户端缓存条目（防止伪造的清单占用过多内存）
+    constexpr size_t kMaxClientContent = 16384;
+
+    SimpleJson::Value stringArray(const std::vector<std::string>& strings) {
+        SimpleJson::Value array = SimpleJson::Value::array();
+        for (const auto& text : strings) {
+            array.push(SimpleJson::Value(text));
+        }
+        return array;
+    }
+
+    std::string wrapResponse(const char* type, const std::string& timestamp, SimpleJson::Value data) {
+        SimpleJson::Value response = SimpleJson::Value::object();
+        response.set("type", SimpleJson::Value(type));
+        response.set("timestamp", SimpleJson::Value(timestamp));
+        response.set("data", std::move(data));
+        return response.dump();
+    }
+
+} // namespace
+
+APIHandler::APIHandler() : world(WorldData::global()), contentBytesAvoided(0) {
     std::cout << "[APIHandler] 正在创建API消息处理器" << std::endl;
     
     // 初始化默认游戏状态
@@ -23,14 +63,51 @@ APIHandler::APIHandler() {
     availableActions.push_back("examine_bookshelf");
     availableActions.push_back("talk_to_owner");
     availableActions.push_back("look_around");
+
+    // 初始状态也是事实，先送入规则网络
+    for (const auto& attribute : playerAttributes) {
+        feedRules(AttributeChangedEvent(attribute.first, 0, attribute.second, "initial"));
+    }
+    for (const auto& item : inventory) {
+        feedRules(ItemAcquiredEvent(item, item, "story", "initial"));
+    }
+
+    if (world) {
+        if (const Location* start = world->findLocation(world->getStartLocation())) {
+            enterLocation(*start);
+        }
+    }
     
     std::cout << "[APIHandler] 默认游戏状态已初始化" << std::endl;
 }
 
+APIHandler::~APIHandler() {
+    RegionPager::instance().releaseAll(heldRegions);
+}
+
 std::string APIHandler::handleMessage(const std::string& rawMessage) {
     std::cout << "[APIHandler] 正在处理消息: " << rawMessage << std::endl;
 
     try {
+        // 已加载世界数据：按数据驱动处理移动、对话和对话选择
+        if (world) {
+            if (rawMessage.find("\"cacheManifest\"") != std::string::npos) {
+                return handleCacheManifest(rawMessage);
+            } else if (rawMessage.find("\"contentRequest\"") != std::string::npos) {
+                return handleContentRequest(rawMessage);
+            } else if (rawMessage.find("\"optionId\"") != std::string::npos) {
+                return handleWorldChoice(rawMessage);
+            } else if (rawMessage.find("\"action\"") != std::string::npos) {
+                if (rawMessage.find("move") != std::string::npos) {
+                    return handleWorldMove(rawMessage);
+                } else if (rawMessage.find("examine") != std::string::npos) {
+                    return handleWorldExamine(rawMessage);
+                } else if (rawMessage.find("talk") != std::string::npos) {
+                    return handleWorldTalk(rawMessage);
+                }
+            }
+        }
+
         // 简化版本：解析基本的JSON消息
         if (rawMessage.find("\"action\"") != std::string::npos) {
             if (rawMessage.find("move") != std::string::npos) {
@@ -70,7 +147,7 @@ std::string APIHandler::handleExamineCommand(const std::string& message) {
     std::cout << "[APIHandler] 正在处理检查命令" << std::endl;
     
     // 模拟属性提升
-    playerAttributes["observation"]++;
+    changeAttribute("observation", 1, "item_examination");
     
     return generateGameStateResponse();
 }
@@ -92,10 +169,10 @@ std::string APIHandler::handleDialogueChoice(const std::string& message) {
     std::cout << "[APIHandler] 正在处理对话选择" << std::endl;
     
     if (message.find("opt1") != std::string::npos) {
-        playerAttributes["communication"]++;
+        changeAttribute("communication", 1, "dialogue_choice");
         return generateSceneUpdateResponse(currentLocation, "The owner nods slowly, a distant look in his eyes. 'This city holds many forgotten stories...'");
     } else if (message.find("opt2") != std::string::npos) {
-        playerAttributes["empathy"]++;
+        changeAttribute("empathy", 1, "dialogue_choice");
         return generateDialogueResponse(
             "Bookstore Owner",
             "Ah, you have a keen eye. Indeed, some memories are best left undisturbed...",
@@ -106,6 +183,439 @@ std::string APIHandler::handleDialogueChoice(const std::string& message) {
     return generateErrorResponse("Invalid dialogue option");
 }
 
+void APIHandler::setPlayerId(const std::string& id) {
+    playerId = id;
+    if (world) {
+        ChoiceStatistics::instance().recordLocationVisit(playerId, currentLocation);
+    }
+}
+
+void APIHandler::enterLocation(const Location& location) {
+    currentLocation = location.id;
+    RegionPager::instance().enter(heldRegions, location.id);
+    currentDialogueId.clear();
+    availableActions.clear();
+    for (const auto& interaction : location.interactions) {
+        availableActions.push_back(interaction.id);
+    }
+    for (const auto& character : location.characters) {
+        availableActions.push_back("talk_to_" + character);
+    }
+    for (const auto& exit : location.exits) {
+        if (world->findLocation(exit.second)) {
+            availableActions.push_back("move_" + exit.first);
+        }
+    }
+    if (!playerId.empty()) {
+        ChoiceStatistics::instance().recordLocationVisit(playerId, location.id);
+    }
+    if (prefetchedLocations.insert(location.id).second) {
+        queuePrefetch(PrefetchPlanner::instance().hintForLocation(location.id));
+    }
+}
+
+void APIHandler::queuePrefetch(const std::shared_ptr<const PrefetchPlanner::PlannedHint>& hint) {
+    if (!hint) {
+        return;
+    }
+    pendingPrefetch.push_back(hint->message);
+    // 提示带着原文，客户端收到后存入内容缓存；之后的响应对这些文本只发哈希。
+    // 提示被丢弃或没送达时，客户端遇到缺失的哈希会用contentRequest取回
+    for (const auto& hash : hint->contentHashes) {
+        if (clientContent.size() >= kMaxClientContent) {
+            break;
+        }
+        clientContent.insert(hash);
+    }
+}
+
+std::vector<std::shared_ptr<const std::string>> APIHandler::takePrefetchHints() {
+    std::vector<std::shared_ptr<const std::string>> hints;
+    hints.swap(pendingPrefetch);
+    return hints;
+}
+
+std::string APIHandler::handleWorldMove(const std::string& message) {
+    SimpleJson::Value command;
+    SimpleJson::parse(message, command, nullptr, kMaxMessageKeys);
+    const SimpleJson::Value& data = command["data"];
+    std::string target = data["direction"].asString();
+    if (target.empty()) {
+        target = data["target"].asString();
+    }
+
+    // 方向（north）或直接给出相邻场景ID都可以
+    const Location* here = world->findLocation(currentLocation);
+    const Location* destination = nullptr;
+    if (here) {
+        for (const auto& exit : here->exits) {
+            if (exit.first == target || exit.second == target) {
+                destination = world->findLocation(exit.second);
+                break;
+            }
+        }
+    }
+    if (!destination) {
+        return generateErrorResponse("Cannot move to '" + target + "' from here");
+    }
+
+    std::cout << "[APIHandler] 移动: " << currentLocation << " -> " << destination->id << std::endl;
+    enterLocation(*destination);
+    return generateWorldSceneResponse(*destination);
+}
+
+std::string APIHandler::handleWorldExamine(const std::string& message) {
+    SimpleJson::Value command;
+    SimpleJson::parse(message, command, nullptr, kMaxMessageKeys);
+    std::string target = command["data"]["target"].asString();
+
+    // 目标可以是当前场景的交互（examine_bookshelf 或 bookshelf），也可以是身上或场景里的物品
+    TextId description = TextStore::kEmpty;
+    std::vector<std::string> rewardInsights;
+    std::vector<std::string> newItems;
+    std::map<std::string, int> attributeGain;
+    const Script* script = nullptr;
+    std::string examinedKey;
+
+    const Location* here = world->findLocation(currentLocation);
+    const Interaction* interaction = nullptr;
+    if (here) {
+        for (const auto& candidate : here->interactions) {
+            if (candidate.id == target || candidate.id == "examine_" + target) {
+                interaction = &candidate;
+                break;
+            }
+        }
+    }
+    const Item* item = world->findItem(target);
+    bool itemReachable = item && (std::find(inventory.begin(), inventory.end(), target) != inventory.end() ||
+                                  (here && std::find(here->items.begin(), here->items.end(), target) != here->items.end()));
+
+    if (interaction) {
+        if (!meetsRequirement(interaction->requirement, playerAttributes)) {
+            return generateErrorResponse("Requires " + interaction->requirement.attribute + " " +
+                                         std::to_string(interaction->requirement.threshold));
+        }
+        description = interaction->resultText;
+        rewardInsights = interaction->insights;
+        newItems = interaction->items;
+        script = interaction->script.get();
+        examinedKey = currentLocation + "/" + interaction->id;
+    } else if (itemReachable && item->examinable) {
+        description = item->examineText != TextStore::kEmpty ? item->examineText : item->description;
+        rewardInsights = item->examineInsights;
+        attributeGain = item->examineAttributes;
+        script = item->examineScript.get();
+        examinedKey = "item/" + item->id;
+    } else {
+        return generateErrorResponse("Nothing to examine: '" + target + "'");
+    }
+
+    // 奖励只在第一次检查时发放
+    SimpleJson::Value data = SimpleJson::Value::object();
+    data.set("target", SimpleJson::Value(target));
+    setContentField(data, "description", description);
+    if (examinedTargets.insert(examinedKey).second) {
+        std::vector<std::string> newInsights;
+        for (const auto& insight : rewardInsights) {
+            if (gainInsight(insight, "examination")) {
+                newInsights.push_back(insight);
+            }
+        }
+        for (const auto& newItem : newItems) {
+            acquireItem(newItem, "examination");
+        }
+        SimpleJson::Value gains = SimpleJson::Value::object();
+        for (const auto& gain : attributeGain) {
+            changeAttribute(gain.first, gain.second, "item_examination");
+            gains.set(gain.first, SimpleJson::Value(gain.second));
+        }
+        if (script) {
+            runScript(*script);
+            data.set("narration", stringArray(scriptNarration));
+            scriptNarration.clear();
+        }
+        data.set("newInsights", stringArray(newInsights));
+        data.set("newItems", stringArray(newItems));
+        data.set("attributeGain", std::move(gains));
+    }
+    return wrapResponse("examination", getCurrentTimestamp(), std::move(data));
+}
+
+std::string APIHandler::handleCacheManifest(const std::string& message) {
+    SimpleJson::Value manifest;
+    SimpleJson::parse(message, manifest, nullptr, kMaxMessageKeys);
+
+    size_t accepted = 0;
+    for (const auto& hash : manifest["hashes"].items()) {
+        if (clientContent.size() >= kMaxClientContent) {
+            break;
+        }
+        // 只记住服务器认识的哈希，未知的（旧版本内容）直接忽略
+        if (hash.isString() && ContentStore::instance().lookup(hash.asString()) != TextStore::kEmpty) {
+            clientContent.insert(hash.asString());
+            accepted++;
+        }
+    }
+    std::cout << "[APIHandler] 客户端缓存清单: " << accepted << " 条有效内容" << std::endl;
+    return "";
+}
+
+std::string APIHandler::handleContentRequest(const std::string& message) {
+    SimpleJson::Value request;
+    SimpleJson::parse(message, request, nullptr, kMaxMessageKeys);
+
+    SimpleJson::Value data = SimpleJson::Value::object();
+    for (const auto& hash : request["hashes"].items()) {
+        TextId text = hash.isString() ? ContentStore::instance().lookup(hash.asString()) : TextStore::kEmpty;
+        if (text != TextStore::kEmpty) {
+            data.set(hash.asString(), SimpleJson::Value(world->text(text)));
+            if (clientContent.size() < kMaxClientContent) {
+                clientContent.insert(hash.asString());
+            }
+        }
+    }
+    return wrapResponse("content", getCurrentTimestamp(), std::move(data));
+}
+
+void APIHandler::changeAttribute(const std::string& name, int delta, const std::string& reason) {
+    int oldValue = playerAttributes[name];
+    playerAttributes[name] = oldValue + delta;
+    feedRules(AttributeChangedEvent(name, oldValue, oldValue + delta, reason));
+}
+
+void APIHandler::acquireItem(const std::string& itemId, const std::string& source) {
+    if (std::find(inventory.begin(), inventory.end(), itemId) != inventory.end()) {
+        return;
+    }
+    inventory.push_back(itemId);
+    const Item* item = world ? world->findItem(itemId) : nullptr;
+    feedRules(ItemAcquiredEvent(itemId, item ? item->name : itemId, item ? item->type : "story", source));
+}
+
+bool APIHandler::gainInsight(const std::string& insightId, const std::string& trigger) {
+    if (!insights.insert(insightId).second) {
+        return false;
+    }
+    ChoiceStatistics::instance().recordInsight(playerId, insightId);
+    feedRules(InsightGainedEvent(insightId, "", "story", trigger));
+    return true;
+}
+
+void APIHandler::feedRules(const Event& event) {
+    // 只有与这个事件相关的规则会被重新检查；触发的规则由网络发布StoryTriggeredEvent
+    for (const StoryRule* rule : RuleNetwork::instance().onEvent(ruleMemory, event, playerId)) {
+        std::cout << "[APIHandler] 剧情规则触发: " << rule->id << std::endl;
+        storyFlags.insert(rule->unlocks.begin(), rule->unlocks.end());
+    }
+}
+
+void APIHandler::setContentField(SimpleJson::Value& object, const std::string& key, TextId text) {
+    static auto& avoidedCounter = Metrics::instance().counter("content.bytes_avoided");
+    static auto& sentCounter = Metrics::instance().counter("content.bytes_sent");
+
+    const std::string* hash = ContentStore::instance().hashFor(text);
+    if (!hash) {
+        object.set(key, SimpleJson::Value(world->text(text)));
+        return;
+    }
+
+    // 客户端已缓存时只发哈希，连文本块都不需要解压
+    object.set(key + "Ref", SimpleJson::Value(*hash));
+    size_t length = world->getTexts().length(text);
+    if (clientContent.count(*hash)) {
+        contentBytesAvoided += length;
+        avoidedCounter.fetch_add(static_cast<int64_t>(length), std::memory_order_relaxed);
+        return;
+    }
+
+    // 发送原文，客户端收到后会缓存；之后同一段文本只发哈希
+    object.set(key, SimpleJson::Value(world->text(text)));
+    sentCounter.fetch_add(static_cast<int64_t>(length), std::memory_order_relaxed);
+    if (clientContent.size() < kMaxClientContent) {
+        clientContent.insert(*hash);
+    }
+}
+
+std::string APIHandler::generateWorldSceneResponse(const Location& location) {
+    SimpleJson::Value data = SimpleJson::Value::object();
+    data.set("location", SimpleJson::Value(location.id));
+    data.set("name", SimpleJson::Value(location.name));
+    setContentField(data, "description", location.description());
+    data.set("ambientEffects", stringArray(location.ambientEffects));
+    data.set("musicTrack", SimpleJson::Value(location.musicTrack));
+    return wrapResponse("sceneUpdate", getCurrentTimestamp(), std::move(data));
+}
+
+std::string APIHandler::handleWorldTalk(const std::string& message) {
+    SimpleJson::Value command;
+    SimpleJson::parse(message, command, nullptr, kMaxMessageKeys);
+    std::string target = command["data"]["target"].asString();
+
+    const Location* here = world->findLocation(currentLocation);
+    if (!here || here->characters.empty()) {
+        return generateErrorResponse("There is nobody to talk to here");
+    }
+    std::string character = here->characters.front();
+    for (const auto& candidate : here->characters) {
+        if (candidate == target) {
+            character = candidate;
+        }
+    }
+
+    std::string dialogueId = world->startDialogueFor(character);
+    if (dialogueId.empty()) {
+        return generateErrorResponse("'" + character + "' has nothing to say");
+    }
+    return enterDialogue(dialogueId);
+}
+
+std::string APIHandler::handleWorldChoice(const std::string& message) {
+    SimpleJson::Value choice;
+    SimpleJson::parse(message, choice, nullptr, kMaxMessageKeys);
+    std::string optionId = choice["optionId"].asString();
+
+    const DialogueNode* node = world->findDialogue(currentDialogueId);
+    if (!node) {
+        return generateErrorResponse("Not in a dialogue");
+    }
+    const DialogueOption* option = nullptr;
+    for (const auto& candidate : node->options) {
+        if (candidate.id == optionId && meetsRequirement(candidate.requirement, playerAttributes)) {
+            option = &candidate;
+            break;
+        }
+    }
+    if (!option) {
+        return generateErrorResponse("Invalid dialogue option");
+    }
+
+    // 在选择发生处记录统计（对话事件不携带玩家信息）
+    ChoiceStatistics::instance().recordChoice(node->id, option->id);
+    for (const auto& insight : option->insights) {
+        gainInsight(insight, "dialogue");
+    }
+    for (const auto& change : option->attributes) {
+        changeAttribute(change.first, change.second, "dialogue_choice");
+    }
+
+    // 脚本在固定结果之后执行，goto可以改变下一个对话节点
+    std::string nextDialogue = option->endDialogue ? "" : option->nextDialogue;
+    if (option->script) {
+        runScript(*option->script);
+        if (!scriptGoto.empty()) {
+            nextDialogue = scriptGoto;
+        }
+    }
+
+    if (!nextDialogue.empty() && world->findDialogue(nextDialogue)) {
+        return attachNarration(enterDialogue(nextDialogue));
+    }
+    currentDialogueId.clear();
+    return attachNarration(generateGameStateResponse());
+}
+
+void APIHandler::runScript(const Script& script) {
+    static auto& executed = Metrics::instance().counter("scripts.executed");
+
+    scriptNarration.clear();
+    scriptGoto.clear();
+    ScriptVM::execute(script, *this);
+    executed.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string APIHandler::attachNarration(const std::string& response) {
+    if (scriptNarration.empty()) {
+        return response;
+    }
+    std::string narration = stringArray(scriptNarration).dump();
+    scriptNarration.clear();
+    return SimpleJson::prependField(response, "narration", narration);
+}
+
+int APIHandler::getAttribute(const std::string& name) {
+    auto it = playerAttributes.find(name);
+    return it != playerAttributes.end() ? it->second : 0;
+}
+
+void APIHandler::setAttribute(const std::string& name, int value) {
+    int delta = value - getAttribute(name);
+    if (delta != 0) {
+        changeAttribute(name, delta, "script");
+    }
+}
+
+bool APIHandler::hasItem(const std::string& itemId) {
+    return std::find(inventory.begin(), inventory.end(), itemId) != inventory.end();
+}
+
+bool APIHandler::knowsInsight(const std::string& insightId) {
+    return insights.count(insightId) > 0;
+}
+
+bool APIHandler::hasFlag(const std::string& flag) {
+    return storyFlags.count(flag) > 0;
+}
+
+void APIHandler::giveItem(const std::string& itemId) {
+    acquireItem(itemId, "script");
+}
+
+void APIHandler::takeItem(const std::string& itemId) {
+    auto it = std::find(inventory.begin(), inventory.end(), itemId);
+    if (it == inventory.end()) {
+        return;
+    }
+    inventory.erase(it);
+    const Item* item = world ? world->findItem(itemId) : nullptr;
+    feedRules(ItemLostEvent(itemId, item ? item->name : itemId, "script"));
+}
+
+void APIHandler::gainInsight(const std::string& insightId) {
+    gainInsight(insightId, "script");
+}
+
+void APIHandler::setFlag(const std::string& flag) {
+    storyFlags.insert(flag);
+}
+
+void APIHandler::say(const std::string& text) {
+    scriptNarration.push_back(text);
+}
+
+void APIHandler::gotoDialogue(const std::string& dialogueId) {
+    scriptGoto = dialogueId;
+}
+
+std::string APIHandler::enterDialogue(const std::string& dialogueId) {
+    const DialogueNode* node = world->findDialogue(dialogueId);
+    currentDialogueId = dialogueId;
+    if (prefetchedDialogues.insert(dialogueId).second) {
+        queuePrefetch(PrefetchPlanner::instance().hintForDialogue(dialogueId));
+    }
+
+    // 选项附带"多少旅人选择了它"（来自最近一次发布的统计快照，未有人选择时为-1）
+    auto snapshot = ChoiceStatistics::instance().snapshot();
+    SimpleJson::Value options = SimpleJson::Value::array();
+    for (const auto& option : node->options) {
+        if (!meetsRequirement(option.requirement, playerAttributes)) {
+            continue;
+        }
+        SimpleJson::Value entry = SimpleJson::Value::object();
+        entry.set("id", SimpleJson::Value(option.id));
+        setContentField(entry, "text", option.text);
+        entry.set("chosenPercent", SimpleJson::Value(snapshot->percentFor(dialogueId, option.id)));
+        options.push(std::move(entry));
+    }
+
+    SimpleJson::Value data = SimpleJson::Value::object();
+    data.set("dialogueId", SimpleJson::Value(dialogueId));
+    data.set("speaker", SimpleJson::Value(node->speaker));
+    setContentField(data, "text", node->text);
+    data.set("options", std::move(options));
+    return wrapResponse("dialogue", getCurrentTimestamp(), std::move(data));
+}
+
 std::string APIHandler::generateGameStateResponse() {
     std::ostringstream json;
     json << "{\n";
@@ -130,6 +640,11 @@ std::string APIHandler::generateGameStateResponse() {
         json << "\"" << availableActions[i] << "\"";
         if (i < availableActions.size() - 1) json << ",";
     }
+    json << "],\n";
+    json << "    \"storyFlags\": [";
+    for (auto it = storyFlags.begin(); it != storyFlags.end(); ++it) {
+        json << (it == storyFlags.begin() ? "" : ",") << SimpleJson::quote(*it);
+    }
     json << "]\n";
     json << "  }\n";
     json << "}";
@@ -182,7 +697,7 @@ std::string APIHandler::generateErrorResponse(const std::string& errorMessage) {
     json << "  \"type\": \"error\",\n";
     json << "  \"timestamp\": \"" << getCurrentTimestamp() << "\",\n";
     json << "  \"data\": {\n";
-    json << "    \"message\": \"" << errorMessage << "\",\n";
+    json << "    \"message\": " << SimpleJson::quote(errorMessage) << ",\n";   // 可能带有客户端输入
     json << "    \"code\": 0\n";
     json << "  }\n";
     json << "}";
@@ -9,15 +9,41 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <set>
+#include <unordered_set>
+#include <cstdint>
+#include "PrefetchPlanner.h"
+#include "RuleNetwork.h"
+#include "ScriptVM.h"
+#include "TextStore.h"
+
+class WorldData;
+class Event;
+struct Location;
+struct Script;
+
+namespace SimpleJson {
+    class Value;
+}
 
 /**
  * API处理器类
  * 负责处理前端发来的消息，并生成相应的响应
+ * 【说明】：同时作为交互脚本的宿主（私有继承ScriptHost，脚本只能经由状态变化方法修改玩家状态）
  */
-class APIHandler {
+class APIHandler : private ScriptHost {
 public:
+    /**
+     * 一条客户端消息中最多的对象键数（超过时整条消息拒绝，防止超大对象占住游戏线程）
+     */
+    static constexpr size_t kMaxMessageKeys = 1024;
+
     APIHandler();
-    ~APIHandler() = default;
+    ~APIHandler();
+
+    APIHandler(const APIHandler&) = delete;
+    APIHandler& operator=(const APIHandler&) = delete;
 
     /**
      * 处理收到的消息
@@ -26,12 +52,65 @@ public:
      */
     std::string handleMessage(const std::string& rawMessage);
 
+    /**
+     * 生成当前游戏状态的完整快照（用于会话恢复）
+     * @return gameState消息的JSON字符串
+     */
+    std::string getStateSnapshot() { return generateGameStateResponse(); }
+
+    /**
+     * 设置玩家ID（会话创建时调用，用于跨玩家统计）
+     */
+    void setPlayerId(const std::string& id);
+
+    /**
+     * 取出待推送的预取消息（场景或对话变化后产生，每条在会话内只推送一次）
+     * @return 已编码的prefetch消息，没有时为空
+     */
+    std::vector<std::shared_ptr<const std::string>> takePrefetchHints();
+
+    /**
+     * 因客户端已缓存而没有发送的静态文本字节数
+     */
+    uint64_t getContentBytesAvoided() const { return contentBytesAvoided; }
+
+    /**
+     * 当前场景和对话节点（管理接口用；不在对话中时对话节点为空）
+     */
+    const std::string& getCurrentLocation() const { return currentLocation; }
+    const std::string& getCurrentDialogue() const { return currentDialogueId; }
+
 private:
     // 游戏状态
     std::string currentLocation;
     std::map<std::string, int> playerAttributes;
     std::vector<std::string> inventory;
     std::vector<std::string> availableActions;
+    std::string playerId;
+    std::string currentDialogueId;          // 正在进行的对话节点（为空表示不在对话中）
+
+    // 世界数据（已加载时按数据驱动处理命令，否则使用内置的演示内容）
+    const WorldData* world;
+    std::vector<uint32_t> heldRegions;      // 当前场景邻域内持有的区域（见RegionPager）
+
+    // 预取：待推送的消息和已推送过的场景/对话
+    std::vector<std::shared_ptr<const std::string>> pendingPrefetch;
+    std::set<std::string> prefetchedLocations;
+    std::set<std::string> prefetchedDialogues;
+
+    // 内容缓存：客户端已有的静态文本哈希（见ContentStore）
+    std::unordered_set<std::string> clientContent;
+    uint64_t contentBytesAvoided;
+    std::set<std::string> examinedTargets;  // 已检查过的物品/交互（奖励只发一次）
+
+    // 剧情：已获得的洞察、规则网络中的匹配状态、已解锁的剧情标记
+    std::set<std::string> insights;
+    RuleMemory ruleMemory;
+    std::set<std::string> storyFlags;
+
+    // 脚本：本次执行输出的文字和要转到的对话节点
+    std::vector<std::string> scriptNarration;
+    std::string scriptGoto;
 
     // 消息处理方法
     std::string handleMoveCommand(const std::string& message);
@@ -39,6 +118,40 @@ private:
     std::string handleTalkCommand(const std::string& message);
     std::string handleDialogueChoice(const std::string& message);
 
+    // 数据驱动的处理方法（world不为空时使用）
+    std::string handleWorldMove(const std::string& message);
+    std::string handleWorldTalk(const std::string& message);
+    std::string handleWorldChoice(const std::string& message);
+    std::string handleWorldExamine(const std::string& message);
+    std::string handleCacheManifest(const std::string& message);
+    std::string handleContentRequest(const std::string& message);
+    std::string generateWorldSceneResponse(const Location& location);
+    void setContentField(SimpleJson::Value& object, const std::string& key, TextId text);
+    void queuePrefetch(const std::shared_ptr<const PrefetchPlanner::PlannedHint>& hint);
+
+    // 状态变化（同时送入剧情规则网络）
+    void changeAttribute(const std::string& name, int delta, const std::string& reason);
+    void acquireItem(const std::string& itemId, const std::string& source);
+    bool gainInsight(const std::string& insightId, const std::string& trigger);
+    void feedRules(const Event& event);
+    std::string enterDialogue(const std::string& dialogueId);
+    void runScript(const Script& script);
+    std::string attachNarration(const std::string& response);
+
+    // ScriptHost
+    int getAttribute(const std::string& name) override;
+    void setAttribute(const std::string& name, int value) override;
+    bool hasItem(const std::string& itemId) override;
+    bool knowsInsight(const std::string& insightId) override;
+    bool hasFlag(const std::string& flag) override;
+    void giveItem(const std::string& itemId) override;
+    void takeItem(const std::string& itemId) override;
+    void gainInsight(const std::string& insightId) override;
+    void setFlag(const std::string& flag) override;
+    void say(const std::string& text) override;
+    void gotoDialogue(const std::string& dialogueId) override;
+    void enterLocation(const Location& location);
+
     // 响应生成方法
     std::string generateGameStateResponse();
     std::string generateDialogueResponse(const std::string& speaker, const std::string& text, const std::vector<std::pair<std::string, std::string>>& options);
@@ -0,0 +1,324 @@
+/**
+ * AdminServer.cpp
+ *
+ * 管理接口实现
+ */
+
+#include "AdminServer.h"
+#include "Metrics.h"
+#include "TickWatchdog.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    constexpr size_t kMaxCommandLength = 1024;
+    constexpr auto kSnapshotWait = std::chrono::milliseconds(200);
+
+    std::vector<std::string> splitWords(const std::string& line) {
+        std::vector<std::string> words;
+        std::istringstream in(line);
+        std::string word;
+        while (in >> word) {
+            words.push_back(word);
+        }
+        return words;
+    }
+
+} // namespace
+
+AdminServer::AdminServer() : listenFd(-1), running(false), requested(false) {
+}
+
+AdminServer::~AdminServer() {
+    stop();
+}
+
+std::string AdminServer::defaultSocketPath() {
+    if (const char* env = std::getenv("TIME_ARTIFACTS_ADMIN_SOCKET")) {
+        return env;
+    }
+    return "/tmp/time_artifacts_admin.sock";
+}
+
+bool AdminServer::start(const std::string& path) {
+    if (path.empty() || running.load()) {
+        return false;
+    }
+#ifdef _WIN32
+    std::cerr << "[AdminServer] 当前平台不支持Unix套接字，管理接口未启动" << std::endl;
+    return false;
+#else
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "[AdminServer] 套接字路径过长: " << path << std::endl;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "[AdminServer] 创建套接字失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // 上次异常退出可能留下套接字文件
+    ::unlink(path.c_str());
+    mode_t previousMask = ::umask(0077);
+    bool bound = ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    ::umask(previousMask);
+    if (!bound || ::listen(listenFd, 8) != 0) {
+        std::cerr << "[AdminServer] 无法监听 " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    socketPath = path;
+    running.store(true);
+    serverThread = std::thread([this]() { serveLoop(); });
+    std::cout << "[AdminServer] 管理接口已启动: " << socketPath << std::endl;
+    return true;
+#endif
+}
+
+void AdminServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (serverThread.joinable()) {
+        serverThread.join();
+    }
+#ifndef _WIN32
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+#endif
+    listenFd = -1;
+    std::cout << "[AdminServer] 管理接口已停止" << std::endl;
+}
+
+void AdminServer::serveLoop() {
+#ifndef _WIN32
+    static auto& requests = Metrics::instance().counter("admin.requests");
+    while (running.load()) {
+        pollfd listener{listenFd, POLLIN, 0};
+        if (::poll(&listener, 1, 200) <= 0) {
+            continue;
+        }
+        int client = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        timeval timeout{1, 0};
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        // 读到换行或对端关闭写方向为止
+        std::string line;
+        char buffer[256];
+        while (line.size() < kMaxCommandLength && line.find('\n') == std::string::npos) {
+            ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            line.append(buffer, static_cast<size_t>(received));
+        }
+        line = line.substr(0, line.find('\n'));
+
+        requests.fetch_add(1, std::memory_order_relaxed);
+        std::string reply = execute(line);
+        size_t offset = 0;
+        while (offset < reply.size()) {
+            ssize_t sent = ::send(client, reply.data() + offset, reply.size() - offset, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(sent);
+        }
+        ::close(client);
+    }
+#endif
+}
+
+void AdminServer::publish(std::shared_ptr<AdminSnapshot> snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        auto previous = std::atomic_load(&published);
+        snapshot->version = previous ? previous->version + 1 : 1;
+        std::atomic_store(&published, std::shared_ptr<const AdminSnapshot>(std::move(snapshot)));
+        requested.store(false, std::memory_order_release);
+    }
+    publishedSignal.notify_all();
+}
+
+std::shared_ptr<const AdminSnapshot> AdminServer::latest() const {
+    return std::atomic_load(&published);
+}
+
+std::shared_ptr<const AdminSnapshot> AdminServer::freshSnapshot() {
+    std::unique_lock<std::mutex> lock(publishMutex);
+    auto before = std::atomic_load(&published);
+    uint64_t version = before ? before->version : 0;
+    requested.store(true, std::memory_order_release);
+    publishedSignal.wait_for(lock, kSnapshotWait, [&]() {
+        auto current = std::atomic_load(&published);
+        return current && current->version > version;
+    });
+    return std::atomic_load(&published);
+}
+
+std::string AdminServer::execute(const std::string& commandLine) {
+    std::vector<std::string> words = splitWords(commandLine);
+    std::string command = words.empty() ? "help" : words[0];
+
+    if (command == "ticks") {
+        return renderTicks();
+    }
+    if (command == "metrics") {
+        return Metrics::instance().renderText();
+    }
+    if (command == "summary" || command == "events" || command == "sessions") {
+        auto snapshot = freshSnapshot();
+        if (!snapshot) {
+            return "引擎尚未发布快照（主循环未运行或已卡住，见 ticks）\n";
+        }
+        if (command == "summary") {
+            return renderSummary(*snapshot);
+        }
+        if (command == "events") {
+            return renderEvents(*snapshot);
+        }
+        size_t limit = words.size() > 1 ? static_cast<size_t>(std::strtoul(words[1].c_str(), nullptr, 10)) : 10;
+        return renderSessions(*snapshot, limit == 0 ? 10 : limit);
+    }
+
+    std::string reply = command == "help" ? "" : "未知命令: " + command + "\n";
+    return reply +
+        "命令:\n"
+        "  summary        引擎状态、队列长度、会话数\n"
+        "  events         每种事件的订阅者数和处理次数\n"
+        "  sessions [N]   最活跃的N个会话\n"
+        "  ticks          各循环的帧耗时直方图\n"
+        "  metrics        全部运行指标\n";
+}
+
+std::string AdminServer::renderSummary(const AdminSnapshot& snapshot) {
+    auto age = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - snapshot.builtAt);
+    int subscribers = 0;
+    for (const auto& entry : snapshot.subscribers) {
+        subscribers += entry.second;
+    }
+    size_t attached = 0;
+    for (const auto& session : snapshot.sessions) {
+        attached += session.attached ? 1 : 0;
+    }
+
+    std::ostringstream out;
+    out << "快照: #" << snapshot.version << "，" << age.count() << " ms 前生成（第 " << snapshot.frameCount << " 帧）\n"
+        << "引擎状态: " << (snapshot.engineState.empty() ? "-" : snapshot.engineState)
+        << "（状态栈深度 " << snapshot.stateDepth << "）\n"
+        << "事件队列: " << snapshot.queueSize << "，订阅者: " << subscribers
+        << "（" << snapshot.subscribers.size() << " 种事件）\n"
+        << "会话: " << snapshot.sessions.size() << "（在线 " << attached << "）\n";
+    return out.str();
+}
+
+std::string AdminServer::renderEvents(const AdminSnapshot& snapshot) {
+    std::map<std::string, std::pair<int, int>> rows;     // 类型 -> (订阅者, 处理次数)
+    for (const auto& entry : snapshot.subscribers) {
+        rows[entry.first].first = entry.second;
+    }
+    for (const auto& entry : snapshot.eventCounts) {
+        rows[entry.first].second = entry.second;
+    }
+    std::vector<std::pair<std::string, std::pair<int, int>>> sorted(rows.begin(), rows.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.second > b.second.second;
+    });
+
+    std::ostringstream out;
+    out << std::left << std::setw(28) << "event" << std::right << std::setw(12) << "subscribers"
+        << std::setw(12) << "processed" << "\n";
+    for (const auto& row : sorted) {
+        out << std::left << std::setw(28) << row.first << std::right << std::setw(12) << row.second.first
+            << std::setw(12) << row.second.second << "\n";
+    }
+    out << "队列中: " << snapshot.queueSize << "\n";
+    return out.str();
+}
+
+std::string AdminServer::renderSessions(const AdminSnapshot& snapshot, size_t limit) {
+    std::vector<const AdminSnapshot::SessionInfo*> sorted;
+    for (const auto& session : snapshot.sessions) {
+        sorted.push_back(&session);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+        return a->recentMessages != b->recentMessages ? a->recentMessages > b->recentMessages
+                                                      : a->messages > b->messages;
+    });
+    if (sorted.size() > limit) {
+        sorted.resize(limit);
+    }
+
+    std::ostringstream out;
+    out << std::left << std::setw(14) << "session" << std::setw(10) << "conn" << std::setw(11) << "mode"
+        << std::setw(24) << "location" << std::right << std::setw(8) << "recent" << std::setw(10) << "messages"
+        << std::setw(8) << "idle s" << std::setw(8) << "events" << std::setw(10) << "wait us" << "  dialogue\n";
+    for (const auto* session : sorted) {
+        out << std::left << std::setw(14) << session->id << std::setw(10) << (session->attached ? "online" : "detached")
+            << std::setw(11) << (session->dialogue.empty() ? "EXPLORING" : "DIALOGUE")
+            << std::setw(24) << session->location << std::right << std::setw(8) << session->recentMessages
+            << std::setw(10) << session->messages << std::setw(8) << session->idleSeconds
+            << std::setw(8) << session->queuedEvents << std::setw(10) << std::fixed << std::setprecision(0)
+            << session->eventWaitMicros << "  " << (session->dialogue.empty() ? "-" : session->dialogue) << "\n";
+    }
+    out << "共 " << snapshot.sessions.size() << " 个会话\n";
+    return out.str();
+}
+
+std::string AdminServer::renderTicks() {
+    std::ostringstream out;
+    for (const auto& shard : TickWatchdog::instance().shardStats()) {
+        uint64_t total = 0;
+        uint64_t peak = 1;
+        for (uint64_t count : shard.histogram) {
+            total += count;
+            peak = std::max(peak, count);
+        }
+        out << shard.name << "：预算 " << shard.budget.count() << " ms，已运行 " << shard.heartbeat << " 轮";
+        if (shard.currentTickMillis > 0) {
+            out << "，当前一轮已持续 " << shard.currentTickMillis << " ms";
+        }
+        out << "\n";
+
+        for (size_t i = 0; i < shard.histogram.size(); ++i) {
+            double limit = TickWatchdog::bucketLimitMillis(i);
+            std::ostringstream label;
+            if (limit > 0) {
+                label << "< " << limit << " ms";
+            } else {
+                label << ">= " << TickWatchdog::bucketLimitMillis(i - 1) << " ms";
+            }
+            size_t bar = static_cast<size_t>(40 * shard.histogram[i] / peak);
+            out << "  " << std::left << std::setw(12) << label.str() << std::right << std::setw(10) << shard.histogram[i]
+                << std::setw(7) << std::fixed << std::setprecision(1)
+                << (total ? 100.0 * shard.histogram[i] / total : 0.0) << "%  " << std::string(bar, '#') << "\n";
+        }
+    }
+    if (out.tellp() == 0) {
+        out << "没有正在运行的循环\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,130 @@
+/**
+ * AdminServer.h
+ *
+ * 管理接口 - 本机Unix套接字，不挂调试器查看运行中服务器的事件队列、会话和帧耗时
+ *
+ * 【文件作用】：
+ * 1. 在独立线程上监听Unix套接字（默认 /tmp/time_artifacts_admin.sock，权限0600）
+ * 2. 每个连接发送一行命令，服务器返回文本后关闭连接；客户端见 TimeArtifacts --admin
+ * 3. 引擎状态（事件队列、订阅者、会话）来自主循环发布的只读快照：
+ *    收到请求时设置标志，主循环在下一帧生成快照并以 std::atomic_store 发布，
+ *    管理线程最多等待200ms后读取最近一次的快照——没有人查询时主循环不做任何额外工作，
+ *    主循环卡住时也能拿到（带有年龄的）旧快照
+ * 4. 帧耗时直方图直接读取看门狗的原子计数，运行指标读取Metrics
+ *
+ * 【命令】：
+ *   summary        引擎状态、队列长度、会话数、快照年龄
+ *   events         每种事件的订阅者数和累计处理次数（按处理次数排序）
+ *   sessions [N]   最活跃的N个会话（按上次快照以来的消息数，默认10），含排队事件数和平均等待时间
+ *   ticks          各循环的帧耗时直方图
+ *   metrics        全部运行指标
+ *
+ * 【配置】：环境变量 TIME_ARTIFACTS_ADMIN_SOCKET 设置套接字路径，设为空字符串时不启动
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 主循环发布的引擎快照（发布后只读）
+ */
+struct AdminSnapshot {
+    /**
+     * 单个会话
+     */
+    struct SessionInfo {
+        std::string id;
+        bool attached = false;
+        std::string location;
+        std::string dialogue;               // 为空表示不在对话中
+        uint64_t messages = 0;              // 累计消息数
+        uint64_t recentMessages = 0;        // 上次快照以来的消息数
+        int64_t idleSeconds = 0;
+        size_t queuedEvents = 0;            // 事件队列中属于该会话的事件
+        double eventWaitMicros = 0;         // 事件平均等待时间
+    };
+
+    uint64_t version = 0;
+    std::chrono::steady_clock::time_point builtAt;
+    int frameCount = 0;
+    std::string engineState;                // StateManager当前状态（为空表示没有状态）
+    size_t stateDepth = 0;
+    int queueSize = 0;
+    std::map<std::string, int> subscribers; // 事件类型 -> 订阅者数
+    std::map<std::string, int> eventCounts; // 事件类型 -> 累计处理次数
+    std::vector<SessionInfo> sessions;
+};
+
+/**
+ * 管理接口服务器
+ */
+class AdminServer {
+public:
+    AdminServer();
+    ~AdminServer();
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    /**
+     * 开始监听
+     * 【返回】：路径为空、平台不支持或绑定失败时返回false（不影响游戏服务器）
+     */
+    bool start(const std::string& socketPath);
+
+    void stop();
+
+    /**
+     * 是否有请求在等待新快照（主循环每帧调用）
+     */
+    bool snapshotRequested() const { return requested.load(std::memory_order_acquire); }
+
+    /**
+     * 发布新快照（主循环调用）
+     */
+    void publish(std::shared_ptr<AdminSnapshot> snapshot);
+
+    /**
+     * 最近一次发布的快照（可能为空）
+     */
+    std::shared_ptr<const AdminSnapshot> latest() const;
+
+    /**
+     * 默认套接字路径（环境变量 TIME_ARTIFACTS_ADMIN_SOCKET 或 /tmp/time_artifacts_admin.sock）
+     */
+    static std::string defaultSocketPath();
+
+    /**
+     * 执行一条命令，返回文本回复（管理线程调用；也供测试直接调用）
+     */
+    std::string execute(const std::string& commandLine);
+
+private:
+    void serveLoop();
+    std::shared_ptr<const AdminSnapshot> freshSnapshot();
+
+    std::string renderSummary(const AdminSnapshot& snapshot);
+    std::string renderEvents(const AdminSnapshot& snapshot);
+    std::string renderSessions(const AdminSnapshot& snapshot, size_t limit);
+    std::string renderTicks();
+
+    std::string socketPath;
+    int listenFd;
+    std::thread serverThread;
+    std::atomic<bool> running;
+
+    std::shared_ptr<const AdminSnapshot> published;     // 通过 std::atomic_load/store 访问
+    std::atomic<bool> requested;
+    std::mutex publishMutex;                            // 只用于等待新快照
+    std::condition_variable publishedSignal;
+};
@@ -0,0 +1,220 @@
+/**
+ * ChoiceStatistics.cpp
+ *
+ * 玩家选择统计实现
+ */
+
+#include "ChoiceStatistics.h"
+#include "WorldData.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "utils/SimpleJson.h"
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+    // 每个分片的槽数向上对齐到8个计数器（64字节），避免相邻分片共享缓存行
+    constexpr size_t kSlotsPerCacheLine = 64 / sizeof(std::atomic<uint64_t>);
+
+} // namespace
+
+int ChoiceSnapshot::percentFor(const std::string& dialogueId, const std::string& optionId) const {
+    auto it = dialogues.find(dialogueId);
+    if (it == dialogues.end() || it->second.total == 0) {
+        return -1;
+    }
+    for (const auto& option : it->second.options) {
+        if (option.optionId == optionId) {
+            return option.percent;
+        }
+    }
+    return 0;
+}
+
+std::string ChoiceSnapshot::toJson() const {
+    using SimpleJson::Value;
+
+    Value root = Value::object();
+    root.set("version", Value(static_cast<double>(version)));
+    root.set("totalChoices", Value(static_cast<double>(totalChoices)));
+
+    Value dialogueValues = Value::object();
+    for (const auto& dialogue : std::map<std::string, DialogueStats>(dialogues.begin(), dialogues.end())) {
+        Value options = Value::object();
+        for (const auto& option : dialogue.second.options) {
+            Value optionValue = Value::object();
+            optionValue.set("count", Value(static_cast<double>(option.count)));
+            optionValue.set("percent", Value(option.percent));
+            options.set(option.optionId, std::move(optionValue));
+        }
+        Value dialogueValue = Value::object();
+        dialogueValue.set("total", Value(static_cast<double>(dialogue.second.total)));
+        dialogueValue.set("options", std::move(options));
+        dialogueValues.set(dialogue.first, std::move(dialogueValue));
+    }
+    root.set("dialogues", std::move(dialogueValues));
+
+    Value locations = Value::object();
+    for (const auto& entry : locationVisitors) {
+        locations.set(entry.first, Value(static_cast<double>(entry.second)));
+    }
+    root.set("uniqueVisitorsByLocation", std::move(locations));
+
+    Value insights = Value::object();
+    for (const auto& entry : insightHolders) {
+        insights.set(entry.first, Value(static_cast<double>(entry.second)));
+    }
+    root.set("uniquePlayersByInsight", std::move(insights));
+
+    return root.dump();
+}
+
+ChoiceStatistics& ChoiceStatistics::instance() {
+    static ChoiceStatistics statistics;
+    return statistics;
+}
+
+ChoiceStatistics::ChoiceStatistics()
+    : slotCount(0)
+    , shardStride(0)
+    , published(std::make_shared<const ChoiceSnapshot>())
+    , lastMerge(std::chrono::steady_clock::now())
+    , mergeCount(0) {
+}
+
+void ChoiceStatistics::initialize(const WorldData& world) {
+    MemoryScope memoryScope(MemoryTag::Statistics);
+    std::lock_guard<std::mutex> lock(mergeMutex);
+
+    dialogueIndex.clear();
+    slotCount = 0;
+    for (const auto& entry : world.getDialogues()) {
+        DialogueIndex index;
+        index.firstSlot = static_cast<uint32_t>(slotCount);
+        for (const auto& option : entry.second.options) {
+            index.optionIds.push_back(option.id);
+        }
+        slotCount += index.optionIds.size();
+        dialogueIndex[entry.first] = std::move(index);
+    }
+
+    shardStride = (slotCount + kSlotsPerCacheLine - 1) / kSlotsPerCacheLine * kSlotsPerCacheLine;
+    counters.reset(new std::atomic<uint64_t>[kShardCount * shardStride]);
+    for (size_t i = 0; i < kShardCount * shardStride; ++i) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+
+    locationIds.clear();
+    locationIndex.clear();
+    for (const auto& entry : world.getLocations()) {
+        locationIndex[entry.first] = locationIds.size();
+        locationIds.push_back(entry.first);
+    }
+    insightIds = world.collectInsightIds();
+    insightIndex.clear();
+    for (size_t i = 0; i < insightIds.size(); ++i) {
+        insightIndex[insightIds[i]] = i;
+    }
+    locationSketches.reset(new HyperLogLog[locationIds.size()]);
+    insightSketches.reset(new HyperLogLog[insightIds.size()]);
+
+    std::atomic_store(&published, std::make_shared<const ChoiceSnapshot>());
+    std::cout << "[ChoiceStatistics] 统计索引已建立: " << slotCount << " 个对话选项、"
+              << locationIds.size() << " 个场景、" << insightIds.size() << " 个洞察" << std::endl;
+}
+
+size_t ChoiceStatistics::currentShard() {
+    static std::atomic<size_t> nextShard{0};
+    thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+    return shard;
+}
+
+void ChoiceStatistics::recordChoice(const std::string& dialogueId, const std::string& optionId) {
+    auto it = dialogueIndex.find(dialogueId);
+    if (it == dialogueIndex.end()) {
+        return;
+    }
+    const DialogueIndex& index = it->second;
+    for (size_t i = 0; i < index.optionIds.size(); ++i) {
+        if (index.optionIds[i] == optionId) {
+            // 分片只被少数线程写入，relaxed加法不会在线程间来回传递缓存行
+            counters[currentShard() * shardStride + index.firstSlot + i].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+void ChoiceStatistics::recordLocationVisit(const std::string& playerId, const std::string& locationId) {
+    auto it = locationIndex.find(locationId);
+    if (it != locationIndex.end()) {
+        locationSketches[it->second].add(playerId);
+    }
+}
+
+void ChoiceStatistics::recordInsight(const std::string& playerId, const std::string& insightId) {
+    auto it = insightIndex.find(insightId);
+    if (it != insightIndex.end()) {
+        insightSketches[it->second].add(playerId);
+    }
+}
+
+bool ChoiceStatistics::mergeIfDue(std::chrono::steady_clock::duration interval) {
+    if (std::chrono::steady_clock::now() - lastMerge < interval) {
+        return false;
+    }
+    merge();
+    return true;
+}
+
+void ChoiceStatistics::merge() {
+    MemoryScope memoryScope(MemoryTag::Statistics);
+    std::lock_guard<std::mutex> lock(mergeMutex);
+
+    auto next = std::make_shared<ChoiceSnapshot>();
+    next->version = ++mergeCount;
+
+    for (const auto& entry : dialogueIndex) {
+        const DialogueIndex& index = entry.second;
+        ChoiceSnapshot::DialogueStats stats;
+        for (size_t i = 0; i < index.optionIds.size(); ++i) {
+            ChoiceSnapshot::OptionStats option;
+            option.optionId = index.optionIds[i];
+            for (size_t shard = 0; shard < kShardCount; ++shard) {
+                option.count += counters[shard * shardStride + index.firstSlot + i].load(std::memory_order_relaxed);
+            }
+            stats.total += option.count;
+            stats.options.push_back(std::move(option));
+        }
+        if (stats.total > 0) {
+            for (auto& option : stats.options) {
+                option.percent = static_cast<int>(std::lround(100.0 * static_cast<double>(option.count) /
+                                                              static_cast<double>(stats.total)));
+            }
+        }
+        next->totalChoices += stats.total;
+        next->dialogues[entry.first] = std::move(stats);
+    }
+
+    for (size_t i = 0; i < locationIds.size(); ++i) {
+        next->locationVisitors[locationIds[i]] = static_cast<uint64_t>(std::llround(locationSketches[i].estimate()));
+    }
+    for (size_t i = 0; i < insightIds.size(); ++i) {
+        next->insightHolders[insightIds[i]] = static_cast<uint64_t>(std::llround(insightSketches[i].estimate()));
+    }
+
+    std::atomic_store(&published, std::shared_ptr<const ChoiceSnapshot>(std::move(next)));
+    lastMerge = std::chrono::steady_clock::now();
+}
+
+std::shared_ptr<const ChoiceSnapshot> ChoiceStatistics::snapshot() const {
+    return std::atomic_load(&published);
+}
+
+void ChoiceStatistics::registerMetrics() {
+    Metrics::instance().registerCollector("choice_statistics", [this](Metrics::Samples& out) {
+        auto current = snapshot();
+        out["stats.snapshot_version"] = static_cast<double>(current->version);
+        out["stats.choices_total"] = static_cast<double>(current->totalChoices);
+    });
+}
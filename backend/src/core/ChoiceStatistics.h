@@ -0,0 +1,157 @@
+/**
+ * ChoiceStatistics.h
+ *
+ * 玩家选择统计 - "37%的旅人选择了这个选项"、场景/洞察的独立玩家数
+ *
+ * 【文件作用】：
+ * 1. 记录每个对话选项被选择的次数（按线程分片的计数器，写入无锁、无共享缓存行）
+ * 2. 用HyperLogLog估计每个场景、每个洞察的独立玩家数
+ * 3. 定期把分片合并成只读快照并原子发布；读取方拿到快照指针后无需任何锁
+ *
+ * 【数据流】：
+ *   会话线程 recordChoice() → 本线程的计数分片
+ *   主循环   mergeIfDue()   → 汇总所有分片 → 发布新快照
+ *   任意线程 snapshot()     → 读取最近一次发布的快照
+ *
+ * 【说明】：选项、场景、洞察的索引在启动时按世界数据建立，之后只读；
+ *   世界数据之外的ID不统计
+ */
+
+#pragma once
+
+#include "utils/HyperLogLog.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorldData;
+
+/**
+ * 选择统计快照（发布后只读）
+ */
+struct ChoiceSnapshot {
+    /**
+     * 单个选项
+     */
+    struct OptionStats {
+        std::string optionId;
+        uint64_t count = 0;
+        int percent = 0;        // 占该对话节点全部选择的百分比（四舍五入）
+    };
+
+    /**
+     * 单个对话节点
+     */
+    struct DialogueStats {
+        uint64_t total = 0;
+        std::vector<OptionStats> options;
+    };
+
+    uint64_t version = 0;                                   // 第几次合并
+    uint64_t totalChoices = 0;
+    std::unordered_map<std::string, DialogueStats> dialogues;
+    std::map<std::string, uint64_t> locationVisitors;      // 场景 -> 独立玩家数（估计）
+    std::map<std::string, uint64_t> insightHolders;        // 洞察 -> 独立玩家数（估计）
+
+    /**
+     * 某个选项的百分比
+     * 【返回】：该节点还没有任何选择时返回-1
+     */
+    int percentFor(const std::string& dialogueId, const std::string& optionId) const;
+
+    /**
+     * 导出为JSON（设计人员查看，GET /stats）
+     */
+    std::string toJson() const;
+};
+
+/**
+ * 选择统计类（全局单例）
+ */
+class ChoiceStatistics {
+public:
+    static ChoiceStatistics& instance();
+
+    ChoiceStatistics(const ChoiceStatistics&) = delete;
+    ChoiceStatistics& operator=(const ChoiceStatistics&) = delete;
+
+    /**
+     * 按世界数据建立索引（启动时调用一次，必须早于任何记录）
+     */
+    void initialize(const WorldData& world);
+
+    /**
+     * 记录一次对话选择（任意线程）
+     */
+    void recordChoice(const std::string& dialogueId, const std::string& optionId);
+
+    /**
+     * 记录玩家到访场景（任意线程）
+     */
+    void recordLocationVisit(const std::string& playerId, const std::string& locationId);
+
+    /**
+     * 记录玩家获得洞察（任意线程）
+     */
+    void recordInsight(const std::string& playerId, const std::string& insightId);
+
+    /**
+     * 距上次合并超过间隔时合并（主循环每帧调用）
+     * 【返回】：本次是否合并
+     */
+    bool mergeIfDue(std::chrono::steady_clock::duration interval = std::chrono::seconds(1));
+
+    /**
+     * 立即合并所有分片并发布新快照
+     */
+    void merge();
+
+    /**
+     * 最近一次发布的快照（不会为空）
+     */
+    std::shared_ptr<const ChoiceSnapshot> snapshot() const;
+
+    /**
+     * 注册运行指标
+     */
+    void registerMetrics();
+
+private:
+    ChoiceStatistics();
+
+    // 分片数（2的幂）；线程按首次记录的顺序轮流分配分片
+    static constexpr size_t kShardCount = 16;
+
+    /**
+     * 对话节点的索引：选项在计数数组中从firstSlot开始连续排列
+     */
+    struct DialogueIndex {
+        uint32_t firstSlot = 0;
+        std::vector<std::string> optionIds;
+    };
+
+    static size_t currentShard();
+
+    std::unordered_map<std::string, DialogueIndex> dialogueIndex;
+    size_t slotCount;
+    size_t shardStride;                                     // 每个分片的槽数（对齐到缓存行）
+    std::unique_ptr<std::atomic<uint64_t>[]> counters;      // kShardCount * shardStride
+
+    std::unordered_map<std::string, size_t> locationIndex;
+    std::unordered_map<std::string, size_t> insightIndex;
+    std::vector<std::string> locationIds;
+    std::vector<std::string> insightIds;
+    std::unique_ptr<HyperLogLog[]> locationSketches;
+    std::unique_ptr<HyperLogLog[]> insightSketches;
+
+    std::shared_ptr<const ChoiceSnapshot> published;        // 通过 std::atomic_load/store 访问
+    std::mutex mergeMutex;                                  // 只串行化合并，不影响记录和读取
+    std::chrono::steady_clock::time_point lastMerge;
+    uint64_t mergeCount;
+};
@@ -0,0 +1,639 @@
+/**
+ * ConnectionAcceptor.cpp
+ *
+ * 连接接入流水线实现
+ */
+
+#include "ConnectionAcceptor.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "WebSocketFrame.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * 握手线程中等待请求的连接
+ */
+struct ConnectionAcceptor::Pending {
+    int fd = -1;
+    std::string buffer;
+    Clock::time_point acceptedAt;
+    std::unique_ptr<TlsSession> tls;
+    bool secured = false;               // TLS握手已完成
+    bool wantWrite = false;             // TLS需要等待套接字可写
+};
+
+/**
+ * 握手线程
+ */
+struct ConnectionAcceptor::Worker {
+    std::thread thread;
+    int wakePipe[2] = {-1, -1};
+    std::mutex mutex;
+    std::vector<Pending> incoming;      // 接入线程投递，握手线程取走
+};
+
+#ifndef _WIN32
+
+namespace {
+
+    // 每批最多accept的连接数（之后先把这批分给握手线程）
+    constexpr size_t kAcceptBatch = 64;
+
+    // 连上后迟迟不发完请求的连接在握手线程里最多保留的时间
+    constexpr auto kHandshakeTimeout = std::chrono::seconds(10);
+
+    constexpr size_t kDefaultWorkers = 2;
+
+    const char kServiceUnavailable[] =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Content-Type: text/plain; charset=utf-8\r\n"
+        "Content-Length: 20\r\n"
+        "Retry-After: 1\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "Server is too busy.\n";
+
+    void setNonBlocking(int fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        if (flags >= 0) {
+            ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        }
+    }
+
+    void setCloseOnExec(int fd) {
+        int flags = ::fcntl(fd, F_GETFD, 0);
+        if (flags >= 0) {
+            ::fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+        }
+    }
+
+    /**
+     * 接受一个连接，返回已设置非阻塞和CLOEXEC的套接字
+     */
+    int acceptOne(int listenFd) {
+#ifdef __linux__
+        return ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd >= 0) {
+            setNonBlocking(fd);
+            setCloseOnExec(fd);
+        }
+        return fd;
+#endif
+    }
+
+    void drainPipe(int fd) {
+        char buffer[64];
+        while (::read(fd, buffer, sizeof(buffer)) > 0) {
+        }
+    }
+
+    void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t elapsedMicros(ConnectionAcceptor::Clock::time_point from, ConnectionAcceptor::Clock::time_point to) {
+        return static_cast<uint64_t>(std::max<int64_t>(
+            0, std::chrono::duration_cast<std::chrono::microseconds>(to - from).count()));
+    }
+
+} // namespace
+
+ConnectionAcceptor::ConnectionAcceptor(int listenFd, std::function<void()> notify, TlsContext* tls)
+    : listenFd(listenFd), notify(std::move(notify)), tlsContext(tls) {
+}
+
+ConnectionAcceptor::~ConnectionAcceptor() {
+    stop();
+}
+
+bool ConnectionAcceptor::start() {
+    if (running) {
+        return true;
+    }
+
+    size_t workerCount = kDefaultWorkers;
+    if (const char* env = std::getenv("TIME_ARTIFACTS_HANDSHAKE_WORKERS")) {
+        workerCount = static_cast<size_t>(std::max(1L, std::strtol(env, nullptr, 10)));
+    }
+    if (const char* env = std::getenv("TIME_ARTIFACTS_ADMIT_RATE")) {
+        admitRate = std::max(0.0, std::strtod(env, nullptr));
+    }
+    if (const char* env = std::getenv("TIME_ARTIFACTS_ADMIT_BACKLOG")) {
+        maxBacklog = static_cast<size_t>(std::max(1L, std::strtol(env, nullptr, 10)));
+    }
+    // 一轮事件循环最多放行约50ms的配额
+    admitBurst = std::max(1.0, admitRate / 20.0);
+    tokens = admitBurst;
+    lastRefill = Clock::now();
+
+    if (::pipe(stopPipe) != 0) {
+        std::cerr << "[ConnectionAcceptor] 创建管道失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < workerCount; ++i) {
+        auto worker = std::make_unique<Worker>();
+        if (::pipe(worker->wakePipe) != 0) {
+            std::cerr << "[ConnectionAcceptor] 创建管道失败: " << std::strerror(errno) << std::endl;
+            for (int fd : worker->wakePipe) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+            stop();
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+    for (int fd : stopPipe) {
+        setNonBlocking(fd);
+        setCloseOnExec(fd);
+    }
+    for (auto& worker : workers) {
+        for (int fd : worker->wakePipe) {
+            setNonBlocking(fd);
+            setCloseOnExec(fd);
+        }
+    }
+
+    running = true;
+    registerMetrics();
+    for (auto& worker : workers) {
+        Worker* target = worker.get();
+        worker->thread = std::thread([this, target]() {
+            workerLoop(*target);
+        });
+    }
+    acceptThread = std::thread([this]() {
+        acceptLoop();
+    });
+
+    std::cout << "[ConnectionAcceptor] 接入线程已启动，握手线程: " << workerCount << "，放行速率: ";
+    if (admitRate > 0) {
+        std::cout << admitRate << "/s";
+    } else {
+        std::cout << "不限";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+void ConnectionAcceptor::stop() {
+    bool wasRunning = running.exchange(false);
+    if (wasRunning) {
+        char byte = 0;
+        (void)!::write(stopPipe[1], &byte, 1);
+        for (auto& worker : workers) {
+            (void)!::write(worker->wakePipe[1], &byte, 1);
+        }
+    }
+
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        for (auto& pending : worker->incoming) {
+            ::close(pending.fd);
+        }
+        for (int fd : worker->wakePipe) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+    workers.clear();
+    for (int& fd : stopPipe) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(readyMutex);
+    for (auto* queue : {&readyPlain, &readyUpgrades}) {
+        for (auto& ready : *queue) {
+            ::close(ready.fd);
+        }
+        queue->clear();
+    }
+    if (wasRunning) {
+        Metrics::instance().unregisterCollector("connection_acceptor");
+    }
+}
+
+// 接入线程：批量accept，按轮转分给握手线程
+void ConnectionAcceptor::acceptLoop() {
+    static auto& acceptedCounter = Metrics::instance().counter("network.connections_accepted");
+    static auto& batchCounter = Metrics::instance().counter("network.accept_batches");
+    static auto& errorCounter = Metrics::instance().counter("network.accept_errors");
+
+    MemoryScope memoryScope(MemoryTag::Network);
+    pollfd fds[2] = {{listenFd, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+    std::vector<bool> touched(workers.size());
+
+    while (running) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[ConnectionAcceptor] poll失败: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (!running) {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        bool more = true;
+        while (more && running) {
+            std::fill(touched.begin(), touched.end(), false);
+            size_t count = 0;
+            Clock::time_point now = Clock::now();
+            while (count < kAcceptBatch) {
+                int fd = acceptOne(listenFd);
+                if (fd < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                        // 描述符耗尽：稍后重试，避免空转
+                        errorCounter.fetch_add(1, std::memory_order_relaxed);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                    more = false;
+                    break;
+                }
+                int enable = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#ifdef SO_NOSIGPIPE
+                ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+                size_t index = nextWorker++ % workers.size();
+                {
+                    std::lock_guard<std::mutex> lock(workers[index]->mutex);
+                    Pending pending;
+                    pending.fd = fd;
+                    pending.acceptedAt = now;
+                    workers[index]->incoming.push_back(std::move(pending));
+                }
+                touched[index] = true;
+                ++count;
+            }
+            if (count == 0) {
+                break;
+            }
+
+            acceptedCounter.fetch_add(static_cast<int64_t>(count), std::memory_order_relaxed);
+            batchCounter.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < workers.size(); ++i) {
+                if (touched[i]) {
+                    char byte = 1;
+                    (void)!::write(workers[i]->wakePipe[1], &byte, 1);
+                }
+            }
+        }
+    }
+}
+
+// 握手线程：读取第一个请求，为升级请求计算握手响应
+void ConnectionAcceptor::workerLoop(Worker& worker) {
+    static auto& timeoutCounter = Metrics::instance().counter("network.handshake_timeouts");
+
+    MemoryScope memoryScope(MemoryTag::Network);
+    std::vector<Pending> pending;
+    std::vector<pollfd> fds;
+
+    while (running) {
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            for (auto& item : worker.incoming) {
+                pending.push_back(std::move(item));
+            }
+            worker.incoming.clear();
+        }
+
+        fds.clear();
+        fds.push_back({worker.wakePipe[0], POLLIN, 0});
+        for (const auto& item : pending) {
+            fds.push_back({item.fd, static_cast<short>(item.wantWrite ? POLLOUT : POLLIN), 0});
+        }
+
+        if (::poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+            std::cerr << "[ConnectionAcceptor] poll失败: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            drainPipe(worker.wakePipe[0]);
+        }
+
+        // 逐个处理；完成（交出或关闭）的连接从列表中移除
+        Clock::time_point now = Clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            bool done = false;
+            if (fds[i + 1].revents != 0) {
+                done = readRequest(pending[i]);
+            }
+            if (!done && now - pending[i].acceptedAt > kHandshakeTimeout) {
+                ::close(pending[i].fd);
+                timeoutCounter.fetch_add(1, std::memory_order_relaxed);
+                done = true;
+            }
+            if (!done) {
+                if (kept != i) {
+                    pending[kept] = std::move(pending[i]);
+                }
+                ++kept;
+            }
+        }
+        pending.resize(kept);
+    }
+
+    for (auto& item : pending) {
+        ::close(item.fd);
+    }
+}
+
+// 推进TLS握手
+// 【返回】：握手完成时返回true；失败时关闭连接并把finished置为true
+bool ConnectionAcceptor::secureHandshake(Pending& pending, bool& finished) {
+    static auto& handshakeCounter = Metrics::instance().counter("tls.handshakes");
+    static auto& failureCounter = Metrics::instance().counter("tls.handshake_failures");
+    static auto& kernelSendCounter = Metrics::instance().counter("tls.ktls_send");
+    static auto& kernelReceiveCounter = Metrics::instance().counter("tls.ktls_receive");
+    static std::atomic<bool> reported{false};
+
+    if (!pending.tls) {
+        pending.tls = tlsContext->newSession(pending.fd);
+    }
+    TlsSession::Result result = pending.tls ? pending.tls->handshake() : TlsSession::Result::Failed;
+    if (result == TlsSession::Result::WantRead || result == TlsSession::Result::WantWrite) {
+        pending.wantWrite = result == TlsSession::Result::WantWrite;
+        return false;
+    }
+    if (result != TlsSession::Result::Ok) {
+        pending.tls.reset();
+        ::close(pending.fd);
+        failureCounter.fetch_add(1, std::memory_order_relaxed);
+        finished = true;
+        return false;
+    }
+
+    pending.secured = true;
+    pending.wantWrite = false;
+    handshakeCounter.fetch_add(1, std::memory_order_relaxed);
+    bool kernelSend = pending.tls->kernelSend();
+    if (kernelSend) {
+        kernelSendCounter.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (pending.tls->kernelReceive()) {
+        kernelReceiveCounter.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!reported.exchange(true)) {
+        std::cout << "[TLS] 首个连接: " << pending.tls->describe() << "，内核加密发送: "
+                  << (kernelSend ? "是（writev/sendfile零拷贝）" : "否（回退到用户态SSL_write）") << std::endl;
+    }
+    return true;
+}
+
+// 读取到请求头完整为止（启用TLS时先完成握手）
+// 【返回】：连接已交给就绪队列或已关闭时返回true
+bool ConnectionAcceptor::readRequest(Pending& pending) {
+    if (tlsContext && !pending.secured) {
+        bool finished = false;
+        if (!secureHandshake(pending, finished)) {
+            return finished;
+        }
+    }
+
+    char buffer[4096];
+    bool peerClosed = false;
+    while (pending.tls) {
+        size_t received = 0;
+        TlsSession::Result result = pending.tls->read(buffer, sizeof(buffer), received);
+        if (result == TlsSession::Result::Ok) {
+            pending.buffer.append(buffer, received);
+            continue;
+        }
+        if (result == TlsSession::Result::Closed) {
+            peerClosed = true;
+        } else if (result == TlsSession::Result::Failed) {
+            ::close(pending.fd);
+            return true;
+        }
+        pending.wantWrite = result == TlsSession::Result::WantWrite;
+        break;
+    }
+    while (!pending.tls) {
+        ssize_t received = ::recv(pending.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            pending.buffer.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received == 0) {
+            peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            ::close(pending.fd);
+            return true;
+        }
+        break;
+    }
+
+    HttpRequest request;
+    size_t consumed = 0;
+    Http::ParseResult result = Http::parseRequest(pending.buffer, request, consumed);
+    if (result == Http::ParseResult::Incomplete) {
+        if (peerClosed) {
+            ::close(pending.fd);
+            return true;
+        }
+        return false;
+    }
+
+    Ready ready;
+    ready.fd = pending.fd;
+    ready.acceptedAt = pending.acceptedAt;
+    ready.tls = std::move(pending.tls);
+
+    // 版本或key不合法的升级请求也原样交还，由事件循环回复400
+    if (result == Http::ParseResult::Ok && request.isWebSocketUpgrade()) {
+        std::string key = request.header("sec-websocket-key");
+        if (!key.empty() && request.header("sec-websocket-version") == "13") {
+            ready.upgrade = true;
+            ready.acceptKey = WebSocketFrame::computeAcceptKey(key);
+            ready.buffered = pending.buffer.substr(consumed);
+            ready.request = std::move(request);
+        }
+    }
+    if (!ready.upgrade) {
+        ready.buffered = std::move(pending.buffer);
+    }
+
+    ready.readyAt = Clock::now();
+    finishPending(pending, ready.readyAt);
+    pushReady(std::move(ready));
+    return true;
+}
+
+// 记录从accept到请求就绪的耗时
+void ConnectionAcceptor::finishPending(Pending& pending, Clock::time_point now) {
+    uint64_t micros = elapsedMicros(pending.acceptedAt, now);
+    handshakes.fetch_add(1, std::memory_order_relaxed);
+    handshakeMicros.fetch_add(micros, std::memory_order_relaxed);
+    updateMax(handshakeMaxMicros, micros);
+}
+
+// 放入就绪队列；升级连接排队过多时回复503
+void ConnectionAcceptor::pushReady(Ready ready) {
+    static auto& rejectedCounter = Metrics::instance().counter("network.admission_rejected");
+
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        if (!ready.upgrade) {
+            readyPlain.push_back(std::move(ready));
+        } else if (readyUpgrades.size() < maxBacklog) {
+            readyUpgrades.push_back(std::move(ready));
+        } else {
+            if (ready.tls) {
+                size_t written = 0;
+                ready.tls->write(kServiceUnavailable, sizeof(kServiceUnavailable) - 1, written);
+                ready.tls->shutdown();
+            } else {
+                ::send(ready.fd, kServiceUnavailable, sizeof(kServiceUnavailable) - 1, MSG_NOSIGNAL);
+            }
+            ::close(ready.fd);
+            rejectedCounter.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (notify) {
+        notify();
+    }
+}
+
+void ConnectionAcceptor::refillTokens(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    lastRefill = now;
+    tokens = std::min(admitBurst, tokens + elapsed * admitRate);
+}
+
+size_t ConnectionAcceptor::takeReady(std::vector<Ready>& out) {
+    Clock::time_point now = Clock::now();
+    size_t before = out.size();
+
+    std::lock_guard<std::mutex> lock(readyMutex);
+    while (!readyPlain.empty()) {
+        out.push_back(std::move(readyPlain.front()));
+        readyPlain.pop_front();
+    }
+    if (readyUpgrades.empty()) {
+        return out.size() - before;
+    }
+
+    refillTokens(now);
+    while (!readyUpgrades.empty() && (admitRate <= 0 || tokens >= 1.0)) {
+        if (admitRate > 0) {
+            tokens -= 1.0;
+        }
+        uint64_t waited = elapsedMicros(readyUpgrades.front().readyAt, now);
+        admitted.fetch_add(1, std::memory_order_relaxed);
+        admitWaitMicros.fetch_add(waited, std::memory_order_relaxed);
+        updateMax(admitWaitMaxMicros, waited);
+        out.push_back(std::move(readyUpgrades.front()));
+        readyUpgrades.pop_front();
+    }
+    return out.size() - before;
+}
+
+int ConnectionAcceptor::admissionDelayMillis(int idleMillis) const {
+    std::lock_guard<std::mutex> lock(readyMutex);
+    if (!readyPlain.empty() || (!readyUpgrades.empty() && admitRate <= 0)) {
+        return 0;
+    }
+    if (readyUpgrades.empty()) {
+        return idleMillis;
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - lastRefill).count();
+    double missing = 1.0 - (tokens + elapsed * admitRate);
+    if (missing <= 0) {
+        return 0;
+    }
+    int delay = static_cast<int>(std::ceil(missing / admitRate * 1000.0));
+    return std::max(1, std::min(idleMillis, delay));
+}
+
+void ConnectionAcceptor::registerMetrics() {
+    Metrics::instance().registerCollector("connection_acceptor", [this](Metrics::Samples& out) {
+        size_t backlog = 0;
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            backlog = readyUpgrades.size();
+        }
+        uint64_t prepared = handshakes.load(std::memory_order_relaxed);
+        uint64_t admittedCount = admitted.load(std::memory_order_relaxed);
+        out["network.admission_backlog"] = static_cast<double>(backlog);
+        out["network.handshakes_prepared"] = static_cast<double>(prepared);
+        out["network.handshake_us_avg"] = prepared ? static_cast<double>(handshakeMicros.load(std::memory_order_relaxed)) / prepared : 0.0;
+        out["network.handshake_us_max"] = static_cast<double>(handshakeMaxMicros.load(std::memory_order_relaxed));
+        out["network.sessions_admitted"] = static_cast<double>(admittedCount);
+        out["network.admission_wait_us_avg"] = admittedCount ? static_cast<double>(admitWaitMicros.load(std::memory_order_relaxed)) / admittedCount : 0.0;
+        out["network.admission_wait_us_max"] = static_cast<double>(admitWaitMaxMicros.load(std::memory_order_relaxed));
+    });
+}
+
+#else
+
+// Windows上WebSocketServer使用模拟循环，不接入真实连接
+ConnectionAcceptor::ConnectionAcceptor(int listenFd, std::function<void()> notify, TlsContext* tls)
+    : listenFd(listenFd), notify(std::move(notify)), tlsContext(tls) {
+}
+
+ConnectionAcceptor::~ConnectionAcceptor() = default;
+
+bool ConnectionAcceptor::start() {
+    return false;
+}
+
+void ConnectionAcceptor::stop() {
+}
+
+size_t ConnectionAcceptor::takeReady(std::vector<Ready>&) {
+    return 0;
+}
+
+int ConnectionAcceptor::admissionDelayMillis(int idleMillis) const {
+    return idleMillis;
+}
+
+#endif // !_WIN32
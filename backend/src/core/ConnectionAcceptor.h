@@ -0,0 +1,137 @@
+/**
+ * ConnectionAcceptor.h
+ *
+ * 连接接入流水线 - 把accept和WebSocket握手移出网络事件循环
+ *
+ * 【文件作用】：
+ * 1. 接入线程：监听套接字可读时批量accept4（非阻塞+CLOEXEC一次完成），
+ *    每批连接按轮转分给握手线程，每个握手线程每批只唤醒一次
+ * 2. 握手线程：启用TLS时先完成TLS握手（见TlsContext），再接收并解析第一个HTTP请求；
+ *    合法的WebSocket升级请求在这里算好Sec-WebSocket-Accept（SHA-1 + Base64），
+ *    其余请求（静态资源、/metrics、格式错误）原样交还
+ * 3. 就绪队列：事件循环每轮调用takeReady()取出连接。普通HTTP连接全部取出；
+ *    升级连接按令牌桶限速放行（每个新会话都要在事件循环里创建会话、发送欢迎消息），
+ *    排队的升级连接超过上限时直接回复503
+ *
+ * 【为什么】：连接风暴（大量客户端同时重连）时，accept、读请求和握手计算
+ *   都不再占用事件循环的时间，已连接玩家的消息延迟不受影响
+ *
+ * 【配置】（环境变量）：
+ * - TIME_ARTIFACTS_HANDSHAKE_WORKERS：握手线程数（默认2）
+ * - TIME_ARTIFACTS_ADMIT_RATE：每秒放行的新会话数（默认1000，0表示不限速）
+ * - TIME_ARTIFACTS_ADMIT_BACKLOG：排队等待放行的升级连接上限（默认4096）
+ *
+ * 【线程】：start/stop/takeReady/admissionDelayMillis 只在事件循环所在线程调用
+ */
+
+#pragma once
+
+#include "HttpRequest.h"
+#include "TlsContext.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 连接接入流水线
+ */
+class ConnectionAcceptor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 交给事件循环的连接
+     */
+    struct Ready {
+        int fd = -1;
+        bool upgrade = false;       // 已完成升级请求的解析和握手计算
+        HttpRequest request;        // upgrade时有效（恢复令牌等查询参数）
+        std::string acceptKey;      // upgrade时有效
+        std::string buffered;       // 尚未处理的接收数据（非upgrade时为完整的原始请求）
+        std::unique_ptr<TlsSession> tls;    // 启用TLS时为已完成握手的会话
+        Clock::time_point acceptedAt;
+        Clock::time_point readyAt;
+    };
+
+    /**
+     * 【参数】：listenFd - 已listen的非阻塞套接字（不转移所有权）
+     *          notify - 有新的就绪连接时调用（在接入/握手线程上；通常写事件循环的唤醒管道）
+     *          tls - 不为空时所有连接先完成TLS握手（不转移所有权）
+     */
+    ConnectionAcceptor(int listenFd, std::function<void()> notify, TlsContext* tls = nullptr);
+    ~ConnectionAcceptor();
+
+    ConnectionAcceptor(const ConnectionAcceptor&) = delete;
+    ConnectionAcceptor& operator=(const ConnectionAcceptor&) = delete;
+
+    /**
+     * 启动接入线程和握手线程
+     */
+    bool start();
+
+    /**
+     * 停止所有线程，关闭尚未交给事件循环的连接
+     */
+    void stop();
+
+    /**
+     * 取出就绪连接（升级连接受令牌桶限制）
+     * 【返回】：取出的连接数
+     */
+    size_t takeReady(std::vector<Ready>& out);
+
+    /**
+     * 事件循环下一次poll的等待时间：有升级连接在等令牌时为下一个令牌到来的时间
+     * 【参数】：idleMillis - 没有等待中的连接时返回的值
+     */
+    int admissionDelayMillis(int idleMillis) const;
+
+private:
+    struct Pending;
+    struct Worker;
+
+    void acceptLoop();
+    void workerLoop(Worker& worker);
+    bool readRequest(Pending& pending);
+    bool secureHandshake(Pending& pending, bool& finished);
+    void finishPending(Pending& pending, Clock::time_point now);
+    void pushReady(Ready ready);
+    void refillTokens(Clock::time_point now);
+    void registerMetrics();
+
+    int listenFd;
+    std::function<void()> notify;
+    TlsContext* tlsContext;
+    std::atomic<bool> running{false};
+    int stopPipe[2] = {-1, -1};
+    std::thread acceptThread;
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t nextWorker = 0;
+
+    // 就绪队列
+    mutable std::mutex readyMutex;
+    std::deque<Ready> readyPlain;
+    std::deque<Ready> readyUpgrades;
+
+    // 令牌桶（只在事件循环线程访问）
+    double admitRate = 1000.0;
+    double admitBurst = 50.0;
+    double tokens = 0.0;
+    Clock::time_point lastRefill;
+    size_t maxBacklog = 4096;
+
+    // 统计
+    std::atomic<uint64_t> handshakes{0};
+    std::atomic<uint64_t> handshakeMicros{0};
+    std::atomic<uint64_t> handshakeMaxMicros{0};
+    std::atomic<uint64_t> admitted{0};
+    std::atomic<uint64_t> admitWaitMicros{0};
+    std::atomic<uint64_t> admitWaitMaxMicros{0};
+};
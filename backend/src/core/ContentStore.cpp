@@ -0,0 +1,101 @@
+/**
+ * ContentStore.cpp
+ *
+ * 静态内容寻址实现
+ */
+
+#include "ContentStore.h"
+#include "WorldData.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include <cstdint>
+#include <iostream>
+
+ContentStore& ContentStore::instance() {
+    static ContentStore store;
+    return store;
+}
+
+std::string ContentStore::computeHash(const std::string& text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    static const char* hexDigits = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        hex[i] = hexDigits[hash & 0xF];
+        hash >>= 4;
+    }
+    return hex;
+}
+
+void ContentStore::add(const WorldData& world, TextId text) {
+    if (text == TextStore::kEmpty) {
+        return;
+    }
+    if (text >= hashes.size()) {
+        hashes.resize(text + 1);
+    }
+    if (!hashes[text].empty()) {
+        return;
+    }
+
+    std::string content = world.text(text);
+    std::string hash = computeHash(content);
+    if (!byHash.emplace(hash, text).second) {
+        // 64位哈希冲突：这段文本不参与缓存，始终发送原文
+        std::cerr << "[ContentStore] 内容哈希冲突，忽略: " << hash << std::endl;
+        return;
+    }
+    hashes[text] = std::move(hash);
+    totalBytes += content.size();
+}
+
+void ContentStore::initialize(const WorldData& world) {
+    MemoryScope memoryScope(MemoryTag::World);
+
+    byHash.clear();
+    hashes.clear();
+    totalBytes = 0;
+
+    for (const auto& entry : world.getLocations()) {
+        for (const auto& description : entry.second.descriptions) {
+            add(world, description.second);
+        }
+        for (const auto& interaction : entry.second.interactions) {
+            add(world, interaction.resultText);
+        }
+    }
+    for (const auto& entry : world.getDialogues()) {
+        add(world, entry.second.text);
+        for (const auto& option : entry.second.options) {
+            add(world, option.text);
+        }
+    }
+    for (const auto& entry : world.getItems()) {
+        add(world, entry.second.description);
+        add(world, entry.second.examineText);
+    }
+
+    std::cout << "[ContentStore] 已为 " << byHash.size() << " 段静态文本计算内容哈希（"
+              << totalBytes << " 字节）" << std::endl;
+}
+
+const std::string* ContentStore::hashFor(TextId text) const {
+    return text < hashes.size() && !hashes[text].empty() ? &hashes[text] : nullptr;
+}
+
+TextId ContentStore::lookup(const std::string& hash) const {
+    auto it = byHash.find(hash);
+    return it != byHash.end() ? it->second : TextStore::kEmpty;
+}
+
+void ContentStore::registerMetrics() {
+    Metrics::instance().registerCollector("content_store", [this](Metrics::Samples& out) {
+        out["content.blobs"] = static_cast<double>(byHash.size());
+        out["content.blob_bytes"] = static_cast<double>(totalBytes);
+    });
+}
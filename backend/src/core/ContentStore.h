@@ -0,0 +1,79 @@
+/**
+ * ContentStore.h
+ *
+ * 静态内容寻址 - 世界中每段静态文本都有一个稳定的内容哈希
+ *
+ * 【文件作用】：
+ * 1. 世界数据加载后，为场景描述、对话台词、选项文字、物品描述和检查结果计算内容哈希
+ * 2. 消息中用 "<字段>Ref" 引用哈希；客户端已缓存的文本不再重复发送
+ * 3. 客户端缓存缺失时按哈希取回原文（contentRequest）
+ *
+ * 【协议】：
+ *   客户端 → {"type":"cacheManifest","hashes":["9f3a...", ...]}   连接后声明已缓存的内容
+ *   客户端 → {"type":"contentRequest","hashes":[...]}            缓存被清理时取回原文
+ *   服务器 → {"type":"content","data":{"<哈希>":"原文", ...}}
+ *   消息中的文本字段：{"text":"...","textRef":"<哈希>"}，客户端已有时只发 {"textRef":"<哈希>"}
+ *
+ * 【说明】：哈希为16位十六进制的FNV-1a（与静态资源ETag相同的算法），
+ *   内容不变哈希就不变，客户端缓存可以跨会话、跨服务器重启复用
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TextStore.h"
+
+class WorldData;
+
+/**
+ * 静态内容表（全局单例，初始化后只读）
+ */
+class ContentStore {
+public:
+    static ContentStore& instance();
+
+    ContentStore(const ContentStore&) = delete;
+    ContentStore& operator=(const ContentStore&) = delete;
+
+    /**
+     * 为世界数据中的所有静态文本建立哈希表（启动时调用一次）
+     */
+    void initialize(const WorldData& world);
+
+    /**
+     * 文本的内容哈希
+     * 【返回】：空文本或未登记的文本返回nullptr
+     */
+    const std::string* hashFor(TextId text) const;
+
+    /**
+     * 按哈希查找文本（原文用 WorldData::text() 取出）
+     * 【返回】：哈希未知时返回TextStore::kEmpty
+     */
+    TextId lookup(const std::string& hash) const;
+
+    /**
+     * 计算内容哈希（16位十六进制）
+     */
+    static std::string computeHash(const std::string& text);
+
+    size_t size() const { return byHash.size(); }
+
+    /**
+     * 注册运行指标
+     */
+    void registerMetrics();
+
+private:
+    ContentStore() = default;
+
+    void add(const WorldData& world, TextId text);
+
+    // 只保存文本编号和哈希，原文留在TextStore的压缩块中
+    std::unordered_map<std::string, TextId> byHash;     // 哈希 -> 文本
+    std::vector<std::string> hashes;                    // 文本编号 -> 哈希（为空表示未登记）
+    size_t totalBytes = 0;
+};
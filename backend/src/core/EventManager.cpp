@@ -12,13 +12,34 @@
  */
 
 #include "EventManager.h"
+#include "Metrics.h"
+#include "TickWatchdog.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
 
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // 默认DRR配额：每个会话每轮100µs
+    constexpr int64_t kDefaultQuantumNanos = 100 * 1000;
+
+    // 长时间没有事件的会话子队列（连同统计）在这之后清理
+    constexpr auto kIdleQueueLifetime = std::chrono::seconds(60);
+
+    int64_t elapsedNanos(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+    }
+
+} // namespace
+
 EventManager::EventManager(int maxQueue)
-    : processingEvents(false)
+    : queuedEvents(0)
+    , quantumNanos(kDefaultQuantumNanos)
+    , lastPrune(Clock::now())
+    , processingEvents(false)
     , debugMode(false)
     , maxQueueSize(maxQueue) {
     
@@ -28,6 +49,10 @@ EventManager::EventManager(int maxQueue)
 EventManager::~EventManager() {
     std::cout << "[EventManager] 正在销毁事件管理器..." << std::endl;
     
+    if (metricsRegistered) {
+        Metrics::instance().unregisterCollector("event_manager");
+    }
+    
     // 清理队列
     clearEventQueue();
     
@@ -69,8 +94,12 @@ std::string EventManager::subscribe(const std::string& eventType,
     // 生成订阅者ID
     std::string finalId = subscriberId.empty() ? generateSubscriberId(eventType) : subscriberId;
     
+    // 订阅表相关的分配（ID字符串、事件类型键等）都记到 Subscribers
+    MemoryScope memoryScope(MemoryTag::Subscribers);
+    
     // 创建订阅者
-    auto subscriber = std::make_shared<Subscriber>(callback, finalId, priority);
+    auto subscriber = std::allocate_shared<Subscriber>(
+        TrackedAllocator<Subscriber, MemoryTag::Subscribers>(), callback, finalId, priority);
     
     {
         std::lock_guard<std::mutex> lock(subscriberMutex);
@@ -194,13 +223,16 @@ void EventManager::publishImmediate(std::unique_ptr<Event> event) {
     }
     
     // 更新统计
-    eventCounts[event->getType()]++;
+    {
+        MemoryScope memoryScope(MemoryTag::Events);
+        eventCounts[event->getType()]++;
+    }
     
     // 立即分发
     dispatchEvent(*event);
 }
 
-void EventManager::publish(std::unique_ptr<Event> event) {
+void EventManager::publish(std::unique_ptr<Event> event, const std::string& sessionId) {
     if (!event) {
         std::cerr << "[EventManager] 错误: 尝试发布空事件" << std::endl;
         return;
@@ -211,20 +243,18 @@ void EventManager::publish(std::unique_ptr<Event> event) {
     }
     
     // 检查队列大小
+    std::string eventType = event->getType();
+    bool queued;
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        if (static_cast<int>(eventQueue.size()) >= maxQueueSize) {
-            std::cerr << "[EventManager] 警告: 事件队列已满，丢弃事件: " 
-                      << event->getType() << std::endl;
-            return;
-        }
-        
-        // 加入队列
-        eventQueue.emplace(std::move(event), false);
+        queued = enqueueLocked(std::move(event), sessionId);
+    }
+    if (!queued) {
+        std::cerr << "[EventManager] 警告: 事件队列已满，丢弃事件: " << eventType << std::endl;
     }
 }
 
-void EventManager::publishBatch(std::vector<std::unique_ptr<Event>> events) {
+void EventManager::publishBatch(std::vector<std::unique_ptr<Event>> events, const std::string& sessionId) {
     if (events.empty()) {
         return;
     }
@@ -236,17 +266,57 @@ void EventManager::publishBatch(std::vector<std::unique_ptr<Event>> events) {
     std::lock_guard<std::mutex> lock(queueMutex);
     
     for (auto& event : events) {
-        if (event && static_cast<int>(eventQueue.size()) < maxQueueSize) {
-            eventQueue.emplace(std::move(event), false);
+        if (event) {
+            enqueueLocked(std::move(event), sessionId);
         }
     }
 }
 
+bool EventManager::enqueueLocked(std::unique_ptr<Event> event, const std::string& sessionId) {
+    static auto& droppedCounter = Metrics::instance().counter("events.dropped");
+    
+    if (queuedEvents >= maxQueueSize) {
+        droppedCounter.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    MemoryScope memoryScope(MemoryTag::Events);
+    SessionQueue& queue = sessionQueues[sessionId];
+    queue.events.emplace_back(std::move(event), false);
+    queue.lastActive = queue.events.back().enqueuedAt;
+    queuedEvents++;
+    
+    // 新加入轮转的会话排在队尾，不插队
+    if (!queue.inRing) {
+        queue.inRing = true;
+        queue.onTurn = false;
+        queue.deficitNanos = std::min<int64_t>(queue.deficitNanos, 0);
+        activeRing.push_back(sessionId);
+    }
+    return true;
+}
+
 // =================================================================
 // 事件处理
 // =================================================================
 
 int EventManager::processEvents(int maxEvents) {
+    return drainQueues(maxEvents, 0);
+}
+
+int EventManager::processEvents(std::chrono::nanoseconds budget, int maxEvents) {
+    return drainQueues(maxEvents, std::max<int64_t>(1, budget.count()));
+}
+
+void EventManager::setQuantum(std::chrono::nanoseconds quantum) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    quantumNanos = std::max<int64_t>(1, quantum.count());
+}
+
+int EventManager::drainQueues(int maxEvents, int64_t budgetNanos) {
+    static auto& dispatchedCounter = Metrics::instance().counter("events.dispatched");
+    static auto& exhaustedCounter = Metrics::instance().counter("events.budget_exhausted");
+    
     if (processingEvents) {
         std::cerr << "[EventManager] 警告: 已在处理事件，避免重入" << std::endl;
         return 0;
@@ -254,40 +324,128 @@ int EventManager::processEvents(int maxEvents) {
     
     processingEvents = true;
     int processedCount = 0;
+    bool exhausted = false;
+    Clock::time_point start = Clock::now();
     
     try {
-        while (processedCount != maxEvents) {
+        while (maxEvents <= 0 || processedCount < maxEvents) {
             std::unique_ptr<Event> event;
+            std::string sessionId;
+            Clock::time_point enqueuedAt;
             
-            // 从队列取出事件
+            // 从轮到的会话取出一个事件
             {
                 std::lock_guard<std::mutex> lock(queueMutex);
-                if (eventQueue.empty()) {
+                if (activeRing.empty()) {
+                    break;
+                }
+                if (budgetNanos > 0 && elapsedNanos(start, Clock::now()) >= budgetNanos) {
+                    exhausted = true;
                     break;
                 }
                 
-                event = std::move(eventQueue.front().event);
-                eventQueue.pop();
+                auto it = sessionQueues.find(activeRing.front());
+                SessionQueue& queue = it->second;
+                if (!queue.onTurn) {
+                    queue.deficitNanos += quantumNanos;
+                    queue.onTurn = true;
+                }
+                if (queue.deficitNanos <= 0) {
+                    // 还在还上一轮欠下的时间，让给下一个会话
+                    queue.onTurn = false;
+                    activeRing.push_back(std::move(activeRing.front()));
+                    activeRing.pop_front();
+                    continue;
+                }
+                
+                sessionId = it->first;
+                enqueuedAt = queue.events.front().enqueuedAt;
+                event = std::move(queue.events.front().event);
+                queue.events.pop_front();
+                queuedEvents--;
             }
             
+            Clock::time_point dispatchStart = Clock::now();
             if (event) {
                 // 更新统计
-                eventCounts[event->getType()]++;
+                {
+                    MemoryScope memoryScope(MemoryTag::Events);
+                    eventCounts[event->getType()]++;
+                }
                 
                 if (debugMode) {
                     logEvent(*event, "队列处理");
                 }
                 
                 // 分发事件
+                TickWatchdog::Context watchdogContext("", sessionId);
                 dispatchEvent(*event);
                 processedCount++;
             }
+            Clock::time_point dispatchEnd = Clock::now();
+            
+            uint64_t waited = static_cast<uint64_t>(std::max<int64_t>(0, elapsedNanos(enqueuedAt, dispatchStart)));
+            waitNanosTotal.fetch_add(waited, std::memory_order_relaxed);
+            waitSamples.fetch_add(1, std::memory_order_relaxed);
+            if (waited > waitNanosMax.load(std::memory_order_relaxed)) {
+                waitNanosMax.store(waited, std::memory_order_relaxed);
+            }
+            
+            // 扣除实际耗时；队列空了退出轮转，赤字用完换下一个会话
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                auto it = sessionQueues.find(sessionId);
+                if (it == sessionQueues.end() || !it->second.inRing) {
+                    continue;   // 处理期间队列被清空
+                }
+                SessionQueue& queue = it->second;
+                queue.deficitNanos -= elapsedNanos(dispatchStart, dispatchEnd);
+                queue.dispatched++;
+                queue.waitNanosTotal += waited;
+                queue.waitNanosMax = std::max(queue.waitNanosMax, waited);
+                queue.lastActive = dispatchEnd;
+                
+                bool atFront = !activeRing.empty() && activeRing.front() == sessionId;
+                if (queue.events.empty()) {
+                    // 空闲的会话不保留正的赤字（否则回来时可以一次占用很长时间），欠账保留
+                    queue.deficitNanos = std::min<int64_t>(queue.deficitNanos, 0);
+                    queue.inRing = false;
+                    queue.onTurn = false;
+                    if (atFront) {
+                        activeRing.pop_front();
+                    } else {
+                        activeRing.erase(std::find(activeRing.begin(), activeRing.end(), sessionId));
+                    }
+                } else if (queue.deficitNanos <= 0 && atFront) {
+                    queue.onTurn = false;
+                    activeRing.push_back(std::move(activeRing.front()));
+                    activeRing.pop_front();
+                }
+            }
         }
     } catch (const std::exception& e) {
         std::cerr << "[EventManager] 事件处理异常: " << e.what() << std::endl;
     }
     
+    // 清理长时间没有事件的会话子队列
+    Clock::time_point now = Clock::now();
+    if (now - lastPrune >= std::chrono::seconds(10)) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (auto it = sessionQueues.begin(); it != sessionQueues.end();) {
+            if (!it->second.inRing && now - it->second.lastActive > kIdleQueueLifetime) {
+                it = sessionQueues.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        lastPrune = now;
+    }
+    
     processingEvents = false;
+    dispatchedCounter.fetch_add(processedCount, std::memory_order_relaxed);
+    if (exhausted) {
+        exhaustedCounter.fetch_add(1, std::memory_order_relaxed);
+    }
     
     if (debugMode && processedCount > 0) {
         std::cout << "[EventManager] 处理了 " << processedCount << " 个事件" << std::endl;
@@ -299,10 +457,15 @@ int EventManager::processEvents(int maxEvents) {
 void EventManager::clearEventQueue() {
     std::lock_guard<std::mutex> lock(queueMutex);
     
-    int queueSize = eventQueue.size();
-    while (!eventQueue.empty()) {
-        eventQueue.pop();
+    int queueSize = queuedEvents;
+    for (auto& entry : sessionQueues) {
+        entry.second.events.clear();
+        entry.second.inRing = false;
+        entry.second.onTurn = false;
+        entry.second.deficitNanos = 0;
     }
+    activeRing.clear();
+    queuedEvents = 0;
     
     if (debugMode && queueSize > 0) {
         std::cout << "[EventManager] 清空事件队列，丢弃 " << queueSize << " 个事件" << std::endl;
@@ -328,9 +491,60 @@ int EventManager::getSubscriberCount(const std::string& eventType) const {
     return (it != subscribers.end()) ? it->second.size() : 0;
 }
 
+std::map<std::string, int> EventManager::getSubscriberCounts() const {
+    std::lock_guard<std::mutex> lock(subscriberMutex);
+    
+    std::map<std::string, int> counts;
+    for (const auto& pair : subscribers) {
+        counts[pair.first] = static_cast<int>(pair.second.size());
+    }
+    return counts;
+}
+
 int EventManager::getQueueSize() const {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return eventQueue.size();
+    return queuedEvents;
+}
+
+std::map<std::string, SessionEventStats> EventManager::getSessionEventStats() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    
+    std::map<std::string, SessionEventStats> stats;
+    for (const auto& entry : sessionQueues) {
+        const SessionQueue& queue = entry.second;
+        SessionEventStats& item = stats[entry.first];
+        item.queued = queue.events.size();
+        item.dispatched = queue.dispatched;
+        item.waitMicrosAvg = queue.dispatched ? queue.waitNanosTotal / 1000.0 / queue.dispatched : 0.0;
+        item.waitMicrosMax = queue.waitNanosMax / 1000;
+    }
+    return stats;
+}
+
+void EventManager::registerMetrics() {
+    metricsRegistered = true;
+    Metrics::instance().registerCollector("event_manager", [this](Metrics::Samples& out) {
+        size_t activeSessions = 0;
+        int queued = 0;
+        double worstSessionWait = 0;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            activeSessions = activeRing.size();
+            queued = queuedEvents;
+            for (const auto& entry : sessionQueues) {
+                const SessionQueue& queue = entry.second;
+                if (queue.dispatched > 0) {
+                    worstSessionWait = std::max(worstSessionWait, queue.waitNanosTotal / 1000.0 / queue.dispatched);
+                }
+            }
+        }
+        uint64_t samples = waitSamples.load(std::memory_order_relaxed);
+        out["events.queued"] = static_cast<double>(queued);
+        out["events.active_sessions"] = static_cast<double>(activeSessions);
+        out["events.wait_us_avg"] = samples ? waitNanosTotal.load(std::memory_order_relaxed) / 1000.0 / samples : 0.0;
+        out["events.wait_us_max"] = waitNanosMax.load(std::memory_order_relaxed) / 1000.0;
+        out["events.session_wait_us_avg_worst"] = worstSessionWait;
+    });
 }
 
 std::map<std::string, int> EventManager::getEventStatistics() const {
@@ -394,13 +608,14 @@ void EventManager::setMaxQueueSize(int maxSize) {
 
 void EventManager::dispatchEvent(const Event& event) {
     const std::string& eventType = event.getType();
+    TickWatchdog::Context watchdogContext(eventType, "");
     
     // 检查过滤器
     if (!passesFilter(eventType)) {
         return;
     }
     
-    std::vector<std::shared_ptr<Subscriber>> eventSubscribers;
+    SubscriberList eventSubscribers;
     
     // 获取订阅者副本（避免长时间持锁）
     {
@@ -438,7 +653,7 @@ void EventManager::dispatchEvent(const Event& event) {
     }
 }
 
-void EventManager::sortSubscribersByPriority(std::vector<std::shared_ptr<Subscriber>>& subs) {
+void EventManager::sortSubscribersByPriority(SubscriberList& subs) {
     std::sort(subs.begin(), subs.end(),
         [](const std::shared_ptr<Subscriber>& a, const std::shared_ptr<Subscriber>& b) {
             return a->priority < b->priority; // 数字越小优先级越高
@@ -461,6 +676,8 @@ bool EventManager::passesFilter(const std::string& eventType) const {
 }
 
 void EventManager::logEvent(const Event& event, const std::string& action) const {
+    MemoryScope memoryScope(MemoryTag::Logging);
+    
     auto now = std::chrono::steady_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()).count();
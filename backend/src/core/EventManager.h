@@ -11,6 +11,13 @@
  * 
  * 【设计模式】：观察者模式 + 中介者模式
  * 【核心优势】：系统解耦、易于扩展、性能可控
+ *
+ * 【异步队列的公平性】：
+ * - publish()可以带会话ID，每个会话一个子队列（不带会话ID的事件进入系统队列）
+ * - processEvents(budget)按赤字轮转（DRR）在有事件的会话之间分配时间：
+ *   轮到某个会话时赤字增加一个配额（默认100µs），每处理一个事件扣掉实际耗时，
+ *   赤字用完就换下一个会话；一个很耗时的事件会让该会话欠账，之后的轮次少分时间
+ * - 本帧时间预算用完时停止，剩余事件和轮转位置留到下一帧继续
  * 
  * 【使用示例】：
  * ```cpp
@@ -29,10 +36,14 @@
 #pragma once
 
 #include "Events.h"
+#include "MemoryTracker.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <vector>
 #include <map>
-#include <queue>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -58,6 +69,12 @@ struct Subscriber {
         : callback(cb), subscriberId(id), priority(prio), active(true) {}
 };
 
+/**
+ * 订阅者列表（订阅表内存记到 MemoryTag::Subscribers）
+ */
+using SubscriberList = std::vector<std::shared_ptr<Subscriber>,
+    TrackedAllocator<std::shared_ptr<Subscriber>, MemoryTag::Subscribers>>;
+
 /**
  * 事件队列项
  * 【作用】：用于异步事件处理的队列结构
@@ -65,9 +82,21 @@ struct Subscriber {
 struct QueuedEvent {
     std::unique_ptr<Event> event;
     bool immediate;           // 是否立即处理
+    std::chrono::steady_clock::time_point enqueuedAt;  // 入队时间（用于统计等待时间）
     
     QueuedEvent(std::unique_ptr<Event> e, bool imm = false)
-        : event(std::move(e)), immediate(imm) {}
+        : event(std::move(e)), immediate(imm), enqueuedAt(std::chrono::steady_clock::now()) {}
+};
+
+/**
+ * 单个会话的事件队列统计
+ * 【作用】：管理接口和指标用，观察是否有会话长时间得不到处理
+ */
+struct SessionEventStats {
+    size_t queued = 0;              // 队列中的事件数
+    uint64_t dispatched = 0;        // 累计处理的事件数
+    double waitMicrosAvg = 0;       // 从入队到开始处理的平均等待时间
+    uint64_t waitMicrosMax = 0;
 };
 
 /**
@@ -83,10 +112,36 @@ struct QueuedEvent {
 class EventManager {
 private:
     // 订阅者映射：事件类型 -> 订阅者列表
-    std::map<std::string, std::vector<std::shared_ptr<Subscriber>>> subscribers;
+    std::map<std::string, SubscriberList, std::less<std::string>,
+             TrackedAllocator<std::pair<const std::string, SubscriberList>, MemoryTag::Subscribers>> subscribers;
     
-    // 事件队列（用于异步处理）
-    std::queue<QueuedEvent> eventQueue;
+    /**
+     * 一个会话的事件子队列（会话ID为空的是系统队列）
+     */
+    struct SessionQueue {
+        std::deque<QueuedEvent, TrackedAllocator<QueuedEvent, MemoryTag::Events>> events;
+        int64_t deficitNanos = 0;   // DRR赤字（可为负：处理的事件超出了配额）
+        bool inRing = false;        // 是否在轮转队列中
+        bool onTurn = false;        // 本轮的配额是否已发放
+        uint64_t dispatched = 0;
+        uint64_t waitNanosTotal = 0;
+        uint64_t waitNanosMax = 0;
+        std::chrono::steady_clock::time_point lastActive;
+    };
+    
+    // 事件队列（用于异步处理，队列内存记到 MemoryTag::Events）
+    std::map<std::string, SessionQueue, std::less<std::string>,
+             TrackedAllocator<std::pair<const std::string, SessionQueue>, MemoryTag::Events>> sessionQueues;
+    std::deque<std::string, TrackedAllocator<std::string, MemoryTag::Events>> activeRing;  // 有事件的会话，按轮转顺序
+    int queuedEvents;
+    int64_t quantumNanos;
+    std::chrono::steady_clock::time_point lastPrune;
+    
+    // 等待时间统计（指标用）
+    std::atomic<uint64_t> waitNanosTotal{0};
+    std::atomic<uint64_t> waitNanosMax{0};
+    std::atomic<uint64_t> waitSamples{0};
+    bool metricsRegistered = false;
     
     // 线程安全
     mutable std::mutex subscriberMutex;
@@ -183,16 +238,17 @@ public:
     /**
      * 异步发布事件（加入队列）
      * 【作用】：将事件加入队列，在下次processEvents时处理
+     * 【参数】：sessionId - 事件所属的会话（为空表示系统事件）
      * 【特点】：非阻塞调用，性能更好
      * 【使用场景】：一般事件，可以延迟处理
      */
-    void publish(std::unique_ptr<Event> event);
+    void publish(std::unique_ptr<Event> event, const std::string& sessionId = "");
     
     /**
      * 发布多个事件
      * 【作用】：批量发布事件，提高性能
      */
-    void publishBatch(std::vector<std::unique_ptr<Event>> events);
+    void publishBatch(std::vector<std::unique_ptr<Event>> events, const std::string& sessionId = "");
     
     // =================================================================
     // 事件处理
@@ -207,6 +263,19 @@ public:
      */
     int processEvents(int maxEvents = 0);
     
+    /**
+     * 在时间预算内处理事件队列（会话之间按DRR轮转）
+     * 【参数】：budget - 本次最多用的时间（纳秒）；maxEvents - 最大处理事件数（0表示不限）
+     * 【说明】：预算用完时剩余事件留在队列中，下次调用从中断的会话继续
+     * 【返回】：实际处理的事件数量
+     */
+    int processEvents(std::chrono::nanoseconds budget, int maxEvents = 0);
+    
+    /**
+     * 设置DRR配额（每个会话每轮分到的处理时间）
+     */
+    void setQuantum(std::chrono::nanoseconds quantum);
+    
     /**
      * 清空事件队列
      * 【作用】：丢弃所有未处理的事件
@@ -224,11 +293,26 @@ public:
      */
     int getSubscriberCount(const std::string& eventType = "") const;
     
+    /**
+     * 获取每种事件类型的订阅者数量
+     */
+    std::map<std::string, int> getSubscriberCounts() const;
+    
     /**
      * 获取队列大小
      */
     int getQueueSize() const;
     
+    /**
+     * 获取每个会话的事件队列统计（只包含最近有过事件的会话）
+     */
+    std::map<std::string, SessionEventStats> getSessionEventStats() const;
+    
+    /**
+     * 注册运行指标（队列长度、等待时间、预算用尽次数）
+     */
+    void registerMetrics();
+    
     /**
      * 获取事件统计
      * 【返回】：事件类型到处理次数的映射
@@ -277,6 +361,16 @@ public:
     void setMaxQueueSize(int maxSize);
 
 private:
+    /**
+     * 按DRR处理队列（budgetNanos为0表示不限时间）
+     */
+    int drainQueues(int maxEvents, int64_t budgetNanos);
+    
+    /**
+     * 把事件放入会话子队列（调用方持有queueMutex）
+     */
+    bool enqueueLocked(std::unique_ptr<Event> event, const std::string& sessionId);
+    
     /**
      * 分发事件给订阅者
      * 【内部方法】：核心事件分发逻辑
@@ -286,7 +380,7 @@ private:
     /**
      * 对订阅者按优先级排序
      */
-    void sortSubscribersByPriority(std::vector<std::shared_ptr<Subscriber>>& subs);
+    void sortSubscribersByPriority(SubscriberList& subs);
     
     /**
      * 生成唯一的订阅者ID
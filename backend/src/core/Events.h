@@ -25,6 +25,7 @@
 #include <vector>
 #include <map>
 #include <chrono>
+#include "MemoryTracker.h"
 
 /**
  * 事件基类
@@ -69,6 +70,22 @@ public:
     virtual bool isCancellable() const {
         return true;
     }
+    
+    /**
+     * 事件对象的内存统一记到 MemoryTag::Events
+     * 【作用】：无论在哪个线程、哪个子系统创建事件，都能在内存报告中单独统计
+     */
+    static void* operator new(size_t size) {
+        void* p = MemoryTracker::allocate(size, MemoryTag::Events);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+    
+    static void operator delete(void* p) noexcept {
+        MemoryTracker::deallocate(p);
+    }
 
 protected:
     Event() : timestamp(std::chrono::steady_clock::now()) {}
@@ -293,6 +310,25 @@ public:
     int getPriority() const override { return 4; }
 };
 
+/**
+ * 剧情触发事件
+ * 【触发时机】：规则网络（RuleNetwork）中某条剧情规则的全部条件在某个玩家身上同时满足
+ * 【响应者】：剧情系统、成就系统、音效系统
+ */
+class StoryTriggeredEvent : public Event {
+public:
+    std::string ruleId;                 // 触发的规则ID
+    std::string playerId;               // 玩家（会话ID）
+    std::vector<std::string> unlocks;   // 解锁的剧情标记
+    
+    StoryTriggeredEvent(const std::string& rule_id, const std::string& player_id,
+                        const std::vector<std::string>& unlocked = {})
+        : ruleId(rule_id), playerId(player_id), unlocks(unlocked) {}
+    
+    std::string getType() const override { return "StoryTriggered"; }
+    int getPriority() const override { return 3; }
+};
+
 // =============================================================================
 // 系统相关事件
 // =============================================================================
@@ -0,0 +1,492 @@
+/**
+ * FrameKernels.cpp
+ *
+ * WebSocket帧负载处理内核实现
+ *
+ * 【实现重点】：
+ * 1. 标量版本：8字节一组解掩码；UTF-8按RFC 3629的字节范围表逐字符校验
+ * 2. SIMD版本：查表法UTF-8校验，每块先XOR掩码、写回，再在寄存器中校验
+ * 3. 使用函数级target属性编译AVX2/SSE4代码，无需全局-mavx2，运行时分派
+ */
+
+#include "FrameKernels.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TA_FRAME_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TA_TARGET_SSE4
+#define TA_TARGET_AVX2
+#else
+#define TA_TARGET_SSE4 __attribute__((target("ssse3,sse4.1")))
+#define TA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+    // =================================================================
+    // 标量实现
+    // =================================================================
+
+    void unmaskScalar(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+        uint8_t mask8[8];
+        std::memcpy(mask8, maskKey, 4);
+        std::memcpy(mask8 + 4, maskKey, 4);
+        uint64_t maskWord;
+        std::memcpy(&maskWord, mask8, 8);
+
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            word ^= maskWord;
+            std::memcpy(data + i, &word, 8);
+        }
+        for (; i < length; ++i) {
+            data[i] ^= maskKey[i & 3];
+        }
+    }
+
+    bool validateUtf8Scalar(const uint8_t* data, size_t length) {
+        size_t i = 0;
+        while (i < length) {
+            // ASCII快速路径：8字节一组
+            if (i + 8 <= length) {
+                uint64_t word;
+                std::memcpy(&word, data + i, 8);
+                if ((word & 0x8080808080808080ULL) == 0) {
+                    i += 8;
+                    continue;
+                }
+            }
+
+            uint8_t lead = data[i];
+            if (lead < 0x80) {
+                ++i;
+                continue;
+            }
+
+            // 按RFC 3629表3确定后续字节数和第二字节的合法范围
+            size_t continuationCount;
+            uint8_t secondLow = 0x80;
+            uint8_t secondHigh = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF) {
+                continuationCount = 1;
+            } else if (lead == 0xE0) {
+                continuationCount = 2;
+                secondLow = 0xA0;       // 排除过长编码
+            } else if (lead == 0xED) {
+                continuationCount = 2;
+                secondHigh = 0x9F;      // 排除代理对
+            } else if (lead >= 0xE1 && lead <= 0xEF) {
+                continuationCount = 2;
+            } else if (lead == 0xF0) {
+                continuationCount = 3;
+                secondLow = 0x90;       // 排除过长编码
+            } else if (lead >= 0xF1 && lead <= 0xF3) {
+                continuationCount = 3;
+            } else if (lead == 0xF4) {
+                continuationCount = 3;
+                secondHigh = 0x8F;      // 不超过U+10FFFF
+            } else {
+                return false;
+            }
+
+            if (length - i - 1 < continuationCount) {
+                return false;
+            }
+            if (data[i + 1] < secondLow || data[i + 1] > secondHigh) {
+                return false;
+            }
+            for (size_t k = 2; k <= continuationCount; ++k) {
+                if ((data[i + k] & 0xC0) != 0x80) {
+                    return false;
+                }
+            }
+            i += continuationCount + 1;
+        }
+        return true;
+    }
+
+    bool unmaskAndValidateScalar(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+        unmaskScalar(data, length, maskKey);
+        return validateUtf8Scalar(data, length);
+    }
+
+#ifdef TA_FRAME_KERNELS_X86
+
+    // =================================================================
+    // 查表法UTF-8校验的错误位定义
+    // 【说明】：每个位代表一种非法的"前一字节 + 当前字节"组合，
+    //         三张16项表分别按前一字节高4位、低4位、当前字节高4位查询，
+    //         三者按位与后非零即为错误
+    // =================================================================
+
+    constexpr uint8_t TOO_SHORT = 1 << 0;       // 11______ 0_______ 或 11______ 11______
+    constexpr uint8_t TOO_LONG = 1 << 1;        // 0_______ 10______
+    constexpr uint8_t OVERLONG_3 = 1 << 2;      // 11100000 100_____
+    constexpr uint8_t TOO_LARGE = 1 << 3;       // 11110100 1001____ 等
+    constexpr uint8_t SURROGATE = 1 << 4;       // 11101101 101_____
+    constexpr uint8_t OVERLONG_2 = 1 << 5;      // 1100000_ 10______
+    constexpr uint8_t TOO_LARGE_1000 = 1 << 6;  // 11110101 1000____ 等
+    constexpr uint8_t OVERLONG_4 = 1 << 6;      // 11110000 1000____
+    constexpr uint8_t TWO_CONTS = 1 << 7;       // 10______ 10______
+    constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    // 前一字节高4位
+    alignas(16) constexpr uint8_t kByte1High[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+    };
+
+    // 前一字节低4位
+    alignas(16) constexpr uint8_t kByte1Low[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000
+    };
+
+    // 当前字节高4位
+    alignas(16) constexpr uint8_t kByte2High[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+    };
+
+    // =================================================================
+    // SSE4实现（16字节一块）
+    // =================================================================
+
+    struct Utf8StateSse {
+        __m128i error;
+        __m128i prevInput;
+        __m128i prevIncomplete;
+    };
+
+    TA_TARGET_SSE4 inline __m128i shr4Sse(__m128i v) {
+        return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+    }
+
+    TA_TARGET_SSE4 inline void utf8StepSse(__m128i input, Utf8StateSse& state) {
+        if (_mm_movemask_epi8(input) == 0) {
+            // 纯ASCII块：只需确认上一块没有被截断的多字节字符
+            state.error = _mm_or_si128(state.error, state.prevIncomplete);
+        } else {
+            const __m128i byte1HighTable = _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1High));
+            const __m128i byte1LowTable = _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1Low));
+            const __m128i byte2HighTable = _mm_load_si128(reinterpret_cast<const __m128i*>(kByte2High));
+
+            __m128i prev1 = _mm_alignr_epi8(input, state.prevInput, 15);
+            __m128i byte1High = _mm_shuffle_epi8(byte1HighTable, shr4Sse(prev1));
+            __m128i byte1Low = _mm_shuffle_epi8(byte1LowTable, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+            __m128i byte2High = _mm_shuffle_epi8(byte2HighTable, shr4Sse(input));
+            __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+            // 三/四字节字符的第3、4字节必须是延续字节
+            __m128i prev2 = _mm_alignr_epi8(input, state.prevInput, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, state.prevInput, 13);
+            __m128i isThird = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            __m128i isFourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            __m128i must23 = _mm_and_si128(_mm_or_si128(isThird, isFourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+            state.error = _mm_or_si128(state.error, _mm_xor_si128(must23, special));
+
+            // 块尾是否有未完成的多字节字符
+            const __m128i maxValue = _mm_setr_epi8(
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+            state.prevIncomplete = _mm_subs_epu8(input, maxValue);
+        }
+        state.prevInput = input;
+    }
+
+    template <bool Unmask, bool Validate>
+    TA_TARGET_SSE4 bool processSse4(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+        int32_t maskWord = 0;
+        std::memcpy(&maskWord, maskKey, 4);
+        const __m128i maskVec = _mm_set1_epi32(maskWord);
+
+        Utf8StateSse state{_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            if (Unmask) {
+                input = _mm_xor_si128(input, maskVec);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), input);
+            }
+            if (Validate) {
+                utf8StepSse(input, state);
+            }
+        }
+
+        if (i < length) {
+            // 尾部补0（0是ASCII，不影响校验结果）；i是16的倍数，掩码相位不变
+            alignas(16) uint8_t tail[16] = {0};
+            size_t rest = length - i;
+            std::memcpy(tail, data + i, rest);
+            __m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+            if (Unmask) {
+                input = _mm_xor_si128(input, maskVec);
+                _mm_store_si128(reinterpret_cast<__m128i*>(tail), input);
+                std::memcpy(data + i, tail, rest);
+                // 补齐部分被XOR成了掩码值，重新清零后再校验
+                std::memset(tail + rest, 0, 16 - rest);
+                input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+            }
+            if (Validate) {
+                utf8StepSse(input, state);
+            }
+        }
+
+        if (!Validate) {
+            return true;
+        }
+        __m128i error = _mm_or_si128(state.error, state.prevIncomplete);
+        return _mm_testz_si128(error, error) != 0;
+    }
+
+    // =================================================================
+    // AVX2实现（32字节一块）
+    // =================================================================
+
+    struct Utf8StateAvx2 {
+        __m256i error;
+        __m256i prevInput;
+        __m256i prevIncomplete;
+    };
+
+    TA_TARGET_AVX2 inline __m256i broadcastTable(const uint8_t* table) {
+        return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+    }
+
+    TA_TARGET_AVX2 inline __m256i shr4Avx2(__m256i v) {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    template <int N>
+    TA_TARGET_AVX2 inline __m256i prevBytesAvx2(__m256i input, __m256i prevInput) {
+        // 跨128位通道取"前N个字节"
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prevInput, input, 0x21), 16 - N);
+    }
+
+    TA_TARGET_AVX2 inline void utf8StepAvx2(__m256i input, Utf8StateAvx2& state) {
+        if (_mm256_movemask_epi8(input) == 0) {
+            state.error = _mm256_or_si256(state.error, state.prevIncomplete);
+        } else {
+            const __m256i byte1HighTable = broadcastTable(kByte1High);
+            const __m256i byte1LowTable = broadcastTable(kByte1Low);
+            const __m256i byte2HighTable = broadcastTable(kByte2High);
+
+            __m256i prev1 = prevBytesAvx2<1>(input, state.prevInput);
+            __m256i byte1High = _mm256_shuffle_epi8(byte1HighTable, shr4Avx2(prev1));
+            __m256i byte1Low = _mm256_shuffle_epi8(byte1LowTable, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+            __m256i byte2High = _mm256_shuffle_epi8(byte2HighTable, shr4Avx2(input));
+            __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+            __m256i prev2 = prevBytesAvx2<2>(input, state.prevInput);
+            __m256i prev3 = prevBytesAvx2<3>(input, state.prevInput);
+            __m256i isThird = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            __m256i isFourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            __m256i must23 = _mm256_and_si256(_mm256_or_si256(isThird, isFourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+            state.error = _mm256_or_si256(state.error, _mm256_xor_si256(must23, special));
+
+            const __m256i maxValue = _mm256_setr_epi8(
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+            state.prevIncomplete = _mm256_subs_epu8(input, maxValue);
+        }
+        state.prevInput = input;
+    }
+
+    template <bool Unmask, bool Validate>
+    TA_TARGET_AVX2 bool processAvx2(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+        int32_t maskWord = 0;
+        std::memcpy(&maskWord, maskKey, 4);
+        const __m256i maskVec = _mm256_set1_epi32(maskWord);
+
+        Utf8StateAvx2 state{_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32) {
+            __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            if (Unmask) {
+                input = _mm256_xor_si256(input, maskVec);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), input);
+            }
+            if (Validate) {
+                utf8StepAvx2(input, state);
+            }
+        }
+
+        if (i < length) {
+            alignas(32) uint8_t tail[32] = {0};
+            size_t rest = length - i;
+            std::memcpy(tail, data + i, rest);
+            __m256i input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+            if (Unmask) {
+                input = _mm256_xor_si256(input, maskVec);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(tail), input);
+                std::memcpy(data + i, tail, rest);
+                std::memset(tail + rest, 0, 32 - rest);
+                input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+            }
+            if (Validate) {
+                utf8StepAvx2(input, state);
+            }
+        }
+
+        if (!Validate) {
+            return true;
+        }
+        __m256i error = _mm256_or_si256(state.error, state.prevIncomplete);
+        return _mm256_testz_si256(error, error) != 0;
+    }
+
+    bool cpuSupportsSse4() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) && (info[2] & (1 << 19));  // SSSE3 + SSE4.1
+#else
+        return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+#endif
+    }
+
+    bool cpuSupportsAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+#endif // TA_FRAME_KERNELS_X86
+
+    // =================================================================
+    // 运行时分派
+    // =================================================================
+
+    FrameKernels::Isa detectBestIsa() {
+#ifdef TA_FRAME_KERNELS_X86
+        if (cpuSupportsAvx2()) {
+            return FrameKernels::Isa::Avx2;
+        }
+        if (cpuSupportsSse4()) {
+            return FrameKernels::Isa::Sse4;
+        }
+#endif
+        return FrameKernels::Isa::Scalar;
+    }
+
+    std::atomic<FrameKernels::Isa>& currentIsa() {
+        static std::atomic<FrameKernels::Isa> isa{detectBestIsa()};
+        return isa;
+    }
+
+} // namespace
+
+void FrameKernels::unmask(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+    switch (currentIsa().load(std::memory_order_relaxed)) {
+#ifdef TA_FRAME_KERNELS_X86
+        case Isa::Avx2: processAvx2<true, false>(data, length, maskKey); return;
+        case Isa::Sse4: processSse4<true, false>(data, length, maskKey); return;
+#endif
+        default: unmaskScalar(data, length, maskKey); return;
+    }
+}
+
+bool FrameKernels::validateUtf8(const uint8_t* data, size_t length) {
+    // 只读路径：Unmask=false时不会写入data
+    static const uint8_t kNoMask[4] = {0, 0, 0, 0};
+    uint8_t* mutableData = const_cast<uint8_t*>(data);
+    switch (currentIsa().load(std::memory_order_relaxed)) {
+#ifdef TA_FRAME_KERNELS_X86
+        case Isa::Avx2: return processAvx2<false, true>(mutableData, length, kNoMask);
+        case Isa::Sse4: return processSse4<false, true>(mutableData, length, kNoMask);
+#endif
+        default: return validateUtf8Scalar(data, length);
+    }
+}
+
+bool FrameKernels::unmaskAndValidateUtf8(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+    switch (currentIsa().load(std::memory_order_relaxed)) {
+#ifdef TA_FRAME_KERNELS_X86
+        case Isa::Avx2: return processAvx2<true, true>(data, length, maskKey);
+        case Isa::Sse4: return processSse4<true, true>(data, length, maskKey);
+#endif
+        default: return unmaskAndValidateScalar(data, length, maskKey);
+    }
+}
+
+FrameKernels::Isa FrameKernels::activeIsa() {
+    return currentIsa().load(std::memory_order_relaxed);
+}
+
+bool FrameKernels::isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return true;
+#ifdef TA_FRAME_KERNELS_X86
+        case Isa::Sse4: return cpuSupportsSse4();
+        case Isa::Avx2: return cpuSupportsAvx2();
+#endif
+        default: return false;
+    }
+}
+
+bool FrameKernels::setIsa(Isa isa) {
+    if (!isSupported(isa)) {
+        return false;
+    }
+    currentIsa().store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+const char* FrameKernels::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Sse4: return "sse4";
+        case Isa::Avx2: return "avx2";
+        default: return "unknown";
+    }
+}
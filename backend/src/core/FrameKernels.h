@@ -0,0 +1,83 @@
+/**
+ * FrameKernels.h
+ *
+ * WebSocket帧负载处理内核 - 解掩码与UTF-8校验
+ *
+ * 【文件作用】：
+ * 1. 客户端发往服务器的每一帧都经过XOR掩码（RFC 6455 5.3），需要原地解掩码
+ * 2. 文本帧必须是合法UTF-8（RFC 6455 8.1），不合法时应以1007关闭连接
+ * 3. 提供AVX2 / SSE4 / 标量三套实现，运行时按CPU能力选择
+ *
+ * 【性能要点】：
+ * - SIMD版本在一次遍历中完成解掩码和UTF-8校验（数据只进一次寄存器）
+ * - UTF-8校验采用查表法（Keiser & Lemire, "Validating UTF-8 In Less Than One
+ *   Instruction Per Byte"），中文三字节字符不会走慢路径
+ * - 纯ASCII块走快速路径
+ *
+ * 【使用示例】：
+ * ```cpp
+ * if (!FrameKernels::unmaskAndValidateUtf8(payload, length, header.maskKey)) {
+ *     closeConnection(1007);  // 非法UTF-8
+ * }
+ * ```
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 帧负载处理内核（纯静态接口）
+ */
+class FrameKernels {
+public:
+    /**
+     * 指令集实现
+     */
+    enum class Isa {
+        Scalar,     // 标量实现（所有平台可用）
+        Sse4,       // 128位SIMD（SSSE3/SSE4.1指令）
+        Avx2        // 256位SIMD
+    };
+
+    /**
+     * 原地解掩码
+     * 【参数】：data/length - 负载；maskKey - 帧头中的4字节掩码（按线上字节顺序）
+     */
+    static void unmask(uint8_t* data, size_t length, const uint8_t maskKey[4]);
+
+    /**
+     * 校验UTF-8
+     * 【返回】：合法返回true
+     */
+    static bool validateUtf8(const uint8_t* data, size_t length);
+
+    /**
+     * 原地解掩码并校验UTF-8（单次遍历）
+     * 【返回】：解掩码总会完成；负载是合法UTF-8时返回true
+     * 【注意】：用于完整的单帧文本消息；分片消息应在拼接后调用validateUtf8
+     */
+    static bool unmaskAndValidateUtf8(uint8_t* data, size_t length, const uint8_t maskKey[4]);
+
+    /**
+     * 当前使用的实现
+     */
+    static Isa activeIsa();
+
+    /**
+     * 检查CPU是否支持某个实现
+     */
+    static bool isSupported(Isa isa);
+
+    /**
+     * 强制使用某个实现（用于基准测试和对比验证）
+     * 【返回】：CPU不支持时返回false，保持原实现不变
+     */
+    static bool setIsa(Isa isa);
+
+    /**
+     * 实现名称
+     */
+    static const char* isaName(Isa isa);
+};
@@ -9,14 +9,47 @@
 #include "EventManager.h"     // 事件管理器
 #include "Events.h"           // 事件类定义
 #include "WebSocketServer.h"  // WebSocket服务器
+#include "SessionManager.h"   // 会话管理器
+#include "MemoryTracker.h"    // 内存记账
+#include "Metrics.h"          // 运行指标
+#include "WorldData.h"        // 世界数据
+#include "ChoiceStatistics.h" // 玩家选择统计
+#include "PrefetchPlanner.h"  // 预取规划
+#include "ContentStore.h"     // 静态内容哈希
+#include "RuleNetwork.h"      // 剧情规则网络
+#include "RegionPager.h"      // 世界文本区域分页
+#include "TickWatchdog.h"     // 帧看门狗
+#include "AdminServer.h"      // 管理接口
+#include "APIHandler.h"       // 会话的玩家状态（管理快照）
+#include "Replication.h"      // 热备复制
+#include "StartupPlan.h"      // 并行启动和启动时间线
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <thread>
 #include <chrono>
 
+namespace {
+    // 每帧处理异步事件的时间预算（16ms一帧，其余时间留给状态更新和其他子系统）
+    constexpr std::chrono::nanoseconds kEventBudget = std::chrono::microseconds(4000);
+    
+    // 本帧到此用时低于这个值才算空闲帧，顺手整理会话存储
+    constexpr std::chrono::nanoseconds kQuietFrame = std::chrono::microseconds(2000);
+    
+    // 每个空闲帧最多移动的会话数（移动一个会话只是几次指针交换，远低于1微秒）
+    constexpr size_t kCompactionMoves = 64;
+    
+    // 启动到开始接受连接的目标时间（超过时启动时间线后打印警告）
+    constexpr uint64_t kStartupTargetMillis = 1000;
+}
+
 GameEngine::GameEngine() 
     : stateManager(nullptr)
     , eventManager(nullptr)
+    , sessionManager(nullptr)
     , webSocketServer(nullptr)
+    , adminServer(nullptr)
+    , takeoverAttempts(0)
     , initialized(false)
     , running(false)
     , targetFrameTime(1.0f / 60.0f) // 默认60FPS
@@ -68,11 +101,14 @@ void GameEngine::run() {
     
     // 游戏主循环
     const auto frameInterval = std::chrono::milliseconds(16); // ~60 FPS
+    TickWatchdog::instance().registerCurrentThread("engine", frameInterval);
     
     while (running.load()) {
         auto frameStart = std::chrono::steady_clock::now();
         
         try {
+            TickWatchdog::Tick tick;
+            
             // 计算delta时间
             static auto lastFrameTime = frameStart;
             auto deltaTime = std::chrono::duration<float>(frameStart - lastFrameTime).count();
@@ -95,6 +131,7 @@ void GameEngine::run() {
         }
     }
     
+    TickWatchdog::instance().unregisterCurrentThread();
     std::cout << "[GameEngine] 主游戏循环已退出" << std::endl;
 }
 
@@ -109,6 +146,11 @@ void GameEngine::shutdown() {
     // 停止主循环
     running.store(false);
     
+    // 输出最终的运行指标
+    if (initialized.load()) {
+        std::cout << "[GameEngine] 运行指标:\n" << Metrics::instance().renderText();
+    }
+    
     // 清理所有子系统
     cleanupSubsystems();
     
@@ -120,33 +162,145 @@ bool GameEngine::initializeSubsystems() {
     std::cout << "[GameEngine] 正在初始化子系统..." << std::endl;
     
     try {
-        // 1. 创建事件管理器（首先创建，其他系统需要依赖它）
-        std::cout << "[GameEngine] 正在创建事件管理器..." << std::endl;
-        eventManager = std::make_unique<EventManager>();
+        // 初始化步骤组成依赖图，互不依赖的步骤并行执行；
+        // 监听端口等收尾步骤在全部预热完成后才执行，之后到来的连接不会碰到冷缓存
+        StartupPlan plan;
         
-        // 2. 创建状态管理器
-        std::cout << "[GameEngine] 正在创建状态管理器..." << std::endl;
-        stateManager = std::make_unique<StateManager>();
+        // 0. 注册内存记账指标
+        MemoryTracker::registerMetrics();
         
-        // 3. 创建WebSocket服务器
-        std::cout << "[GameEngine] 正在创建WebSocket服务器..." << std::endl;
-        webSocketServer = std::make_unique<WebSocketServer>();
+        // 1. 世界数据：加载后建立内容哈希和选择统计索引、设置预取规划（预取消息按需生成）；
+        //    数据缺失时使用内置演示内容，这些步骤跳过，因此都是可选步骤；最后把世界文本移入按区域分页的包文件
+        plan.add("world", {}, [] { return WorldData::loadGlobal(); }, false);
+        plan.add("content_hashes", {"world"}, [] {
+            ContentStore::instance().initialize(*WorldData::global());
+            return true;
+        }, false);
+        plan.add("choice_index", {"world"}, [] {
+            ChoiceStatistics::instance().initialize(*WorldData::global());
+            return true;
+        }, false);
+        plan.add("prefetch_messages", {"world"}, [] {
+            PrefetchPlanner::instance().initialize(*WorldData::global());
+            return true;
+        }, false);
+        plan.add("rules", {"world"}, [] {
+            RuleNetwork::instance().loadFromDirectory(WorldData::locateDataDirectory());
+            return true;
+        }, false);
+        // 包文件建立后世界文本只能从包中读取：等所有读取世界文本的步骤结束
+        plan.add("region_pack", {"content_hashes", "choice_index", "prefetch_messages", "rules"}, [] {
+            return RegionPager::instance().initialize(*WorldData::global());
+        }, false);
+        // 预先换入起始场景及相邻区域，第一批玩家进入时不用等磁盘
+        plan.add("prefault_start", {"region_pack"}, [] {
+            std::vector<uint32_t> held;
+            RegionPager::instance().enter(held, WorldData::global()->getStartLocation());
+            RegionPager::instance().releaseAll(held);   // 之后按空闲时间正常换出
+            return true;
+        }, false);
         
-        // 4. 启动WebSocket服务器
-        if (!webSocketServer->start(8080)) {
-            std::cerr << "[GameEngine] WebSocket服务器启动失败" << std::endl;
-            return false;
-        }
+        // 2. 创建事件管理器、状态管理器和会话管理器（互不依赖）
+        plan.add("event_manager", {}, [this] {
+            eventManager = std::make_unique<EventManager>();
+            eventManager->registerMetrics();
+            return true;
+        });
+        plan.add("state_manager", {}, [this] {
+            stateManager = std::make_unique<StateManager>();
+            return true;
+        });
+        plan.add("session_manager", {}, [this] {
+            sessionManager = std::make_unique<SessionManager>();
+            return true;
+        });
         
-        std::cout << "[GameEngine] WebSocket服务器启动成功，正在监听端口 8080" << std::endl;
+        // 3. 创建WebSocket服务器并预热：前端静态资源读入内存缓存、加载TLS证书
+        plan.add("websocket_prepare", {"session_manager"}, [this] {
+            webSocketServer = std::make_unique<WebSocketServer>();
+            webSocketServer->setSessionManager(sessionManager.get());
+            if (!webSocketServer->prepare()) {
+                std::cerr << "[GameEngine] TLS配置无效" << std::endl;
+                return false;
+            }
+            return true;
+        });
         
-        // 5. 设置系统间的连接
-        setupEventListeners();
+        // 4. 收尾：注册指标、连接各系统、启动看门狗和管理接口，最后开始接受连接
+        plan.addFinal("metrics", [] {
+            WorldData::registerMetrics();
+            ContentStore::instance().registerMetrics();
+            ChoiceStatistics::instance().registerMetrics();
+            PrefetchPlanner::instance().registerMetrics();
+            RuleNetwork::instance().registerMetrics();
+            RegionPager::instance().registerMetrics();
+            TickWatchdog::instance().registerMetrics();
+            return true;
+        });
+        plan.addFinal("event_listeners", [this] {
+            RuleNetwork::instance().setEventSink(eventManager.get());
+            setupEventListeners();
+            return true;
+        });
+        // 帧看门狗（卡住时可以隔离正在处理的会话）
+        plan.addFinal("watchdog", [this] {
+            SessionManager* sessions = sessionManager.get();
+            TickWatchdog::instance().setPoisonHandler([sessions](const std::string& sessionId) {
+                sessions->poisonSession(sessionId);
+            });
+            TickWatchdog::instance().start();
+            return true;
+        });
+        // 本机管理接口（失败不影响游戏服务器）
+        // 同一台机器上的备用进程默认使用另一个套接字，不顶替主服务器的管理接口
+        const char* standbyOf = std::getenv("TIME_ARTIFACTS_STANDBY_OF");
+        bool standbyMode = standbyOf && *standbyOf;
+        plan.addFinal("admin", [this, standbyMode] {
+            std::string adminPath = AdminServer::defaultSocketPath();
+            if (standbyMode && !adminPath.empty() && !std::getenv("TIME_ARTIFACTS_ADMIN_SOCKET")) {
+                adminPath += ".standby";
+            }
+            adminServer = std::make_unique<AdminServer>();
+            return adminServer->start(adminPath);
+        }, false);
+        // 启动WebSocket服务器（备用模式下先接收主服务器的会话变更，主服务器失效后再接管端口）
+        plan.addFinal("listen", [this, standbyMode, standbyOf] {
+            if (standbyMode) {
+                standby = std::make_unique<ReplicationStandby>(*sessionManager);
+                if (!standby->start(standbyOf)) {
+                    return false;
+                }
+                std::cout << "[GameEngine] 备用模式：主服务器失效后接管端口 8080" << std::endl;
+                return true;
+            }
+            if (!webSocketServer->start(8080)) {
+                std::cerr << "[GameEngine] WebSocket服务器启动失败" << std::endl;
+                return false;
+            }
+            std::cout << "[GameEngine] WebSocket服务器启动成功，正在监听端口 8080" << std::endl;
+            
+            // 向备用进程复制会话变更（失败不影响游戏服务器）
+            const char* replicationListen = std::getenv("TIME_ARTIFACTS_REPLICATION_LISTEN");
+            if (replicationListen && *replicationListen) {
+                ReplicationPrimary::instance().start(replicationListen);
+            }
+            return true;
+        });
         
-        // TODO: 后端架构师继续添加其他子系统
-        // 3. 创建事件管理器
-        // 4. 创建状态管理器  
-        // 5. 创建数据加载器
+        size_t threads = 0;
+        if (const char* env = std::getenv("TIME_ARTIFACTS_STARTUP_THREADS")) {
+            threads = static_cast<size_t>(std::max(1L, std::strtol(env, nullptr, 10)));
+        }
+        uint64_t targetMillis = kStartupTargetMillis;
+        if (const char* env = std::getenv("TIME_ARTIFACTS_STARTUP_TARGET_MS")) {
+            targetMillis = std::strtoull(env, nullptr, 10);
+        }
+        bool ready = plan.run(threads);
+        plan.printTimeline(std::cout, targetMillis);
+        if (!ready) {
+            std::cerr << "[GameEngine] 启动步骤失败，见上面的时间线" << std::endl;
+            return false;
+        }
         
         std::cout << "[GameEngine] 所有子系统初始化成功" << std::endl;
         return true;
@@ -159,11 +313,17 @@ bool GameEngine::initializeSubsystems() {
 
 void GameEngine::update(float deltaTime) {
     frameCount++;
+    auto updateStart = std::chrono::steady_clock::now();
     
     try {
+        // 0. 备用模式：主服务器失效后接管端口
+        if (standby && standby->primaryLost()) {
+            takeOverFromPrimary();
+        }
+        
         // 1. 处理事件队列
         if (eventManager) {
-            eventManager->processEvents(50); // 每帧最多处理50个事件
+            eventManager->processEvents(kEventBudget); // 会话之间公平分配，处理不完的留到下一帧
         }
         
         // 2. 更新状态管理器
@@ -171,9 +331,30 @@ void GameEngine::update(float deltaTime) {
             stateManager->update(deltaTime);
         }
         
+        // 2.5 按状态批量更新所有会话
+        if (sessionManager) {
+            sessionManager->updateSessionStates(deltaTime);
+        }
+        
         // 3. 处理系统级事件
         handleSystemEvents();
         
+        // 3.5 定期合并选择统计分片，发布新快照
+        ChoiceStatistics::instance().mergeIfDue();
+        
+        // 3.6 换出长时间无人接近的世界区域
+        RegionPager::instance().sweepIfDue();
+        
+        // 3.7 管理接口有请求在等待时发布快照
+        if (adminServer && adminServer->snapshotRequested()) {
+            publishAdminSnapshot();
+        }
+        
+        // 3.8 空闲帧：增量整理会话存储，空页归还给操作系统
+        if (sessionManager && std::chrono::steady_clock::now() - updateStart < kQuietFrame) {
+            sessionManager->compactSessions(kCompactionMoves);
+        }
+        
         // 4. 渲染当前状态
         if (stateManager) {
             stateManager->render();
@@ -195,6 +376,14 @@ void GameEngine::cleanupSubsystems() {
     
     // 按照初始化的逆序进行清理
     
+    // 0. 停止看门狗和管理接口（之后不再访问会话管理器）
+    TickWatchdog::instance().stop();
+    TickWatchdog::instance().setPoisonHandler(nullptr);
+    if (adminServer) {
+        adminServer->stop();
+        adminServer.reset();
+    }
+    
     // 1. 停止WebSocket服务器
     if (webSocketServer) {
         std::cout << "[GameEngine] 正在停止WebSocket服务器..." << std::endl;
@@ -203,23 +392,35 @@ void GameEngine::cleanupSubsystems() {
         std::cout << "[GameEngine] WebSocket服务器已停止" << std::endl;
     }
     
-    // 2. 清理状态管理器
+    // 1.5 停止复制（之后不再有会话变更；最后一批尽量发给备用进程）
+    standby.reset();
+    ReplicationPrimary::instance().stop();
+    
+    // 2. 清理会话管理器（服务器已停止，不会再有新会话）
+    if (sessionManager) {
+        std::cout << "[GameEngine] 正在清理会话管理器..." << std::endl;
+        sessionManager.reset();
+        std::cout << "[GameEngine] 会话管理器已清理" << std::endl;
+    }
+    
+    // 3. 清理状态管理器
     if (stateManager) {
         std::cout << "[GameEngine] 正在清理状态管理器..." << std::endl;
         stateManager.reset();
         std::cout << "[GameEngine] 状态管理器已清理" << std::endl;
     }
     
-    // 3. 清理事件管理器（最后清理，因为其他系统可能还需要发布事件）
+    // 4. 清理事件管理器（最后清理，因为其他系统可能还需要发布事件）
     if (eventManager) {
         std::cout << "[GameEngine] 正在清理事件管理器..." << std::endl;
+        RuleNetwork::instance().setEventSink(nullptr);
         eventManager.reset();
         std::cout << "[GameEngine] 事件管理器已清理" << std::endl;
     }
     
     // TODO: 后续添加其他子系统的清理
-    // 4. 清理数据加载器
-    // 5. 清理音频系统
+    // 5. 清理数据加载器
+    // 6. 清理音频系统
     
     std::cout << "[GameEngine] 子系统清理完成" << std::endl;
 }
@@ -240,6 +441,10 @@ WebSocketServer* GameEngine::getWebSocketServer() const {
     return webSocketServer.get();
 }
 
+SessionManager* GameEngine::getSessionManager() const {
+    return sessionManager.get();
+}
+
 void GameEngine::setTargetFPS(int fps) {
     if (fps > 0) {
         targetFrameTime = 1.0f / fps;
@@ -279,9 +484,96 @@ void GameEngine::setupEventListeners() {
             std::cout << "[GameEngine] 收到错误事件，考虑关闭游戏" << std::endl;
         }, "GameEngine", 0);
     
+    // 监听剧情触发事件（由剧情规则网络发布）
+    eventManager->subscribe("StoryTriggered",
+        [](const Event& e) {
+            const auto& story = static_cast<const StoryTriggeredEvent&>(e);
+            std::cout << "[GameEngine] 剧情触发: " << story.ruleId << "（玩家 " << story.playerId << "）" << std::endl;
+        }, "GameEngine", 3);
+    
     std::cout << "[GameEngine] 事件监听器设置完成" << std::endl;
 }
 
+void GameEngine::publishAdminSnapshot() {
+    auto snapshot = std::make_shared<AdminSnapshot>();
+    auto now = std::chrono::steady_clock::now();
+    snapshot->builtAt = now;
+    snapshot->frameCount = frameCount;
+    
+    if (stateManager && stateManager->hasCurrentState()) {
+        snapshot->engineState = stateManager->getCurrentStateName();
+        snapshot->stateDepth = stateManager->getStateStackDepth();
+    }
+    if (eventManager) {
+        snapshot->queueSize = eventManager->getQueueSize();
+        snapshot->subscribers = eventManager->getSubscriberCounts();
+        snapshot->eventCounts = eventManager->getEventStatistics();
+    }
+    
+    if (sessionManager) {
+        // 与上一份快照比较，得到这段时间内每个会话的消息数
+        std::map<std::string, uint64_t> previousMessages;
+        std::map<std::string, SessionEventStats> eventStats;
+        if (eventManager) {
+            eventStats = eventManager->getSessionEventStats();
+        }
+        if (auto previous = adminServer->latest()) {
+            for (const auto& session : previous->sessions) {
+                previousMessages[session.id] = session.messages;
+            }
+        }
+        sessionManager->forEachSession([&](const Session& session) {
+            AdminSnapshot::SessionInfo info;
+            info.id = session.id;
+            info.attached = session.attached;
+            info.location = session.handler->getCurrentLocation();
+            info.dialogue = session.handler->getCurrentDialogue();
+            info.messages = session.messagesHandled;
+            auto events = eventStats.find(session.id);
+            if (events != eventStats.end()) {
+                info.queuedEvents = events->second.queued;
+                info.eventWaitMicros = events->second.waitMicrosAvg;
+            }
+            auto previous = previousMessages.find(session.id);
+            info.recentMessages = session.messagesHandled - (previous != previousMessages.end() ? previous->second : 0);
+            info.idleSeconds = std::chrono::duration_cast<std::chrono::seconds>(now - session.lastActive).count();
+            snapshot->sessions.push_back(std::move(info));
+        });
+    }
+    
+    adminServer->publish(std::move(snapshot));
+}
+
+void GameEngine::takeOverFromPrimary() {
+    static auto& takeovers = Metrics::instance().counter("replication.takeovers");
+    static const auto kFirstRetry = std::chrono::milliseconds(100);
+    static const auto kMaxRetry = std::chrono::milliseconds(2000);
+    
+    auto now = std::chrono::steady_clock::now();
+    if (takeoverAttempts > 0 && now < nextTakeoverAttempt) {
+        return;
+    }
+    if (takeoverAttempts == 0) {
+        standby->stop();
+    }
+    if (!webSocketServer->start(8080)) {
+        if (takeoverAttempts == 0) {
+            std::cerr << "[GameEngine] 接管失败：端口 8080 仍被占用，按退避间隔重试" << std::endl;
+        }
+        auto delay = std::min<std::chrono::milliseconds>(kMaxRetry, kFirstRetry * (1 << std::min(takeoverAttempts, 5)));
+        nextTakeoverAttempt = now + delay;
+        ++takeoverAttempts;
+        return;
+    }
+    // 断线时间从接管时算起，客户端有完整的恢复窗口
+    sessionManager->detachAllSessions();
+    standby.reset();
+    takeoverAttempts = 0;
+    takeovers.fetch_add(1, std::memory_order_relaxed);
+    std::cout << "[GameEngine] 已接管端口 8080，" << sessionManager->getSessionCount()
+              << " 个复制来的会话等待客户端凭恢复令牌重连" << std::endl;
+}
+
 void GameEngine::handleSystemEvents() {
     // 处理系统级事件
     // 这个方法在主循环中每帧调用
@@ -0,0 +1,166 @@
+/**
+ * HttpRequest.cpp
+ *
+ * HTTP请求解析实现
+ */
+
+#include "HttpRequest.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+    // 请求头最大长度，超过按错误处理，避免慢速客户端撑爆缓冲
+    constexpr size_t kMaxHeaderBytes = 16 * 1024;
+
+    std::string trim(const std::string& value) {
+        size_t begin = value.find_first_not_of(" \t");
+        if (begin == std::string::npos) {
+            return "";
+        }
+        size_t end = value.find_last_not_of(" \t\r");
+        return value.substr(begin, end - begin + 1);
+    }
+
+} // namespace
+
+std::string HttpRequest::header(const std::string& name) const {
+    auto it = headers.find(Http::toLower(name));
+    return it != headers.end() ? it->second : "";
+}
+
+bool HttpRequest::hasToken(const std::string& name, const std::string& token) const {
+    std::string value = Http::toLower(header(name));
+    std::string wanted = Http::toLower(token);
+
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t comma = value.find(',', start);
+        if (comma == std::string::npos) {
+            comma = value.size();
+        }
+        if (trim(value.substr(start, comma - start)) == wanted) {
+            return true;
+        }
+        start = comma + 1;
+    }
+    return false;
+}
+
+std::string HttpRequest::queryParameter(const std::string& name) const {
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        size_t equals = query.find('=', start);
+        if (equals != std::string::npos && equals < end && query.compare(start, equals - start, name) == 0 &&
+            equals - start == name.size()) {
+            return query.substr(equals + 1, end - equals - 1);
+        }
+        start = end + 1;
+    }
+    return "";
+}
+
+bool HttpRequest::isWebSocketUpgrade() const {
+    return method == "GET" && hasToken("upgrade", "websocket") && hasToken("connection", "upgrade")
+        && !header("sec-websocket-key").empty();
+}
+
+bool HttpRequest::keepAlive() const {
+    if (version == "HTTP/1.0") {
+        return hasToken("connection", "keep-alive");
+    }
+    return !hasToken("connection", "close");
+}
+
+namespace Http {
+
+    std::string toLower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    }
+
+    ParseResult parseRequest(const std::string& buffer, HttpRequest& request, size_t& consumed) {
+        size_t headerEnd = buffer.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            return buffer.size() > kMaxHeaderBytes ? ParseResult::BadRequest : ParseResult::Incomplete;
+        }
+        if (headerEnd > kMaxHeaderBytes) {
+            return ParseResult::BadRequest;
+        }
+
+        request = HttpRequest();
+
+        // 请求行
+        size_t lineEnd = buffer.find("\r\n");
+        std::string requestLine = buffer.substr(0, lineEnd);
+        size_t firstSpace = requestLine.find(' ');
+        size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+        if (firstSpace == std::string::npos || secondSpace == std::string::npos) {
+            return ParseResult::BadRequest;
+        }
+        request.method = requestLine.substr(0, firstSpace);
+        std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+        request.version = requestLine.substr(secondSpace + 1);
+        if (target.empty() || target[0] != '/' || request.version.compare(0, 5, "HTTP/") != 0) {
+            return ParseResult::BadRequest;
+        }
+
+        size_t questionMark = target.find('?');
+        request.path = target.substr(0, questionMark);
+        if (questionMark != std::string::npos) {
+            request.query = target.substr(questionMark + 1);
+        }
+
+        // 头部
+        size_t pos = lineEnd + 2;
+        while (pos < headerEnd) {
+            size_t next = buffer.find("\r\n", pos);
+            std::string line = buffer.substr(pos, next - pos);
+            pos = next + 2;
+
+            size_t colon = line.find(':');
+            if (colon == std::string::npos || colon == 0) {
+                return ParseResult::BadRequest;
+            }
+            std::string name = toLower(line.substr(0, colon));
+            std::string value = trim(line.substr(colon + 1));
+
+            auto existing = request.headers.find(name);
+            if (existing != request.headers.end()) {
+                existing->second += ", " + value;
+            } else {
+                request.headers.emplace(std::move(name), std::move(value));
+            }
+        }
+
+        // 不支持请求体
+        std::string contentLength = request.header("content-length");
+        if ((!contentLength.empty() && contentLength != "0") || !request.header("transfer-encoding").empty()) {
+            return ParseResult::BadRequest;
+        }
+
+        consumed = headerEnd + 4;
+        return ParseResult::Ok;
+    }
+
+    const char* reasonPhrase(int status) {
+        switch (status) {
+            case 101: return "Switching Protocols";
+            case 200: return "OK";
+            case 304: return "Not Modified";
+            case 400: return "Bad Request";
+            case 403: return "Forbidden";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 500: return "Internal Server Error";
+            case 503: return "Service Unavailable";
+            default: return "Unknown";
+        }
+    }
+
+} // namespace Http
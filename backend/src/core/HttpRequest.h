@@ -0,0 +1,85 @@
+/**
+ * HttpRequest.h
+ *
+ * HTTP/1.1请求解析（只覆盖游戏端口需要的子集）
+ *
+ * 【用途】：
+ * 1. WebSocket升级请求（GET + Upgrade: websocket）
+ * 2. 前端静态资源请求（GET/HEAD）
+ * 3. 指标查询（GET /metrics）
+ *
+ * 【限制】：不支持请求体和分块编码，带请求体的请求直接按错误处理
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * 已解析的HTTP请求
+ */
+struct HttpRequest {
+    std::string method;     // "GET"、"HEAD" 等
+    std::string path;       // 已去掉查询串的路径
+    std::string query;      // 查询串（不含'?'）
+    std::string version;    // "HTTP/1.1"
+    std::map<std::string, std::string> headers;  // 头部名统一为小写
+
+    /**
+     * 获取头部值（名字不区分大小写）
+     */
+    std::string header(const std::string& name) const;
+
+    /**
+     * 头部值中是否包含某个逗号分隔的记号（不区分大小写）
+     * 【示例】：hasToken("connection", "upgrade")
+     */
+    bool hasToken(const std::string& name, const std::string& token) const;
+
+    /**
+     * 获取查询参数（不做百分号解码，只用于令牌、数字等简单值）
+     * 【示例】：/?resume=abc&lastSeq=42 → queryParameter("lastSeq") == "42"
+     */
+    std::string queryParameter(const std::string& name) const;
+
+    /**
+     * 是否为WebSocket升级请求
+     */
+    bool isWebSocketUpgrade() const;
+
+    /**
+     * 连接是否应保持（HTTP/1.1默认保持）
+     */
+    bool keepAlive() const;
+};
+
+namespace Http {
+
+    /**
+     * 解析结果
+     */
+    enum class ParseResult {
+        Ok,
+        Incomplete,     // 头部尚未接收完整
+        BadRequest      // 格式错误或过大
+    };
+
+    /**
+     * 从接收缓冲解析一个请求
+     * 【参数】：consumed - 成功时返回请求占用的字节数
+     */
+    ParseResult parseRequest(const std::string& buffer, HttpRequest& request, size_t& consumed);
+
+    /**
+     * 状态码对应的原因短语
+     */
+    const char* reasonPhrase(int status);
+
+    /**
+     * 字符串转小写（ASCII）
+     */
+    std::string toLower(std::string value);
+
+} // namespace Http
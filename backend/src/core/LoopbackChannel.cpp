@@ -0,0 +1,163 @@
+/**
+ * LoopbackChannel.cpp
+ *
+ * 进程内回环通道实现
+ */
+
+#include "LoopbackChannel.h"
+#include "FrameKernels.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+    size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // RFC 6455 示例密钥（回环连接不需要随机性，固定值让结果可复现）
+    const char* const kClientKey = "dGhlIHNhbXBsZSBub25jZQ==";
+
+} // namespace
+
+// ==================== SpscByteRing ====================
+
+SpscByteRing::SpscByteRing(size_t requested)
+    : capacity(roundUpPowerOfTwo(std::max<size_t>(requested, 64))), mask(capacity - 1) {
+    buffer.reset(new uint8_t[capacity]);
+}
+
+size_t SpscByteRing::write(const void* data, size_t length) {
+    size_t writePos = tail.load(std::memory_order_relaxed);
+    size_t readPos = head.load(std::memory_order_acquire);
+    size_t count = std::min(length, capacity - (writePos - readPos));
+    if (count == 0) {
+        return 0;
+    }
+
+    // 可能跨越环尾，分两段拷贝
+    size_t start = writePos & mask;
+    size_t first = std::min(count, capacity - start);
+    std::memcpy(buffer.get() + start, data, first);
+    std::memcpy(buffer.get(), static_cast<const uint8_t*>(data) + first, count - first);
+    tail.store(writePos + count, std::memory_order_release);
+    return count;
+}
+
+size_t SpscByteRing::readAppend(std::string& out, size_t maxBytes) {
+    size_t readPos = head.load(std::memory_order_relaxed);
+    size_t writePos = tail.load(std::memory_order_acquire);
+    size_t count = std::min(maxBytes, writePos - readPos);
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t start = readPos & mask;
+    size_t first = std::min(count, capacity - start);
+    out.append(reinterpret_cast<const char*>(buffer.get() + start), first);
+    out.append(reinterpret_cast<const char*>(buffer.get()), count - first);
+    head.store(readPos + count, std::memory_order_release);
+    return count;
+}
+
+size_t SpscByteRing::readable() const {
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+// ==================== LoopbackChannel ====================
+
+LoopbackChannel::LoopbackChannel(size_t capacity)
+    : toServer(capacity), toClient(capacity), maskState(0x9E3779B9u) {
+}
+
+bool LoopbackChannel::sendUpgrade(const std::string& query) {
+    std::string request = "GET /" + (query.empty() ? "" : "?" + query) + " HTTP/1.1\r\n"
+                          "Host: loopback\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: " + std::string(kClientKey) + "\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (toServer.writable() < request.size()) {
+        return false;
+    }
+    toServer.write(request.data(), request.size());
+    return true;
+}
+
+bool LoopbackChannel::sendText(const std::string& message) {
+    return writeFrame(WebSocketFrame::Opcode::Text, message);
+}
+
+bool LoopbackChannel::sendClose(uint16_t code) {
+    std::string payload;
+    payload.push_back(static_cast<char>(code >> 8));
+    payload.push_back(static_cast<char>(code & 0xFF));
+    return writeFrame(WebSocketFrame::Opcode::Close, payload);
+}
+
+bool LoopbackChannel::writeFrame(WebSocketFrame::Opcode opcode, const std::string& payload) {
+    // 客户端帧：服务器帧头 + 掩码位 + 4字节掩码
+    uint8_t header[14];
+    size_t headerLength = WebSocketFrame::encodeHeader(header, opcode, payload.size());
+    header[1] |= 0x80;
+
+    // xorshift生成掩码（确定性）
+    maskState ^= maskState << 13;
+    maskState ^= maskState >> 17;
+    maskState ^= maskState << 5;
+    uint8_t maskKey[4];
+    std::memcpy(maskKey, &maskState, sizeof(maskKey));
+    std::memcpy(header + headerLength, maskKey, sizeof(maskKey));
+    headerLength += sizeof(maskKey);
+
+    if (toServer.writable() < headerLength + payload.size()) {
+        return false;
+    }
+    std::string masked = payload;
+    FrameKernels::unmask(reinterpret_cast<uint8_t*>(&masked[0]), masked.size(), maskKey);
+    toServer.write(header, headerLength);
+    toServer.write(masked.data(), masked.size());
+    return true;
+}
+
+bool LoopbackChannel::receive(std::string& payload, WebSocketFrame::Opcode* opcode) {
+    if (receivedOffset > 0 && receivedOffset * 2 >= received.size()) {
+        received.erase(0, receivedOffset);
+        receivedOffset = 0;
+    }
+    toClient.readAppend(received);
+
+    if (status == 0) {
+        size_t end = received.find("\r\n\r\n", receivedOffset);
+        if (end == std::string::npos) {
+            return false;
+        }
+        // "HTTP/1.1 101 Switching Protocols"
+        size_t space = received.find(' ', receivedOffset);
+        status = space < end ? std::atoi(received.c_str() + space + 1) : -1;
+        receivedOffset = end + 4;
+    }
+    if (status != 101) {
+        return false;   // 升级被拒绝，之后是HTTP响应体
+    }
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(received.data()) + receivedOffset;
+    size_t length = received.size() - receivedOffset;
+    WebSocketFrame::FrameHeader header;
+    if (WebSocketFrame::parseHeader(data, length, header) != WebSocketFrame::ParseResult::Ok ||
+        length < header.headerLength + header.payloadLength) {
+        return false;
+    }
+    payload.assign(reinterpret_cast<const char*>(data + header.headerLength),
+                   static_cast<size_t>(header.payloadLength));
+    if (opcode) {
+        *opcode = header.opcode;
+    }
+    receivedOffset += header.headerLength + static_cast<size_t>(header.payloadLength);
+    return true;
+}
@@ -0,0 +1,133 @@
+/**
+ * LoopbackChannel.h
+ *
+ * 进程内回环通道 - 不经过内核套接字，把客户端字节流直接交给WebSocketServer
+ *
+ * 【文件作用】：
+ * 1. SpscByteRing：单生产者单消费者的字节环（固定容量，无锁）
+ * 2. LoopbackChannel：两个字节环组成的双工通道，客户端一侧提供
+ *    升级请求、加掩码的文本帧、关闭帧的写入，以及服务器帧的读取
+ *
+ * 【为什么】：基准和集成测试需要在没有内核套接字噪声的情况下，
+ *   让消息完整地走一遍 帧解析 → APIHandler → 序列化/编码 的真实路径；
+ *   服务器一侧与普通连接共用同一套处理代码（见WebSocketServer::openLoopback）
+ *
+ * 【线程】：客户端一侧的方法只能在一个线程调用，服务器一侧由WebSocketServer在
+ *   驱动线程（pumpLoopback的调用者）上访问；两侧可以是同一个线程
+ */
+
+#pragma once
+
+#include "WebSocketFrame.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * 单生产者单消费者字节环
+ * 【说明】：容量取整到2的幂；写满时只写入能放下的部分（与非阻塞套接字一致）
+ */
+class SpscByteRing {
+public:
+    explicit SpscByteRing(size_t capacity);
+
+    SpscByteRing(const SpscByteRing&) = delete;
+    SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+    /**
+     * 写入（生产者）
+     * 【返回】：实际写入的字节数
+     */
+    size_t write(const void* data, size_t length);
+
+    /**
+     * 读出追加到out（消费者）
+     * 【返回】：读出的字节数
+     */
+    size_t readAppend(std::string& out, size_t maxBytes = SIZE_MAX);
+
+    size_t readable() const;
+    size_t writable() const { return capacity - readable(); }
+    size_t getCapacity() const { return capacity; }
+
+private:
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t capacity;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};    // 下一个读位置（消费者写）
+    alignas(64) std::atomic<size_t> tail{0};    // 下一个写位置（生产者写）
+};
+
+/**
+ * 回环通道
+ */
+class LoopbackChannel {
+public:
+    /**
+     * 【参数】：capacity - 每个方向的字节环容量
+     */
+    explicit LoopbackChannel(size_t capacity = 256 * 1024);
+
+    // ===== 客户端一侧 =====
+
+    /**
+     * 写入WebSocket升级请求
+     * 【参数】：query - 请求路径的查询部分（如 "resume=<令牌>&lastSeq=3"，可为空）
+     */
+    bool sendUpgrade(const std::string& query = "");
+
+    /**
+     * 写入一个加掩码的文本帧（整帧放不下时不写入并返回false，稍后重试）
+     */
+    bool sendText(const std::string& message);
+
+    /**
+     * 写入关闭帧
+     */
+    bool sendClose(uint16_t code = WebSocketFrame::CloseNormal);
+
+    /**
+     * 取出下一条服务器消息（握手响应在第一次调用时被消费）
+     * 【参数】：opcode - 可选，输出帧的操作码
+     * 【返回】：没有完整的帧时返回false
+     */
+    bool receive(std::string& payload, WebSocketFrame::Opcode* opcode = nullptr);
+
+    /**
+     * 握手响应的状态码（还没收到时为0）
+     */
+    int handshakeStatus() const { return status; }
+
+    /**
+     * 客户端断开（服务器读完剩余数据后关闭连接）
+     */
+    void disconnect() { clientClosed.store(true, std::memory_order_release); }
+
+    /**
+     * 服务器是否已关闭连接
+     */
+    bool isClosedByServer() const { return serverClosed.load(std::memory_order_acquire); }
+
+    // ===== 服务器一侧（WebSocketServer使用） =====
+
+    SpscByteRing& serverInbound() { return toServer; }
+    SpscByteRing& serverOutbound() { return toClient; }
+    bool isClientClosed() const { return clientClosed.load(std::memory_order_acquire); }
+    void markServerClosed() { serverClosed.store(true, std::memory_order_release); }
+
+private:
+    bool writeFrame(WebSocketFrame::Opcode opcode, const std::string& payload);
+
+    SpscByteRing toServer;
+    SpscByteRing toClient;
+    std::atomic<bool> clientClosed{false};
+    std::atomic<bool> serverClosed{false};
+
+    // 客户端状态（只在客户端线程访问）
+    std::string received;
+    size_t receivedOffset = 0;
+    int status = 0;
+    uint32_t maskState;
+};
@@ -0,0 +1,369 @@
+/**
+ * MemoryTracker.cpp
+ *
+ * 内存记账器实现
+ *
+ * 【实现重点】：
+ * 1. 每块内存前加16字节头部（保持max_align_t对齐），记录大小、标签和到原始指针的偏移
+ * 2. 每个线程写自己的计数槽（独占缓存行），快照时求和；热路径上没有锁，也没有跨线程争用的原子操作
+ * 3. 全局operator new/delete替换受 TIME_ARTIFACTS_MEMORY_TRACKING 宏控制
+ * 4. 这里的代码不能使用任何会分配内存的设施（iostream、string等）
+ */
+
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// 头部指针由全局operator new经malloc得到，这里的free是匹配的
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+
+    constexpr size_t kTagCount = static_cast<size_t>(MemoryTag::Count);
+
+    // 线程计数槽数量（超过的线程共用一个原子累加的槽）
+    constexpr size_t kThreadSlots = 128;
+
+    /**
+     * 内存块头部
+     * 【说明】：16字节，紧贴在返回给调用方的指针之前；offset是返回指针到malloc所得指针的距离
+     *   （普通分配为16，对齐分配为对齐值），释放时据此找回原始指针
+     */
+    struct alignas(16) AllocationHeader {
+        uint64_t size;
+        uint32_t offset;
+        uint8_t tag;
+    };
+    static_assert(sizeof(AllocationHeader) == 16, "AllocationHeader必须是16字节");
+
+    /**
+     * 一个线程的计数
+     * 【说明】：每个槽只有占用它的线程写（普通的读-加-写，没有锁前缀的原子操作），
+     *   快照时把所有槽相加；一个线程释放另一个线程分配的内存时，本槽的字节数可以是负的
+     */
+    struct alignas(64) CounterSlot {
+        std::atomic<bool> claimed{false};
+        std::atomic<int64_t> bytes[kTagCount];
+        std::atomic<uint64_t> allocations[kTagCount];
+        std::atomic<uint64_t> deallocations[kTagCount];
+    };
+
+    // 静态零初始化，不依赖构造顺序（operator new可能在main之前被调用）
+    CounterSlot g_slots[kThreadSlots];
+    CounterSlot g_sharedSlot;
+    std::atomic<int64_t> g_peakBytes[kTagCount];
+
+    thread_local MemoryTag t_currentTag = MemoryTag::Untagged;
+    thread_local CounterSlot* t_slot = nullptr;
+    thread_local bool t_exiting = false;
+
+    /**
+     * 线程退出时归还计数槽（槽里的计数保留，下一个占用它的线程接着累加）
+     */
+    struct SlotOwner {
+        CounterSlot* slot = nullptr;
+        ~SlotOwner() {
+            t_exiting = true;
+            t_slot = &g_sharedSlot;
+            if (slot) {
+                slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local SlotOwner t_owner;
+
+    CounterSlot& localSlot() {
+        if (t_slot) {
+            return *t_slot;
+        }
+        t_slot = &g_sharedSlot;
+        if (!t_exiting) {
+            for (auto& slot : g_slots) {
+                bool expected = false;
+                if (!slot.claimed.load(std::memory_order_relaxed) &&
+                    slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    t_slot = &slot;
+                    t_owner.slot = &slot;
+                    break;
+                }
+            }
+        }
+        return *t_slot;
+    }
+
+    template <typename T>
+    void add(CounterSlot& slot, std::atomic<T>& counter, T delta) {
+        if (&slot == &g_sharedSlot) {
+            counter.fetch_add(delta, std::memory_order_relaxed);
+        } else {
+            counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+    }
+
+    void recordAllocation(MemoryTag tag, size_t size) {
+        CounterSlot& slot = localSlot();
+        size_t index = static_cast<size_t>(tag);
+        add<int64_t>(slot, slot.bytes[index], static_cast<int64_t>(size));
+        add<uint64_t>(slot, slot.allocations[index], 1);
+    }
+
+    void recordDeallocation(MemoryTag tag, size_t size) {
+        CounterSlot& slot = localSlot();
+        size_t index = static_cast<size_t>(tag);
+        add<int64_t>(slot, slot.bytes[index], -static_cast<int64_t>(size));
+        add<uint64_t>(slot, slot.deallocations[index], 1);
+    }
+
+    void* rawAllocate(size_t bytes, size_t alignment) {
+#ifdef _WIN32
+        return _aligned_malloc(bytes, alignment);
+#else
+        if (alignment <= alignof(std::max_align_t)) {
+            return std::malloc(bytes);
+        }
+        void* raw = nullptr;
+        return posix_memalign(&raw, alignment, bytes) == 0 ? raw : nullptr;
+#endif
+    }
+
+    void rawRelease(void* raw) {
+#ifdef _WIN32
+        _aligned_free(raw);
+#else
+        std::free(raw);
+#endif
+    }
+
+} // namespace
+
+int64_t MemorySnapshot::totalBytes() const {
+    int64_t total = 0;
+    for (const auto& t : tags) {
+        total += t.currentBytes;
+    }
+    return total;
+}
+
+void* MemoryTracker::allocate(size_t size, MemoryTag tag) {
+    return allocateAligned(size, sizeof(AllocationHeader), tag);
+}
+
+void* MemoryTracker::allocateAligned(size_t size, size_t alignment, MemoryTag tag) {
+    size_t offset = alignment > sizeof(AllocationHeader) ? alignment : sizeof(AllocationHeader);
+    void* raw = rawAllocate(offset + (size ? size : 1), offset);
+    if (!raw) {
+        return nullptr;
+    }
+
+    char* user = static_cast<char*>(raw) + offset;
+    auto* header = reinterpret_cast<AllocationHeader*>(user) - 1;
+    header->size = size;
+    header->offset = static_cast<uint32_t>(offset);
+    header->tag = static_cast<uint8_t>(tag);
+    recordAllocation(tag, size);
+
+    return user;
+}
+
+void MemoryTracker::deallocate(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+
+    auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+    recordDeallocation(static_cast<MemoryTag>(header->tag), static_cast<size_t>(header->size));
+    rawRelease(static_cast<char*>(ptr) - header->offset);
+}
+
+void MemoryTracker::recordMapped(MemoryTag tag, size_t size) {
+#ifdef TIME_ARTIFACTS_MEMORY_TRACKING
+    recordAllocation(tag, size);
+#else
+    (void)tag;
+    (void)size;
+#endif
+}
+
+void MemoryTracker::recordUnmapped(MemoryTag tag, size_t size) {
+#ifdef TIME_ARTIFACTS_MEMORY_TRACKING
+    recordDeallocation(tag, size);
+#else
+    (void)tag;
+    (void)size;
+#endif
+}
+
+MemoryTag MemoryTracker::currentTag() {
+    return t_currentTag;
+}
+
+void MemoryTracker::setCurrentTag(MemoryTag tag) {
+    t_currentTag = tag;
+}
+
+MemorySnapshot MemoryTracker::snapshot() {
+    MemorySnapshot snap;
+    auto accumulate = [&snap](const CounterSlot& slot) {
+        for (size_t i = 0; i < kTagCount; ++i) {
+            snap.tags[i].currentBytes += slot.bytes[i].load(std::memory_order_relaxed);
+            snap.tags[i].allocations += slot.allocations[i].load(std::memory_order_relaxed);
+            snap.tags[i].deallocations += slot.deallocations[i].load(std::memory_order_relaxed);
+        }
+    };
+    for (const auto& slot : g_slots) {
+        accumulate(slot);
+    }
+    accumulate(g_sharedSlot);
+
+    // 峰值在取快照时更新（指标采集、内存报告），两次快照之间的短暂尖峰不计入
+    for (size_t i = 0; i < kTagCount; ++i) {
+        int64_t peak = g_peakBytes[i].load(std::memory_order_relaxed);
+        while (snap.tags[i].currentBytes > peak &&
+               !g_peakBytes[i].compare_exchange_weak(peak, snap.tags[i].currentBytes, std::memory_order_relaxed)) {
+        }
+        snap.tags[i].peakBytes = std::max(peak, snap.tags[i].currentBytes);
+    }
+    return snap;
+}
+
+bool MemoryTracker::isEnabled() {
+#ifdef TIME_ARTIFACTS_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* MemoryTracker::tagName(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::Untagged: return "untagged";
+        case MemoryTag::Sessions: return "sessions";
+        case MemoryTag::Events: return "events";
+        case MemoryTag::Subscribers: return "subscribers";
+        case MemoryTag::Network: return "network";
+        case MemoryTag::World: return "world";
+        case MemoryTag::Logging: return "logging";
+        case MemoryTag::Statistics: return "statistics";
+        case MemoryTag::TextCache: return "text_cache";
+        default: return "unknown";
+    }
+}
+
+void MemoryTracker::registerMetrics() {
+    Metrics::instance().registerCollector("memory", [](Metrics::Samples& out) {
+        MemorySnapshot snap = MemoryTracker::snapshot();
+        for (size_t i = 0; i < kTagCount; ++i) {
+            std::string prefix = std::string("memory.") + tagName(static_cast<MemoryTag>(i));
+            out[prefix + ".bytes"] = static_cast<double>(snap.tags[i].currentBytes);
+            out[prefix + ".peak_bytes"] = static_cast<double>(snap.tags[i].peakBytes);
+            out[prefix + ".live_allocations"] = static_cast<double>(snap.tags[i].liveAllocations());
+        }
+        out["memory.total.bytes"] = static_cast<double>(snap.totalBytes());
+    });
+}
+
+// =================================================================
+// 全局operator new/delete替换
+// =================================================================
+
+#ifdef TIME_ARTIFACTS_MEMORY_TRACKING
+
+void* operator new(size_t size) {
+    void* p = MemoryTracker::allocate(size, t_currentTag);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return MemoryTracker::allocate(size, t_currentTag);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return MemoryTracker::allocate(size, t_currentTag);
+}
+
+void operator delete(void* ptr) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+// 对齐分配（alignas超过默认对齐的类型，如按缓存行对齐的计数分片）
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* p = MemoryTracker::allocateAligned(size, static_cast<size_t>(alignment), t_currentTag);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return MemoryTracker::allocateAligned(size, static_cast<size_t>(alignment), t_currentTag);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return MemoryTracker::allocateAligned(size, static_cast<size_t>(alignment), t_currentTag);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    MemoryTracker::deallocate(ptr);
+}
+
+#endif // TIME_ARTIFACTS_MEMORY_TRACKING
@@ -0,0 +1,189 @@
+/**
+ * MemoryTracker.h
+ *
+ * 内存记账器 - 按子系统统计堆内存占用
+ *
+ * 【文件作用】：
+ * 1. 为会话、事件、订阅表、网络缓冲、世界数据、日志等子系统分别统计堆内存
+ * 2. 通过线程局部的"当前标签"把分配归属到子系统（MemoryScope）
+ * 3. 提供带标签的STL分配器（TrackedAllocator），用于固定归属的容器
+ * 4. 为指标系统和 --memory-report 提供快照数据
+ *
+ * 【实现方式】：
+ * - 替换全局 operator new/delete（含对齐版本），在每块内存前加一个小头部记录大小和标签
+ * - 每个线程写自己的计数槽，snapshot时求和，分配热路径上线程之间不争用缓存行
+ * - 峰值在取快照时更新（指标采集和内存报告时），不是逐次分配的精确峰值
+ * - 编译选项 ENABLE_MEMORY_TRACKING 关闭时，全局替换不生效，计数保持为0
+ *
+ * 【使用示例】：
+ * ```cpp
+ * {
+ *     MemoryScope scope(MemoryTag::Sessions);
+ *     auto session = std::make_unique<Session>(...);  // 所有分配都记到 Sessions
+ * }
+ * ```
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * 内存标签
+ * 【作用】：标识一次分配属于哪个子系统
+ */
+enum class MemoryTag : uint8_t {
+    Untagged,       // 未归属（默认）
+    Sessions,       // 会话及玩家状态
+    Events,         // 事件对象和事件队列
+    Subscribers,    // 事件订阅表
+    Network,        // 网络缓冲区
+    World,          // 世界数据（场景、物品、对话）
+    Logging,        // 日志格式化
+    Statistics,     // 玩家选择统计（计数分片、基数草图）
+    TextCache,      // 已解压的世界文本（文本块LRU缓存、常驻块、预取消息缓存）
+    Count           // 标签数量（不是有效标签）
+};
+
+/**
+ * 单个标签的统计快照
+ */
+struct MemoryTagStats {
+    int64_t currentBytes = 0;   // 当前占用字节数
+    int64_t peakBytes = 0;      // 历史峰值
+    uint64_t allocations = 0;   // 累计分配次数
+    uint64_t deallocations = 0; // 累计释放次数
+
+    int64_t liveAllocations() const {
+        return static_cast<int64_t>(allocations) - static_cast<int64_t>(deallocations);
+    }
+};
+
+/**
+ * 所有标签的快照
+ */
+struct MemorySnapshot {
+    std::array<MemoryTagStats, static_cast<size_t>(MemoryTag::Count)> tags{};
+
+    const MemoryTagStats& operator[](MemoryTag tag) const {
+        return tags[static_cast<size_t>(tag)];
+    }
+
+    int64_t totalBytes() const;
+};
+
+/**
+ * 内存记账器（全局单例，纯静态接口）
+ */
+class MemoryTracker {
+public:
+    /**
+     * 按标签分配内存
+     * 【作用】：全局operator new和类专属operator new的共同入口
+     * 【返回】：失败时返回nullptr，由调用方决定是否抛出bad_alloc
+     */
+    static void* allocate(size_t size, MemoryTag tag);
+
+    /**
+     * 按标签分配对齐的内存（alignment为2的幂）
+     * 【作用】：对齐版本的全局operator new的入口，同样由deallocate释放
+     */
+    static void* allocateAligned(size_t size, size_t alignment, MemoryTag tag);
+
+    /**
+     * 释放由allocate分配的内存
+     * 【注意】：标签从内存头部读取，调用方无需提供
+     */
+    static void deallocate(void* ptr) noexcept;
+
+    /**
+     * 记录不经过operator new的内存（如直接mmap的页）
+     * 【作用】：映射时调用recordMapped，归还时调用recordUnmapped，字节数和次数都记到tag
+     * 【注意】：记账未编译进来时不记录，与其他标签一致保持为0
+     */
+    static void recordMapped(MemoryTag tag, size_t size);
+    static void recordUnmapped(MemoryTag tag, size_t size);
+
+    /**
+     * 获取/设置当前线程的默认标签
+     */
+    static MemoryTag currentTag();
+    static void setCurrentTag(MemoryTag tag);
+
+    /**
+     * 获取当前所有标签的统计快照
+     */
+    static MemorySnapshot snapshot();
+
+    /**
+     * 记账是否已编译进来
+     */
+    static bool isEnabled();
+
+    /**
+     * 标签名称（用于日志和指标）
+     */
+    static const char* tagName(MemoryTag tag);
+
+    /**
+     * 将指标注册到Metrics（memory.<tag>.bytes 等）
+     */
+    static void registerMetrics();
+};
+
+/**
+ * 标签作用域（RAII）
+ * 【作用】：作用域内当前线程的所有分配都记到指定标签，离开时恢复原标签
+ */
+class MemoryScope {
+public:
+    explicit MemoryScope(MemoryTag tag) : previous(MemoryTracker::currentTag()) {
+        MemoryTracker::setCurrentTag(tag);
+    }
+    ~MemoryScope() { MemoryTracker::setCurrentTag(previous); }
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemoryTag previous;
+};
+
+/**
+ * 带标签的STL分配器
+ * 【作用】：让容器的节点/缓冲固定记到某个标签，不受调用线程当前标签影响
+ * 【使用示例】：std::deque<T, TrackedAllocator<T, MemoryTag::Events>>
+ */
+template <typename T, MemoryTag Tag>
+class TrackedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = TrackedAllocator<U, Tag>; };
+
+    TrackedAllocator() noexcept = default;
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        void* p = MemoryTracker::allocate(n * sizeof(T), Tag);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        MemoryTracker::deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TrackedAllocator<U, Tag>&) const noexcept { return false; }
+};
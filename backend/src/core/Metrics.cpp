@@ -0,0 +1,82 @@
+/**
+ * Metrics.cpp
+ *
+ * 指标注册表实现
+ */
+
+#include "Metrics.h"
+#include <sstream>
+#include <vector>
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+std::atomic<int64_t>& Metrics::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = counters[name];
+    if (!slot) {
+        slot = std::make_unique<std::atomic<int64_t>>(0);
+    }
+    return *slot;
+}
+
+std::atomic<int64_t>& Metrics::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = gauges[name];
+    if (!slot) {
+        slot = std::make_unique<std::atomic<int64_t>>(0);
+    }
+    return *slot;
+}
+
+void Metrics::registerCollector(const std::string& id, Collector collector) {
+    std::lock_guard<std::mutex> lock(mutex);
+    collectors[id] = std::move(collector);
+}
+
+void Metrics::unregisterCollector(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    collectors.erase(id);
+}
+
+Metrics::Samples Metrics::collect() const {
+    Samples samples;
+    std::vector<Collector> pending;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& pair : counters) {
+            samples[pair.first] = static_cast<double>(pair.second->load(std::memory_order_relaxed));
+        }
+        for (const auto& pair : gauges) {
+            samples[pair.first] = static_cast<double>(pair.second->load(std::memory_order_relaxed));
+        }
+        for (const auto& pair : collectors) {
+            pending.push_back(pair.second);
+        }
+    }
+
+    // 采集函数在锁外执行，允许它们自己访问counter()/gauge()
+    for (const auto& collector : pending) {
+        collector(samples);
+    }
+
+    return samples;
+}
+
+std::string Metrics::renderText() const {
+    std::ostringstream out;
+    for (const auto& pair : collect()) {
+        double value = pair.second;
+        out << pair.first << " ";
+        if (value == static_cast<double>(static_cast<int64_t>(value))) {
+            out << static_cast<int64_t>(value);
+        } else {
+            out << value;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,85 @@
+/**
+ * Metrics.h
+ *
+ * 指标注册表 - 服务器运行指标的统一出口
+ *
+ * 【文件作用】：
+ * 1. 提供命名计数器（单调递增）和仪表（可增可减）
+ * 2. 允许各子系统注册采集函数，在导出时按需计算指标
+ * 3. 以文本格式导出所有指标，供日志、管理接口和HTTP使用
+ *
+ * 【性能说明】：
+ * - counter()/gauge() 返回的引用地址稳定，热路径应缓存引用后直接原子操作
+ * - 只有首次按名字查找和导出时需要加锁
+ *
+ * 【使用示例】：
+ * ```cpp
+ * static auto& sent = Metrics::instance().counter("network.frames_sent");
+ * sent.fetch_add(1, std::memory_order_relaxed);
+ * ```
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * 指标注册表（单例）
+ */
+class Metrics {
+public:
+    // 采集结果：指标名 -> 数值
+    using Samples = std::map<std::string, double>;
+    using Collector = std::function<void(Samples&)>;
+
+    /**
+     * 获取全局实例
+     */
+    static Metrics& instance();
+
+    /**
+     * 获取（必要时创建）命名计数器
+     * 【返回】：地址稳定的原子变量引用
+     */
+    std::atomic<int64_t>& counter(const std::string& name);
+
+    /**
+     * 获取（必要时创建）命名仪表
+     */
+    std::atomic<int64_t>& gauge(const std::string& name);
+
+    /**
+     * 注册采集函数
+     * 【参数】：id - 采集器ID，重复注册会替换原采集器
+     */
+    void registerCollector(const std::string& id, Collector collector);
+
+    /**
+     * 移除采集函数
+     */
+    void unregisterCollector(const std::string& id);
+
+    /**
+     * 采集所有指标
+     */
+    Samples collect() const;
+
+    /**
+     * 以"名称 数值"每行一条的文本格式导出
+     */
+    std::string renderText() const;
+
+private:
+    Metrics() = default;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::unique_ptr<std::atomic<int64_t>>> counters;
+    std::map<std::string, std::unique_ptr<std::atomic<int64_t>>> gauges;
+    std::map<std::string, Collector> collectors;
+};
@@ -0,0 +1,131 @@
+/**
+ * OutboundLanes.cpp
+ *
+ * 出站优先级通道实现
+ */
+
+#include "OutboundLanes.h"
+#include "Metrics.h"
+#include "utils/SimpleJson.h"
+#include <algorithm>
+
+bool OutboundLanes::push(Lane lane, Payload payload) {
+    static auto& coalescedCounter = Metrics::instance().counter("network.lanes_coalesced");
+    static auto& droppedCounter = Metrics::instance().counter("network.lanes_dropped");
+
+    if (!payload || (lane != Lane::Ambient && lane != Lane::Bulk)) {
+        return false;
+    }
+
+    if (lane == Lane::Ambient) {
+        std::deque<Payload>& queue = queues[slot(lane)];
+        for (const auto& queued : queue) {
+            if (queued == payload || *queued == *payload) {
+                coalescedCounter.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        if (queue.size() >= kAmbientLimit) {
+            takeFront(slot(lane));      // 拥塞：旧通知让位给新通知
+            droppedCounter.fetch_add(1, std::memory_order_relaxed);
+        }
+        bytes[slot(lane)] += payload->size();
+        queue.push_back(std::move(payload));
+        return true;
+    }
+
+    if (bytes[slot(lane)] + payload->size() > kBulkByteLimit) {
+        droppedCounter.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    pushBulk(std::move(payload));
+    return true;
+}
+
+// 大消息切成分片信封：{"type":"part","id":N,"index":i,"count":n,"data":"<原文片段>"}
+// 客户端按id收齐后拼接原文再解析；切分点落在UTF-8字符边界上
+void OutboundLanes::pushBulk(Payload payload) {
+    static auto& partsCounter = Metrics::instance().counter("network.bulk_parts");
+
+    std::deque<Payload>& queue = queues[slot(Lane::Bulk)];
+    size_t& queued = bytes[slot(Lane::Bulk)];
+    if (payload->size() <= kPartSize) {
+        queued += payload->size();
+        queue.push_back(std::move(payload));
+        return;
+    }
+
+    const std::string& text = *payload;
+    std::deque<std::string> pieces;
+    for (size_t begin = 0; begin < text.size();) {
+        size_t end = std::min(begin + kPartSize, text.size());
+        while (end < text.size() && end > begin && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) {
+            --end;
+        }
+        pieces.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    uint32_t id = nextPartId++;
+    for (size_t index = 0; index < pieces.size(); ++index) {
+        SimpleJson::Value part = SimpleJson::Value::object();
+        part.set("type", SimpleJson::Value("part"));
+        part.set("id", SimpleJson::Value(static_cast<double>(id)));
+        part.set("index", SimpleJson::Value(static_cast<double>(index)));
+        part.set("count", SimpleJson::Value(static_cast<double>(pieces.size())));
+        part.set("data", SimpleJson::Value(std::move(pieces[index])));
+        auto encoded = std::make_shared<const std::string>(part.dump());
+        queued += encoded->size();
+        queue.push_back(std::move(encoded));
+    }
+    partsCounter.fetch_add(static_cast<int64_t>(pieces.size()), std::memory_order_relaxed);
+}
+
+OutboundLanes::Payload OutboundLanes::takeFront(size_t index) {
+    Payload payload = std::move(queues[index].front());
+    queues[index].pop_front();
+    bytes[index] -= payload->size();
+    return payload;
+}
+
+// 差额轮转：每次轮到一个通道时加一份配额，队首消息不超过累计配额就取出
+bool OutboundLanes::next(Message& out) {
+    static const std::array<size_t, 2> quantum = {kAmbientQuantum, kBulkQuantum};
+
+    if (empty()) {
+        return false;
+    }
+    for (;;) {
+        size_t index = current;
+        if (queues[index].empty()) {
+            deficit[index] = 0;
+        } else {
+            if (!credited) {
+                deficit[index] += quantum[index];
+                credited = true;
+            }
+            size_t size = queues[index].front()->size();
+            if (size <= deficit[index]) {
+                deficit[index] -= size;
+                out.lane = index == 0 ? Lane::Ambient : Lane::Bulk;
+                out.payload = takeFront(index);
+                if (queues[index].empty()) {
+                    deficit[index] = 0;
+                }
+                return true;
+            }
+        }
+        current = 1 - current;
+        credited = false;
+    }
+}
+
+const char* OutboundLanes::laneName(Lane lane) {
+    switch (lane) {
+        case Lane::Control: return "control";
+        case Lane::Interactive: return "interactive";
+        case Lane::Ambient: return "ambient";
+        case Lane::Bulk: return "bulk";
+    }
+    return "unknown";
+}
@@ -0,0 +1,91 @@
+/**
+ * OutboundLanes.h
+ *
+ * 出站优先级通道 - 每个连接上可以延后发送的消息按优先级排队，不挡住紧急消息
+ *
+ * 【通道】（优先级从高到低）：
+ * - Control     握手、HTTP响应、关闭帧、Pong、"resumed"：直接进入发送队列
+ * - Interactive 会话响应（对话、错误、场景更新）及重连补发：直接进入发送队列
+ * - Ambient     广播通知（sendToAll）：在本类中排队，发出时才分配会话序号
+ * - Bulk        预取提示等大块数据：在本类中排队，超过kPartSize的消息切成
+ *               {"type":"part"} 分片，每片是一条独立的WebSocket消息
+ *
+ * 前两个通道严格优先：它们的消息到达时立即追加到发送队列；本类中的消息只在发送队列
+ * 清空后按加权轮转（Ambient : Bulk = 3 : 1，按字节计）取出，每次最多一个配额，
+ * 所以紧急消息前面最多只有一个分片大小的低优先级数据
+ *
+ * 【拥塞】：
+ * - Ambient：与队列中已有消息相同的新消息合并为一条；超过kAmbientLimit条时丢弃最旧的
+ * - Bulk：排队字节超过kBulkByteLimit时丢弃新消息（预取只是提示，丢弃不影响正确性）
+ *
+ * 【线程安全】：不加锁，只在服务器线程访问
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+class OutboundLanes {
+public:
+    using Payload = std::shared_ptr<const std::string>;
+
+    enum class Lane : uint8_t {
+        Control,
+        Interactive,
+        Ambient,
+        Bulk
+    };
+
+    // Bulk消息的分片大小（按消息文本计，分片信封和转义另计）
+    static constexpr size_t kPartSize = 16 * 1024;
+
+    // 每轮加权轮转中各通道的字节配额
+    static constexpr size_t kAmbientQuantum = 12 * 1024;
+    static constexpr size_t kBulkQuantum = 4 * 1024;
+
+    static constexpr size_t kAmbientLimit = 64;
+    static constexpr size_t kBulkByteLimit = 512 * 1024;
+
+    /**
+     * 排队的消息
+     */
+    struct Message {
+        Lane lane = Lane::Ambient;
+        Payload payload;
+    };
+
+    /**
+     * 加入一条消息（只接受Ambient和Bulk）
+     * 【返回】：消息被合并或丢弃时返回false
+     */
+    bool push(Lane lane, Payload payload);
+
+    /**
+     * 按加权轮转取出下一条消息
+     * 【返回】：所有通道为空时返回false
+     */
+    bool next(Message& out);
+
+    bool empty() const { return queues[0].empty() && queues[1].empty(); }
+
+    size_t queuedBytes() const { return bytes[0] + bytes[1]; }
+
+    static const char* laneName(Lane lane);
+
+private:
+    static size_t slot(Lane lane) { return lane == Lane::Bulk ? 1 : 0; }
+    void pushBulk(Payload payload);
+    Payload takeFront(size_t index);
+
+    std::array<std::deque<Payload>, 2> queues;
+    std::array<size_t, 2> bytes{};
+    std::array<size_t, 2> deficit{};
+    size_t current = 0;                 // 正在轮到的通道
+    bool credited = false;              // 本次轮到时是否已加过配额
+    uint32_t nextPartId = 1;
+};
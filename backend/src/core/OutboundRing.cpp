@@ -0,0 +1,54 @@
+/**
+ * OutboundRing.cpp
+ *
+ * 出站消息环实现
+ */
+
+#include "OutboundRing.h"
+
+OutboundRing::OutboundRing(size_t capacity, size_t limit)
+    : slots(capacity == 0 ? 1 : capacity)
+    , head(0)
+    , count(0)
+    , totalBytes(0)
+    , byteLimit(limit)
+    , newest(0) {
+}
+
+void OutboundRing::push(uint64_t sequence, Frame frame) {
+    if (count == slots.size()) {
+        evictOldest();
+    }
+    size_t frameBytes = frame ? frame->size() : 0;
+    while (count > 0 && totalBytes + frameBytes > byteLimit) {
+        evictOldest();
+    }
+
+    slots[(head + count) % slots.size()] = std::move(frame);
+    ++count;
+    totalBytes += frameBytes;
+    newest = sequence;
+}
+
+bool OutboundRing::collectSince(uint64_t lastSequence, std::vector<Frame>& out) const {
+    if (lastSequence > newest) {
+        return false;   // 客户端声称收到了还没发出的帧
+    }
+    if (lastSequence + 1 < oldestSequence()) {
+        return false;   // 缺口已被淘汰
+    }
+
+    size_t skip = static_cast<size_t>(lastSequence + 1 - oldestSequence());
+    for (size_t i = skip; i < count; ++i) {
+        out.push_back(slots[(head + i) % slots.size()]);
+    }
+    return true;
+}
+
+void OutboundRing::evictOldest() {
+    Frame& slot = slots[head];
+    totalBytes -= slot ? slot->size() : 0;
+    slot.reset();
+    head = (head + 1) % slots.size();
+    --count;
+}
@@ -0,0 +1,65 @@
+/**
+ * OutboundRing.h
+ *
+ * 出站消息环 - 保存会话最近发出的已编码帧，用于断线重连后补发
+ *
+ * 【文件作用】：
+ * 1. 按序号保存最近N条已编码的WebSocket帧（共享缓冲，不拷贝）
+ * 2. 同时限制条数和总字节数，超出时淘汰最旧的帧
+ * 3. 重连时给出"最后收到的序号"之后的所有帧；缺口超出环的范围时报告需要完整快照
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * 出站消息环类
+ * 【线程安全】：不加锁，由持有者（SessionManager）负责同步
+ */
+class OutboundRing {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+
+    /**
+     * 构造函数
+     * 【参数】：
+     *   - capacity: 最多保存的帧数
+     *   - byteLimit: 最多保存的总字节数
+     */
+    explicit OutboundRing(size_t capacity = 256, size_t byteLimit = 1024 * 1024);
+
+    /**
+     * 追加一帧（序号必须连续递增）
+     */
+    void push(uint64_t sequence, Frame frame);
+
+    /**
+     * 收集序号大于lastSequence的所有帧
+     * 【返回】：环中能补齐缺口时返回true；缺口太大（或序号无效）返回false
+     */
+    bool collectSince(uint64_t lastSequence, std::vector<Frame>& out) const;
+
+    /**
+     * 最早/最新的序号（环为空时最早序号为最新序号+1）
+     */
+    uint64_t oldestSequence() const { return newest + 1 - count; }
+    uint64_t newestSequence() const { return newest; }
+
+    size_t size() const { return count; }
+    size_t bytes() const { return totalBytes; }
+
+private:
+    void evictOldest();
+
+    std::vector<Frame> slots;   // 固定大小的环形缓冲
+    size_t head;                // 最旧帧所在的位置
+    size_t count;               // 当前帧数
+    size_t totalBytes;
+    size_t byteLimit;
+    uint64_t newest;            // 最新帧的序号（0表示还没有发过）
+};
@@ -0,0 +1,288 @@
+/**
+ * PrefetchPlanner.cpp
+ *
+ * 预取规划实现
+ */
+
+#include "PrefetchPlanner.h"
+#include "WorldData.h"
+#include "ContentStore.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "utils/SimpleJson.h"
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+namespace {
+
+    using SimpleJson::Value;
+
+    Value stringArray(const std::vector<std::string>& strings) {
+        Value array = Value::array();
+        for (const auto& text : strings) {
+            array.push(Value(text));
+        }
+        return array;
+    }
+
+    /**
+     * 写入文本字段和它的内容哈希（客户端据此把预取的文本存入内容缓存），哈希同时记入hashes
+     */
+    void setText(const WorldData& world, Value& object, const std::string& key, TextId text,
+                 std::vector<std::string>& hashes) {
+        object.set(key, Value(world.text(text)));
+        if (const std::string* hash = ContentStore::instance().hashFor(text)) {
+            object.set(key + "Ref", Value(*hash));
+            hashes.push_back(*hash);
+        }
+    }
+
+    Value sceneValue(const WorldData& world, const Location& location, std::vector<std::string>& hashes) {
+        Value scene = Value::object();
+        scene.set("location", Value(location.id));
+        scene.set("name", Value(location.name));
+        setText(world, scene, "description", location.description(), hashes);
+        scene.set("musicTrack", Value(location.musicTrack));
+        scene.set("ambientEffects", stringArray(location.ambientEffects));
+        return scene;
+    }
+
+    Value dialogueValue(const WorldData& world, const DialogueNode& node, std::vector<std::string>& hashes) {
+        Value options = Value::array();
+        for (const auto& option : node.options) {
+            Value entry = Value::object();
+            entry.set("id", Value(option.id));
+            setText(world, entry, "text", option.text, hashes);
+            options.push(std::move(entry));
+        }
+        Value dialogue = Value::object();
+        dialogue.set("dialogueId", Value(node.id));
+        dialogue.set("speaker", Value(node.speaker));
+        setText(world, dialogue, "text", node.text, hashes);
+        dialogue.set("options", std::move(options));
+        return dialogue;
+    }
+
+    /**
+     * 把对话节点及其直接后续节点加入集合（对话图上走一步）
+     */
+    void addDialogueWithFollowUps(const WorldData& world, const std::string& dialogueId,
+                                  std::set<std::string>& dialogueIds) {
+        const DialogueNode* node = world.findDialogue(dialogueId);
+        if (!node) {
+            return;
+        }
+        dialogueIds.insert(node->id);
+        for (const auto& option : node->options) {
+            if (!option.nextDialogue.empty() && world.findDialogue(option.nextDialogue)) {
+                dialogueIds.insert(option.nextDialogue);
+            }
+        }
+    }
+
+    // 默认的消息缓存容量
+    constexpr size_t kDefaultCacheKb = 1024;
+
+    std::shared_ptr<const PrefetchPlanner::PlannedHint> encodeHint(Value data, std::vector<std::string> hashes) {
+        Value message = Value::object();
+        message.set("type", Value("prefetch"));
+        message.set("data", std::move(data));
+        auto hint = std::make_shared<PrefetchPlanner::PlannedHint>();
+        hint->message = std::make_shared<const std::string>(message.dump());
+        hint->contentHashes = std::move(hashes);
+        return hint;
+    }
+
+    /**
+     * 场景的预取消息：出口图上走一步（相邻场景），加上当前和相邻场景角色的开场对话
+     */
+    std::shared_ptr<const PrefetchPlanner::PlannedHint> encodeLocation(const WorldData& world,
+                                                                       const std::string& locationId) {
+        const Location* location = world.findLocation(locationId);
+        if (!location) {
+            return nullptr;
+        }
+
+        // 出口指向未定义的场景时跳过
+        Value exits = Value::object();
+        std::vector<const Location*> neighbours;
+        std::set<std::string> dialogueIds;
+        std::set<std::string> seenScenes;
+        for (const auto& exit : location->exits) {
+            const Location* neighbour = world.findLocation(exit.second);
+            if (!neighbour) {
+                continue;
+            }
+            exits.set(exit.first, Value(neighbour->id));
+            if (!seenScenes.insert(neighbour->id).second) {
+                continue;
+            }
+            neighbours.push_back(neighbour);
+            for (const auto& character : neighbour->characters) {
+                addDialogueWithFollowUps(world, world.startDialogueFor(character), dialogueIds);
+            }
+        }
+
+        // 当前场景的角色最可能马上被搭话
+        for (const auto& character : location->characters) {
+            addDialogueWithFollowUps(world, world.startDialogueFor(character), dialogueIds);
+        }
+
+        // 没有内容时不读取任何文本
+        if (neighbours.empty() && dialogueIds.empty()) {
+            return nullptr;
+        }
+
+        Value scenes = Value::array();
+        std::vector<std::string> hashes;
+        std::set<std::string> audio;
+        for (const Location* neighbour : neighbours) {
+            scenes.push(sceneValue(world, *neighbour, hashes));
+            if (!neighbour->musicTrack.empty()) {
+                audio.insert(neighbour->musicTrack);
+            }
+            audio.insert(neighbour->ambientEffects.begin(), neighbour->ambientEffects.end());
+        }
+        Value dialogues = Value::array();
+        for (const auto& dialogueId : dialogueIds) {
+            dialogues.push(dialogueValue(world, *world.findDialogue(dialogueId), hashes));
+        }
+        Value data = Value::object();
+        data.set("location", Value(location->id));
+        data.set("exits", std::move(exits));
+        data.set("scenes", std::move(scenes));
+        data.set("dialogues", std::move(dialogues));
+        data.set("audio", stringArray(std::vector<std::string>(audio.begin(), audio.end())));
+        return encodeHint(std::move(data), std::move(hashes));
+    }
+
+    /**
+     * 对话节点的预取消息：选项可能进入的后续节点，以及它们的下一步
+     */
+    std::shared_ptr<const PrefetchPlanner::PlannedHint> encodeDialogue(const WorldData& world,
+                                                                       const std::string& dialogueId) {
+        const DialogueNode* node = world.findDialogue(dialogueId);
+        if (!node) {
+            return nullptr;
+        }
+        std::set<std::string> dialogueIds;
+        for (const auto& option : node->options) {
+            if (!option.nextDialogue.empty()) {
+                addDialogueWithFollowUps(world, option.nextDialogue, dialogueIds);
+            }
+        }
+        dialogueIds.erase(node->id);
+        if (dialogueIds.empty()) {
+            return nullptr;
+        }
+
+        Value dialogues = Value::array();
+        std::vector<std::string> hashes;
+        for (const auto& id : dialogueIds) {
+            dialogues.push(dialogueValue(world, *world.findDialogue(id), hashes));
+        }
+        Value data = Value::object();
+        data.set("dialogue", Value(node->id));
+        data.set("dialogues", std::move(dialogues));
+        return encodeHint(std::move(data), std::move(hashes));
+    }
+
+} // namespace
+
+PrefetchPlanner& PrefetchPlanner::instance() {
+    static PrefetchPlanner planner;
+    return planner;
+}
+
+void PrefetchPlanner::initialize(const WorldData& worldData) {
+    size_t cacheBytes = kDefaultCacheKb * 1024;
+    if (const char* env = std::getenv("TIME_ARTIFACTS_PREFETCH_KB")) {
+        cacheBytes = static_cast<size_t>(std::strtoull(env, nullptr, 10)) * 1024;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    world = &worldData;
+    entries.clear();
+    order.clear();
+    cachedBytes = 0;
+    capacity = cacheBytes;
+    std::cout << "[PrefetchPlanner] 预取消息按需生成，缓存容量 " << capacity / 1024 << " KB" << std::endl;
+}
+
+std::shared_ptr<const PrefetchPlanner::PlannedHint> PrefetchPlanner::hintForLocation(const std::string& locationId) {
+    return lookup("L:" + locationId, locationId, encodeLocation);
+}
+
+std::shared_ptr<const PrefetchPlanner::PlannedHint> PrefetchPlanner::hintForDialogue(const std::string& dialogueId) {
+    return lookup("D:" + dialogueId, dialogueId, encodeDialogue);
+}
+
+std::shared_ptr<const PrefetchPlanner::PlannedHint> PrefetchPlanner::lookup(const std::string& key,
+                                                                            const std::string& id,
+                                                                            Encoder encode) {
+    const WorldData* current = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            ++hits;
+            order.splice(order.begin(), order, it->second.position);
+            return it->second.hint;
+        }
+        current = world;
+    }
+    if (!current) {
+        return nullptr;
+    }
+
+    // 在锁外读取文本并编码（可能要解压文本块或换入区域）
+    std::shared_ptr<const PlannedHint> hint;
+    size_t bytes = 0;
+    {
+        MemoryScope memoryScope(MemoryTag::TextCache);
+        hint = encode(*current, id);
+        if (!hint) {
+            return nullptr;
+        }
+        bytes = hint->message->size();
+        for (const auto& hash : hint->contentHashes) {
+            bytes += hash.size();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++encoded;
+    if (world != current || bytes > capacity) {
+        return hint;    // 世界已更换，或单条消息比整个缓存还大：只给这次请求用
+    }
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        return it->second.hint;     // 另一个线程同时编码了同一条消息
+    }
+    MemoryScope memoryScope(MemoryTag::TextCache);
+    order.push_front(key);
+    entries[key] = {hint, bytes, order.begin()};
+    cachedBytes += bytes;
+    while (cachedBytes > capacity) {
+        auto victim = entries.find(order.back());
+        cachedBytes -= victim->second.bytes;
+        entries.erase(victim);
+        order.pop_back();
+        ++evictions;
+    }
+    return hint;
+}
+
+void PrefetchPlanner::registerMetrics() {
+    Metrics::instance().registerCollector("prefetch_planner", [this](Metrics::Samples& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        out["prefetch.cached_hints"] = static_cast<double>(entries.size());
+        out["prefetch.cached_bytes"] = static_cast<double>(cachedBytes);
+        out["prefetch.cache_capacity_bytes"] = static_cast<double>(capacity);
+        out["prefetch.hits"] = static_cast<double>(hits);
+        out["prefetch.encoded"] = static_cast<double>(encoded);
+        out["prefetch.evictions"] = static_cast<double>(evictions);
+    });
+}
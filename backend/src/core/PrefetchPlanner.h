@@ -0,0 +1,106 @@
+/**
+ * PrefetchPlanner.h
+ *
+ * 预取规划 - 根据场景出口图和对话图，预测玩家接下来需要的内容
+ *
+ * 【文件作用】：
+ * 1. 为场景生成prefetch消息：相邻场景的文字/音乐/环境音效 + 在场角色和相邻场景角色的开场对话
+ * 2. 为对话节点生成prefetch消息：选项可能进入的后续节点
+ * 3. 服务器在连接空闲时把这些消息推给客户端（低优先级、不占用会话序号），
+ *    玩家移动时客户端直接从缓存渲染新场景，不用等服务器往返
+ *
+ * 【消息格式】：
+ *   {"type":"prefetch","data":{"location":"...","exits":{"north":"old_street"},
+ *    "scenes":[{"location","name","description","musicTrack","ambientEffects"}],
+ *    "dialogues":[{"dialogueId","speaker","text","options":[{"id","text"}]}],
+ *    "audio":["old_street_theme", ...]}}
+ *
+ * 【说明】：消息在第一次被请求时从TextStore读取文本并编码，放入按字节数限制的LRU缓存，
+ *   之后请求同一场景/节点的会话共享同一份只读文本（不在启动时为整个世界编码，
+ *   否则相邻场景的解压文本按出口数成倍常驻内存，抵消了文本压缩和区域分页）；
+ *   每条消息还记录它携带的文本的内容哈希，会话排队一条提示时把这些哈希记为客户端已有，
+ *   之后的响应只发哈希
+ *
+ * 【配置】：环境变量 TIME_ARTIFACTS_PREFETCH_KB 设置消息缓存容量（默认1024）；
+ *   超出时淘汰最久未用的消息，之后再请求时重新编码
+ *
+ * 【线程安全】：查询可以在任意线程进行，缓存由一把锁保护，编码在锁外进行
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorldData;
+
+/**
+ * 预取规划类（全局单例）
+ */
+class PrefetchPlanner {
+public:
+    using Hint = std::shared_ptr<const std::string>;
+
+    /**
+     * 编码好的预取消息
+     */
+    struct PlannedHint {
+        Hint message;                               // 编码好的prefetch消息
+        std::vector<std::string> contentHashes;     // 消息中带原文的文本的内容哈希
+    };
+
+    static PrefetchPlanner& instance();
+
+    PrefetchPlanner(const PrefetchPlanner&) = delete;
+    PrefetchPlanner& operator=(const PrefetchPlanner&) = delete;
+
+    /**
+     * 设置世界数据并清空消息缓存（启动时调用；不编码任何消息）
+     */
+    void initialize(const WorldData& world);
+
+    /**
+     * 玩家位于某个场景时的预取消息
+     * 【返回】：场景不存在或没有可预取的内容时返回nullptr
+     */
+    std::shared_ptr<const PlannedHint> hintForLocation(const std::string& locationId);
+
+    /**
+     * 玩家处于某个对话节点时的预取消息
+     * 【返回】：节点没有后续节点时返回nullptr
+     */
+    std::shared_ptr<const PlannedHint> hintForDialogue(const std::string& dialogueId);
+
+    /**
+     * 注册运行指标
+     */
+    void registerMetrics();
+
+private:
+    PrefetchPlanner() = default;
+
+    using Encoder = std::shared_ptr<const PlannedHint> (*)(const WorldData& world, const std::string& id);
+
+    std::shared_ptr<const PlannedHint> lookup(const std::string& key, const std::string& id, Encoder encode);
+
+    struct Slot {
+        std::shared_ptr<const PlannedHint> hint;
+        size_t bytes = 0;
+        std::list<std::string>::iterator position;
+    };
+
+    const WorldData* world = nullptr;
+    std::mutex mutex;
+    std::list<std::string> order;                       // 前端为最近使用
+    std::unordered_map<std::string, Slot> entries;      // "L:场景ID" / "D:对话节点ID" -> 消息
+    size_t cachedBytes = 0;
+    size_t capacity = 0;
+    uint64_t hits = 0;
+    uint64_t encoded = 0;
+    uint64_t evictions = 0;
+};
@@ -0,0 +1,185 @@
+/**
+ * RegionPager.cpp
+ *
+ * 区域分页实现
+ */
+
+#include "RegionPager.h"
+#include "Metrics.h"
+#include "MemoryTracker.h"
+#include "WorldData.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+RegionPager& RegionPager::instance() {
+    static RegionPager pager;
+    return pager;
+}
+
+RegionPager::RegionPager()
+    : texts(nullptr), regionCount(0), idleMillis(60 * 1000), lastSweep(std::chrono::steady_clock::now()) {
+}
+
+bool RegionPager::initialize(const WorldData& world) {
+    MemoryScope memoryScope(MemoryTag::World);
+
+    const char* packPath = std::getenv("TIME_ARTIFACTS_WORLD_PACK");
+    if (!world.getTexts().attachPack(packPath ? packPath : "")) {
+        std::cerr << "[RegionPager] 包文件不可用，世界文本保留在内存中" << std::endl;
+        return false;
+    }
+    if (const char* env = std::getenv("TIME_ARTIFACTS_REGION_IDLE_SEC")) {
+        idleMillis = static_cast<int64_t>(std::strtoll(env, nullptr, 10)) * 1000;
+    }
+
+    texts = &world.getTexts();
+    regionCount = world.getRegionCount();
+    regions.reset(new RegionState[regionCount]);
+    int64_t now = nowMillis();
+    for (uint32_t i = 0; i < regionCount; ++i) {
+        regions[i].idleSince.store(now);
+    }
+
+    neighbourhoods.clear();
+    for (const auto& entry : world.getLocations()) {
+        const Location& location = entry.second;
+        std::vector<uint32_t> nearby{location.region};
+        for (const auto& exit : location.exits) {
+            if (const Location* destination = world.findLocation(exit.second)) {
+                nearby.push_back(destination->region);
+            }
+        }
+        std::sort(nearby.begin(), nearby.end());
+        nearby.erase(std::unique(nearby.begin(), nearby.end()), nearby.end());
+        neighbourhoods[location.id] = std::move(nearby);
+    }
+
+    std::cout << "[RegionPager] " << regionCount << " 个区域，包文件 "
+              << texts->stats().packedBytes / 1024 << " KB，空闲 " << idleMillis / 1000 << " 秒后换出" << std::endl;
+    return true;
+}
+
+void RegionPager::enter(std::vector<uint32_t>& held, const std::string& locationId) {
+    if (!texts) {
+        return;
+    }
+    auto it = neighbourhoods.find(locationId);
+    static const std::vector<uint32_t> none;
+    const std::vector<uint32_t>& wanted = it != neighbourhoods.end() ? it->second : none;
+
+    // 先持有新区域再释放旧区域，两个邻域重叠的部分引用计数不会短暂降到0
+    for (uint32_t region : wanted) {
+        if (!std::binary_search(held.begin(), held.end(), region)) {
+            acquire(region);
+        }
+    }
+    for (uint32_t region : held) {
+        if (!std::binary_search(wanted.begin(), wanted.end(), region)) {
+            release(region);
+        }
+    }
+    held = wanted;
+}
+
+void RegionPager::releaseAll(std::vector<uint32_t>& held) {
+    if (!texts) {
+        return;
+    }
+    for (uint32_t region : held) {
+        release(region);
+    }
+    held.clear();
+}
+
+void RegionPager::acquire(uint32_t region) {
+    RegionState& state = regions[region];
+    state.references.fetch_add(1);
+    if (state.resident.load()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pageMutex);
+    if (state.resident.load()) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = texts->pageInRegion(region);
+    uint64_t micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    state.resident.store(true);
+
+    pageIns.fetch_add(1, std::memory_order_relaxed);
+    pageInMicros.fetch_add(micros, std::memory_order_relaxed);
+    pageInBytes.fetch_add(bytes, std::memory_order_relaxed);
+    uint64_t previous = pageInMaxMicros.load(std::memory_order_relaxed);
+    while (micros > previous && !pageInMaxMicros.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void RegionPager::release(uint32_t region) {
+    RegionState& state = regions[region];
+    if (state.references.fetch_sub(1) == 1) {
+        state.idleSince.store(nowMillis());
+    }
+}
+
+size_t RegionPager::sweepIfDue(std::chrono::steady_clock::duration interval) {
+    auto now = std::chrono::steady_clock::now();
+    if (!texts || now - lastSweep < interval) {
+        return 0;
+    }
+    lastSweep = now;
+
+    int64_t cutoff = nowMillis() - idleMillis;
+    size_t released = 0;
+    std::lock_guard<std::mutex> lock(pageMutex);
+    for (uint32_t i = 0; i < regionCount; ++i) {
+        RegionState& state = regions[i];
+        if (!state.resident.load() || state.references.load() != 0 || state.idleSince.load() > cutoff) {
+            continue;
+        }
+        // 先标记为不在内存中再复查引用：并发的acquire要么在这里看到引用，要么看到resident=false后
+        // 在pageMutex上等待本次换出完成再换入
+        state.resident.store(false);
+        if (state.references.load() != 0) {
+            state.resident.store(true);
+            continue;
+        }
+        texts->pageOutRegion(i);
+        ++released;
+    }
+    if (released > 0) {
+        pageOuts.fetch_add(released, std::memory_order_relaxed);
+        std::cout << "[RegionPager] 换出 " << released << " 个空闲区域" << std::endl;
+    }
+    return released;
+}
+
+int64_t RegionPager::nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RegionPager::registerMetrics() {
+    Metrics::instance().registerCollector("region_pager", [this](Metrics::Samples& out) {
+        if (!texts) {
+            return;
+        }
+        size_t resident = 0;
+        size_t referenced = 0;
+        for (uint32_t i = 0; i < regionCount; ++i) {
+            resident += regions[i].resident.load() ? 1 : 0;
+            referenced += regions[i].references.load() > 0 ? 1 : 0;
+        }
+        uint64_t count = pageIns.load(std::memory_order_relaxed);
+        out["regions.count"] = static_cast<double>(regionCount);
+        out["regions.resident"] = static_cast<double>(resident);
+        out["regions.referenced"] = static_cast<double>(referenced);
+        out["regions.page_ins"] = static_cast<double>(count);
+        out["regions.page_outs"] = static_cast<double>(pageOuts.load(std::memory_order_relaxed));
+        out["regions.page_in_bytes"] = static_cast<double>(pageInBytes.load(std::memory_order_relaxed));
+        out["regions.page_in_us_avg"] = count ? static_cast<double>(pageInMicros.load(std::memory_order_relaxed)) / count : 0.0;
+        out["regions.page_in_us_max"] = static_cast<double>(pageInMaxMicros.load(std::memory_order_relaxed));
+    });
+}
@@ -0,0 +1,107 @@
+/**
+ * RegionPager.h
+ *
+ * 区域分页 - 世界文本按区域放在mmap的包文件中，玩家接近时换入，长时间无人时换出
+ *
+ * 【文件作用】：
+ * 1. 启动时把世界文本的压缩块写入包文件并映射（TextStore::attachPack），堆上不再保留压缩数据
+ * 2. 每个区域有引用计数：会话进入场景时持有"所在区域 + 出口通往的区域"，
+ *    离开时释放不再需要的区域；引用计数从0变为1且区域不在内存中时同步换入并记录耗时
+ * 3. 主循环定期检查：引用计数为0且空闲超过设定时间的区域用madvise(MADV_DONTNEED)换出，
+ *    同时丢弃该区域已解压的缓存块
+ *
+ * 【数据流】：
+ *   会话线程 enter()      → 持有新邻域的区域（必要时换入），释放旧邻域多余的区域
+ *   主循环   sweepIfDue() → 换出空闲区域
+ *
+ * 【配置】：
+ *   TIME_ARTIFACTS_WORLD_PACK       包文件路径（默认写到临时目录，映射后删除）
+ *   TIME_ARTIFACTS_REGION_IDLE_SEC  区域无人后多久换出（秒，默认60）
+ *
+ * 【说明】：换出只是把页交还给内核，之后任何读取（例如预取、规则引用的文本）仍然正确，
+ *   只是需要重新从文件读入；引用计数只决定什么时候换出，不保护数据
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorldData;
+class TextStore;
+
+/**
+ * 区域分页类（全局单例）
+ */
+class RegionPager {
+public:
+    static RegionPager& instance();
+
+    RegionPager(const RegionPager&) = delete;
+    RegionPager& operator=(const RegionPager&) = delete;
+
+    /**
+     * 按世界数据建立区域邻域并映射包文件（启动时调用一次）
+     * 【返回】：包文件不可用时返回false，此时其余接口都不做任何事
+     */
+    bool initialize(const WorldData& world);
+
+    /**
+     * 会话进入场景（任意线程）
+     * 【参数】：held - 会话当前持有的区域（按区域号排序），调用后更新为新场景的邻域
+     */
+    void enter(std::vector<uint32_t>& held, const std::string& locationId);
+
+    /**
+     * 释放会话持有的全部区域（会话结束时调用）
+     */
+    void releaseAll(std::vector<uint32_t>& held);
+
+    /**
+     * 距上次检查超过间隔时换出空闲区域（主循环每帧调用）
+     * 【返回】：本次换出的区域数
+     */
+    size_t sweepIfDue(std::chrono::steady_clock::duration interval = std::chrono::seconds(1));
+
+    /**
+     * 注册运行指标
+     */
+    void registerMetrics();
+
+private:
+    RegionPager();
+
+    /**
+     * 单个区域的状态
+     */
+    struct RegionState {
+        std::atomic<int32_t> references{0};
+        std::atomic<bool> resident{false};
+        std::atomic<int64_t> idleSince{0};      // 引用计数降为0的时刻（steady_clock毫秒）
+    };
+
+    void acquire(uint32_t region);
+    void release(uint32_t region);
+    static int64_t nowMillis();
+
+    TextStore* texts;
+    std::unique_ptr<RegionState[]> regions;
+    uint32_t regionCount;
+    std::unordered_map<std::string, std::vector<uint32_t>> neighbourhoods;  // 场景 -> 所在区域及出口通往的区域（已排序）
+    int64_t idleMillis;
+
+    std::mutex pageMutex;                       // 串行化换入和换出
+    std::chrono::steady_clock::time_point lastSweep;
+
+    std::atomic<uint64_t> pageIns{0};
+    std::atomic<uint64_t> pageOuts{0};
+    std::atomic<uint64_t> pageInMicros{0};      // 换入总耗时
+    std::atomic<uint64_t> pageInMaxMicros{0};
+    std::atomic<uint64_t> pageInBytes{0};
+};
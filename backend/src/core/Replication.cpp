@@ -0,0 +1,716 @@
+/**
+ * Replication.cpp
+ *
+ * 热备复制实现
+ */
+
+#include "Replication.h"
+#include "Metrics.h"
+#include "SessionManager.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // 握手：备用进程发送 魔数 + 版本 + 流ID + 起始偏移；主服务器回复 魔数 + 状态 + 流ID + 起始偏移
+    const char kMagic[4] = {'T', 'A', 'R', 'P'};
+    constexpr uint8_t kVersion = 1;
+    constexpr size_t kHandshakeSize = 4 + 1 + 8 + 8;
+
+    enum HandshakeStatus : uint8_t {
+        kStatusOk = 0,
+        kStatusUnavailable = 1,     // 请求的偏移已不在保留范围内
+        kStatusMismatch = 2         // 备用进程应用的是另一个主服务器的日志
+    };
+
+    // 记录：类型(1) + 正文长度(4) + [字段长度(4) + 字段]×2
+    constexpr size_t kRecordHeaderSize = 5;
+
+    constexpr auto kBatchInterval = std::chrono::milliseconds(5);
+    constexpr auto kAckInterval = std::chrono::milliseconds(20);
+    constexpr auto kConnectRetry = std::chrono::milliseconds(200);
+    constexpr int kHandshakeTimeoutMs = 1000;
+
+    void putU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void putU64(std::string& out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    uint32_t getU32(const char* data) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t getU64(const char* data) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    std::string encodeHandshake(uint8_t versionOrStatus, uint64_t streamId, uint64_t offset) {
+        std::string out(kMagic, sizeof(kMagic));
+        out.push_back(static_cast<char>(versionOrStatus));
+        putU64(out, streamId);
+        putU64(out, offset);
+        return out;
+    }
+
+    size_t envSize(const char* name, size_t fallback) {
+        const char* value = std::getenv(name);
+        if (!value || !*value) {
+            return fallback;
+        }
+        long long parsed = std::atoll(value);
+        return parsed > 0 ? static_cast<size_t>(parsed) : fallback;
+    }
+
+#ifndef _WIN32
+
+    /**
+     * 打开端点：含'/'为Unix套接字路径，否则为 [主机:]端口（主机默认127.0.0.1，只支持IPv4地址）
+     * 【返回】：套接字；失败时返回-1并记录日志
+     */
+    int openEndpoint(const std::string& endpoint, bool listening) {
+        bool isUnix = endpoint.find('/') != std::string::npos;
+        int fd = ::socket(isUnix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+
+        sockaddr_storage storage{};
+        socklen_t length = 0;
+        if (isUnix) {
+            auto* address = reinterpret_cast<sockaddr_un*>(&storage);
+            if (endpoint.size() >= sizeof(address->sun_path)) {
+                std::cerr << "[Replication] 套接字路径过长: " << endpoint << std::endl;
+                ::close(fd);
+                return -1;
+            }
+            address->sun_family = AF_UNIX;
+            std::memcpy(address->sun_path, endpoint.c_str(), endpoint.size() + 1);
+            length = sizeof(sockaddr_un);
+            if (listening) {
+                ::unlink(endpoint.c_str());
+            }
+        } else {
+            size_t colon = endpoint.rfind(':');
+            std::string host = colon == std::string::npos ? "127.0.0.1" : endpoint.substr(0, colon);
+            int port = std::atoi(endpoint.c_str() + (colon == std::string::npos ? 0 : colon + 1));
+            if (host.empty() || host == "localhost") {
+                host = "127.0.0.1";
+            }
+            auto* address = reinterpret_cast<sockaddr_in*>(&storage);
+            address->sin_family = AF_INET;
+            address->sin_port = htons(static_cast<uint16_t>(port));
+            if (port <= 0 || port > 65535 || ::inet_pton(AF_INET, host.c_str(), &address->sin_addr) != 1) {
+                std::cerr << "[Replication] 无效的端点: " << endpoint << std::endl;
+                ::close(fd);
+                return -1;
+            }
+            length = sizeof(sockaddr_in);
+            if (listening) {
+                int enable = 1;
+                ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            }
+        }
+
+        sockaddr* address = reinterpret_cast<sockaddr*>(&storage);
+        bool ok = listening ? (::bind(fd, address, length) == 0 && ::listen(fd, 4) == 0)
+                            : ::connect(fd, address, length) == 0;
+        if (!ok) {
+            if (listening) {
+                std::cerr << "[Replication] 无法监听 " << endpoint << ": " << std::strerror(errno) << std::endl;
+            }
+            ::close(fd);
+            return -1;
+        }
+        if (listening && isUnix) {
+            ::chmod(endpoint.c_str(), 0600);
+        }
+        return fd;
+    }
+
+    bool readExact(int fd, char* buffer, size_t length, int timeoutMs) {
+        size_t got = 0;
+        while (got < length) {
+            pollfd pfd{fd, POLLIN, 0};
+            if (::poll(&pfd, 1, timeoutMs) <= 0) {
+                return false;
+            }
+            ssize_t received = ::recv(fd, buffer + got, length - got, 0);
+            if (received <= 0) {
+                if (received < 0 && (errno == EINTR || errno == EAGAIN)) {
+                    continue;
+                }
+                return false;
+            }
+            got += static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    bool writeAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            sent += static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+#endif
+
+} // namespace
+
+// ==================== ReplicationPrimary ====================
+
+ReplicationPrimary& ReplicationPrimary::instance() {
+    static ReplicationPrimary primary;
+    return primary;
+}
+
+ReplicationPrimary::ReplicationPrimary()
+    : retainLimit(envSize("TIME_ARTIFACTS_REPLICATION_RETAIN_MB", 64) * 1024 * 1024),
+      streamId(std::random_device{}() | (static_cast<uint64_t>(std::random_device{}()) << 32) | 1) {
+}
+
+ReplicationPrimary::~ReplicationPrimary() {
+    stop();
+}
+
+void ReplicationPrimary::recordCreate(const std::string& sessionId, const std::string& resumeToken) {
+    if (isEnabled()) {
+        append('C', sessionId, resumeToken);
+    }
+}
+
+void ReplicationPrimary::recordMessage(const std::string& sessionId, const std::string& rawMessage) {
+    if (isEnabled()) {
+        append('M', sessionId, rawMessage);
+    }
+}
+
+void ReplicationPrimary::recordOutbound(const std::string& sessionId, const std::string& message) {
+    if (isEnabled()) {
+        append('O', sessionId, message);
+    }
+}
+
+void ReplicationPrimary::recordRemove(const std::string& sessionId) {
+    if (isEnabled()) {
+        append('X', sessionId, "");
+    }
+}
+
+void ReplicationPrimary::append(char type, const std::string& first, const std::string& second) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(type);
+    putU32(pending, static_cast<uint32_t>(8 + first.size() + second.size()));
+    putU32(pending, static_cast<uint32_t>(first.size()));
+    pending += first;
+    putU32(pending, static_cast<uint32_t>(second.size()));
+    pending += second;
+}
+
+#ifndef _WIN32
+
+bool ReplicationPrimary::start(const std::string& endpoint) {
+    if (running.load()) {
+        return true;
+    }
+    listenFd = openEndpoint(endpoint, true);
+    if (listenFd < 0) {
+        return false;
+    }
+    unixPath = endpoint.find('/') != std::string::npos ? endpoint : "";
+
+    Metrics::instance().registerCollector("replication", [this](Metrics::Samples& out) {
+        uint64_t produced;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            produced = sealedOffset + pending.size();
+        }
+        out["replication.lag_bytes"] = static_cast<double>(produced - ackedOffset.load(std::memory_order_relaxed));
+        out["replication.lag_ms"] = static_cast<double>(lagMicros.load(std::memory_order_relaxed)) / 1000.0;
+    });
+
+    enabled.store(true);
+    running.store(true);
+    thread = std::thread([this]() { run(); });
+    std::cout << "[Replication] 主服务器: 等待备用进程连接 " << endpoint << "（保留上限 "
+              << retainLimit / (1024 * 1024) << " MB）" << std::endl;
+    return true;
+}
+
+void ReplicationPrimary::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    // 最后一批变更尽量发给备用进程
+    sealPending();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (standbyFd >= 0 && cursor < sealedOffset && std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{standbyFd, POLLOUT, 0};
+        ::poll(&pfd, 1, 50);
+        if (!shipBatches()) {
+            break;
+        }
+    }
+    if (standbyFd >= 0) {
+        ::close(standbyFd);
+        standbyFd = -1;
+    }
+    enabled.store(false);
+    Metrics::instance().unregisterCollector("replication");
+    ::close(listenFd);
+    listenFd = -1;
+    if (!unixPath.empty()) {
+        ::unlink(unixPath.c_str());
+    }
+}
+
+void ReplicationPrimary::run() {
+    static auto& connectedGauge = Metrics::instance().gauge("replication.standby_connected");
+
+    while (running.load()) {
+        pollfd fds[2];
+        nfds_t count = 0;
+        fds[count++] = {listenFd, POLLIN, 0};
+        if (standbyFd >= 0) {
+            fds[count++] = {standbyFd, static_cast<short>(cursor < sealedOffset ? POLLIN | POLLOUT : POLLIN), 0};
+        }
+        ::poll(fds, count, static_cast<int>(kBatchInterval.count()));
+
+        if (fds[0].revents & POLLIN) {
+            acceptStandby();
+        }
+        sealPending();
+        if (standbyFd >= 0 && !readAcks()) {
+            dropStandby("连接已断开");
+        }
+        if (standbyFd >= 0 && !shipBatches()) {
+            dropStandby("发送失败");
+        }
+        connectedGauge.store(standbyFd >= 0 ? 1 : 0, std::memory_order_relaxed);
+
+        // 复制延迟：最早一个未被确认的批次产生至今的时间
+        uint64_t acked = ackedOffset.load(std::memory_order_relaxed);
+        auto oldest = std::upper_bound(retained.begin(), retained.end(), acked,
+                                       [](uint64_t offset, const Batch& batch) {
+                                           return offset < batch.offset + batch.bytes.size();
+                                       });
+        lagMicros.store(oldest == retained.end() ? 0
+                        : std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - oldest->producedAt).count(),
+                        std::memory_order_relaxed);
+    }
+}
+
+// 把待发送缓冲切成一个批次，并按保留上限淘汰最早的批次
+void ReplicationPrimary::sealPending() {
+    Batch batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) {
+            return;
+        }
+        batch.bytes.swap(pending);
+        batch.offset = sealedOffset;
+        sealedOffset += batch.bytes.size();
+    }
+    batch.producedAt = std::chrono::steady_clock::now();
+    retainedBytes += batch.bytes.size();
+    retained.push_back(std::move(batch));
+
+    while (retainedBytes > retainLimit && retained.size() > 1) {
+        const Batch& front = retained.front();
+        if (standbyFd >= 0 && front.offset + front.bytes.size() > cursor) {
+            dropStandby("落后超过保留上限");
+        }
+        retainedBytes -= front.bytes.size();
+        retained.pop_front();
+    }
+}
+
+bool ReplicationPrimary::acceptStandby() {
+    int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    if (standbyFd >= 0) {
+        std::cerr << "[Replication] 已有备用进程连接，拒绝新的连接" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    char hello[kHandshakeSize];
+    if (!readExact(fd, hello, sizeof(hello), kHandshakeTimeoutMs) ||
+        std::memcmp(hello, kMagic, sizeof(kMagic)) != 0 || static_cast<uint8_t>(hello[4]) != kVersion) {
+        std::cerr << "[Replication] 备用进程握手失败" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    uint64_t requestedStream = getU64(hello + 5);
+    uint64_t requestedOffset = getU64(hello + 13);
+
+    sealPending();
+    uint64_t base = retained.empty() ? sealedOffset : retained.front().offset;
+    uint8_t status = kStatusOk;
+    if (requestedStream != 0 && requestedStream != streamId) {
+        status = kStatusMismatch;
+    } else if (requestedOffset < base || requestedOffset > sealedOffset) {
+        status = kStatusUnavailable;
+    }
+    if (!writeAll(fd, encodeHandshake(status, streamId, requestedOffset)) || status != kStatusOk) {
+        std::cerr << "[Replication] 拒绝备用进程: "
+                  << (status == kStatusMismatch ? "日志来自另一个主服务器" : "请求的偏移已不在保留范围内")
+                  << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    standbyFd = fd;
+    cursor = requestedOffset;
+    ackedOffset.store(requestedOffset, std::memory_order_relaxed);
+    ackBuffer.clear();
+    std::cout << "[Replication] 备用进程已连接，从偏移 " << requestedOffset << " 开始发送" << std::endl;
+    return true;
+}
+
+// 发送尚未发出的批次（套接字写满时留到下一轮）
+bool ReplicationPrimary::shipBatches() {
+    static auto& shippedCounter = Metrics::instance().counter("replication.shipped_bytes");
+
+    while (cursor < sealedOffset) {
+        auto batch = std::upper_bound(retained.begin(), retained.end(), cursor,
+                                      [](uint64_t offset, const Batch& item) {
+                                          return offset < item.offset + item.bytes.size();
+                                      });
+        if (batch == retained.end() || batch->offset > cursor) {
+            return false;   // 需要的批次已被淘汰
+        }
+        size_t skip = static_cast<size_t>(cursor - batch->offset);
+        ssize_t sent = ::send(standbyFd, batch->bytes.data() + skip, batch->bytes.size() - skip, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        cursor += static_cast<uint64_t>(sent);
+        shippedCounter.fetch_add(sent, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// 读取备用进程回报的已应用偏移
+bool ReplicationPrimary::readAcks() {
+    char buffer[256];
+    while (true) {
+        ssize_t received = ::recv(standbyFd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            ackBuffer.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+        break;
+    }
+    size_t complete = ackBuffer.size() / 8 * 8;
+    if (complete > 0) {
+        ackedOffset.store(getU64(ackBuffer.data() + complete - 8), std::memory_order_relaxed);
+        ackBuffer.erase(0, complete);
+    }
+    return true;
+}
+
+void ReplicationPrimary::dropStandby(const char* reason) {
+    std::cerr << "[Replication] 备用进程断开: " << reason << std::endl;
+    ::close(standbyFd);
+    standbyFd = -1;
+}
+
+#else
+
+bool ReplicationPrimary::start(const std::string&) {
+    std::cerr << "[Replication] 当前平台不支持复制" << std::endl;
+    return false;
+}
+
+void ReplicationPrimary::stop() {
+}
+
+void ReplicationPrimary::run() {
+}
+
+void ReplicationPrimary::sealPending() {
+}
+
+bool ReplicationPrimary::acceptStandby() {
+    return false;
+}
+
+bool ReplicationPrimary::shipBatches() {
+    return false;
+}
+
+bool ReplicationPrimary::readAcks() {
+    return false;
+}
+
+void ReplicationPrimary::dropStandby(const char*) {
+}
+
+#endif // !_WIN32
+
+// ==================== ReplicationStandby ====================
+
+ReplicationStandby::ReplicationStandby(SessionManager& sessions)
+    : sessions(sessions), grace(static_cast<int64_t>(envSize("TIME_ARTIFACTS_STANDBY_GRACE_MS", 500))) {
+}
+
+ReplicationStandby::~ReplicationStandby() {
+    stop();
+}
+
+// 解析从offset开始的完整记录并应用，offset前进到解析到的位置（之后是不完整的记录）
+// 【返回】：记录体的长度字段与记录长度不一致时返回false（不应用这条记录，调用方断开连接）
+bool ReplicationStandby::applyRecords(const std::string& buffer, size_t& offset) {
+    while (buffer.size() - offset >= kRecordHeaderSize) {
+        const char* record = buffer.data() + offset;
+        uint32_t bodyLength = getU32(record + 1);
+        if (buffer.size() - offset < kRecordHeaderSize + bodyLength) {
+            break;
+        }
+        const char* body = record + kRecordHeaderSize;
+        uint32_t firstLength = bodyLength >= 8 ? getU32(body) : 0;
+        if (bodyLength < 8 || firstLength > bodyLength - 8 ||
+            getU32(body + 4 + firstLength) != bodyLength - 8 - firstLength) {
+            std::cerr << "[Replication] 记录格式错误（偏移 " << appliedOffset.load(std::memory_order_relaxed)
+                      << "，长度 " << bodyLength << "），断开连接" << std::endl;
+            return false;
+        }
+        uint32_t secondLength = bodyLength - 8 - firstLength;
+        std::string first(body + 4, firstLength);
+        std::string second(body + 8 + firstLength, secondLength);
+
+        applyRecord(record[0], first, second);
+        offset += kRecordHeaderSize + bodyLength;
+        appliedOffset.fetch_add(kRecordHeaderSize + bodyLength, std::memory_order_relaxed);
+        appliedRecords.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ReplicationStandby::applyRecord(char type, const std::string& first, const std::string& second) {
+    switch (type) {
+        case 'C':
+            sessions.restoreSession(first, second);
+            break;
+        case 'M':
+            sessions.handleMessage(first, second);
+            break;
+        case 'O':
+            sessions.encodeOutbound(first, second);
+            break;
+        case 'X':
+            sessions.removeSession(first);
+            break;
+        default:
+            std::cerr << "[Replication] 未知的记录类型: " << static_cast<int>(type) << std::endl;
+            break;
+    }
+}
+
+#ifndef _WIN32
+
+bool ReplicationStandby::start(const std::string& primaryEndpoint) {
+    if (running.load()) {
+        return true;
+    }
+    endpoint = primaryEndpoint;
+
+    Metrics::instance().registerCollector("replication.standby", [this](Metrics::Samples& out) {
+        out["replication.applied_bytes"] = static_cast<double>(appliedOffset.load(std::memory_order_relaxed));
+        out["replication.applied_records"] = static_cast<double>(appliedRecords.load(std::memory_order_relaxed));
+        out["replication.connected"] = connected.load(std::memory_order_relaxed) ? 1.0 : 0.0;
+    });
+
+    running.store(true);
+    thread = std::thread([this]() { run(); });
+    std::cout << "[Replication] 备用模式: 从 " << endpoint << " 接收会话变更" << std::endl;
+    return true;
+}
+
+void ReplicationStandby::stop() {
+    if (!running.exchange(false) && !thread.joinable()) {
+        return;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    Metrics::instance().unregisterCollector("replication.standby");
+}
+
+// 连接主服务器并完成握手
+// 【返回】：套接字；暂时连不上返回-1；主服务器拒绝（无法继续复制）返回-2
+int ReplicationStandby::connectWithHandshake() {
+    int fd = openEndpoint(endpoint, false);
+    if (fd < 0) {
+        return -1;
+    }
+    uint64_t offset = appliedOffset.load(std::memory_order_relaxed);
+    char reply[kHandshakeSize];
+    if (!writeAll(fd, encodeHandshake(kVersion, streamId, offset)) ||
+        !readExact(fd, reply, sizeof(reply), kHandshakeTimeoutMs) ||
+        std::memcmp(reply, kMagic, sizeof(kMagic)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    if (static_cast<uint8_t>(reply[4]) != kStatusOk) {
+        std::cerr << "[Replication] 主服务器拒绝复制（"
+                  << (static_cast<uint8_t>(reply[4]) == kStatusMismatch ? "日志来自另一个主服务器"
+                                                                        : "需要的日志已被淘汰，请在主服务器启动后尽快启动备用进程")
+                  << "）" << std::endl;
+        ::close(fd);
+        return -2;
+    }
+    streamId = getU64(reply + 5);
+    return fd;
+}
+
+void ReplicationStandby::run() {
+    bool everConnected = false;
+    auto disconnectedAt = std::chrono::steady_clock::now();
+
+    while (running.load()) {
+        int fd = connectWithHandshake();
+        if (fd == -2) {
+            break;
+        }
+        if (fd < 0) {
+            if (everConnected && std::chrono::steady_clock::now() - disconnectedAt > grace) {
+                std::cerr << "[Replication] 主服务器已失效（" << grace.count() << "ms内无法重连），已应用 "
+                          << appliedRecords.load() << " 条记录" << std::endl;
+                lost.store(true, std::memory_order_release);
+                break;
+            }
+            std::this_thread::sleep_for(everConnected ? std::chrono::milliseconds(50) : kConnectRetry);
+            continue;
+        }
+
+        if (!everConnected) {
+            std::cout << "[Replication] 已连接主服务器" << std::endl;
+        }
+        everConnected = true;
+        connected.store(true, std::memory_order_relaxed);
+
+        // 重连时从已应用的偏移继续，不完整的记录会重新收到
+        std::string buffer;
+        size_t parsed = 0;
+        uint64_t ackedOffset = appliedOffset.load(std::memory_order_relaxed);
+        auto lastAck = std::chrono::steady_clock::now();
+        char chunk[64 * 1024];
+        while (running.load()) {
+            pollfd pfd{fd, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, static_cast<int>(kAckInterval.count()));
+            if (ready > 0) {
+                ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (received <= 0 && !(received < 0 && (errno == EINTR || errno == EAGAIN))) {
+                    break;
+                }
+                if (received > 0) {
+                    buffer.append(chunk, static_cast<size_t>(received));
+                    if (!applyRecords(buffer, parsed)) {
+                        break;
+                    }
+                    if (parsed > buffer.size() / 2) {
+                        buffer.erase(0, parsed);
+                        parsed = 0;
+                    }
+                }
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            uint64_t applied = appliedOffset.load(std::memory_order_relaxed);
+            if (applied != ackedOffset && now - lastAck >= kAckInterval) {
+                std::string ack;
+                putU64(ack, applied);
+                ::send(fd, ack.data(), ack.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+                ackedOffset = applied;
+                lastAck = now;
+            }
+        }
+
+        ::close(fd);
+        connected.store(false, std::memory_order_relaxed);
+        disconnectedAt = std::chrono::steady_clock::now();
+        if (running.load()) {
+            std::cerr << "[Replication] 与主服务器的连接断开，尝试重连" << std::endl;
+        }
+    }
+    running.store(false);
+}
+
+#else
+
+bool ReplicationStandby::start(const std::string&) {
+    std::cerr << "[Replication] 当前平台不支持复制" << std::endl;
+    return false;
+}
+
+void ReplicationStandby::stop() {
+}
+
+int ReplicationStandby::connectWithHandshake() {
+    return -2;
+}
+
+void ReplicationStandby::run() {
+}
+
+#endif // !_WIN32
@@ -0,0 +1,161 @@
+/**
+ * Replication.h
+ *
+ * 热备复制 - 主服务器把会话变更日志异步发送给备用进程，主服务器崩溃时备用进程接管端口
+ *
+ * 【日志内容】：会话状态由 创建 → 客户端消息序列 决定（APIHandler对同样的消息序列
+ *   产生同样的状态），所以日志记录的是变更的输入而不是状态本身：
+ *   - C 创建会话（会话ID、恢复令牌）
+ *   - M 客户端消息（会话ID、原始消息）：备用进程交给同一会话重新处理
+ *   - O 出站消息（会话ID、消息）：备用进程重新编号并放入出站消息环，
+ *       接管后客户端凭恢复令牌重连，序号和补发内容与主服务器一致
+ *   - X 删除会话
+ *   记录在持有会话锁时追加，日志顺序就是变更顺序
+ *
+ * 【主服务器】（ReplicationPrimary）：
+ * - 追加记录只是在锁内拷贝到待发送缓冲；复制线程每5ms把缓冲切成一个批次发出，
+ *   网络线程和主循环都不等待备用进程（异步、批量）
+ * - 已发出的批次保留在内存中（上限见 TIME_ARTIFACTS_REPLICATION_RETAIN_MB，默认64），
+ *   备用进程断线重连时从它已应用的偏移继续
+ * - 备用进程定期回报已应用的偏移，主服务器据此计算复制延迟
+ *
+ * 【备用进程】（ReplicationStandby）：
+ * - 连接主服务器（主服务器尚未启动时每200ms重试），应用收到的记录，回报偏移
+ * - 连接断开后在宽限时间内重连（TIME_ARTIFACTS_STANDBY_GRACE_MS，默认500）；
+ *   重连失败即认为主服务器已失效，由GameEngine接管监听端口
+ *
+ * 【配置】（环境变量）：
+ * - 主服务器：TIME_ARTIFACTS_REPLICATION_LISTEN=<Unix套接字路径 | [主机:]端口>
+ * - 备用进程：TIME_ARTIFACTS_STANDBY_OF=<同上>
+ *   同一台机器上运行两个进程时，备用进程的管理接口默认使用 <管理套接字>.standby
+ *
+ * 【指标】：
+ * - 主服务器：replication.lag_bytes、replication.lag_ms（最早未确认批次的年龄）、
+ *   replication.shipped_bytes、replication.standby_connected
+ * - 备用进程：replication.applied_bytes、replication.applied_records、replication.connected
+ *
+ * 【限制】：备用进程只能从日志开头同步（需要在保留上限内连上主服务器）；
+ *   接管后的新主服务器不再向其他备用进程复制
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class SessionManager;
+
+/**
+ * 主服务器一侧：记录并发送会话变更日志
+ */
+class ReplicationPrimary {
+public:
+    static ReplicationPrimary& instance();
+
+    ReplicationPrimary(const ReplicationPrimary&) = delete;
+    ReplicationPrimary& operator=(const ReplicationPrimary&) = delete;
+
+    /**
+     * 开始接受备用进程连接
+     * 【参数】：endpoint - Unix套接字路径（含'/'）或 [主机:]端口
+     * 【返回】：监听失败时返回false（不影响游戏服务器）
+     */
+    bool start(const std::string& endpoint);
+
+    void stop();
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // 追加变更记录（未启用时直接返回；调用方持有会话锁）
+    void recordCreate(const std::string& sessionId, const std::string& resumeToken);
+    void recordMessage(const std::string& sessionId, const std::string& rawMessage);
+    void recordOutbound(const std::string& sessionId, const std::string& message);
+    void recordRemove(const std::string& sessionId);
+
+private:
+    ReplicationPrimary();
+    ~ReplicationPrimary();
+
+    /**
+     * 已切分的批次
+     */
+    struct Batch {
+        uint64_t offset = 0;
+        std::string bytes;
+        std::chrono::steady_clock::time_point producedAt;
+    };
+
+    void append(char type, const std::string& first, const std::string& second);
+    void run();
+    void sealPending();
+    bool acceptStandby();
+    bool shipBatches();
+    bool readAcks();
+    void dropStandby(const char* reason);
+
+    std::atomic<bool> enabled{false};
+    std::atomic<bool> running{false};
+    std::thread thread;
+    int listenFd = -1;
+    int standbyFd = -1;
+    std::string unixPath;
+
+    // 待发送缓冲（由mutex保护）
+    std::mutex mutex;
+    std::string pending;
+
+    // 以下只在复制线程访问
+    std::deque<Batch> retained;
+    uint64_t retainedBytes = 0;
+    uint64_t retainLimit;
+    uint64_t streamId;
+    uint64_t sealedOffset = 0;          // 已切分批次的末尾偏移
+    uint64_t cursor = 0;                // 已发给备用进程的偏移
+    std::string ackBuffer;
+
+    std::atomic<uint64_t> ackedOffset{0};
+    std::atomic<int64_t> lagMicros{0};
+};
+
+/**
+ * 备用进程一侧：接收并应用变更日志
+ */
+class ReplicationStandby {
+public:
+    explicit ReplicationStandby(SessionManager& sessions);
+    ~ReplicationStandby();
+
+    ReplicationStandby(const ReplicationStandby&) = delete;
+    ReplicationStandby& operator=(const ReplicationStandby&) = delete;
+
+    bool start(const std::string& endpoint);
+    void stop();
+
+    /**
+     * 主服务器已失效（曾经连上，断开后宽限时间内重连失败）
+     */
+    bool primaryLost() const { return lost.load(std::memory_order_acquire); }
+
+private:
+    void run();
+    int connectWithHandshake();
+    bool applyRecords(const std::string& buffer, size_t& offset);
+    void applyRecord(char type, const std::string& first, const std::string& second);
+
+    SessionManager& sessions;
+    std::string endpoint;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> lost{false};
+    std::atomic<bool> connected{false};
+
+    uint64_t streamId = 0;
+    std::atomic<uint64_t> appliedOffset{0};
+    std::atomic<uint64_t> appliedRecords{0};
+    std::chrono::milliseconds grace;
+};
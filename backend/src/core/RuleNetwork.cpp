@@ -0,0 +1,178 @@
+/**
+ * RuleNetwork.cpp
+ *
+ * 剧情规则网络实现
+ */
+
+#include "RuleNetwork.h"
+#include "Events.h"
+#include "EventManager.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "utils/SimpleJson.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+RuleNetwork& RuleNetwork::instance() {
+    static RuleNetwork network;
+    return network;
+}
+
+bool RuleNetwork::loadFromDirectory(const std::string& directory) {
+    std::ifstream in((std::filesystem::path(directory) / "rules.json").string(), std::ios::binary);
+    if (!in) {
+        std::cerr << "[RuleNetwork] 未找到 rules.json，目录: " << directory << std::endl;
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    return loadFromString(buffer.str());
+}
+
+bool RuleNetwork::loadFromString(const std::string& rulesJson) {
+    MemoryScope memoryScope(MemoryTag::World);
+
+    SimpleJson::Value root;
+    std::string error;
+    if (!SimpleJson::parse(rulesJson, root, &error) || !root.isObject()) {
+        std::cerr << "[RuleNetwork] rules.json 格式错误: " << error << std::endl;
+        return false;
+    }
+
+    alphaNodes.clear();
+    alphaIndex.clear();
+    rules.clear();
+
+    for (const auto& ruleValue : root["rules"].items()) {
+        StoryRule rule;
+        rule.id = ruleValue["id"].asString();
+        for (const auto& condition : ruleValue["conditions"].items()) {
+            const std::string& type = condition["type"].asString();
+            const std::string& name = condition["id"].asString();
+            if ((type != "item" && type != "insight" && type != "attribute") || name.empty()) {
+                std::cerr << "[RuleNetwork] 规则 " << rule.id << " 中的条件无效，已忽略" << std::endl;
+                continue;
+            }
+            int minimum = type == "attribute" ? static_cast<int>(condition["min"].asNumber()) : 0;
+            rule.conditions.push_back(internAlpha(type + ":" + name, minimum));
+        }
+        for (const auto& unlock : ruleValue["unlocks"].items()) {
+            rule.unlocks.push_back(unlock.asString());
+        }
+        if (rule.id.empty() || rule.conditions.empty()) {
+            continue;
+        }
+
+        uint32_t ruleIndex = static_cast<uint32_t>(rules.size());
+        for (uint32_t alpha : rule.conditions) {
+            alphaNodes[alpha].rules.push_back(ruleIndex);
+        }
+        rules.push_back(std::move(rule));
+    }
+
+    std::cout << "[RuleNetwork] 已编译 " << rules.size() << " 条剧情规则，"
+              << alphaNodes.size() << " 个条件节点" << std::endl;
+    return true;
+}
+
+uint32_t RuleNetwork::internAlpha(const std::string& key, int minimum) {
+    // 相同的条件只建一个节点，多条规则共享同一次检查
+    auto& candidates = alphaIndex[key];
+    for (uint32_t alpha : candidates) {
+        if (alphaNodes[alpha].minimum == minimum) {
+            return alpha;
+        }
+    }
+    AlphaNode node;
+    node.key = key;
+    node.minimum = minimum;
+    alphaNodes.push_back(std::move(node));
+    candidates.push_back(static_cast<uint32_t>(alphaNodes.size() - 1));
+    return candidates.back();
+}
+
+std::vector<const StoryRule*> RuleNetwork::onEvent(RuleMemory& memory, const Event& event,
+                                                   const std::string& playerId) {
+    static auto& activations = Metrics::instance().counter("rules.alpha_activations");
+
+    std::vector<const StoryRule*> fired;
+    if (rules.empty()) {
+        return fired;
+    }
+    if (memory.alphaActive.size() != alphaNodes.size() || memory.satisfied.size() != rules.size()) {
+        memory.alphaActive.assign(alphaNodes.size(), 0);
+        memory.satisfied.assign(rules.size(), 0);
+        memory.fired.assign(rules.size(), 0);
+    }
+
+    // 事件 → 事实键和新状态
+    std::string key;
+    bool present = true;
+    int value = 0;
+    const std::string type = event.getType();
+    if (type == "ItemAcquired") {
+        key = "item:" + static_cast<const ItemAcquiredEvent&>(event).itemId;
+    } else if (type == "ItemLost") {
+        key = "item:" + static_cast<const ItemLostEvent&>(event).itemId;
+        present = false;
+    } else if (type == "InsightGained") {
+        key = "insight:" + static_cast<const InsightGainedEvent&>(event).insightId;
+    } else if (type == "AttributeChanged") {
+        const auto& attributeEvent = static_cast<const AttributeChangedEvent&>(event);
+        key = "attribute:" + attributeEvent.attributeName;
+        value = attributeEvent.newValue;
+    } else {
+        return fired;
+    }
+
+    auto it = alphaIndex.find(key);
+    if (it == alphaIndex.end()) {
+        return fired;
+    }
+    for (uint32_t alpha : it->second) {
+        bool active = present && value >= alphaNodes[alpha].minimum;
+        activations.fetch_add(1, std::memory_order_relaxed);
+        setAlpha(memory, alpha, active, playerId, fired);
+    }
+    return fired;
+}
+
+void RuleNetwork::setAlpha(RuleMemory& memory, uint32_t alpha, bool active, const std::string& playerId,
+                           std::vector<const StoryRule*>& fired) {
+    static auto& evaluations = Metrics::instance().counter("rules.evaluations");
+    static auto& firedCounter = Metrics::instance().counter("rules.fired");
+
+    if (static_cast<bool>(memory.alphaActive[alpha]) == active) {
+        return;
+    }
+    memory.alphaActive[alpha] = active ? 1 : 0;
+
+    // 只有挂在这个条件上的规则需要更新
+    for (uint32_t ruleIndex : alphaNodes[alpha].rules) {
+        evaluations.fetch_add(1, std::memory_order_relaxed);
+        if (!active) {
+            memory.satisfied[ruleIndex]--;
+            continue;
+        }
+        const StoryRule& rule = rules[ruleIndex];
+        if (++memory.satisfied[ruleIndex] < rule.conditions.size() || memory.fired[ruleIndex]) {
+            continue;
+        }
+
+        memory.fired[ruleIndex] = 1;
+        fired.push_back(&rule);
+        firedCounter.fetch_add(1, std::memory_order_relaxed);
+        if (EventManager* sink = eventSink.load()) {
+            sink->publish(std::make_unique<StoryTriggeredEvent>(rule.id, playerId, rule.unlocks), playerId);
+        }
+    }
+}
+
+void RuleNetwork::registerMetrics() {
+    Metrics::instance().registerCollector("rule_network", [this](Metrics::Samples& out) {
+        out["rules.count"] = static_cast<double>(rules.size());
+        out["rules.alpha_nodes"] = static_cast<double>(alphaNodes.size());
+    });
+}
@@ -0,0 +1,118 @@
+/**
+ * RuleNetwork.h
+ *
+ * 剧情规则网络 - 增量式（Rete风格）的剧情触发条件匹配
+ *
+ * 【文件作用】：
+ * 1. 从 rules.json 编译剧情规则，例如
+ *    "持有hidden_diary 且 获得bookstore_secret洞察 且 共情≥3 → 解锁owner_true_story"
+ * 2. 每个玩家事件只唤醒与它相关的条件和规则，不需要每次重新检查全部规则
+ * 3. 规则触发时向 EventManager 发布 StoryTriggeredEvent
+ *
+ * 【网络结构】：
+ *   事件 ──(事件类型+名称)──▶ Alpha节点（单个条件，相同条件在规则间共享）
+ *        ──▶ Beta汇合（每个玩家每条规则已满足的条件数，保存在RuleMemory中）
+ *        ──▶ 全部满足时触发
+ *
+ * 【事件到Alpha键的映射】：
+ *   ItemAcquired / ItemLost   → "item:<物品ID>"
+ *   InsightGained             → "insight:<洞察ID>"
+ *   AttributeChanged          → "attribute:<属性名>"（按新值检查阈值）
+ *
+ * 【线程】：网络编译后只读；RuleMemory属于单个会话，由会话锁保护
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Event;
+class EventManager;
+
+/**
+ * 剧情规则
+ */
+struct StoryRule {
+    std::string id;
+    std::vector<uint32_t> conditions;   // Alpha节点编号
+    std::vector<std::string> unlocks;   // 解锁的剧情标记
+};
+
+/**
+ * 单个玩家的规则匹配状态（Beta记忆）
+ */
+struct RuleMemory {
+    std::vector<uint8_t> alphaActive;   // 每个Alpha节点当前是否满足
+    std::vector<uint16_t> satisfied;    // 每条规则已满足的条件数
+    std::vector<uint8_t> fired;         // 每条规则是否已经触发过（每个玩家只触发一次）
+};
+
+/**
+ * 剧情规则网络（全局单例）
+ */
+class RuleNetwork {
+public:
+    static RuleNetwork& instance();
+
+    RuleNetwork(const RuleNetwork&) = delete;
+    RuleNetwork& operator=(const RuleNetwork&) = delete;
+
+    /**
+     * 从数据目录的 rules.json 编译规则
+     * 【返回】：文件缺失或格式错误时返回false（网络为空，事件不会触发任何规则）
+     */
+    bool loadFromDirectory(const std::string& directory);
+
+    /**
+     * 从JSON文本编译规则
+     */
+    bool loadFromString(const std::string& rulesJson);
+
+    /**
+     * 设置触发事件的发布目标（GameEngine启动时设置，关闭前清空）
+     */
+    void setEventSink(EventManager* manager) { eventSink.store(manager); }
+
+    /**
+     * 把一个玩家事件送入网络
+     * 【参数】：
+     *   - memory: 该玩家的匹配状态
+     *   - event: ItemAcquired / ItemLost / InsightGained / AttributeChanged，其他类型忽略
+     *   - playerId: 写入StoryTriggeredEvent
+     * 【返回】：本次新触发的规则
+     */
+    std::vector<const StoryRule*> onEvent(RuleMemory& memory, const Event& event, const std::string& playerId);
+
+    size_t ruleCount() const { return rules.size(); }
+    size_t alphaCount() const { return alphaNodes.size(); }
+
+    /**
+     * 注册运行指标
+     */
+    void registerMetrics();
+
+private:
+    RuleNetwork() = default;
+
+    /**
+     * Alpha节点：对单个事实的测试
+     */
+    struct AlphaNode {
+        std::string key;                // "item:old_diary" / "attribute:empathy" ...
+        int minimum = 0;                // 属性阈值（只用于attribute）
+        std::vector<uint32_t> rules;    // 使用这个条件的规则（Beta汇合的入口）
+    };
+
+    uint32_t internAlpha(const std::string& key, int minimum);
+    void setAlpha(RuleMemory& memory, uint32_t alpha, bool active, const std::string& playerId,
+                  std::vector<const StoryRule*>& fired);
+
+    std::vector<AlphaNode> alphaNodes;
+    std::unordered_map<std::string, std::vector<uint32_t>> alphaIndex;  // 事实键 -> Alpha节点
+    std::vector<StoryRule> rules;
+    std::atomic<EventManager*> eventSink{nullptr};
+};
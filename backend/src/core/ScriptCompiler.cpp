@@ -0,0 +1,583 @@
+/**
+ * ScriptCompiler.cpp
+ *
+ * 交互脚本编译器实现（递归下降，边解析边生成代码）
+ *
+ * 【寄存器分配】：局部变量占用从0开始的固定寄存器，临时值在其上按栈方式分配，
+ * 每条语句结束时临时值全部释放
+ */
+
+#include "ScriptCompiler.h"
+#include <cctype>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+    enum class TokenKind { End, Identifier, Number, String, Symbol };
+
+    struct Token {
+        TokenKind kind = TokenKind::End;
+        std::string text;
+        int32_t number = 0;
+        int line = 1;
+    };
+
+    /**
+     * 词法分析
+     */
+    class Lexer {
+    public:
+        explicit Lexer(const std::string& source) : source(source) {}
+
+        Token next() {
+            skipSpaceAndComments();
+            Token token;
+            token.line = line;
+            if (pos >= source.size()) {
+                return token;
+            }
+
+            char c = source[pos];
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = pos;
+                while (pos < source.size() &&
+                       (std::isalnum(static_cast<unsigned char>(source[pos])) || source[pos] == '_')) {
+                    ++pos;
+                }
+                token.kind = TokenKind::Identifier;
+                token.text = source.substr(start, pos - start);
+                return token;
+            }
+
+            if (std::isdigit(static_cast<unsigned char>(c))) {
+                int64_t value = 0;
+                while (pos < source.size() && std::isdigit(static_cast<unsigned char>(source[pos]))) {
+                    value = value * 10 + (source[pos++] - '0');
+                    if (value > INT32_MAX) {
+                        fail("数字超出范围");
+                    }
+                }
+                token.kind = TokenKind::Number;
+                token.number = static_cast<int32_t>(value);
+                return token;
+            }
+
+            if (c == '"') {
+                ++pos;
+                token.kind = TokenKind::String;
+                while (pos < source.size() && source[pos] != '"') {
+                    char ch = source[pos++];
+                    if (ch == '\n') {
+                        fail("字符串未结束");
+                    }
+                    if (ch == '\\' && pos < source.size()) {
+                        char escaped = source[pos++];
+                        ch = escaped == 'n' ? '\n' : escaped;
+                    }
+                    token.text.push_back(ch);
+                }
+                if (pos >= source.size()) {
+                    fail("字符串未结束");
+                }
+                ++pos;
+                return token;
+            }
+
+            static const char* const twoCharSymbols[] = {"==", "!=", "<=", ">=", "&&", "||", "+=", "-="};
+            for (const char* symbol : twoCharSymbols) {
+                if (source.compare(pos, 2, symbol) == 0) {
+                    pos += 2;
+                    token.kind = TokenKind::Symbol;
+                    token.text = symbol;
+                    return token;
+                }
+            }
+            if (std::string("+-*/%!<>=(){};.").find(c) != std::string::npos) {
+                ++pos;
+                token.kind = TokenKind::Symbol;
+                token.text = std::string(1, c);
+                return token;
+            }
+            fail(std::string("无法识别的字符 '") + c + "'");
+            return token;
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::runtime_error("第" + std::to_string(line) + "行: " + message);
+        }
+
+    private:
+        void skipSpaceAndComments() {
+            while (pos < source.size()) {
+                char c = source[pos];
+                if (c == '\n') {
+                    ++line;
+                    ++pos;
+                } else if (std::isspace(static_cast<unsigned char>(c))) {
+                    ++pos;
+                } else if (c == '#') {
+                    while (pos < source.size() && source[pos] != '\n') {
+                        ++pos;
+                    }
+                } else {
+                    break;
+                }
+            }
+        }
+
+        const std::string& source;
+        size_t pos = 0;
+        int line = 1;
+    };
+
+    /**
+     * 语法分析 + 代码生成
+     */
+    class Parser {
+    public:
+        explicit Parser(const std::string& source) : lexer(source) {
+            script = std::make_shared<Script>();
+            script->source = source;
+            advance();
+        }
+
+        std::shared_ptr<Script> run() {
+            while (current.kind != TokenKind::End) {
+                statement();
+            }
+            emit(ScriptOp::Halt);
+            return script;
+        }
+
+    private:
+        // ==================== 词法辅助 ====================
+
+        void advance() {
+            current = lexer.next();
+        }
+
+        bool isSymbol(const char* symbol) const {
+            return current.kind == TokenKind::Symbol && current.text == symbol;
+        }
+
+        bool isKeyword(const char* keyword) const {
+            return current.kind == TokenKind::Identifier && current.text == keyword;
+        }
+
+        bool accept(const char* symbol) {
+            if (isSymbol(symbol)) {
+                advance();
+                return true;
+            }
+            return false;
+        }
+
+        void expect(const char* symbol) {
+            if (!accept(symbol)) {
+                fail(std::string("缺少 '") + symbol + "'");
+            }
+        }
+
+        std::string expectIdentifier() {
+            if (current.kind != TokenKind::Identifier) {
+                fail("缺少名称");
+            }
+            std::string name = current.text;
+            advance();
+            return name;
+        }
+
+        int32_t expectStringSymbol() {
+            if (current.kind != TokenKind::String) {
+                fail("缺少字符串");
+            }
+            int32_t index = intern(current.text);
+            advance();
+            return index;
+        }
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::runtime_error("第" + std::to_string(current.line) + "行: " + message);
+        }
+
+        // ==================== 代码生成辅助 ====================
+
+        size_t emit(ScriptOp op, uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, int32_t imm = 0) {
+            script->code.push_back({op, a, b, c, imm});
+            return script->code.size() - 1;
+        }
+
+        void patchHere(size_t jump) {
+            script->code[jump].imm = static_cast<int32_t>(script->code.size());
+            labelAt = script->code.size();
+        }
+
+        int32_t intern(const std::string& text) {
+            auto it = symbolIndex.find(text);
+            if (it != symbolIndex.end()) {
+                return it->second;
+            }
+            script->symbols.push_back(text);
+            int32_t index = static_cast<int32_t>(script->symbols.size() - 1);
+            symbolIndex.emplace(text, index);
+            return index;
+        }
+
+        uint8_t allocRegister() {
+            if (top >= Script::kMaxRegisters) {
+                fail("表达式过于复杂（寄存器不足）");
+            }
+            uint8_t reg = static_cast<uint8_t>(top++);
+            if (top > script->registerCount) {
+                script->registerCount = static_cast<uint8_t>(top);
+            }
+            return reg;
+        }
+
+        void freeRegister() {
+            --top;
+        }
+
+        /**
+         * 最后一条指令是否为可以被窥孔改写的常量加载（不是跳转目标）
+         */
+        bool lastIsFoldableConstant(uint8_t reg) const {
+            const auto& code = script->code;
+            return !code.empty() && labelAt != code.size() && code.back().op == ScriptOp::LoadK &&
+                   code.back().a == reg;
+        }
+
+        /**
+         * 最后一条指令是否只写入r[a]，且不是跳转目标（可以直接改写目标寄存器）
+         */
+        bool lastWritesRegister(uint8_t reg) const {
+            const auto& code = script->code;
+            if (code.empty() || labelAt == code.size() || code.back().a != reg) {
+                return false;
+            }
+            switch (code.back().op) {
+                case ScriptOp::LoadK: case ScriptOp::Move: case ScriptOp::Add: case ScriptOp::Sub:
+                case ScriptOp::Mul: case ScriptOp::Div: case ScriptOp::Mod: case ScriptOp::AddK:
+                case ScriptOp::Neg: case ScriptOp::Not: case ScriptOp::Eq: case ScriptOp::Ne:
+                case ScriptOp::Lt: case ScriptOp::Le: case ScriptOp::GetAttr: case ScriptOp::HasItem:
+                case ScriptOp::KnowsInsight: case ScriptOp::HasFlag:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * dest = dest ± 右操作数（右操作数已在temp中；若为常量则改写成AddK）
+         */
+        void emitAddSub(bool subtract, uint8_t dest, uint8_t left, uint8_t temp) {
+            if (lastIsFoldableConstant(temp)) {
+                int32_t constant = script->code.back().imm;
+                script->code.pop_back();
+                emit(ScriptOp::AddK, dest, left, 0,
+                     subtract ? static_cast<int32_t>(0u - static_cast<uint32_t>(constant)) : constant);
+            } else {
+                emit(subtract ? ScriptOp::Sub : ScriptOp::Add, dest, left, temp);
+            }
+        }
+
+        // ==================== 语句 ====================
+
+        void statement() {
+            if (accept(";")) {
+                return;
+            }
+
+            if (isKeyword("var")) {
+                advance();
+                std::string name = expectIdentifier();
+                expect("=");
+                auto it = locals.find(name);
+                uint8_t reg = it != locals.end() ? it->second : allocRegister();
+                assignTo(reg);
+                locals[name] = reg;
+            } else if (isKeyword("if")) {
+                advance();
+                ifStatement();
+            } else if (isKeyword("attr")) {
+                advance();
+                expect(".");
+                int32_t symbol = intern(expectIdentifier());
+                attributeAssignment(symbol);
+            } else if (isKeyword("give")) {
+                advance();
+                emit(ScriptOp::GiveItem, 0, 0, 0, expectStringSymbol());
+            } else if (isKeyword("take")) {
+                advance();
+                emit(ScriptOp::TakeItem, 0, 0, 0, expectStringSymbol());
+            } else if (isKeyword("insight")) {
+                advance();
+                emit(ScriptOp::GainInsight, 0, 0, 0, expectStringSymbol());
+            } else if (isKeyword("flag")) {
+                advance();
+                emit(ScriptOp::SetFlag, 0, 0, 0, expectStringSymbol());
+            } else if (isKeyword("say")) {
+                advance();
+                emit(ScriptOp::Say, 0, 0, 0, expectStringSymbol());
+            } else if (isKeyword("goto")) {
+                advance();
+                emit(ScriptOp::Goto, 0, 0, 0, expectStringSymbol());
+            } else if (current.kind == TokenKind::Identifier) {
+                std::string name = current.text;
+                auto it = locals.find(name);
+                if (it == locals.end()) {
+                    fail("未声明的变量 '" + name + "'");
+                }
+                advance();
+                variableAssignment(it->second);
+            } else {
+                fail("无法识别的语句");
+            }
+        }
+
+        /**
+         * 把表达式结果写入reg（先算到临时寄存器，再把最后一条指令的目标改成reg，避免 x = y + x 覆盖问题）
+         */
+        void assignTo(uint8_t reg) {
+            uint8_t temp = allocRegister();
+            expression(temp);
+            if (lastWritesRegister(temp)) {
+                script->code.back().a = reg;
+            } else {
+                emit(ScriptOp::Move, reg, temp);
+            }
+            freeRegister();
+        }
+
+        void variableAssignment(uint8_t reg) {
+            if (accept("=")) {
+                assignTo(reg);
+                return;
+            }
+            bool subtract = isSymbol("-=");
+            if (!accept("+=") && !accept("-=")) {
+                fail("缺少赋值运算符");
+            }
+            uint8_t temp = allocRegister();
+            expression(temp);
+            emitAddSub(subtract, reg, reg, temp);
+            freeRegister();
+        }
+
+        void attributeAssignment(int32_t symbol) {
+            uint8_t value = allocRegister();
+            if (accept("=")) {
+                expression(value);
+            } else {
+                bool subtract = isSymbol("-=");
+                if (!accept("+=") && !accept("-=")) {
+                    fail("缺少赋值运算符");
+                }
+                emit(ScriptOp::GetAttr, value, 0, 0, symbol);
+                uint8_t temp = allocRegister();
+                expression(temp);
+                emitAddSub(subtract, value, value, temp);
+                freeRegister();
+            }
+            emit(ScriptOp::SetAttr, value, 0, 0, symbol);
+            freeRegister();
+        }
+
+        void ifStatement() {
+            uint8_t condition = allocRegister();
+            expression(condition);
+            freeRegister();
+            size_t skipThen = emit(ScriptOp::JumpIfFalse, condition);
+            block();
+
+            if (!isKeyword("else")) {
+                patchHere(skipThen);
+                return;
+            }
+            advance();
+            size_t skipElse = emit(ScriptOp::Jump);
+            patchHere(skipThen);
+            if (isKeyword("if")) {
+                advance();
+                ifStatement();
+            } else {
+                block();
+            }
+            patchHere(skipElse);
+        }
+
+        void block() {
+            expect("{");
+            while (!isSymbol("}")) {
+                if (current.kind == TokenKind::End) {
+                    fail("缺少 '}'");
+                }
+                statement();
+            }
+            advance();
+        }
+
+        // ==================== 表达式（结果写入dest） ====================
+
+        void expression(uint8_t dest) {
+            logicalOr(dest);
+        }
+
+        void logicalOr(uint8_t dest) {
+            logicalAnd(dest);
+            std::vector<size_t> jumps;
+            while (accept("||")) {
+                jumps.push_back(emit(ScriptOp::JumpIfTrue, dest));
+                logicalAnd(dest);
+            }
+            for (size_t jump : jumps) {
+                patchHere(jump);
+            }
+        }
+
+        void logicalAnd(uint8_t dest) {
+            equality(dest);
+            std::vector<size_t> jumps;
+            while (accept("&&")) {
+                jumps.push_back(emit(ScriptOp::JumpIfFalse, dest));
+                equality(dest);
+            }
+            for (size_t jump : jumps) {
+                patchHere(jump);
+            }
+        }
+
+        void equality(uint8_t dest) {
+            comparison(dest);
+            while (isSymbol("==") || isSymbol("!=")) {
+                ScriptOp op = isSymbol("==") ? ScriptOp::Eq : ScriptOp::Ne;
+                advance();
+                uint8_t temp = allocRegister();
+                comparison(temp);
+                emit(op, dest, dest, temp);
+                freeRegister();
+            }
+        }
+
+        void comparison(uint8_t dest) {
+            additive(dest);
+            while (isSymbol("<") || isSymbol("<=") || isSymbol(">") || isSymbol(">=")) {
+                std::string op = current.text;
+                advance();
+                uint8_t temp = allocRegister();
+                additive(temp);
+                // a > b 即 b < a，a >= b 即 b <= a
+                bool orEqual = op.size() == 2;
+                if (op[0] == '<') {
+                    emit(orEqual ? ScriptOp::Le : ScriptOp::Lt, dest, dest, temp);
+                } else {
+                    emit(orEqual ? ScriptOp::Le : ScriptOp::Lt, dest, temp, dest);
+                }
+                freeRegister();
+            }
+        }
+
+        void additive(uint8_t dest) {
+            multiplicative(dest);
+            while (isSymbol("+") || isSymbol("-")) {
+                bool subtract = isSymbol("-");
+                advance();
+                uint8_t temp = allocRegister();
+                multiplicative(temp);
+                emitAddSub(subtract, dest, dest, temp);
+                freeRegister();
+            }
+        }
+
+        void multiplicative(uint8_t dest) {
+            unary(dest);
+            while (isSymbol("*") || isSymbol("/") || isSymbol("%")) {
+                ScriptOp op = isSymbol("*") ? ScriptOp::Mul : isSymbol("/") ? ScriptOp::Div : ScriptOp::Mod;
+                advance();
+                uint8_t temp = allocRegister();
+                unary(temp);
+                emit(op, dest, dest, temp);
+                freeRegister();
+            }
+        }
+
+        void unary(uint8_t dest) {
+            if (accept("!")) {
+                unary(dest);
+                emit(ScriptOp::Not, dest, dest);
+            } else if (accept("-")) {
+                if (current.kind == TokenKind::Number) {
+                    emit(ScriptOp::LoadK, dest, 0, 0, -current.number);
+                    advance();
+                    return;
+                }
+                unary(dest);
+                emit(ScriptOp::Neg, dest, dest);
+            } else {
+                primary(dest);
+            }
+        }
+
+        void primary(uint8_t dest) {
+            if (current.kind == TokenKind::Number) {
+                emit(ScriptOp::LoadK, dest, 0, 0, current.number);
+                advance();
+                return;
+            }
+            if (accept("(")) {
+                expression(dest);
+                expect(")");
+                return;
+            }
+            if (current.kind != TokenKind::Identifier) {
+                fail("缺少表达式");
+            }
+
+            std::string name = current.text;
+            advance();
+            if (name == "true" || name == "false") {
+                emit(ScriptOp::LoadK, dest, 0, 0, name == "true" ? 1 : 0);
+            } else if (name == "attr") {
+                expect(".");
+                emit(ScriptOp::GetAttr, dest, 0, 0, intern(expectIdentifier()));
+            } else if (name == "has" || name == "knows" || name == "flag") {
+                expect("(");
+                int32_t symbol = expectStringSymbol();
+                expect(")");
+                ScriptOp op = name == "has" ? ScriptOp::HasItem
+                            : name == "knows" ? ScriptOp::KnowsInsight : ScriptOp::HasFlag;
+                emit(op, dest, 0, 0, symbol);
+            } else {
+                auto it = locals.find(name);
+                if (it == locals.end()) {
+                    fail("未声明的变量 '" + name + "'");
+                }
+                if (it->second != dest) {
+                    emit(ScriptOp::Move, dest, it->second);
+                }
+            }
+        }
+
+        Lexer lexer;
+        Token current;
+        std::shared_ptr<Script> script;
+        std::unordered_map<std::string, int32_t> symbolIndex;
+        std::unordered_map<std::string, uint8_t> locals;
+        int top = 0;                                // 下一个空闲寄存器
+        size_t labelAt = static_cast<size_t>(-1);   // 最近一个跳转目标的位置（窥孔优化不能跨越它）
+    };
+
+} // namespace
+
+std::shared_ptr<const Script> ScriptCompiler::compile(const std::string& source, std::string* error) {
+    try {
+        Parser parser(source);
+        return parser.run();
+    } catch (const std::exception& e) {
+        if (error) {
+            *error = e.what();
+        }
+        return nullptr;
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * ScriptCompiler.h
+ *
+ * 交互脚本编译器 - 把数据文件中嵌入的脚本文本编译成 ScriptVM 字节码
+ *
+ * 【脚本语言】：
+ *   语句（可用 ; 或换行分隔）：
+ *     var x = 表达式              声明局部变量（整个脚本内可见）
+ *     x = 表达式 / x += 表达式 / x -= 表达式
+ *     attr.empathy = 表达式 / attr.empathy += 表达式 / attr.empathy -= 表达式
+ *     if 表达式 { ... } else if 表达式 { ... } else { ... }
+ *     give "物品ID"   take "物品ID"   insight "洞察ID"   flag "剧情标记"
+ *     say "文字"      goto "对话节点ID"
+ *   表达式（32位整数运算，溢出按补码回绕，除数为0时结果为0；非0为真）：
+ *     || && == != < <= > >= + - * / % ! 一元-
+ *     数字、true、false、变量、attr.属性名、has("物品ID")、knows("洞察ID")、flag("剧情标记")、( )
+ *   注释：# 到行尾
+ *
+ * 【示例】：
+ *   if has("old_diary") && attr.empathy >= 3 { insight "owner_past"; say "你想起了日记里的那一页。" }
+ *
+ * 【限制】：没有循环；同时存活的变量和临时值不超过 Script::kMaxRegisters 个
+ */
+
+#pragma once
+
+#include "ScriptVM.h"
+#include <memory>
+#include <string>
+
+/**
+ * 脚本编译器（纯静态接口）
+ */
+class ScriptCompiler {
+public:
+    /**
+     * 编译脚本
+     * 【返回】：语法错误时返回nullptr，错误信息（含行号）写入error
+     */
+    static std::shared_ptr<const Script> compile(const std::string& source, std::string* error = nullptr);
+};
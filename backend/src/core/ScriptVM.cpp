@@ -0,0 +1,215 @@
+/**
+ * ScriptVM.cpp
+ *
+ * 交互脚本虚拟机实现
+ */
+
+#include "ScriptVM.h"
+#include <sstream>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SCRIPT_VM_COMPUTED_GOTO 1
+// computed goto（&&label、goto *p）是GNU扩展，-Wpedantic下会报警告
+#pragma GCC diagnostic ignored "-Wpedantic"
+#else
+#define SCRIPT_VM_COMPUTED_GOTO 0
+#endif
+
+namespace {
+
+    // 脚本整数按32位补码回绕：在64位中计算再截断（int32有符号溢出是未定义行为，
+    // INT32_MIN / -1 在x86上还会触发SIGFPE）
+    inline int32_t wrap(int64_t value) {
+        return static_cast<int32_t>(static_cast<uint32_t>(value));
+    }
+
+} // namespace
+
+const char* ScriptVM::dispatchMode() {
+    return SCRIPT_VM_COMPUTED_GOTO ? "computed-goto" : "switch";
+}
+
+const char* ScriptVM::opName(ScriptOp op) {
+    static const char* const names[] = {
+#define SCRIPT_OPCODE_NAME(name) #name,
+        SCRIPT_OPCODES(SCRIPT_OPCODE_NAME)
+#undef SCRIPT_OPCODE_NAME
+    };
+    return op < ScriptOp::Count ? names[static_cast<size_t>(op)] : "?";
+}
+
+std::string Script::disassemble() const {
+    std::ostringstream out;
+    for (size_t i = 0; i < code.size(); ++i) {
+        const ScriptInstruction& in = code[i];
+        out << i << "\t" << ScriptVM::opName(in.op) << "\ta=" << int(in.a) << " b=" << int(in.b)
+            << " c=" << int(in.c) << " imm=" << in.imm;
+        switch (in.op) {
+            case ScriptOp::GetAttr: case ScriptOp::SetAttr: case ScriptOp::HasItem:
+            case ScriptOp::KnowsInsight: case ScriptOp::HasFlag: case ScriptOp::GiveItem:
+            case ScriptOp::TakeItem: case ScriptOp::GainInsight: case ScriptOp::SetFlag:
+            case ScriptOp::Say: case ScriptOp::Goto:
+                out << "\t; " << symbols[in.imm];
+                break;
+            default:
+                break;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+void ScriptVM::execute(const Script& script, ScriptHost& host) {
+    int32_t r[Script::kMaxRegisters];
+    for (int i = 0; i < script.registerCount; ++i) {
+        r[i] = 0;
+    }
+
+    const ScriptInstruction* const code = script.code.data();
+    const std::string* const symbols = script.symbols.data();
+    const ScriptInstruction* ip = code;
+
+#if SCRIPT_VM_COMPUTED_GOTO
+    // 分派表：每个处理代码末尾各自跳转，分支预测器能按"上一条指令"区分跳转目标
+    static void* const dispatch[] = {
+#define SCRIPT_OPCODE_LABEL(name) &&op_##name,
+        SCRIPT_OPCODES(SCRIPT_OPCODE_LABEL)
+#undef SCRIPT_OPCODE_LABEL
+    };
+#define VM_DISPATCH() goto *dispatch[static_cast<uint8_t>(ip->op)]
+#define VM_OP(name) op_##name:
+#define VM_BEGIN VM_DISPATCH();
+#define VM_END
+#else
+#define VM_DISPATCH() goto dispatch_switch
+#define VM_OP(name) case ScriptOp::name:
+#define VM_BEGIN dispatch_switch: switch (ip->op) {
+#define VM_END default: return; }
+#endif
+#define VM_NEXT() do { ++ip; VM_DISPATCH(); } while (0)
+
+    VM_BEGIN
+
+    VM_OP(Halt)
+        return;
+
+    VM_OP(LoadK)
+        r[ip->a] = ip->imm;
+        VM_NEXT();
+
+    VM_OP(Move)
+        r[ip->a] = r[ip->b];
+        VM_NEXT();
+
+    VM_OP(Add)
+        r[ip->a] = wrap(int64_t(r[ip->b]) + r[ip->c]);
+        VM_NEXT();
+
+    VM_OP(Sub)
+        r[ip->a] = wrap(int64_t(r[ip->b]) - r[ip->c]);
+        VM_NEXT();
+
+    VM_OP(Mul)
+        r[ip->a] = wrap(int64_t(r[ip->b]) * r[ip->c]);
+        VM_NEXT();
+
+    VM_OP(Div)
+        r[ip->a] = r[ip->c] != 0 ? wrap(int64_t(r[ip->b]) / r[ip->c]) : 0;
+        VM_NEXT();
+
+    VM_OP(Mod)
+        r[ip->a] = r[ip->c] != 0 ? wrap(int64_t(r[ip->b]) % r[ip->c]) : 0;
+        VM_NEXT();
+
+    VM_OP(AddK)
+        r[ip->a] = wrap(int64_t(r[ip->b]) + ip->imm);
+        VM_NEXT();
+
+    VM_OP(Neg)
+        r[ip->a] = wrap(-int64_t(r[ip->b]));
+        VM_NEXT();
+
+    VM_OP(Not)
+        r[ip->a] = !r[ip->b];
+        VM_NEXT();
+
+    VM_OP(Eq)
+        r[ip->a] = r[ip->b] == r[ip->c];
+        VM_NEXT();
+
+    VM_OP(Ne)
+        r[ip->a] = r[ip->b] != r[ip->c];
+        VM_NEXT();
+
+    VM_OP(Lt)
+        r[ip->a] = r[ip->b] < r[ip->c];
+        VM_NEXT();
+
+    VM_OP(Le)
+        r[ip->a] = r[ip->b] <= r[ip->c];
+        VM_NEXT();
+
+    VM_OP(Jump)
+        ip = code + ip->imm;
+        VM_DISPATCH();
+
+    VM_OP(JumpIfFalse)
+        ip = r[ip->a] ? ip + 1 : code + ip->imm;
+        VM_DISPATCH();
+
+    VM_OP(JumpIfTrue)
+        ip = r[ip->a] ? code + ip->imm : ip + 1;
+        VM_DISPATCH();
+
+    VM_OP(GetAttr)
+        r[ip->a] = host.getAttribute(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(SetAttr)
+        host.setAttribute(symbols[ip->imm], r[ip->a]);
+        VM_NEXT();
+
+    VM_OP(HasItem)
+        r[ip->a] = host.hasItem(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(KnowsInsight)
+        r[ip->a] = host.knowsInsight(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(HasFlag)
+        r[ip->a] = host.hasFlag(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(GiveItem)
+        host.giveItem(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(TakeItem)
+        host.takeItem(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(GainInsight)
+        host.gainInsight(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(SetFlag)
+        host.setFlag(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(Say)
+        host.say(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_OP(Goto)
+        host.gotoDialogue(symbols[ip->imm]);
+        VM_NEXT();
+
+    VM_END
+
+#undef VM_NEXT
+#undef VM_END
+#undef VM_BEGIN
+#undef VM_OP
+#undef VM_DISPATCH
+}
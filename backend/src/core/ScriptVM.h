@@ -0,0 +1,139 @@
+/**
+ * ScriptVM.h
+ *
+ * 交互脚本虚拟机 - 执行由 ScriptCompiler 编译的寄存器式字节码
+ *
+ * 【文件作用】：
+ * 1. 定义字节码格式（指令、常量符号表）和脚本对宿主的接口（ScriptHost）
+ * 2. 解释执行：GCC/Clang下使用computed goto分派（每条指令末尾直接跳到下一条的处理代码），
+ *    其他编译器退回switch
+ *
+ * 【性能要点】：
+ * - 寄存器放在栈上的定长数组里，执行过程不分配内存
+ * - 指令定长8字节，符号（物品ID、属性名、台词）编译时放入常量表，运行时按下标取用
+ * - 语言没有循环（只有条件跳转且只向前跳），脚本必然在指令数步之内结束，不需要步数限制
+ *
+ * 【线程】：Script编译后只读，可以被多个线程同时执行
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 操作码列表（X宏：枚举和分派表由同一份列表生成，保证顺序一致）
+ */
+#define SCRIPT_OPCODES(X) \
+    X(Halt)          /* 结束 */                                     \
+    X(LoadK)         /* r[a] = imm */                               \
+    X(Move)          /* r[a] = r[b] */                              \
+    X(Add)           /* r[a] = r[b] + r[c] */                       \
+    X(Sub)           /* r[a] = r[b] - r[c] */                       \
+    X(Mul)           /* r[a] = r[b] * r[c] */                       \
+    X(Div)           /* r[a] = r[b] / r[c]（除数为0时结果为0） */     \
+    X(Mod)           /* r[a] = r[b] % r[c]（除数为0时结果为0） */     \
+    X(AddK)          /* r[a] = r[b] + imm */                        \
+    X(Neg)           /* r[a] = -r[b] */                             \
+    X(Not)           /* r[a] = !r[b] */                             \
+    X(Eq)            /* r[a] = r[b] == r[c] */                      \
+    X(Ne)            /* r[a] = r[b] != r[c] */                      \
+    X(Lt)            /* r[a] = r[b] < r[c] */                       \
+    X(Le)            /* r[a] = r[b] <= r[c] */                      \
+    X(Jump)          /* ip = imm */                                 \
+    X(JumpIfFalse)   /* if (!r[a]) ip = imm */                      \
+    X(JumpIfTrue)    /* if (r[a]) ip = imm */                       \
+    X(GetAttr)       /* r[a] = 属性 symbols[imm] */                  \
+    X(SetAttr)       /* 属性 symbols[imm] = r[a] */                  \
+    X(HasItem)       /* r[a] = 持有物品 symbols[imm] */              \
+    X(KnowsInsight)  /* r[a] = 已获得洞察 symbols[imm] */            \
+    X(HasFlag)       /* r[a] = 已解锁剧情标记 symbols[imm] */         \
+    X(GiveItem)      /* 获得物品 symbols[imm] */                     \
+    X(TakeItem)      /* 失去物品 symbols[imm] */                     \
+    X(GainInsight)   /* 获得洞察 symbols[imm] */                     \
+    X(SetFlag)       /* 解锁剧情标记 symbols[imm] */                  \
+    X(Say)           /* 输出一段文字 symbols[imm] */                  \
+    X(Goto)          /* 转到对话节点 symbols[imm] */
+
+/**
+ * 操作码
+ */
+enum class ScriptOp : uint8_t {
+#define SCRIPT_OPCODE_ENUM(name) name,
+    SCRIPT_OPCODES(SCRIPT_OPCODE_ENUM)
+#undef SCRIPT_OPCODE_ENUM
+    Count
+};
+
+/**
+ * 指令（定长8字节）
+ */
+struct ScriptInstruction {
+    ScriptOp op;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    int32_t imm;
+};
+
+static_assert(sizeof(ScriptInstruction) == 8, "ScriptInstruction must stay 8 bytes");
+
+/**
+ * 编译好的脚本（只读）
+ */
+struct Script {
+    static constexpr int kMaxRegisters = 64;
+
+    std::vector<ScriptInstruction> code;    // 以Halt结尾
+    std::vector<std::string> symbols;       // 常量符号表
+    uint8_t registerCount = 0;
+    std::string source;                     // 原始脚本文本（调试用）
+
+    /**
+     * 反汇编（调试、基准工具输出）
+     */
+    std::string disassemble() const;
+};
+
+/**
+ * 脚本宿主接口 - 脚本通过它读写玩家状态
+ * 【说明】：由执行脚本的一方实现（APIHandler、基准工具）
+ */
+class ScriptHost {
+public:
+    virtual ~ScriptHost() = default;
+
+    virtual int getAttribute(const std::string& name) = 0;
+    virtual void setAttribute(const std::string& name, int value) = 0;
+    virtual bool hasItem(const std::string& itemId) = 0;
+    virtual bool knowsInsight(const std::string& insightId) = 0;
+    virtual bool hasFlag(const std::string& flag) = 0;
+    virtual void giveItem(const std::string& itemId) = 0;
+    virtual void takeItem(const std::string& itemId) = 0;
+    virtual void gainInsight(const std::string& insightId) = 0;
+    virtual void setFlag(const std::string& flag) = 0;
+    virtual void say(const std::string& text) = 0;
+    virtual void gotoDialogue(const std::string& dialogueId) = 0;
+};
+
+/**
+ * 字节码解释器（纯静态接口）
+ */
+class ScriptVM {
+public:
+    /**
+     * 执行脚本
+     */
+    static void execute(const Script& script, ScriptHost& host);
+
+    /**
+     * 当前构建使用的分派方式（"computed-goto" / "switch"）
+     */
+    static const char* dispatchMode();
+
+    /**
+     * 操作码名称
+     */
+    static const char* opName(ScriptOp op);
+};
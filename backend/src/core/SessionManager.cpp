@@ -0,0 +1,512 @@
+/**
+ * SessionManager.cpp
+ *
+ * 会话管理器实现
+ */
+
+#include "SessionManager.h"
+#include "APIHandler.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "Replication.h"
+#include "WebSocketFrame.h"
+#include "utils/SecureRandom.h"
+#include "utils/SimpleJson.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace {
+
+    // 单个批量信封中最多的命令数
+    constexpr size_t kMaxBatchCommands = 64;
+
+    /**
+     * 生成协议错误响应
+     */
+    std::string makeProtocolError(const std::string& errorMessage) {
+        return "{\"type\":\"error\",\"data\":{\"errorMessage\":" + SimpleJson::quote(errorMessage) + "}}";
+    }
+
+} // namespace
+
+Session::Session(const std::string& sessionId)
+    : id(sessionId)
+    , handler(std::make_unique<APIHandler>())
+    , createdAt(std::chrono::steady_clock::now())
+    , lastActive(createdAt) {
+}
+
+Session::Session(Session&& other) noexcept = default;
+
+Session::~Session() = default;
+
+SessionManager::SessionManager() : nextSessionNumber(0) {
+    std::cout << "[SessionManager] 会话管理器已创建" << std::endl;
+
+    Metrics::instance().registerCollector("sessions", [this](Metrics::Samples& out) {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        size_t detached = 0;
+        size_t ringBytes = 0;
+        uint64_t contentAvoided = 0;
+        for (const auto& session : sessions) {
+            detached += session->attached ? 0 : 1;
+            ringBytes += session->outbound.bytes();
+            contentAvoided += session->handler->getContentBytesAvoided();
+        }
+        out["sessions.active"] = static_cast<double>(sessions.size());
+        out["sessions.detached"] = static_cast<double>(detached);
+        out["sessions.outbound_ring_bytes"] = static_cast<double>(ringBytes);
+        out["content.bytes_avoided_per_session"] =
+            sessions.empty() ? 0.0 : static_cast<double>(contentAvoided) / static_cast<double>(sessions.size());
+
+        auto slab = sessionSlab.stats();
+        out["sessions.slab_pages"] = static_cast<double>(slab.pages);
+        out["sessions.slab_bytes"] = static_cast<double>(sessionSlab.mappedBytes());
+        out["sessions.slab_fragmentation"] = slab.fragmentation();
+        out["sessions.slab_reclaimed_bytes"] = static_cast<double>(slab.reclaimedBytes);
+        out["sessions.slab_moves"] = static_cast<double>(slab.moves);
+
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        const SessionStateTable::Summary& summary = stateTable.summary();
+        for (size_t state = 0; state < SessionStateTable::kStateCount; ++state) {
+            std::string name = SessionStateTable::stateName(static_cast<GameStateType>(state));
+            out["sessions.state." + name] = static_cast<double>(summary.sessions[state]);
+            out["sessions.state_seconds." + name] = summary.seconds[state];
+        }
+        out["sessions.dialogues_stalled"] = static_cast<double>(summary.stalledDialogues);
+    });
+}
+
+SessionManager::~SessionManager() {
+    Metrics::instance().unregisterCollector("sessions");
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    std::cout << "[SessionManager] 清理 " << sessions.size() << " 个会话" << std::endl;
+
+    MemoryScope scope(MemoryTag::Sessions);
+    for (Session* session : sessions) {
+        sessionSlab.destroy(session);
+    }
+    sessions.clear();
+    sessionIds.clear();
+    resumeTokens.clear();
+}
+
+std::string SessionManager::createSession() {
+    MemoryScope scope(MemoryTag::Sessions);
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    std::string sessionId = "session_" + std::to_string(++nextSessionNumber);
+    Session& created = insertSession(sessionId, generateResumeToken());
+    ReplicationPrimary::instance().recordCreate(sessionId, created.resumeToken);
+
+    static auto& createdCounter = Metrics::instance().counter("sessions.created");
+    createdCounter.fetch_add(1, std::memory_order_relaxed);
+
+    return sessionId;
+}
+
+bool SessionManager::restoreSession(const std::string& sessionId, const std::string& resumeToken) {
+    MemoryScope scope(MemoryTag::Sessions);
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (findSession(sessionId).valid()) {
+        return false;
+    }
+    insertSession(sessionId, resumeToken);
+
+    // 接管后新建的会话ID不能与复制来的会话冲突
+    const char* prefix = "session_";
+    if (sessionId.compare(0, std::strlen(prefix), prefix) == 0) {
+        uint64_t number = std::strtoull(sessionId.c_str() + std::strlen(prefix), nullptr, 10);
+        nextSessionNumber = std::max(nextSessionNumber, number);
+    }
+    return true;
+}
+
+// 创建会话并建立索引（调用方持有sessionMutex）
+Session& SessionManager::insertSession(const std::string& sessionId, const std::string& resumeToken) {
+    Session* session = sessionSlab.create(sessionId);
+    if (!session) {
+        throw std::bad_alloc();
+    }
+    session->handler->setPlayerId(sessionId);
+    session->resumeToken = resumeToken;
+    Session& created = *session;
+    created.handle = sessions.insert(session);
+    sessionIds.assign(sessionId, created.handle);
+    if (!created.resumeToken.empty()) {
+        resumeTokens.assign(created.resumeToken, created.handle);
+    }
+
+    std::lock_guard<std::mutex> stateLock(stateMutex);
+    stateTable.add(created.handle, GameStateType::EXPLORING);
+    return created;
+}
+
+void SessionManager::detachAllSessions() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    std::lock_guard<std::mutex> stateLock(stateMutex);
+    for (auto& session : sessions) {
+        session->attached = false;
+        session->detachedAt = now;
+        stateTable.setAttached(session->handle, false);
+    }
+}
+
+bool SessionManager::removeSession(const std::string& sessionId) {
+    MemoryScope scope(MemoryTag::Sessions);
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    SessionHandle handle = findSession(sessionId);
+    if (!sessions.contains(handle)) {
+        return false;
+    }
+    eraseSession(handle);
+    return true;
+}
+
+// 删除会话及其索引（调用方持有sessionMutex）
+void SessionManager::eraseSession(SessionHandle handle) {
+    const Session& session = **sessions.get(handle);
+    ReplicationPrimary::instance().recordRemove(session.id);
+    sessionIds.erase(session.id);
+    resumeTokens.erase(session.resumeToken);
+    {
+        std::lock_guard<std::mutex> poisonLock(poisonMutex);
+        poisonedSessions.erase(handle.bits());
+    }
+    {
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        stateTable.remove(handle);
+    }
+    Session* stored = *sessions.get(handle);
+    sessions.erase(handle);
+    sessionSlab.destroy(stored);
+}
+
+SessionHandle SessionManager::findSession(const std::string& sessionId) const {
+    SessionHandle handle;
+    sessionIds.find(sessionId, handle);
+    return handle;
+}
+
+std::string SessionManager::handleMessage(const std::string& sessionId, const std::string& rawMessage) {
+    SessionHandle handle = findSession(sessionId);
+    if (!handle.valid()) {
+        std::cerr << "[SessionManager] 错误: 会话不存在: " << sessionId << std::endl;
+        return "";
+    }
+    return handleMessage(handle, rawMessage);
+}
+
+std::string SessionManager::handleMessage(SessionHandle handle, const std::string& rawMessage) {
+    static auto& skipped = Metrics::instance().counter("sessions.poisoned_messages");
+    static auto& stale = Metrics::instance().counter("sessions.stale_handles");
+    MemoryScope scope(MemoryTag::Sessions);
+
+    if (isPoisoned(handle)) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return makeProtocolError("会话已被隔离（处理时曾卡住服务器），请刷新页面开始新会话");
+    }
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto* found = sessions.get(handle);
+    if (!found) {
+        stale.fetch_add(1, std::memory_order_relaxed);
+        return "";
+    }
+
+    Session& session = **found;
+    session.lastActive = std::chrono::steady_clock::now();
+    ++session.messagesHandled;
+    ReplicationPrimary::instance().recordMessage(session.id, rawMessage);
+
+    std::string response = dispatchMessage(session, rawMessage);
+    recordActivity(session);
+    return response;
+}
+
+std::string SessionManager::dispatchMessage(Session& session, const std::string& rawMessage) {
+    // 不带ID的单条命令保持原来的处理方式，不需要解析
+    if (rawMessage.find("\"id\"") == std::string::npos && rawMessage.find("\"commands\"") == std::string::npos) {
+        return session.handler->handleMessage(rawMessage);
+    }
+
+    SimpleJson::Value message;
+    std::string error;
+    if (!SimpleJson::parse(rawMessage, message, &error, APIHandler::kMaxMessageKeys) || !message.isObject()) {
+        if (error.compare(0, 20, "too many object keys") == 0) {
+            return makeProtocolError("Too many keys in message (max " + std::to_string(APIHandler::kMaxMessageKeys) + ")");
+        }
+        return session.handler->handleMessage(rawMessage);
+    }
+
+    const SimpleJson::Value* commands = message.find("commands");
+    if (commands && commands->isArray()) {
+        return executeBatch(session, message);
+    }
+    return executeCommand(session, message);
+}
+
+// 处理消息后更新会话在状态表中的位置（有进行中的对话即为对话状态）
+void SessionManager::recordActivity(const Session& session) {
+    GameStateType state = session.handler->getCurrentDialogue().empty() ? GameStateType::EXPLORING
+                                                                         : GameStateType::DIALOGUE;
+    std::lock_guard<std::mutex> stateLock(stateMutex);
+    stateTable.transition(session.handle, state);
+    stateTable.touch(session.handle);
+}
+
+void SessionManager::updateSessionStates(float deltaTime) {
+    std::lock_guard<std::mutex> stateLock(stateMutex);
+    stateTable.update(deltaTime);
+}
+
+// acknowledgeSilent：处理器没有响应的命令（如cacheManifest）改为返回ack，批量结果里每条命令都占一项
+std::string SessionManager::executeCommand(Session& session, SimpleJson::Value command, bool acknowledgeSilent) {
+    static auto& executed = Metrics::instance().counter("commands.executed");
+
+    // 命令ID由客户端分配，原样写回响应；交给处理器的命令保持原来的格式
+    std::string commandId;
+    if (const SimpleJson::Value* id = command.find("id")) {
+        commandId = id->dump();
+        command.erase("id");
+    }
+
+    std::string response = session.handler->handleMessage(command.dump());
+    executed.fetch_add(1, std::memory_order_relaxed);
+    if (response.empty() && acknowledgeSilent) {
+        response = "{\"type\":\"ack\"}";
+    }
+
+    if (commandId.empty()) {
+        return response;
+    }
+    return SimpleJson::prependField(response, "id", commandId);
+}
+
+std::string SessionManager::executeBatch(Session& session, const SimpleJson::Value& envelope) {
+    static auto& batches = Metrics::instance().counter("commands.batches");
+    static auto& batchedCommands = Metrics::instance().counter("commands.batched");
+
+    const auto& commands = envelope["commands"].items();
+    std::string batchId = envelope.find("id") ? envelope["id"].dump() : "";
+
+    std::string response = "{\"type\":\"batchResult\",";
+    if (!batchId.empty()) {
+        response += "\"id\":" + batchId + ",";
+    }
+
+    if (commands.size() > kMaxBatchCommands) {
+        response += "\"results\":[" +
+            makeProtocolError("Too many commands in batch (max " + std::to_string(kMaxBatchCommands) + ")") + "]}";
+        return response;
+    }
+
+    // 按顺序执行，整个批次持有一次会话锁，中间不会插入其他消息
+    response += "\"results\":[";
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (i > 0) {
+            response += ',';
+        }
+        if (!commands[i].isObject()) {
+            response += makeProtocolError("Batch entry is not an object");
+            continue;
+        }
+        response += executeCommand(session, commands[i], true);
+    }
+    response += "]}";
+
+    batches.fetch_add(1, std::memory_order_relaxed);
+    batchedCommands.fetch_add(static_cast<int64_t>(commands.size()), std::memory_order_relaxed);
+    return response;
+}
+
+std::string SessionManager::getResumeToken(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    const auto* found = sessions.get(findSession(sessionId));
+    return found ? (*found)->resumeToken : std::string();
+}
+
+OutboundRing::Frame SessionManager::encodeOutbound(const std::string& sessionId, const std::string& message) {
+    return encodeOutbound(findSession(sessionId), message);
+}
+
+OutboundRing::Frame SessionManager::encodeOutbound(SessionHandle handle, const std::string& message) {
+    MemoryScope scope(MemoryTag::Sessions);
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto* found = sessions.get(handle);
+    if (!found) {
+        return std::make_shared<const std::string>(
+            WebSocketFrame::encodeFrame(WebSocketFrame::Opcode::Text, message));
+    }
+
+    Session& session = **found;
+    ReplicationPrimary::instance().recordOutbound(session.id, message);
+    uint64_t sequence = session.nextSequence++;
+    auto frame = std::make_shared<const std::string>(
+        WebSocketFrame::encodeFrame(WebSocketFrame::Opcode::Text,
+                                   SimpleJson::prependField(message, "seq", std::to_string(sequence))));
+    session.outbound.push(sequence, frame);
+    return frame;
+}
+
+SessionManager::ResumeResult SessionManager::resumeSession(const std::string& resumeToken, uint64_t lastSequence,
+                                                           std::string& sessionId,
+                                                           std::vector<OutboundRing::Frame>& replay) {
+    static auto& resumed = Metrics::instance().counter("sessions.resumed");
+    static auto& snapshots = Metrics::instance().counter("sessions.resume_snapshots");
+    static auto& replayedFrames = Metrics::instance().counter("sessions.replayed_frames");
+
+    // 无效令牌在分片表中就被拒绝，不占用会话锁
+    SessionHandle handle;
+    if (!resumeTokens.find(resumeToken, handle)) {
+        return ResumeResult::NotFound;
+    }
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto* found = sessions.get(handle);
+    if (!found) {
+        return ResumeResult::NotFound;  // 查找后会话恰好过期
+    }
+
+    Session& session = **found;
+    session.attached = true;
+    {
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        stateTable.setAttached(handle, true);
+    }
+    session.lastActive = std::chrono::steady_clock::now();
+    sessionId = session.id;
+    resumed.fetch_add(1, std::memory_order_relaxed);
+
+    size_t before = replay.size();
+    if (!session.outbound.collectSince(lastSequence, replay)) {
+        replay.resize(before);
+        snapshots.fetch_add(1, std::memory_order_relaxed);
+        return ResumeResult::SnapshotRequired;
+    }
+    replayedFrames.fetch_add(static_cast<int64_t>(replay.size() - before), std::memory_order_relaxed);
+    return ResumeResult::Replayed;
+}
+
+std::string SessionManager::snapshot(const std::string& sessionId) {
+    MemoryScope scope(MemoryTag::Sessions);
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto* found = sessions.get(findSession(sessionId));
+    return found ? (*found)->handler->getStateSnapshot() : std::string();
+}
+
+std::vector<std::shared_ptr<const std::string>> SessionManager::takePrefetchHints(const std::string& sessionId) {
+    return takePrefetchHints(findSession(sessionId));
+}
+
+std::vector<std::shared_ptr<const std::string>> SessionManager::takePrefetchHints(SessionHandle handle) {
+    if (isPoisoned(handle)) {
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto* found = sessions.get(handle);
+    if (!found) {
+        return {};
+    }
+    return (*found)->handler->takePrefetchHints();
+}
+
+void SessionManager::detachSession(const std::string& sessionId) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto* found = sessions.get(findSession(sessionId));
+    if (found) {
+        (*found)->attached = false;
+        (*found)->detachedAt = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> stateLock(stateMutex);
+        stateTable.setAttached((*found)->handle, false);
+    }
+}
+
+size_t SessionManager::expireDetachedSessions(std::chrono::steady_clock::duration maxDetached) {
+    static auto& expired = Metrics::instance().counter("sessions.expired");
+    MemoryScope scope(MemoryTag::Sessions);
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    size_t removed = 0;
+    // 从后往前：删除时移入空位的是已经检查过的最后一个会话
+    for (size_t position = sessions.size(); position > 0; --position) {
+        SessionHandle handle = sessions.handleAt(position - 1);
+        const Session& session = **sessions.get(handle);
+        if (!session.attached && now - session.detachedAt > maxDetached) {
+            eraseSession(handle);
+            ++removed;
+        }
+    }
+    expired.fetch_add(static_cast<int64_t>(removed), std::memory_order_relaxed);
+    return removed;
+}
+
+std::string SessionManager::generateResumeToken() {
+    // 128位，来自操作系统的密码学安全随机源，十六进制表示
+    std::string token = SecureRandom::hex(16);
+    if (token.empty()) {
+        // 随机源不可用时不签发令牌：会话照常创建，只是不能断线恢复
+        std::cerr << "[SessionManager] 错误: 安全随机源不可用，会话不支持断线恢复" << std::endl;
+    }
+    return token;
+}
+
+bool SessionManager::hasSession(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return sessions.contains(findSession(sessionId));
+}
+
+size_t SessionManager::getSessionCount() const {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return sessions.size();
+}
+
+void SessionManager::forEachSession(const std::function<void(const Session&)>& visitor) const {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    for (const auto& session : sessions) {
+        visitor(*session);
+    }
+}
+
+size_t SessionManager::compactSessions(size_t maxMoves) {
+    MemoryScope scope(MemoryTag::Sessions);
+
+    // 空闲帧里顺手做的事：网络线程正在处理消息时不等待
+    std::unique_lock<std::mutex> lock(sessionMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !sessionSlab.fragmented()) {
+        return 0;
+    }
+    // 槽位表里的指针是会话唯一的间接引用（其他地方都保存句柄或ID）
+    return sessionSlab.compact(maxMoves, [this](Session& moved) {
+        *sessions.get(moved.handle) = &moved;
+    });
+}
+
+void SessionManager::poisonSession(const std::string& sessionId) {
+    SessionHandle handle = findSession(sessionId);
+    if (!handle.valid()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(poisonMutex);
+    poisonedSessions.insert(handle.bits());
+}
+
+bool SessionManager::isPoisoned(const std::string& sessionId) const {
+    return isPoisoned(findSession(sessionId));
+}
+
+bool SessionManager::isPoisoned(SessionHandle handle) const {
+    std::lock_guard<std::mutex> lock(poisonMutex);
+    return !poisonedSessions.empty() && poisonedSessions.count(handle.bits()) > 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * SessionManager.h
+ *
+ * 会话管理器 - 管理每个玩家连接对应的游戏会话
+ *
+ * 【文件作用】：
+ * 1. 为每个连接创建独立的会话（独立的玩家状态和消息处理器）
+ * 2. 按会话ID查找、删除会话
+ * 3. 会话相关的所有内存都记到 MemoryTag::Sessions
+ * 4. 会话恢复：每条出站消息带序号并保存在出站消息环中，
+ *    断线的会话保留一段时间，客户端凭恢复令牌重连后只补发缺失的消息
+ * 5. 会话存放在代际槽位表（SlotMap）中，对外除字符串ID外还提供SessionHandle：
+ *    连接等长期持有的引用保存句柄，会话删除后旧句柄查找失败而不是指向别的会话；
+ *    会话ID、恢复令牌 -> 句柄 的索引是分片并发哈希表，查找不占用会话锁
+ * 6. 按GameStateType分组的会话状态表（SessionStateTable），处理消息后记录状态切换，
+ *    主循环每帧调用updateSessionStates按状态批量更新
+ * 7. 会话对象存放在分页对象池（SlabPool）中；会话不断创建删除留下的空位由
+ *    compactSessions在主循环的空闲帧里增量整理，空页归还给操作系统
+ *
+ * 【线程安全】：所有公共方法都可以从网络线程和主循环线程调用
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "OutboundRing.h"
+#include "SessionStateTable.h"
+#include "utils/ShardedMap.h"
+#include "utils/SlabPool.h"
+#include "utils/SlotMap.h"
+
+class APIHandler;
+
+namespace SimpleJson {
+    class Value;
+}
+
+/**
+ * 游戏会话
+ * 【说明】：一个会话对应一个玩家，持有该玩家的全部游戏状态
+ */
+struct Session {
+    std::string id;                                   // 会话ID
+    SlotHandle handle;                                // 会话在SessionManager中的句柄
+    std::unique_ptr<APIHandler> handler;              // 该玩家的消息处理器（包含玩家状态）
+    std::chrono::steady_clock::time_point createdAt;  // 创建时间
+    std::chrono::steady_clock::time_point lastActive; // 最后活动时间
+    uint64_t messagesHandled = 0;                     // 处理过的客户端消息数
+
+    // 会话恢复
+    std::string resumeToken;                          // 重连时出示的令牌（不可猜测）
+    uint64_t nextSequence = 1;                        // 下一条出站消息的序号
+    OutboundRing outbound;                            // 最近发出的已编码帧
+    bool attached = true;                             // 是否有连接
+    std::chrono::steady_clock::time_point detachedAt; // 断线时间
+
+    explicit Session(const std::string& sessionId);
+    Session(Session&& other) noexcept;                // 整理时移动到另一页
+    ~Session();
+};
+
+/**
+ * 会话句柄（会话删除后失效，同一槽位上的新会话句柄不同）
+ */
+using SessionHandle = SlotHandle;
+
+/**
+ * 会话管理器类
+ */
+class SessionManager {
+public:
+    /**
+     * 会话恢复结果
+     */
+    enum class ResumeResult {
+        NotFound,           // 令牌无效或会话已过期，需要新建会话
+        Replayed,           // 缺失的消息已全部从出站消息环中取出
+        SnapshotRequired    // 缺口超出消息环，需要发送完整快照
+    };
+
+private:
+    SlabPool<Session, MemoryTag::Sessions> sessionSlab;         // 会话对象的存储（由sessionMutex保护）
+    SlotMap<Session*> sessions;                                 // 句柄 -> 池中的会话（由sessionMutex保护）
+    ShardedMap<std::string, SessionHandle> sessionIds;          // 会话ID -> 句柄
+    ShardedMap<std::string, SessionHandle> resumeTokens;        // 恢复令牌 -> 句柄
+    mutable std::mutex sessionMutex;
+    uint64_t nextSessionNumber;
+
+    // 按状态分组的会话（单独加锁：主循环每帧更新时不等待正在处理消息的会话锁）
+    SessionStateTable stateTable;
+    mutable std::mutex stateMutex;
+
+    // 中毒的会话句柄（看门狗发现处理它时卡住）；单独加锁，卡住的线程持有sessionMutex时也能标记
+    std::set<uint64_t> poisonedSessions;
+    mutable std::mutex poisonMutex;
+
+    std::string generateResumeToken();
+    void eraseSession(SessionHandle handle);
+    Session& insertSession(const std::string& sessionId, const std::string& resumeToken);
+    std::string dispatchMessage(Session& session, const std::string& rawMessage);
+    void recordActivity(const Session& session);
+    std::string executeCommand(Session& session, SimpleJson::Value command, bool acknowledgeSilent = false);
+    std::string executeBatch(Session& session, const SimpleJson::Value& envelope);
+
+public:
+    SessionManager();
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    /**
+     * 创建新会话
+     * 【返回】：新会话的ID
+     */
+    std::string createSession();
+
+    /**
+     * 按复制日志重建会话（备用进程使用，ID和恢复令牌与主服务器相同）
+     * 【返回】：会话已存在时返回false
+     */
+    bool restoreSession(const std::string& sessionId, const std::string& resumeToken);
+
+    /**
+     * 把所有会话标记为断线（备用进程接管时调用，之后等待客户端凭令牌重连）
+     */
+    void detachAllSessions();
+
+    /**
+     * 删除会话
+     * 【返回】：会话存在并被删除时返回true
+     */
+    bool removeSession(const std::string& sessionId);
+
+    /**
+     * 按会话ID查找句柄（不获取会话锁，网络线程可以随时调用）
+     * 【返回】：会话不存在时返回无效句柄
+     */
+    SessionHandle findSession(const std::string& sessionId) const;
+
+    /**
+     * 把一条客户端消息交给会话处理
+     * 【消息格式】：
+     *   - 单条命令：{"action": ..., "data": ...}，可带客户端分配的 "id"，响应中原样带回
+     *   - 批量信封：{"id": ..., "commands": [命令, ...]}，按顺序执行，
+     *     返回一条 {"type": "batchResult", "id": ..., "results": [响应, ...]}
+     * 【返回】：响应消息；会话不存在时返回空字符串
+     */
+    std::string handleMessage(const std::string& sessionId, const std::string& rawMessage);
+    std::string handleMessage(SessionHandle handle, const std::string& rawMessage);
+
+    /**
+     * 获取会话的恢复令牌
+     * 【返回】：会话不存在时返回空字符串
+     */
+    std::string getResumeToken(const std::string& sessionId) const;
+
+    /**
+     * 为出站消息分配序号、编码为WebSocket文本帧并存入出站消息环
+     * 【说明】：序号以 "seq" 字段写在消息对象的最前面
+     * 【返回】：编码后的帧；会话不存在时返回未加序号的帧
+     */
+    OutboundRing::Frame encodeOutbound(const std::string& sessionId, const std::string& message);
+    OutboundRing::Frame encodeOutbound(SessionHandle handle, const std::string& message);
+
+    /**
+     * 凭恢复令牌接管断线的会话
+     * 【参数】：
+     *   - resumeToken: 客户端出示的令牌
+     *   - lastSequence: 客户端最后收到的消息序号
+     *   - sessionId: 返回会话ID
+     *   - replay: Replayed时返回需要补发的帧
+     */
+    ResumeResult resumeSession(const std::string& resumeToken, uint64_t lastSequence,
+                               std::string& sessionId, std::vector<OutboundRing::Frame>& replay);
+
+    /**
+     * 生成会话状态的完整快照（gameState消息）
+     */
+    std::string snapshot(const std::string& sessionId);
+
+    /**
+     * 取出会话待推送的预取消息（连接空闲时调用）
+     */
+    std::vector<std::shared_ptr<const std::string>> takePrefetchHints(const std::string& sessionId);
+    std::vector<std::shared_ptr<const std::string>> takePrefetchHints(SessionHandle handle);
+
+    /**
+     * 连接断开：会话保留，等待重连
+     */
+    void detachSession(const std::string& sessionId);
+
+    /**
+     * 删除断线超过指定时间的会话
+     * 【返回】：删除的会话数
+     */
+    size_t expireDetachedSessions(std::chrono::steady_clock::duration maxDetached);
+
+    /**
+     * 按状态批量更新所有会话（主循环每帧调用）
+     */
+    void updateSessionStates(float deltaTime);
+
+    /**
+     * 整理会话存储：把最稀疏页中的会话移到较满的页，移空的页归还给操作系统
+     * 【参数】：maxMoves - 本次最多移动的会话数（主循环在空闲帧调用，限制单帧耗时）
+     * 【返回】：移动的会话数；会话锁正被占用或碎片不足一页时直接返回0
+     */
+    size_t compactSessions(size_t maxMoves);
+    
+    /**
+     * 把会话标记为中毒：之后它的消息直接返回错误，不再交给处理器，也不再推送预取
+     * 【说明】：由看门狗线程调用，不获取sessionMutex
+     */
+    void poisonSession(const std::string& sessionId);
+
+    bool isPoisoned(const std::string& sessionId) const;
+    bool isPoisoned(SessionHandle handle) const;
+
+    /**
+     * 检查会话是否存在
+     */
+    bool hasSession(const std::string& sessionId) const;
+
+    /**
+     * 获取会话数量
+     */
+    size_t getSessionCount() const;
+
+    /**
+     * 遍历所有会话（持锁执行，回调中不要调用SessionManager的其他方法）
+     */
+    void forEachSession(const std::function<void(const Session&)>& visitor) const;
+};
@@ -0,0 +1,136 @@
+/**
+ * SessionStateTable.cpp
+ *
+ * 会话状态表实现
+ */
+
+#include "SessionStateTable.h"
+
+SessionStateTable::Location* SessionStateTable::locate(SlotHandle session) {
+    if (session.index >= locations.size() || locations[session.index].generation != session.generation ||
+        !session.valid()) {
+        return nullptr;
+    }
+    return &locations[session.index];
+}
+
+const SessionStateTable::Location* SessionStateTable::locate(SlotHandle session) const {
+    return const_cast<SessionStateTable*>(this)->locate(session);
+}
+
+void SessionStateTable::append(SlotHandle session, size_t state, const Record& record) {
+    if (session.index >= locations.size()) {
+        locations.resize(session.index + 1);
+    }
+    Location& location = locations[session.index];
+    location.generation = session.generation;
+    location.state = static_cast<uint8_t>(state);
+    location.position = static_cast<uint32_t>(states[state].size());
+    states[state].push_back(record);
+}
+
+// 从所在数组交换删除，返回原来的数据
+SessionStateTable::Record SessionStateTable::detach(Location& location) {
+    std::vector<Record>& records = states[location.state];
+    Record record = records[location.position];
+    if (location.position != records.size() - 1) {
+        records[location.position] = records.back();
+        locations[records[location.position].session.index].position = location.position;
+    }
+    records.pop_back();
+    location.generation = 0;
+    return record;
+}
+
+void SessionStateTable::add(SlotHandle session, GameStateType state) {
+    if (locate(session)) {
+        transition(session, state);
+        return;
+    }
+    Record record;
+    record.session = session;
+    append(session, static_cast<size_t>(state), record);
+}
+
+void SessionStateTable::remove(SlotHandle session) {
+    if (Location* location = locate(session)) {
+        detach(*location);
+    }
+}
+
+void SessionStateTable::transition(SlotHandle session, GameStateType state) {
+    Location* location = locate(session);
+    if (!location || location->state == static_cast<uint8_t>(state)) {
+        return;
+    }
+    // 状态内的计时和计数从零开始，连接状态保留
+    Record previous = detach(*location);
+    Record record;
+    record.session = session;
+    record.attached = previous.attached;
+    append(session, static_cast<size_t>(state), record);
+}
+
+void SessionStateTable::touch(SlotHandle session) {
+    if (Location* location = locate(session)) {
+        Record& record = states[location->state][location->position];
+        record.idleSeconds = 0.0f;
+        ++record.actions;
+    }
+}
+
+void SessionStateTable::setAttached(SlotHandle session, bool attached) {
+    if (Location* location = locate(session)) {
+        states[location->state][location->position].attached = attached;
+    }
+}
+
+bool SessionStateTable::stateOf(SlotHandle session, GameStateType& state) const {
+    const Location* location = locate(session);
+    if (!location) {
+        return false;
+    }
+    state = static_cast<GameStateType>(location->state);
+    return true;
+}
+
+void SessionStateTable::update(float deltaTime) {
+    // 所有状态共有的计时
+    for (size_t state = 0; state < kStateCount; ++state) {
+        std::vector<Record>& records = states[state];
+        for (Record& record : records) {
+            record.stateSeconds += deltaTime;
+            record.idleSeconds += deltaTime;
+        }
+        lastSummary.sessions[state] = records.size();
+        lastSummary.seconds[state] += static_cast<double>(deltaTime) * static_cast<double>(records.size());
+    }
+
+    // 对话状态：统计停滞的对话
+    size_t stalled = 0;
+    for (const Record& record : states[static_cast<size_t>(GameStateType::DIALOGUE)]) {
+        stalled += (record.attached && record.idleSeconds > kDialogueStallSeconds) ? 1 : 0;
+    }
+    lastSummary.stalledDialogues = stalled;
+}
+
+const char* SessionStateTable::stateName(GameStateType state) {
+    switch (state) {
+        case GameStateType::MAIN_MENU: return "main_menu";
+        case GameStateType::EXPLORING: return "exploring";
+        case GameStateType::DIALOGUE: return "dialogue";
+        case GameStateType::JOURNAL: return "journal";
+        case GameStateType::INVENTORY: return "inventory";
+        case GameStateType::PAUSE_MENU: return "pause_menu";
+        case GameStateType::SETTINGS: return "settings";
+    }
+    return "unknown";
+}
+
+size_t SessionStateTable::size() const {
+    size_t total = 0;
+    for (const auto& records : states) {
+        total += records.size();
+    }
+    return total;
+}
@@ -0,0 +1,120 @@
+/**
+ * SessionStateTable.h
+ *
+ * 会话状态表 - 按GameStateType分组，每种状态的会话连续存放，每帧按状态批量更新
+ *
+ * 【文件作用】：
+ * 1. 每种GameStateType一个连续数组，元素是该状态下的会话句柄和状态内数据
+ *    （在该状态停留的时间、空闲时间、操作次数）
+ * 2. 每帧对每个数组跑一个紧凑循环（见update），不需要逐个会话跳转到
+ *    各自分配的状态对象
+ * 3. 状态切换 = 从原数组交换删除（最后一个元素移入空位）+ 追加到目标数组，O(1)
+ *
+ * 【定位】：会话句柄的槽位索引 -> (状态, 数组中的位置)，按槽位索引直接寻址
+ *   （SlotMap的槽位索引是紧凑的，这个数组不会比会话数大多少）
+ *
+ * 【线程安全】：不加锁，由SessionManager保护
+ */
+
+#pragma once
+
+#include "core/GameState.h"
+#include "utils/SlotMap.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SessionStateTable {
+public:
+    static constexpr size_t kStateCount = static_cast<size_t>(GameStateType::SETTINGS) + 1;
+
+    // 对话中空闲超过这个时间视为停滞（玩家可能卡在选项上）
+    static constexpr float kDialogueStallSeconds = 120.0f;
+
+    /**
+     * 一个会话在当前状态下的数据
+     */
+    struct Record {
+        SlotHandle session;
+        float stateSeconds = 0.0f;      // 进入当前状态后经过的时间
+        float idleSeconds = 0.0f;       // 最后一次操作后经过的时间
+        uint32_t actions = 0;           // 在当前状态下的操作次数
+        bool attached = true;           // 是否有连接（断线的会话不计入停滞）
+    };
+
+    /**
+     * 每帧更新的汇总结果（供指标使用）
+     */
+    struct Summary {
+        std::array<size_t, kStateCount> sessions{};     // 各状态的会话数
+        std::array<double, kStateCount> seconds{};      // 各状态累计停留的会话·秒
+        size_t stalledDialogues = 0;                    // 停滞的对话数
+    };
+
+    /**
+     * 加入新会话
+     */
+    void add(SlotHandle session, GameStateType state);
+
+    /**
+     * 移除会话
+     */
+    void remove(SlotHandle session);
+
+    /**
+     * 切换状态（状态相同时不做任何事）
+     */
+    void transition(SlotHandle session, GameStateType state);
+
+    /**
+     * 记录一次操作（清零空闲时间）
+     */
+    void touch(SlotHandle session);
+
+    void setAttached(SlotHandle session, bool attached);
+
+    /**
+     * 查询会话的状态
+     * 【返回】：会话不在表中时返回false
+     */
+    bool stateOf(SlotHandle session, GameStateType& state) const;
+
+    /**
+     * 某种状态下的全部会话（连续数组，顺序在删除后会变化）
+     */
+    const std::vector<Record>& sessionsIn(GameStateType state) const {
+        return states[static_cast<size_t>(state)];
+    }
+
+    /**
+     * 按状态批量更新
+     * 【参数】：deltaTime - 距离上次更新的时间间隔（秒）
+     */
+    void update(float deltaTime);
+
+    const Summary& summary() const { return lastSummary; }
+
+    size_t size() const;
+
+    /**
+     * 状态名（指标名使用，如 "exploring"）
+     */
+    static const char* stateName(GameStateType state);
+
+private:
+    struct Location {
+        uint32_t generation = 0;        // 0表示槽位上没有会话
+        uint32_t position = 0;
+        uint8_t state = 0;
+    };
+
+    Location* locate(SlotHandle session);
+    const Location* locate(SlotHandle session) const;
+    void append(SlotHandle session, size_t state, const Record& record);
+    Record detach(Location& location);
+
+    std::array<std::vector<Record>, kStateCount> states;
+    std::vector<Location> locations;    // 槽位索引 -> 位置
+    Summary lastSummary;
+};
@@ -0,0 +1,263 @@
+/**
+ * StartupPlan.cpp
+ *
+ * 启动计划实现
+ */
+
+#include "StartupPlan.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+    constexpr size_t kMaxThreads = 8;
+    constexpr size_t kBarWidth = 40;
+    constexpr size_t kNone = static_cast<size_t>(-1);
+
+} // namespace
+
+void StartupPlan::add(const std::string& name, const std::vector<std::string>& after, Step step, bool required) {
+    Entry entry;
+    entry.name = name;
+    entry.step = std::move(step);
+    entry.required = required;
+    size_t index = entries.size();
+    for (const auto& dependency : after) {
+        size_t from = indexOf(dependency);
+        if (from == kNone) {
+            // 依赖必须先添加（这也保证了不会有环）；写错的依赖让这个步骤直接跳过
+            std::cerr << "[Startup] 步骤 " << name << " 依赖的步骤不存在: " << dependency << std::endl;
+            entry.status = Status::Skipped;
+            entry.blocked = true;
+            continue;
+        }
+        entries[from].dependents.push_back(index);
+        ++entry.dependencies;
+    }
+    entries.push_back(std::move(entry));
+}
+
+void StartupPlan::addFinal(const std::string& name, Step step, bool required) {
+    Entry entry;
+    entry.name = name;
+    entry.step = std::move(step);
+    entry.required = required;
+    entry.final = true;
+    entries.push_back(std::move(entry));
+}
+
+// 执行一个步骤并记录时间（不持有计划的锁）
+bool StartupPlan::execute(Entry& entry, size_t thread, std::chrono::steady_clock::time_point begin) {
+    auto micros = [begin]() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    };
+    entry.thread = thread;
+    entry.startMicros = micros();
+    bool succeeded = false;
+    try {
+        succeeded = entry.step();
+    } catch (const std::exception& e) {
+        std::cerr << "[Startup] 步骤 " << entry.name << " 抛出异常: " << e.what() << std::endl;
+    }
+    entry.endMicros = micros();
+    return succeeded;
+}
+
+size_t StartupPlan::indexOf(const std::string& name) const {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].name == name) {
+            return i;
+        }
+    }
+    return kNone;
+}
+
+StartupPlan::Status StartupPlan::statusOf(const std::string& name) const {
+    size_t index = indexOf(name);
+    return index == kNone ? Status::Skipped : entries[index].status;
+}
+
+bool StartupPlan::run(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::min<size_t>(kMaxThreads, std::thread::hardware_concurrency()));
+    }
+    threadCount = threads;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<size_t> ready;
+    size_t settled = 0;
+    size_t graphSize = 0;
+    for (const auto& entry : entries) {
+        graphSize += entry.final ? 0 : 1;
+    }
+
+    // 步骤结束（或被跳过）后：失败时跳过所有依赖它的步骤，成功时依赖全部完成的步骤进入就绪队列；
+    // 被跳过的步骤记下起因是不是必需步骤失败，只因可选步骤未完成而跳过的必需步骤不让启动失败
+    std::function<void(size_t)> settle = [&](size_t index) {
+        ++settled;
+        const Entry& current = entries[index];
+        for (size_t dependent : current.dependents) {
+            Entry& next = entries[dependent];
+            if (next.status != Status::Pending) {
+                continue;
+            }
+            if (current.status != Status::Done) {
+                next.status = Status::Skipped;
+                next.blocked = current.status == Status::Failed ? current.required : current.blocked;
+                settle(dependent);
+            } else if (--next.dependencies == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<size_t> invalid;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].status == Status::Skipped) {
+                invalid.push_back(i);
+            }
+        }
+        for (size_t index : invalid) {
+            settle(index);
+        }
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (!entries[i].final && entries[i].status == Status::Pending && entries[i].dependencies == 0) {
+                ready.push_back(i);
+            }
+        }
+    }
+
+    auto worker = [&](size_t thread) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            changed.wait(lock, [&] { return !ready.empty() || settled == graphSize; });
+            if (ready.empty()) {
+                return;
+            }
+            size_t index = ready.front();
+            ready.pop_front();
+            Entry& entry = entries[index];
+            if (entry.status != Status::Pending) {
+                continue;   // 排队期间因为另一个依赖失败而被跳过
+            }
+            lock.unlock();
+            bool succeeded = execute(entry, thread, begin);
+            lock.lock();
+            entry.status = succeeded ? Status::Done : Status::Failed;
+            settle(index);
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);  // 调用线程也执行步骤
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    bool ok = true;
+    for (const auto& entry : entries) {
+        if (!entry.final && entry.required && entry.status != Status::Done &&
+            (entry.status != Status::Skipped || entry.blocked)) {
+            ok = false;
+        }
+    }
+    // 收尾步骤：预热全部结束后依次执行
+    for (auto& entry : entries) {
+        if (!entry.final) {
+            continue;
+        }
+        if (!ok) {
+            entry.status = Status::Skipped;
+            continue;
+        }
+        entry.status = execute(entry, 0, begin) ? Status::Done : Status::Failed;
+        if (entry.required && entry.status != Status::Done) {
+            ok = false;
+        }
+    }
+    totalMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    Metrics& metrics = Metrics::instance();
+    metrics.gauge("startup.ready_ms").store(totalMicros / 1000, std::memory_order_relaxed);
+    for (const auto& entry : entries) {
+        if (entry.status == Status::Done || entry.status == Status::Failed) {
+            metrics.gauge("startup.step_us." + entry.name)
+                .store(entry.endMicros - entry.startMicros, std::memory_order_relaxed);
+        }
+    }
+    return ok;
+}
+
+void StartupPlan::printTimeline(std::ostream& out, uint64_t targetMillis) const {
+    std::vector<const Entry*> ordered;
+    for (const auto& entry : entries) {
+        ordered.push_back(&entry);
+    }
+    // 执行过的按开始时间排列，跳过的放在最后
+    std::stable_sort(ordered.begin(), ordered.end(), [](const Entry* a, const Entry* b) {
+        bool aRan = a->status == Status::Done || a->status == Status::Failed;
+        bool bRan = b->status == Status::Done || b->status == Status::Failed;
+        if (aRan != bRan) {
+            return aRan;
+        }
+        return a->startMicros < b->startMicros;
+    });
+
+    size_t nameWidth = 4;
+    for (const auto& entry : entries) {
+        nameWidth = std::max(nameWidth, entry.name.size());
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Startup] 启动时间线：%.1f ms，%zu 个步骤，%zu 个线程",
+                  static_cast<double>(totalMicros) / 1000.0, entries.size(), threadCount);
+    out << line << std::endl;
+    std::snprintf(line, sizeof(line), "  %-*s %6s %9s %9s  %s", static_cast<int>(nameWidth), "step", "thread",
+                  "start ms", "took ms", "timeline");
+    out << line << std::endl;
+
+    double scale = totalMicros > 0 ? static_cast<double>(kBarWidth) / static_cast<double>(totalMicros) : 0.0;
+    for (const Entry* entry : ordered) {
+        if (entry->status == Status::Skipped) {
+            std::snprintf(line, sizeof(line), "  %-*s %6s %9s %9s  (跳过：依赖的步骤未完成)",
+                          static_cast<int>(nameWidth), entry->name.c_str(), "-", "-", "-");
+            out << line << std::endl;
+            continue;
+        }
+        size_t from = std::min(kBarWidth - 1, static_cast<size_t>(static_cast<double>(entry->startMicros) * scale));
+        size_t to = std::max(from + 1, std::min(kBarWidth, static_cast<size_t>(static_cast<double>(entry->endMicros) * scale + 0.5)));
+        std::string bar(kBarWidth, '.');
+        std::fill(bar.begin() + static_cast<std::ptrdiff_t>(from), bar.begin() + static_cast<std::ptrdiff_t>(to), '#');
+        std::snprintf(line, sizeof(line), "  %-*s %6zu %9.1f %9.1f  |%s|%s",
+                      static_cast<int>(nameWidth), entry->name.c_str(), entry->thread,
+                      static_cast<double>(entry->startMicros) / 1000.0,
+                      static_cast<double>(entry->endMicros - entry->startMicros) / 1000.0, bar.c_str(),
+                      entry->status == Status::Failed ? (entry->required ? " 失败" : " 未完成（可选）") : "");
+        out << line << std::endl;
+    }
+
+    if (targetMillis > 0) {
+        uint64_t readyMillis = static_cast<uint64_t>(totalMicros / 1000);
+        if (readyMillis > targetMillis) {
+            out << "[Startup] 警告: 启动用时 " << readyMillis << " ms，超过目标 " << targetMillis << " ms" << std::endl;
+        } else {
+            out << "[Startup] 启动用时在目标 " << targetMillis << " ms 以内" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * StartupPlan.h
+ *
+ * 启动计划 - 初始化步骤按依赖关系组成有向无环图，互不依赖的步骤并行执行，并记录时间线
+ *
+ * 【文件作用】：
+ * 1. 每个步骤有名字、依赖的步骤和执行函数；依赖全部完成后进入就绪队列，由工作线程取出执行
+ * 2. 记录每个步骤在哪个线程上、从何时开始到何时结束（相对计划开始的时间）
+ * 3. 结束后打印时间线（每个步骤一行，条形图表示在总时长中的位置），
+ *    并发布指标 startup.ready_ms、startup.step_us.<步骤名>
+ *
+ * 【收尾步骤】：addFinal添加的步骤在所有其他步骤结束（无论成败）之后按添加顺序在调用线程上执行，
+ *   例如开始监听端口：服务器只在预热全部完成后才接受连接
+ *
+ * 【失败】：
+ * - 必需步骤失败（返回false或抛出异常）：依赖它的步骤跳过，run返回false
+ * - 可选步骤失败：依赖它的步骤跳过，其余步骤照常执行（例如没有世界数据时使用内置演示内容）；
+ *   因此跳过的步骤即使是必需的也不让run返回false，只有写错依赖名或必需步骤失败引起的跳过才会
+ *
+ * 【使用】：
+ *   StartupPlan plan;
+ *   plan.add("world", {}, [] { return WorldData::loadGlobal(); }, false);
+ *   plan.add("content", {"world"}, [] { ...; return true; });
+ *   bool ok = plan.run(4);
+ *   plan.printTimeline(std::cout);
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class StartupPlan {
+public:
+    using Step = std::function<bool()>;
+
+    /**
+     * 步骤状态
+     */
+    enum class Status {
+        Pending,
+        Done,
+        Failed,
+        Skipped     // 依赖的步骤失败或被跳过
+    };
+
+    /**
+     * 添加步骤
+     * 【参数】：
+     *   - name: 步骤名（唯一）
+     *   - after: 依赖的步骤名（必须已经添加）
+     *   - step: 执行函数，返回false表示失败
+     *   - required: 失败时是否让整个启动失败
+     */
+    void add(const std::string& name, const std::vector<std::string>& after, Step step, bool required = true);
+
+    /**
+     * 添加收尾步骤（在所有DAG步骤结束后依次执行；之前有必需步骤失败时跳过）
+     */
+    void addFinal(const std::string& name, Step step, bool required = true);
+
+    /**
+     * 执行所有步骤（阻塞到全部结束）
+     * 【参数】：threads - 工作线程数（0表示按CPU核数，最多8个）
+     * 【返回】：所有必需步骤都成功时返回true
+     */
+    bool run(size_t threads = 0);
+
+    /**
+     * 打印时间线
+     * 【参数】：targetMillis - 启动时间目标（0表示不比较）
+     */
+    void printTimeline(std::ostream& out, uint64_t targetMillis = 0) const;
+
+    /**
+     * 从run开始到最后一个步骤结束的时间
+     */
+    std::chrono::microseconds elapsed() const { return std::chrono::microseconds(totalMicros); }
+
+    Status statusOf(const std::string& name) const;
+
+private:
+    struct Entry {
+        std::string name;
+        std::vector<size_t> dependents;
+        size_t dependencies = 0;
+        Step step;
+        bool required = true;
+        bool final = false;
+        Status status = Status::Pending;
+        bool blocked = false;       // 跳过的起因是必需步骤失败（或依赖名写错）
+        int64_t startMicros = 0;
+        int64_t endMicros = 0;
+        size_t thread = 0;
+    };
+
+    size_t indexOf(const std::string& name) const;
+    bool execute(Entry& entry, size_t thread, std::chrono::steady_clock::time_point begin);
+
+    std::vector<Entry> entries;
+    int64_t totalMicros = 0;
+    size_t threadCount = 0;
+};
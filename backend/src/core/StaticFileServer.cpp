@@ -0,0 +1,363 @@
+/**
+ * StaticFileServer.cpp
+ *
+ * 静态资源服务实现
+ */
+
+#include "StaticFileServer.h"
+#include "MemoryTracker.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef TIME_ARTIFACTS_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // 内存生成gzip版本的最小文件大小（更小的文件压缩收益不明显）
+    constexpr size_t kMinCompressSize = 512;
+
+    bool readFile(const std::string& path, std::string& content) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    bool endsWith(const std::string& value, const std::string& suffix) {
+        return value.size() >= suffix.size() &&
+               value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /**
+     * 解析Accept-Encoding中某个编码是否可接受（q=0视为拒绝）
+     */
+    bool acceptsEncoding(const HttpRequest& request, const std::string& encoding) {
+        std::string value = Http::toLower(request.header("accept-encoding"));
+        size_t start = 0;
+        while (start < value.size()) {
+            size_t comma = value.find(',', start);
+            if (comma == std::string::npos) {
+                comma = value.size();
+            }
+            std::string item = value.substr(start, comma - start);
+            start = comma + 1;
+
+            size_t semicolon = item.find(';');
+            std::string name = item.substr(0, semicolon);
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (name != encoding && name != "*") {
+                continue;
+            }
+            if (semicolon != std::string::npos) {
+                size_t q = item.find("q=", semicolon);
+                if (q != std::string::npos && std::atof(item.c_str() + q + 2) <= 0.0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+#ifdef TIME_ARTIFACTS_HAS_ZLIB
+    bool gzipCompress(const std::string& input, std::string& output) {
+        z_stream stream{};
+        // windowBits 15 + 16 = gzip封装
+        if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        stream.avail_out = static_cast<uInt>(output.size());
+        int result = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        return result == Z_STREAM_END;
+    }
+#endif
+
+} // namespace
+
+StaticFileServer::StaticFileServer(const std::string& root, size_t cacheLimit)
+    : rootDirectory(root)
+    , cacheFileLimit(cacheLimit)
+    , cachedBytes(0) {
+}
+
+bool StaticFileServer::initialize() {
+    MemoryScope memoryScope(MemoryTag::Network);
+
+    std::error_code ec;
+    if (rootDirectory.empty() || !fs::is_directory(rootDirectory, ec)) {
+        std::cerr << "[StaticFiles] 前端目录不存在: " << rootDirectory << std::endl;
+        return false;
+    }
+
+    assets.clear();
+    cachedBytes = 0;
+
+    for (auto it = fs::recursive_directory_iterator(rootDirectory, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        std::string filePath = it->path().string();
+        // 预压缩文件作为原文件的变体加载，不单独暴露
+        if (endsWith(filePath, ".gz") || endsWith(filePath, ".br")) {
+            continue;
+        }
+
+        std::string relative = fs::relative(it->path(), rootDirectory, ec).generic_string();
+        if (ec || relative.empty() || relative[0] == '.') {
+            continue;
+        }
+        loadAsset("/" + relative, filePath);
+    }
+
+    std::cout << "[StaticFiles] 已加载 " << assets.size() << " 个静态资源，常驻内存 "
+              << cachedBytes << " 字节，目录: " << rootDirectory << std::endl;
+    return true;
+}
+
+bool StaticFileServer::loadAsset(const std::string& urlPath, const std::string& filePath) {
+    std::error_code ec;
+    uint64_t size = fs::file_size(filePath, ec);
+    if (ec) {
+        return false;
+    }
+
+    Asset asset;
+    asset.contentType = contentTypeFor(filePath);
+
+    // identity版本：ETag需要读取内容，小文件顺便缓存
+    std::string content;
+    if (!readFile(filePath, content)) {
+        return false;
+    }
+
+    Variant identity;
+    identity.encoding = "identity";
+    identity.filePath = filePath;
+    identity.size = size;
+    identity.etag = computeEtag(content, identity.encoding);
+    if (size <= cacheFileLimit) {
+        identity.cached = std::make_shared<const std::string>(content);
+        cachedBytes += size;
+    }
+    asset.variants.push_back(identity);
+
+    // 磁盘上的预压缩版本：必须比原文件新且更小
+    auto sourceTime = fs::last_write_time(filePath, ec);
+    for (const char* encoding : {"br", "gzip"}) {
+        std::string variantPath = filePath + (std::string(encoding) == "br" ? ".br" : ".gz");
+        if (!fs::is_regular_file(variantPath, ec)) {
+            continue;
+        }
+        if (fs::last_write_time(variantPath, ec) < sourceTime) {
+            std::cout << "[StaticFiles] 警告: 预压缩文件比原文件旧，已忽略: " << variantPath << std::endl;
+            continue;
+        }
+        std::string compressed;
+        if (!readFile(variantPath, compressed) || compressed.size() >= size) {
+            continue;
+        }
+
+        Variant variant;
+        variant.encoding = encoding;
+        variant.filePath = variantPath;
+        variant.size = compressed.size();
+        variant.etag = computeEtag(compressed, encoding);
+        if (variant.size <= cacheFileLimit) {
+            cachedBytes += variant.size;
+            variant.cached = std::make_shared<const std::string>(std::move(compressed));
+        }
+        asset.variants.push_back(std::move(variant));
+    }
+
+#ifdef TIME_ARTIFACTS_HAS_ZLIB
+    // 没有现成.gz的小文件：启动时在内存中压缩一次
+    bool hasGzip = false;
+    for (const auto& variant : asset.variants) {
+        hasGzip = hasGzip || variant.encoding == "gzip";
+    }
+    if (!hasGzip && identity.cached && size >= kMinCompressSize) {
+        std::string compressed;
+        if (gzipCompress(content, compressed) && compressed.size() < size * 9 / 10) {
+            Variant variant;
+            variant.encoding = "gzip";
+            variant.size = compressed.size();
+            variant.etag = computeEtag(compressed, variant.encoding);
+            cachedBytes += variant.size;
+            variant.cached = std::make_shared<const std::string>(std::move(compressed));
+            asset.variants.push_back(std::move(variant));
+        }
+    }
+#else
+    (void)kMinCompressSize;
+#endif
+
+    assets[urlPath] = std::move(asset);
+    return true;
+}
+
+const StaticFileServer::Variant& StaticFileServer::chooseVariant(const Asset& asset, const HttpRequest& request) const {
+    const Variant* best = &asset.variants[0];
+    for (const auto& variant : asset.variants) {
+        if (variant.encoding != "identity" && variant.size < best->size &&
+            acceptsEncoding(request, variant.encoding)) {
+            best = &variant;
+        }
+    }
+    return *best;
+}
+
+StaticResponse StaticFileServer::respond(const HttpRequest& request) const {
+    bool keepAlive = request.keepAlive();
+    bool headOnly = request.method == "HEAD";
+
+    if (request.method != "GET" && !headOnly) {
+        return makeResponse(405, "text/plain; charset=utf-8", "Method Not Allowed\n", keepAlive);
+    }
+
+    std::string path = request.path;
+    if (path.find("..") != std::string::npos || path.find('\\') != std::string::npos) {
+        return makeResponse(403, "text/plain; charset=utf-8", "Forbidden\n", keepAlive, headOnly);
+    }
+    if (!path.empty() && path.back() == '/') {
+        path += "index.html";
+    }
+
+    auto it = assets.find(path);
+    if (it == assets.end()) {
+        return makeResponse(404, "text/plain; charset=utf-8", "Not Found\n", keepAlive, headOnly);
+    }
+
+    const Asset& asset = it->second;
+    const Variant& variant = chooseVariant(asset, request);
+
+    StaticResponse response;
+    std::ostringstream head;
+
+    bool notModified = request.hasToken("if-none-match", variant.etag) ||
+                       request.header("if-none-match") == "*";
+    response.status = notModified ? 304 : 200;
+
+    head << "HTTP/1.1 " << response.status << " " << Http::reasonPhrase(response.status) << "\r\n";
+    head << "ETag: " << variant.etag << "\r\n";
+    head << "Cache-Control: no-cache\r\n";
+    if (asset.variants.size() > 1) {
+        head << "Vary: Accept-Encoding\r\n";
+    }
+    if (!notModified) {
+        head << "Content-Type: " << asset.contentType << "\r\n";
+        head << "Content-Length: " << variant.size << "\r\n";
+        if (variant.encoding != "identity") {
+            head << "Content-Encoding: " << variant.encoding << "\r\n";
+        }
+    }
+    head << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+    response.head = head.str();
+
+    if (!notModified && !headOnly) {
+        if (variant.cached) {
+            response.body = variant.cached;
+        } else {
+            response.filePath = variant.filePath;
+            response.fileSize = variant.size;
+        }
+    }
+    return response;
+}
+
+StaticResponse StaticFileServer::makeResponse(int status, const std::string& contentType,
+                                              const std::string& body, bool keepAlive, bool headOnly) {
+    StaticResponse response;
+    response.status = status;
+
+    std::ostringstream head;
+    head << "HTTP/1.1 " << status << " " << Http::reasonPhrase(status) << "\r\n";
+    head << "Content-Type: " << contentType << "\r\n";
+    head << "Content-Length: " << body.size() << "\r\n";
+    head << "Cache-Control: no-store\r\n";
+    head << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+    response.head = head.str();
+
+    if (!headOnly) {
+        response.body = std::make_shared<const std::string>(body);
+    }
+    return response;
+}
+
+std::string StaticFileServer::locateFrontendRoot() {
+    if (const char* env = std::getenv("TIME_ARTIFACTS_FRONTEND_DIR")) {
+        return env;
+    }
+
+    std::error_code ec;
+    for (const char* candidate : {"frontend", "bin/frontend", "../frontend", "../../frontend", "../../../frontend"}) {
+        if (fs::is_regular_file(fs::path(candidate) / "index.html", ec)) {
+            return fs::absolute(candidate, ec).lexically_normal().string();
+        }
+    }
+    return "";
+}
+
+std::string StaticFileServer::contentTypeFor(const std::string& path) {
+    static const std::map<std::string, std::string> types = {
+        {".html", "text/html; charset=utf-8"},
+        {".htm", "text/html; charset=utf-8"},
+        {".js", "text/javascript; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".json", "application/json; charset=utf-8"},
+        {".svg", "image/svg+xml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".ico", "image/x-icon"},
+        {".woff2", "font/woff2"},
+        {".ogg", "audio/ogg"},
+        {".mp3", "audio/mpeg"},
+        {".wav", "audio/wav"},
+        {".txt", "text/plain; charset=utf-8"}
+    };
+
+    std::string extension = Http::toLower(fs::path(path).extension().string());
+    auto it = types.find(extension);
+    return it != types.end() ? it->second : "application/octet-stream";
+}
+
+std::string StaticFileServer::computeEtag(const std::string& content, const std::string& encoding) {
+    // FNV-1a 64位，内容不变ETag就不变（与文件修改时间无关）
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+
+    std::string etag = "\"";
+    etag += buffer;
+    if (encoding != "identity") {
+        etag += "-" + encoding;
+    }
+    etag += "\"";
+    return etag;
+}
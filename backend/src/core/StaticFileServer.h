@@ -0,0 +1,110 @@
+/**
+ * StaticFileServer.h
+ *
+ * 静态资源服务 - 在游戏端口上直接提供 frontend/ 目录下的页面和脚本
+ *
+ * 【文件作用】：
+ * 1. 启动时扫描前端目录，为每个文件建立资源表（类型、大小、ETag）
+ * 2. 启动时选定预压缩版本（同目录下的 .br / .gz），按 Accept-Encoding 返回最小的可用版本
+ * 3. 小文件常驻内存，多个连接共享同一份只读缓冲；大文件交给 sendfile 零拷贝发送
+ * 4. 强ETag + If-None-Match，未修改时返回304
+ *
+ * 【设计说明】：
+ * - 资源表在启动后只读，请求处理无锁
+ * - 前端文件改动后需要重启服务器才会生效
+ * - 编译时找到zlib的话，会为没有 .gz 的小文件在内存中生成gzip版本
+ */
+
+#pragma once
+
+#include "HttpRequest.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * 静态响应
+ * 【说明】：body和filePath二选一；HEAD请求和304响应两者都为空
+ */
+struct StaticResponse {
+    int status = 404;
+    std::string head;                               // 状态行 + 头部 + 空行
+    std::shared_ptr<const std::string> body;        // 内存中的响应体（共享缓存，不拷贝）
+    std::string filePath;                           // 需要sendfile的文件
+    uint64_t fileSize = 0;                          // 文件响应体大小
+};
+
+/**
+ * 静态资源服务类
+ */
+class StaticFileServer {
+public:
+    /**
+     * 构造函数
+     * 【参数】：
+     *   - rootDirectory: 前端根目录
+     *   - cacheFileLimit: 不超过此大小的文件常驻内存
+     */
+    explicit StaticFileServer(const std::string& rootDirectory, size_t cacheFileLimit = 256 * 1024);
+
+    /**
+     * 扫描目录，建立资源表
+     * 【返回】：目录不存在时返回false
+     */
+    bool initialize();
+
+    /**
+     * 处理请求
+     * 【说明】：只支持GET/HEAD，其余方法返回405
+     */
+    StaticResponse respond(const HttpRequest& request) const;
+
+    /**
+     * 生成一个简单的非静态响应（用于错误页、/metrics等）
+     */
+    static StaticResponse makeResponse(int status, const std::string& contentType,
+                                       const std::string& body, bool keepAlive, bool headOnly = false);
+
+    /**
+     * 查找前端目录
+     * 【顺序】：环境变量 TIME_ARTIFACTS_FRONTEND_DIR → 可执行文件旁的frontend → 源码树中的frontend
+     */
+    static std::string locateFrontendRoot();
+
+    size_t getAssetCount() const { return assets.size(); }
+    size_t getCachedBytes() const { return cachedBytes; }
+    const std::string& getRootDirectory() const { return rootDirectory; }
+
+private:
+    /**
+     * 一个资源的某种编码版本
+     */
+    struct Variant {
+        std::string encoding;                       // "identity"、"gzip"、"br"
+        std::string filePath;                       // 磁盘文件（内存生成的版本为空）
+        uint64_t size = 0;
+        std::string etag;                           // 强ETag（每种编码不同）
+        std::shared_ptr<const std::string> cached;  // 常驻内存的内容
+    };
+
+    /**
+     * 一个URL路径对应的资源
+     */
+    struct Asset {
+        std::string contentType;
+        std::vector<Variant> variants;              // variants[0] 总是identity
+    };
+
+    bool loadAsset(const std::string& urlPath, const std::string& filePath);
+    const Variant& chooseVariant(const Asset& asset, const HttpRequest& request) const;
+
+    static std::string contentTypeFor(const std::string& path);
+    static std::string computeEtag(const std::string& content, const std::string& encoding);
+
+    std::string rootDirectory;
+    size_t cacheFileLimit;
+    size_t cachedBytes;
+    std::map<std::string, Asset> assets;            // URL路径 -> 资源
+};
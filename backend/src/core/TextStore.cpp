@@ -0,0 +1,492 @@
+/**
+ * TextStore.cpp
+ *
+ * 块压缩文本存储实现
+ */
+
+#include "TextStore.h"
+#include "MemoryTracker.h"
+#include "utils/Lz4Block.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <list>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    constexpr size_t kCacheShards = 8;
+    constexpr uint32_t kPinAfterHits = 64;  // 命中这么多次的块提升为常驻
+    constexpr size_t kPinnedShare = 4;      // 常驻块最多占缓存容量的 1/kPinnedShare
+    constexpr size_t kPackPage = 4096;      // 包文件中区域的对齐单位（madvise以页为单位）
+
+    size_t alignToPage(size_t value) {
+        return (value + kPackPage - 1) / kPackPage * kPackPage;
+    }
+
+} // namespace
+
+/**
+ * 分片LRU：按块号取模分片，每个分片一把锁、一条LRU链表
+ */
+class TextStore::BlockCache {
+public:
+    explicit BlockCache(size_t capacity) {
+        for (auto& shard : shards) {
+            shard.capacity = capacity / kCacheShards;
+        }
+    }
+
+    std::shared_ptr<const std::string> find(uint32_t block) {
+        Shard& shard = shards[block % kCacheShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(block);
+        if (it == shard.entries.end()) {
+            return nullptr;
+        }
+        shard.order.splice(shard.order.begin(), shard.order, it->second.position);
+        return it->second.data;
+    }
+
+    void insert(uint32_t block, const std::shared_ptr<const std::string>& data) {
+        Shard& shard = shards[block % kCacheShards];
+        if (data->size() > shard.capacity) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        MemoryScope memoryScope(MemoryTag::TextCache);
+        if (shard.entries.count(block)) {
+            return;
+        }
+        shard.order.push_front(block);
+        shard.entries[block] = {data, shard.order.begin()};
+        shard.bytes += data->size();
+        while (shard.bytes > shard.capacity) {
+            uint32_t victim = shard.order.back();
+            auto it = shard.entries.find(victim);
+            shard.bytes -= it->second.data->size();
+            shard.entries.erase(it);
+            shard.order.pop_back();
+        }
+    }
+
+    void erase(uint32_t block) {
+        Shard& shard = shards[block % kCacheShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(block);
+        if (it != shard.entries.end()) {
+            shard.bytes -= it->second.data->size();
+            shard.order.erase(it->second.position);
+            shard.entries.erase(it);
+        }
+    }
+
+    size_t bytes() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.bytes;
+        }
+        return total;
+    }
+
+private:
+    struct Slot {
+        std::shared_ptr<const std::string> data;
+        std::list<uint32_t>::iterator position;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<uint32_t> order;      // 前端为最近使用
+        std::unordered_map<uint32_t, Slot> entries;
+        size_t bytes = 0;
+        size_t capacity = 0;
+    };
+
+    Shard shards[kCacheShards];
+};
+
+TextStore::TextStore(size_t cacheBytes)
+    : cache(std::make_unique<BlockCache>(cacheBytes)), cacheCapacity(cacheBytes) {
+    entries.push_back({0, 0, 0});   // kEmpty
+}
+
+TextStore::~TextStore() {
+#ifndef _WIN32
+    if (packBase) {
+        munmap(const_cast<char*>(packBase), packLength);
+    }
+#endif
+}
+
+TextId TextStore::add(const std::string& group, const std::string& text) {
+    if (text.empty()) {
+        return kEmpty;
+    }
+    if (sealed) {
+        std::cerr << "[TextStore] 已封存，不能再加入文本" << std::endl;
+        return kEmpty;
+    }
+    auto existing = dedupe.find(text);
+    if (existing != dedupe.end()) {
+        return existing->second;
+    }
+
+    auto index = groupIndex.find(group);
+    if (index == groupIndex.end()) {
+        Group entry;
+        entry.name = group;
+        groups.push_back(std::move(entry));
+        index = groupIndex.emplace(group, static_cast<uint32_t>(groups.size() - 1)).first;
+    }
+
+    Group& target = groups[index->second];
+    entries.push_back({index->second, static_cast<uint32_t>(target.raw.size()), static_cast<uint32_t>(text.size())});
+    target.raw += text;
+
+    TextId id = static_cast<TextId>(entries.size() - 1);
+    dedupe.emplace(text, id);
+    return id;
+}
+
+void TextStore::setGroupRegion(const std::string& group, uint32_t region) {
+    if (sealed || region == kNoRegion) {
+        return;
+    }
+    auto index = groupIndex.find(group);
+    if (index != groupIndex.end()) {
+        groups[index->second].region = region;
+    }
+    if (region >= regions.size()) {
+        regions.resize(region + 1);
+    }
+}
+
+void TextStore::seal() {
+    if (sealed) {
+        return;
+    }
+
+    // 分组按区域排序（同区域内保持加入顺序，无区域的排在最后）
+    std::vector<uint32_t> order(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) {
+        order[g] = static_cast<uint32_t>(g);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return groups[a].region < groups[b].region;
+    });
+
+    // 按分组顺序装块：放不下的分组或换了区域时开启新块；单个分组超过块大小时按块大小切开
+    std::vector<std::string> rawBlocks;
+    std::vector<uint32_t> blockRegions;
+    std::vector<uint32_t> groupStart(groups.size());    // 分组在其第一个块中的起点
+    for (uint32_t g : order) {
+        Group& group = groups[g];
+        if (rawBlocks.empty() || rawBlocks.back().size() + group.raw.size() > kBlockSize ||
+            blockRegions.back() != group.region) {
+            rawBlocks.emplace_back();
+            blockRegions.push_back(group.region);
+        }
+        group.firstBlock = static_cast<uint32_t>(rawBlocks.size() - 1);
+        groupStart[g] = static_cast<uint32_t>(rawBlocks.back().size());
+        rawBlocks.back() += group.raw;
+        while (rawBlocks.back().size() > kBlockSize && group.raw.size() > kBlockSize) {
+            // 大分组：超出部分移到下一块（文本可能跨块，见下方的重定位）
+            std::string overflow = rawBlocks.back().substr(kBlockSize);
+            rawBlocks.back().resize(kBlockSize);
+            rawBlocks.push_back(std::move(overflow));
+            blockRegions.push_back(group.region);
+        }
+        group.lastBlock = static_cast<uint32_t>(rawBlocks.size() - 1);
+    }
+
+    // 文本重定位到块内偏移；跨块的文本（只出现在大分组中）整体放到新块的开头
+    for (size_t id = 1; id < entries.size(); ++id) {
+        Entry& entry = entries[id];
+        const Group& group = groups[entry.block];
+        size_t position = groupStart[entry.block] + entry.offset;
+        uint32_t block = group.firstBlock + static_cast<uint32_t>(position / kBlockSize);
+        uint32_t offset = static_cast<uint32_t>(position % kBlockSize);
+        if (group.firstBlock == group.lastBlock) {
+            block = group.firstBlock;
+            offset = static_cast<uint32_t>(position);
+        } else if (offset + entry.length > kBlockSize) {
+            rawBlocks.push_back(group.raw.substr(entry.offset, entry.length));
+            blockRegions.push_back(group.region);
+            block = static_cast<uint32_t>(rawBlocks.size() - 1);
+            offset = 0;
+        }
+        entry.block = block;
+        entry.offset = offset;
+    }
+
+    blocks.resize(rawBlocks.size());
+    for (size_t i = 0; i < rawBlocks.size(); ++i) {
+        blocks[i].rawLength = static_cast<uint32_t>(rawBlocks[i].size());
+        blocks[i].compressed = Lz4Block::compress(rawBlocks[i]);
+        blocks[i].compressed.shrink_to_fit();
+        blocks[i].data = blocks[i].compressed.data();
+        blocks[i].size = static_cast<uint32_t>(blocks[i].compressed.size());
+        blocks[i].region = blockRegions[i];
+        if (blockRegions[i] != kNoRegion) {
+            regions[blockRegions[i]].blocks.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    for (auto& group : groups) {
+        std::string().swap(group.raw);
+    }
+    std::unordered_map<std::string, TextId>().swap(dedupe);
+
+    pinned.assign(blocks.size(), nullptr);
+    heldPins.assign(blocks.size(), 0);
+    blockHits.reset(new std::atomic<uint32_t>[blocks.size()]);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blockHits[i].store(0, std::memory_order_relaxed);
+    }
+    sealed = true;
+}
+
+std::shared_ptr<const std::string> TextStore::loadBlock(uint32_t block) const {
+    if (auto data = std::atomic_load(&pinned[block])) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return data;
+    }
+
+    if (auto data = cache->find(block)) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        if (blockHits[block].fetch_add(1, std::memory_order_relaxed) + 1 == kPinAfterHits) {
+            promote(block, data);
+        }
+        return data;
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    const Block& source = blocks[block];
+    std::shared_ptr<std::string> data;
+    {
+        MemoryScope memoryScope(MemoryTag::TextCache);
+        data = std::make_shared<std::string>();
+        if (!Lz4Block::decompress(source.data, source.size, source.rawLength, *data)) {
+            std::cerr << "[TextStore] 文本块 " << block << " 解压失败" << std::endl;
+            data->clear();
+            data->resize(source.rawLength, '?');
+        }
+    }
+    if (cacheCapacity > 0) {
+        cache->insert(block, data);
+    }
+    return data;
+}
+
+void TextStore::promote(uint32_t block, const std::shared_ptr<const std::string>& data) const {
+    std::lock_guard<std::mutex> lock(pinMutex);
+    if (std::atomic_load(&pinned[block]) || pinnedBytes + data->size() > cacheCapacity / kPinnedShare) {
+        return;
+    }
+    std::atomic_store(&pinned[block], data);
+    pinnedBytes += data->size();
+    cache->erase(block);
+}
+
+std::string TextStore::get(TextId id) const {
+    if (id == kEmpty || id >= entries.size()) {
+        return std::string();
+    }
+    const Entry& entry = entries[id];
+    if (!sealed) {
+        return groups[entry.block].raw.substr(entry.offset, entry.length);
+    }
+    auto data = loadBlock(entry.block);
+    return data->substr(entry.offset, entry.length);
+}
+
+size_t TextStore::length(TextId id) const {
+    return id < entries.size() ? entries[id].length : 0;
+}
+
+void TextStore::pinGroup(const std::string& group) {
+    auto index = groupIndex.find(group);
+    if (!sealed || index == groupIndex.end()) {
+        return;
+    }
+    const Group& target = groups[index->second];
+    for (uint32_t i = target.firstBlock; i <= target.lastBlock; ++i) {
+        if (std::atomic_load(&pinned[i])) {
+            continue;
+        }
+        std::shared_ptr<const std::string> data = loadBlock(i);
+        std::lock_guard<std::mutex> lock(pinMutex);
+        heldPins[i] = 1;
+        std::atomic_store(&pinned[i], data);
+        pinnedBytes += data->size();
+        cache->erase(i);
+    }
+}
+
+void TextStore::setCacheCapacity(size_t bytes) {
+    cache = std::make_unique<BlockCache>(bytes);
+    cacheCapacity = bytes;
+    std::lock_guard<std::mutex> lock(pinMutex);
+    for (auto& block : pinned) {
+        std::atomic_store(&block, std::shared_ptr<const std::string>());
+    }
+    std::fill(heldPins.begin(), heldPins.end(), 0);
+    pinnedBytes = 0;
+    for (size_t i = 0; sealed && i < blocks.size(); ++i) {
+        blockHits[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+TextStore::Stats TextStore::stats() const {
+    Stats stats;
+    stats.texts = entries.size() - 1;
+    stats.blocks = blocks.size();
+    for (const auto& group : groups) {
+        stats.rawBytes += group.raw.size();
+    }
+    for (const auto& block : blocks) {
+        stats.rawBytes += block.rawLength;
+        stats.compressedBytes += block.size;
+    }
+    stats.packedBytes = packLength;
+    stats.cacheBytes = cache->bytes();
+    {
+        std::lock_guard<std::mutex> lock(pinMutex);
+        stats.pinnedBytes = pinnedBytes;
+    }
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TextStore::resetCounters() {
+    hits.store(0, std::memory_order_relaxed);
+    misses.store(0, std::memory_order_relaxed);
+}
+
+bool TextStore::attachPack(const std::string& path) {
+    if (!sealed || packBase) {
+        return false;
+    }
+#ifdef _WIN32
+    (void)path;
+    std::cerr << "[TextStore] 当前平台不支持包文件映射" << std::endl;
+    return false;
+#else
+    // 布局：[区域0][区域1]...[无区域]，每段按页对齐；块在文件中的位置只记在内存索引里
+    std::vector<uint32_t> order(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return blocks[a].region < blocks[b].region;
+    });
+
+    std::vector<size_t> offsets(blocks.size());
+    size_t position = 0;
+    uint32_t currentRegion = kNoRegion;
+    for (size_t n = 0; n < order.size(); ++n) {
+        const Block& block = blocks[order[n]];
+        if (n == 0 || block.region != currentRegion) {
+            if (n > 0 && currentRegion != kNoRegion) {
+                regions[currentRegion].length = position - regions[currentRegion].offset;
+            }
+            position = alignToPage(position);
+            currentRegion = block.region;
+            if (currentRegion != kNoRegion) {
+                regions[currentRegion].offset = position;
+            }
+        }
+        offsets[order[n]] = position;
+        position += block.size;
+    }
+    if (!order.empty() && currentRegion != kNoRegion) {
+        regions[currentRegion].length = position - regions[currentRegion].offset;
+    }
+    size_t fileLength = std::max<size_t>(position, 1);
+
+    bool temporary = path.empty();
+    std::string filePath = path;
+    if (temporary) {
+        std::error_code ec;
+        filePath = (std::filesystem::temp_directory_path(ec) /
+                    ("time_artifacts_world_" + std::to_string(getpid()) + ".pack")).string();
+    }
+
+    int fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[TextStore] 无法创建包文件: " << filePath << std::endl;
+        return false;
+    }
+    bool written = ftruncate(fd, static_cast<off_t>(fileLength)) == 0;
+    for (size_t i = 0; written && i < blocks.size(); ++i) {
+        written = pwrite(fd, blocks[i].data, blocks[i].size, static_cast<off_t>(offsets[i])) ==
+                  static_cast<ssize_t>(blocks[i].size);
+    }
+    void* mapping = written ? mmap(nullptr, fileLength, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (temporary || mapping == MAP_FAILED) {
+        std::remove(filePath.c_str());
+    }
+    if (mapping == MAP_FAILED) {
+        std::cerr << "[TextStore] 包文件写入或映射失败: " << filePath << std::endl;
+        return false;
+    }
+
+    packBase = static_cast<const char*>(mapping);
+    packLength = fileLength;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].data = packBase + offsets[i];
+        std::string().swap(blocks[i].compressed);
+    }
+    return true;
+#endif
+}
+
+size_t TextStore::pageInRegion(uint32_t region) {
+    if (!packBase || region >= regions.size() || regions[region].length == 0) {
+        return 0;
+    }
+    const Region& target = regions[region];
+#ifndef _WIN32
+    madvise(const_cast<char*>(packBase + target.offset), alignToPage(target.length), MADV_WILLNEED);
+#endif
+    // WILLNEED只是提示；逐页读一个字节，返回时区域确实在内存中
+    volatile char sink = 0;
+    for (size_t page = 0; page < target.length; page += kPackPage) {
+        sink = sink + packBase[target.offset + page];
+    }
+    (void)sink;
+    return target.length;
+}
+
+void TextStore::pageOutRegion(uint32_t region) {
+    if (region >= regions.size()) {
+        return;
+    }
+    const Region& target = regions[region];
+#ifndef _WIN32
+    if (packBase && target.length > 0) {
+        madvise(const_cast<char*>(packBase + target.offset), alignToPage(target.length), MADV_DONTNEED);
+    }
+#endif
+    std::lock_guard<std::mutex> lock(pinMutex);
+    for (uint32_t block : target.blocks) {
+        cache->erase(block);
+        if (heldPins[block]) {
+            continue;
+        }
+        if (auto data = std::atomic_load(&pinned[block])) {
+            pinnedBytes -= data->size();
+            std::atomic_store(&pinned[block], std::shared_ptr<const std::string>());
+        }
+        blockHits[block].store(0, std::memory_order_relaxed);
+    }
+}
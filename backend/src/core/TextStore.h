@@ -0,0 +1,200 @@
+/**
+ * TextStore.h
+ *
+ * 世界文本的块压缩存储 - 场景描述、对话台词、物品描述以LZ4压缩块常驻内存，
+ * 访问时按块解压并放入分片LRU缓存
+ *
+ * 【文件作用】：
+ * 1. 加载世界数据时按分组（通常是场景ID）收集文本；seal()时按分组顺序装入约4KB的块，
+ *    一个分组不会被拆到两个块里（超过块大小的分组独占若干块）。
+ *    同一场景的描述、交互结果、角色台词通常一起被访问，一次解压就能服务整个场景
+ * 2. seal()后压缩所有块并释放原文，之后只读
+ * 3. 解压后的块放入按块号分片的LRU缓存（每个分片一把锁）；访问次数多的块提升为常驻，
+ *    不参与淘汰（常驻块总量不超过缓存容量的1/4）
+ *
+ * 4. 可选的区域分页（见RegionPager）：seal()前为分组指定区域，同一区域的块装在一起；
+ *    attachPack()把压缩块写入包文件并以只读方式mmap，释放堆上的压缩数据。
+ *    之后每个区域在文件中占一段按页对齐的连续范围，可以单独预读（pageInRegion）
+ *    或以madvise(MADV_DONTNEED)交还给内核（pageOutRegion），再次访问时从文件重新读入
+ *
+ * 【内存与CPU的取舍】：缓存越小常驻内存越少，但命中率下降、解压次数上升；
+ *   见 TimeArtifacts --text-cache-report
+ *
+ * 【线程】：seal()之后 get() 可以从任意线程并发调用；pageInRegion/pageOutRegion 也可以与 get() 并发
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 文本编号（0表示空文本）
+ */
+using TextId = uint32_t;
+
+/**
+ * 块压缩文本存储
+ */
+class TextStore {
+public:
+    static constexpr TextId kEmpty = 0;
+    static constexpr size_t kBlockSize = 4 * 1024;
+    static constexpr size_t kDefaultCacheBytes = 4 * 1024 * 1024;
+    static constexpr uint32_t kNoRegion = UINT32_MAX;  // 不属于任何区域（始终可访问，不会换出）
+
+    /**
+     * 运行统计
+     */
+    struct Stats {
+        size_t texts = 0;
+        size_t blocks = 0;
+        size_t rawBytes = 0;            // 原文总字节数
+        size_t compressedBytes = 0;     // 压缩后总字节数（未打包时常驻堆上）
+        size_t packedBytes = 0;         // 包文件大小（已打包时压缩块在mmap中）
+        size_t cacheBytes = 0;          // LRU中已解压的块
+        size_t pinnedBytes = 0;         // 常驻的已解压块
+        uint64_t hits = 0;
+        uint64_t misses = 0;            // 每次未命中都要解压一个块
+    };
+
+    explicit TextStore(size_t cacheBytes = kDefaultCacheBytes);
+    ~TextStore();
+
+    TextStore(const TextStore&) = delete;
+    TextStore& operator=(const TextStore&) = delete;
+
+    /**
+     * 加入一段文本（相同文本只保存一次）
+     * 【参数】：group - 分组（同一分组的文本放在相邻的块中）
+     * 【返回】：文本编号；空文本返回kEmpty
+     */
+    TextId add(const std::string& group, const std::string& text);
+
+    /**
+     * 指定分组所属的区域（seal前调用；同一区域的分组装在相邻的块中，块不跨区域）
+     */
+    void setGroupRegion(const std::string& group, uint32_t region);
+
+    /**
+     * 压缩所有块并释放原文（加载完成后调用一次，之后不能再add）
+     */
+    void seal();
+
+    /**
+     * 把压缩块按区域写入包文件并mmap，释放堆上的压缩数据（seal后调用一次）
+     * 【参数】：path - 包文件路径；为空时写到临时目录，映射后立即删除文件
+     * 【返回】：写入或映射失败时返回false（仍使用堆上的压缩数据）
+     */
+    bool attachPack(const std::string& path);
+
+    bool isPacked() const { return packBase != nullptr; }
+
+    /**
+     * 区域数（setGroupRegion用到的最大区域号+1）
+     */
+    uint32_t regionCount() const { return static_cast<uint32_t>(regions.size()); }
+
+    /**
+     * 把区域在包文件中的页读入内存
+     * 【返回】：区域的字节数（未打包时为0）
+     */
+    size_t pageInRegion(uint32_t region);
+
+    /**
+     * 释放区域：包文件中的页交还内核，LRU和常驻列表中该区域已解压的块一并丢弃
+     * （pinGroup固定的块保留）
+     */
+    void pageOutRegion(uint32_t region);
+
+    /**
+     * 取文本（seal之前直接读原文）
+     */
+    std::string get(TextId id) const;
+
+    /**
+     * 文本长度（不需要解压）
+     */
+    size_t length(TextId id) const;
+
+    /**
+     * 分组中的所有块常驻内存（例如起始场景）
+     */
+    void pinGroup(const std::string& group);
+
+    /**
+     * 设置LRU缓存容量（字节，0表示不缓存，每次访问都解压）
+     * 【说明】：会清空缓存和常驻块；不能与get()并发调用（只在启动时和报告工具中使用）
+     */
+    void setCacheCapacity(size_t bytes);
+
+    Stats stats() const;
+
+    /**
+     * 清零命中/未命中计数（报告工具用）
+     */
+    void resetCounters();
+
+private:
+    struct Entry {
+        uint32_t block;             // seal前为分组编号
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Group {
+        std::string name;
+        std::string raw;            // 分组内文本拼接（seal后释放）
+        uint32_t region = kNoRegion;
+        uint32_t firstBlock = 0;
+        uint32_t lastBlock = 0;
+    };
+
+    struct Block {
+        std::string compressed;     // 打包后释放
+        const char* data = nullptr; // 指向compressed或包文件映射
+        uint32_t size = 0;
+        uint32_t rawLength = 0;
+        uint32_t region = kNoRegion;
+    };
+
+    /**
+     * 区域在包文件中的范围（按页对齐）
+     */
+    struct Region {
+        size_t offset = 0;
+        size_t length = 0;
+        std::vector<uint32_t> blocks;
+    };
+
+    class BlockCache;
+
+    std::shared_ptr<const std::string> loadBlock(uint32_t block) const;
+    void promote(uint32_t block, const std::shared_ptr<const std::string>& data) const;
+
+    std::vector<Entry> entries;
+    std::vector<Group> groups;
+    std::vector<Block> blocks;
+    std::unordered_map<std::string, TextId> dedupe;         // 原文 -> 编号（seal后清空）
+    std::unordered_map<std::string, uint32_t> groupIndex;   // 分组名 -> 分组编号
+    std::vector<Region> regions;
+    bool sealed = false;
+
+    const char* packBase = nullptr;                         // 包文件映射
+    size_t packLength = 0;
+
+    std::unique_ptr<BlockCache> cache;
+    mutable std::vector<std::shared_ptr<const std::string>> pinned;  // 常驻块（以atomic_load/store访问）
+    std::vector<char> heldPins;                                      // pinGroup固定的块（换出区域时保留）
+    mutable std::unique_ptr<std::atomic<uint32_t>[]> blockHits;
+    mutable std::mutex pinMutex;
+    mutable size_t pinnedBytes = 0;
+    size_t cacheCapacity;
+    mutable std::atomic<uint64_t> hits{0};
+    mutable std::atomic<uint64_t> misses{0};
+};
@@ -0,0 +1,348 @@
+/**
+ * TickWatchdog.cpp
+ *
+ * 帧看门狗实现
+ */
+
+#include "TickWatchdog.h"
+#include "Metrics.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+/**
+ * 分片：一个循环线程的心跳和当前上下文
+ */
+struct TickWatchdog::Shard {
+    std::string name;
+    std::chrono::milliseconds budget{16};
+    std::atomic<uint64_t> heartbeat{0};         // 已开始的轮数
+    std::atomic<int64_t> tickStart{0};          // 本轮开始时间（steady_clock毫秒），0表示空闲
+    std::atomic<bool> active{true};
+    uint64_t reportedBeat = 0;                  // 已报告过的轮次（只由看门狗线程访问）
+    std::atomic<uint64_t> histogram[kHistogramBuckets] = {};
+#ifndef _WIN32
+    pthread_t thread;
+#endif
+
+    std::mutex contextMutex;
+    std::string eventType;
+    std::string sessionId;
+};
+
+namespace {
+
+    thread_local TickWatchdog::Shard* currentShard = nullptr;
+
+    int64_t nowMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#ifndef _WIN32
+    constexpr int kMaxFrames = 64;
+    constexpr int kStackSignal = SIGUSR2;
+
+    // 信号处理函数写、看门狗线程读；同一时间只抓取一个线程
+    void* capturedFrames[kMaxFrames];
+    std::atomic<int> capturedCount{0};
+    std::atomic<bool> captureDone{false};
+
+    void onStackSignal(int) {
+        capturedCount.store(backtrace(capturedFrames, kMaxFrames));
+        captureDone.store(true);
+    }
+
+    /**
+     * "binary(_ZN3Foo3barEv+0x12) [0x...]" 中的符号名还原为C++名字
+     */
+    std::string demangleFrame(const char* frame) {
+        std::string text(frame);
+        size_t open = text.find('(');
+        size_t plus = text.find('+', open);
+        if (open == std::string::npos || plus == std::string::npos || plus == open + 1) {
+            return text;
+        }
+        std::string mangled = text.substr(open + 1, plus - open - 1);
+        int status = 0;
+        char* name = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+        if (status != 0 || !name) {
+            return text;
+        }
+        std::string result = text.substr(0, open + 1) + name + text.substr(plus);
+        std::free(name);
+        return result;
+    }
+#endif
+
+} // namespace
+
+TickWatchdog::Tick::Tick() : shard(currentShard) {
+    if (shard) {
+        start = std::chrono::steady_clock::now();
+        shard->heartbeat.fetch_add(1, std::memory_order_relaxed);
+        shard->tickStart.store(nowMillis(), std::memory_order_release);
+    }
+}
+
+TickWatchdog::Tick::~Tick() {
+    if (!shard) {
+        return;
+    }
+    shard->tickStart.store(0, std::memory_order_release);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    size_t bucket = 0;
+    for (int64_t limit = 125; micros >= limit && bucket + 1 < kHistogramBuckets; limit *= 2) {
+        ++bucket;
+    }
+    shard->histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+TickWatchdog::Context::Context(const std::string& eventType, const std::string& sessionId) : shard(currentShard) {
+    if (!shard) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(shard->contextMutex);
+    previousEvent = shard->eventType;
+    previousSession = shard->sessionId;
+    if (!eventType.empty()) {
+        shard->eventType = eventType;
+    }
+    if (!sessionId.empty()) {
+        shard->sessionId = sessionId;
+    }
+}
+
+TickWatchdog::Context::~Context() {
+    if (!shard) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(shard->contextMutex);
+    shard->eventType.swap(previousEvent);
+    shard->sessionId.swap(previousSession);
+}
+
+TickWatchdog& TickWatchdog::instance() {
+    static TickWatchdog watchdog;
+    return watchdog;
+}
+
+TickWatchdog::TickWatchdog() : factor(30), poisonOnStall(false), watching(false) {
+    if (const char* env = std::getenv("TIME_ARTIFACTS_WATCHDOG_FACTOR")) {
+        factor = std::atoi(env);
+    }
+    if (const char* env = std::getenv("TIME_ARTIFACTS_WATCHDOG_POISON")) {
+        poisonOnStall = std::atoi(env) != 0;
+    }
+}
+
+TickWatchdog::~TickWatchdog() {
+    stop();
+}
+
+void TickWatchdog::registerCurrentThread(const std::string& name, std::chrono::milliseconds budget) {
+    auto shard = std::make_unique<Shard>();
+    shard->name = name;
+    shard->budget = budget;
+#ifndef _WIN32
+    shard->thread = pthread_self();
+#endif
+    currentShard = shard.get();
+    std::lock_guard<std::mutex> lock(shardMutex);
+    shards.push_back(std::move(shard));
+}
+
+void TickWatchdog::unregisterCurrentThread() {
+    if (currentShard) {
+        currentShard->active.store(false);
+        currentShard = nullptr;
+    }
+}
+
+void TickWatchdog::setPoisonHandler(std::function<void(const std::string&)> handler) {
+    std::lock_guard<std::mutex> lock(shardMutex);
+    poisonHandler = std::move(handler);
+}
+
+void TickWatchdog::start() {
+    if (factor <= 0 || watcher.joinable()) {
+        return;
+    }
+#ifndef _WIN32
+    struct sigaction action {};
+    action.sa_handler = onStackSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(kStackSignal, &action, nullptr);
+
+    // backtrace第一次调用时会加载libgcc（可能分配内存），先在这里调用一次，信号处理函数中就不会再分配
+    void* warmup[1];
+    backtrace(warmup, 1);
+#endif
+    watching = true;
+    watcher = std::thread([this]() { watchLoop(); });
+    std::cout << "[TickWatchdog] 看门狗已启动，单轮超过预算 " << factor << " 倍视为卡住"
+              << (poisonOnStall ? "（卡住的会话将被隔离）" : "") << std::endl;
+}
+
+void TickWatchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex);
+        if (!watching) {
+            return;
+        }
+        watching = false;
+    }
+    watcherWake.notify_all();
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+}
+
+void TickWatchdog::watchLoop() {
+    std::unique_lock<std::mutex> wakeLock(watcherMutex);
+    while (watching) {
+        watcherWake.wait_for(wakeLock, std::chrono::milliseconds(50));
+        if (!watching) {
+            break;
+        }
+        wakeLock.unlock();
+
+        int64_t now = nowMillis();
+        std::vector<Shard*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(shardMutex);
+            for (const auto& shard : shards) {
+                snapshot.push_back(shard.get());
+            }
+        }
+        for (Shard* shard : snapshot) {
+            int64_t start = shard->tickStart.load(std::memory_order_acquire);
+            uint64_t beat = shard->heartbeat.load(std::memory_order_relaxed);
+            if (!shard->active.load() || start == 0 || beat == shard->reportedBeat) {
+                continue;
+            }
+            int64_t elapsed = now - start;
+            if (elapsed > shard->budget.count() * factor) {
+                shard->reportedBeat = beat;
+                reportStall(*shard, elapsed);
+            }
+        }
+
+        wakeLock.lock();
+    }
+}
+
+void TickWatchdog::reportStall(Shard& shard, int64_t elapsedMillis) {
+    static auto& stalls = Metrics::instance().counter("watchdog.stalls");
+    static auto& poisoned = Metrics::instance().counter("watchdog.sessions_poisoned");
+    stalls.fetch_add(1, std::memory_order_relaxed);
+
+    std::string eventType, sessionId;
+    {
+        std::lock_guard<std::mutex> lock(shard.contextMutex);
+        eventType = shard.eventType;
+        sessionId = shard.sessionId;
+    }
+
+    std::cerr << "[TickWatchdog] 循环 " << shard.name << " 卡住: 第 " << shard.heartbeat.load()
+              << " 轮已持续 " << elapsedMillis << " ms（预算 " << shard.budget.count() << " ms）"
+              << "，事件: " << (eventType.empty() ? "-" : eventType)
+              << "，会话: " << (sessionId.empty() ? "-" : sessionId) << "\n"
+              << captureStack(shard) << std::flush;
+
+    if (poisonOnStall && !sessionId.empty()) {
+        std::function<void(const std::string&)> handler;
+        {
+            std::lock_guard<std::mutex> lock(shardMutex);
+            handler = poisonHandler;
+        }
+        if (handler) {
+            handler(sessionId);
+            poisoned.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[TickWatchdog] 会话 " << sessionId << " 已标记为中毒，之后的消息将被跳过" << std::endl;
+        }
+    }
+}
+
+std::string TickWatchdog::captureStack(Shard& shard) {
+#ifdef _WIN32
+    (void)shard;
+    return "  （当前平台不支持抓取调用栈）\n";
+#else
+    captureDone.store(false);
+    if (pthread_kill(shard.thread, kStackSignal) != 0) {
+        return "  （无法向线程发送信号）\n";
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (!captureDone.load()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return "  （线程未响应信号，可能阻塞在屏蔽了信号的调用中）\n";
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    int count = capturedCount.load();
+    std::ostringstream out;
+    char** symbols = backtrace_symbols(capturedFrames, count);
+    // 跳过信号处理函数自身和信号跳板两帧
+    for (int i = 2; i < count; ++i) {
+        out << "  #" << (i - 2) << " " << (symbols ? demangleFrame(symbols[i]) : "?") << "\n";
+    }
+    std::free(symbols);
+    return out.str();
+#endif
+}
+
+std::vector<TickWatchdog::ShardStats> TickWatchdog::shardStats() {
+    int64_t now = nowMillis();
+    std::vector<ShardStats> result;
+    std::lock_guard<std::mutex> lock(shardMutex);
+    for (const auto& shard : shards) {
+        if (!shard->active.load()) {
+            continue;
+        }
+        ShardStats stats;
+        stats.name = shard->name;
+        stats.budget = shard->budget;
+        stats.heartbeat = shard->heartbeat.load(std::memory_order_relaxed);
+        int64_t start = shard->tickStart.load(std::memory_order_acquire);
+        stats.currentTickMillis = start == 0 ? 0 : now - start;
+        for (const auto& bucket : shard->histogram) {
+            stats.histogram.push_back(bucket.load(std::memory_order_relaxed));
+        }
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+double TickWatchdog::bucketLimitMillis(size_t bucket) {
+    if (bucket + 1 >= kHistogramBuckets) {
+        return 0.0;
+    }
+    return 0.125 * static_cast<double>(1u << bucket);
+}
+
+void TickWatchdog::registerMetrics() {
+    Metrics::instance().counter("watchdog.stalls");
+    Metrics::instance().counter("watchdog.sessions_poisoned");
+    Metrics::instance().registerCollector("tick_watchdog", [this](Metrics::Samples& out) {
+        int64_t now = nowMillis();
+        std::lock_guard<std::mutex> lock(shardMutex);
+        for (const auto& shard : shards) {
+            if (!shard->active.load()) {
+                continue;
+            }
+            int64_t start = shard->tickStart.load(std::memory_order_acquire);
+            out["watchdog." + shard->name + ".heartbeat"] = static_cast<double>(shard->heartbeat.load(std::memory_order_relaxed));
+            out["watchdog." + shard->name + ".tick_ms"] = start == 0 ? 0.0 : static_cast<double>(now - start);
+        }
+    });
+}
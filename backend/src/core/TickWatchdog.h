@@ -0,0 +1,156 @@
+/**
+ * TickWatchdog.h
+ *
+ * 帧看门狗 - 发现卡住的循环（主循环、网络事件循环），抓取卡住线程的调用栈
+ *
+ * 【文件作用】：
+ * 1. 每个循环线程注册为一个分片，每轮开始/结束时更新分片的心跳计数和本轮开始时间
+ * 2. 看门狗线程定期检查：某一轮持续超过 预算×倍数 时，向该线程发送SIGUSR2，
+ *    由信号处理函数在卡住的线程上记录调用栈，看门狗线程再把调用栈连同
+ *    正在分发的事件类型、正在处理的会话ID一起写入日志（每个卡住的轮次只报告一次）
+ * 3. 可选：把卡住时正在处理的会话标记为"中毒"，之后的消息不再交给它处理
+ *    （见SessionManager::poisonSession）
+ * 4. 每轮结束时把耗时计入分片的直方图（原子计数，按2的幂分桶），供管理接口查看
+ *
+ * 【用法】：
+ * ```cpp
+ * TickWatchdog::instance().registerCurrentThread("engine", std::chrono::milliseconds(16));
+ * while (running) {
+ *     TickWatchdog::Tick tick;                       // 本轮开始，析构时结束
+ *     TickWatchdog::Context context("", sessionId);  // 正在处理的会话
+ *     ...
+ * }
+ * ```
+ *
+ * 【配置】：
+ *   TIME_ARTIFACTS_WATCHDOG_FACTOR  超过预算多少倍视为卡住（默认30，0表示关闭看门狗）
+ *   TIME_ARTIFACTS_WATCHDOG_POISON  为1时把卡住时正在处理的会话标记为中毒
+ *
+ * 【线程】：未注册的线程上Tick、Context不做任何事；调用栈抓取只在非Windows平台可用
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 帧看门狗类（全局单例）
+ */
+class TickWatchdog {
+public:
+    struct Shard;
+
+    // 直方图分桶：第0桶 < 0.125ms，之后每桶上限翻倍，最后一桶不设上限
+    static constexpr size_t kHistogramBuckets = 14;
+
+    /**
+     * 分片状态（管理接口用，读取时不加锁）
+     */
+    struct ShardStats {
+        std::string name;
+        std::chrono::milliseconds budget{0};
+        uint64_t heartbeat = 0;
+        int64_t currentTickMillis = 0;      // 当前这一轮已持续的时间（空闲时为0）
+        std::vector<uint64_t> histogram;    // kHistogramBuckets 个桶
+    };
+
+    /**
+     * 一轮循环（构造时开始，析构时结束）
+     */
+    class Tick {
+    public:
+        Tick();
+        ~Tick();
+        Tick(const Tick&) = delete;
+        Tick& operator=(const Tick&) = delete;
+    private:
+        Shard* shard;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * 当前线程正在做的事（嵌套时析构恢复外层的值；参数为空表示保持外层的值）
+     */
+    class Context {
+    public:
+        Context(const std::string& eventType, const std::string& sessionId);
+        ~Context();
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
+    private:
+        Shard* shard;
+        std::string previousEvent;
+        std::string previousSession;
+    };
+
+    static TickWatchdog& instance();
+
+    TickWatchdog(const TickWatchdog&) = delete;
+    TickWatchdog& operator=(const TickWatchdog&) = delete;
+
+    /**
+     * 把当前线程注册为分片（每个循环线程启动时调用一次）
+     * 【参数】：budget - 一轮的正常耗时上限
+     */
+    void registerCurrentThread(const std::string& name, std::chrono::milliseconds budget);
+
+    /**
+     * 注销当前线程（循环退出时调用）
+     */
+    void unregisterCurrentThread();
+
+    /**
+     * 设置会话中毒处理（GameEngine连接到SessionManager）
+     */
+    void setPoisonHandler(std::function<void(const std::string&)> handler);
+
+    /**
+     * 启动/停止看门狗线程
+     */
+    void start();
+    void stop();
+
+    /**
+     * 所有在运行的分片的状态
+     */
+    std::vector<ShardStats> shardStats();
+
+    /**
+     * 直方图第i桶的上限（毫秒；最后一桶返回0表示不设上限）
+     */
+    static double bucketLimitMillis(size_t bucket);
+
+    /**
+     * 注册运行指标
+     */
+    void registerMetrics();
+
+private:
+    TickWatchdog();
+    ~TickWatchdog();
+
+    void watchLoop();
+    void reportStall(Shard& shard, int64_t elapsedMillis);
+    std::string captureStack(Shard& shard);
+
+    std::mutex shardMutex;
+    std::vector<std::unique_ptr<Shard>> shards;     // 注销的分片保留（地址稳定），只是不再检查
+
+    std::function<void(const std::string&)> poisonHandler;
+    int factor;
+    bool poisonOnStall;
+
+    std::thread watcher;
+    std::mutex watcherMutex;
+    std::condition_variable watcherWake;
+    bool watching;
+};
@@ -0,0 +1,332 @@
+/**
+ * TlsContext.cpp
+ *
+ * TLS终止实现（OpenSSL）
+ */
+
+#include "TlsContext.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+#ifdef TIME_ARTIFACTS_HAS_OPENSSL
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+#endif
+
+#ifdef TIME_ARTIFACTS_HAS_OPENSSL
+
+namespace {
+
+    /**
+     * 取出并清空当前线程的OpenSSL错误队列（返回第一条错误的描述）
+     */
+    std::string takeErrors() {
+        std::string first;
+        unsigned long code;
+        while ((code = ERR_get_error()) != 0) {
+            if (first.empty()) {
+                char text[256];
+                ERR_error_string_n(code, text, sizeof(text));
+                first = text;
+            }
+        }
+        return first.empty() ? "unknown error" : first;
+    }
+
+} // namespace
+
+// ==================== TlsSession ====================
+
+TlsSession::TlsSession(ssl_st* ssl) : ssl(ssl) {
+}
+
+TlsSession::~TlsSession() {
+    SSL_free(ssl);
+}
+
+TlsSession::Result TlsSession::classify(int returnCode) {
+    int error = SSL_get_error(ssl, returnCode);
+    int savedErrno = errno;
+    ERR_clear_error();
+    switch (error) {
+        case SSL_ERROR_WANT_READ:
+            return Result::WantRead;
+        case SSL_ERROR_WANT_WRITE:
+            return Result::WantWrite;
+        case SSL_ERROR_ZERO_RETURN:
+            return Result::Closed;
+        case SSL_ERROR_SYSCALL:
+            // 没有OpenSSL错误、errno也为0：对端直接断开了TCP
+            return savedErrno == 0 ? Result::Closed : Result::Failed;
+        default:
+            return Result::Failed;
+    }
+}
+
+TlsSession::Result TlsSession::handshake() {
+    int returnCode = SSL_do_handshake(ssl);
+    return returnCode == 1 ? Result::Ok : classify(returnCode);
+}
+
+TlsSession::Result TlsSession::read(char* buffer, size_t length, size_t& transferred) {
+    transferred = 0;
+    errno = 0;
+    int returnCode = SSL_read_ex(ssl, buffer, length, &transferred);
+    return returnCode == 1 ? Result::Ok : classify(returnCode);
+}
+
+TlsSession::Result TlsSession::write(const char* data, size_t length, size_t& transferred) {
+    static auto& userspaceBytesCounter = Metrics::instance().counter("tls.userspace_bytes");
+
+    transferred = 0;
+    errno = 0;
+    int returnCode = SSL_write_ex(ssl, data, length, &transferred);
+    if (returnCode != 1) {
+        return classify(returnCode);
+    }
+    userspaceBytesCounter.fetch_add(static_cast<int64_t>(transferred), std::memory_order_relaxed);
+    return Result::Ok;
+}
+
+void TlsSession::shutdown() {
+    if (SSL_is_init_finished(ssl)) {
+        SSL_shutdown(ssl);
+    }
+    ERR_clear_error();
+}
+
+bool TlsSession::kernelSend() const {
+#ifndef OPENSSL_NO_KTLS
+    return BIO_get_ktls_send(SSL_get_wbio(ssl)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool TlsSession::kernelReceive() const {
+#ifndef OPENSSL_NO_KTLS
+    return BIO_get_ktls_recv(SSL_get_rbio(ssl)) != 0;
+#else
+    return false;
+#endif
+}
+
+std::string TlsSession::describe() const {
+    return std::string(SSL_get_version(ssl)) + " " + SSL_get_cipher_name(ssl);
+}
+
+// ==================== TlsContext ====================
+
+TlsContext::TlsContext(ssl_ctx_st* ctx) : ctx(ctx) {
+}
+
+TlsContext::~TlsContext() {
+    SSL_CTX_free(ctx);
+}
+
+bool TlsContext::isAvailable() {
+    return true;
+}
+
+std::unique_ptr<TlsContext> TlsContext::create(const std::string& certPath, const std::string& keyPath) {
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    if (!ctx) {
+        std::cerr << "[TLS] 创建SSL_CTX失败: " << takeErrors() << std::endl;
+        return nullptr;
+    }
+    std::unique_ptr<TlsContext> context(new TlsContext(ctx));
+
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    uint64_t options = SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_NO_RENEGOTIATION;
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    options |= SSL_OP_IGNORE_UNEXPECTED_EOF;
+#endif
+#ifdef SSL_OP_ENABLE_KTLS
+    options |= SSL_OP_ENABLE_KTLS;
+#endif
+    SSL_CTX_set_options(ctx, options);
+    // 部分写入：事件循环的发送队列按已发送的字节数推进，与套接字的send语义一致
+    SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER |
+                          SSL_MODE_RELEASE_BUFFERS);
+    // 不发会话票据：握手后套接字上不再有OpenSSL自己写入的记录
+    SSL_CTX_set_num_tickets(ctx, 0);
+    // 只用kTLS支持的AEAD套件（AES-GCM优先，内核对它的支持最广）
+    SSL_CTX_set_ciphersuites(ctx, "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256");
+    SSL_CTX_set_cipher_list(ctx, "ECDHE+AESGCM:ECDHE+CHACHA20");
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, certPath.c_str()) != 1 ||
+        SSL_CTX_use_PrivateKey_file(ctx, keyPath.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(ctx) != 1) {
+        std::cerr << "[TLS] 加载证书失败（" << certPath << " / " << keyPath << "）: " << takeErrors() << std::endl;
+        return nullptr;
+    }
+
+#ifndef _WIN32
+    // OpenSSL用write()写套接字，无法带MSG_NOSIGNAL；对端断开时不能让SIGPIPE结束进程
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    std::cout << "[TLS] 已加载证书: " << certPath << std::endl;
+    return context;
+}
+
+std::unique_ptr<TlsSession> TlsContext::newSession(int fd) {
+    SSL* ssl = SSL_new(ctx);
+    if (!ssl) {
+        std::cerr << "[TLS] 创建会话失败: " << takeErrors() << std::endl;
+        return nullptr;
+    }
+    if (SSL_set_fd(ssl, fd) != 1) {
+        std::cerr << "[TLS] 绑定套接字失败: " << takeErrors() << std::endl;
+        SSL_free(ssl);
+        return nullptr;
+    }
+    SSL_set_accept_state(ssl);
+    return std::unique_ptr<TlsSession>(new TlsSession(ssl));
+}
+
+bool TlsContext::generateSelfSigned(const std::string& certPath, const std::string& keyPath,
+                                    const std::string& commonName) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    bool ok = key && cert;
+
+    if (ok) {
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), static_cast<long>(std::time(nullptr)));
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 365L * 24 * 3600);
+        X509_set_pubkey(cert, key);
+
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_UTF8,
+                                   reinterpret_cast<const unsigned char*>(commonName.c_str()), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+
+        // 浏览器只认SAN，不看CN
+        X509V3_CTX extensionContext;
+        X509V3_set_ctx_nodb(&extensionContext);
+        X509V3_set_ctx(&extensionContext, cert, cert, nullptr, nullptr, 0);
+        std::string alternativeNames = "DNS:localhost,IP:127.0.0.1,IP:::1";
+        if (commonName != "localhost") {
+            alternativeNames += ",DNS:" + commonName;
+        }
+        X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &extensionContext, NID_subject_alt_name,
+                                                         alternativeNames.c_str());
+        ok = extension && X509_add_ext(cert, extension, -1) == 1;
+        X509_EXTENSION_free(extension);
+        ok = ok && X509_sign(cert, key, EVP_sha256()) > 0;
+    }
+
+    if (ok) {
+        BIO* keyFile = BIO_new_file(keyPath.c_str(), "wb");
+        ok = keyFile && PEM_write_bio_PrivateKey(keyFile, key, nullptr, nullptr, 0, nullptr, nullptr) == 1;
+        BIO_free(keyFile);
+#ifndef _WIN32
+        ::chmod(keyPath.c_str(), 0600);
+#endif
+    }
+    if (ok) {
+        BIO* certFile = BIO_new_file(certPath.c_str(), "wb");
+        ok = certFile && PEM_write_bio_X509(certFile, cert) == 1;
+        BIO_free(certFile);
+    }
+    if (!ok) {
+        std::cerr << "[TLS] 生成自签名证书失败: " << takeErrors() << std::endl;
+    }
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ok;
+}
+
+#else
+
+// 未找到OpenSSL：TLS不可用，设置了证书时服务器拒绝以明文启动
+
+TlsSession::TlsSession(ssl_st* ssl) : ssl(ssl) {
+}
+
+TlsSession::~TlsSession() = default;
+
+TlsSession::Result TlsSession::classify(int) {
+    return Result::Failed;
+}
+
+TlsSession::Result TlsSession::handshake() {
+    return Result::Failed;
+}
+
+TlsSession::Result TlsSession::read(char*, size_t, size_t& transferred) {
+    transferred = 0;
+    return Result::Failed;
+}
+
+TlsSession::Result TlsSession::write(const char*, size_t, size_t& transferred) {
+    transferred = 0;
+    return Result::Failed;
+}
+
+void TlsSession::shutdown() {
+}
+
+bool TlsSession::kernelSend() const {
+    return false;
+}
+
+bool TlsSession::kernelReceive() const {
+    return false;
+}
+
+std::string TlsSession::describe() const {
+    return "";
+}
+
+TlsContext::TlsContext(ssl_ctx_st* ctx) : ctx(ctx) {
+}
+
+TlsContext::~TlsContext() = default;
+
+bool TlsContext::isAvailable() {
+    return false;
+}
+
+std::unique_ptr<TlsContext> TlsContext::create(const std::string&, const std::string&) {
+    std::cerr << "[TLS] 编译时未找到OpenSSL，不支持TLS" << std::endl;
+    return nullptr;
+}
+
+std::unique_ptr<TlsSession> TlsContext::newSession(int) {
+    return nullptr;
+}
+
+bool TlsContext::generateSelfSigned(const std::string&, const std::string&, const std::string&) {
+    std::cerr << "[TLS] 编译时未找到OpenSSL，无法生成证书" << std::endl;
+    return false;
+}
+
+#endif // TIME_ARTIFACTS_HAS_OPENSSL
+
+std::unique_ptr<TlsContext> TlsContext::fromEnvironment(bool& configured) {
+    const char* cert = std::getenv("TIME_ARTIFACTS_TLS_CERT");
+    const char* key = std::getenv("TIME_ARTIFACTS_TLS_KEY");
+    configured = (cert && *cert) || (key && *key);
+    if (!configured) {
+        return nullptr;
+    }
+    if (!cert || !*cert || !key || !*key) {
+        std::cerr << "[TLS] TIME_ARTIFACTS_TLS_CERT 和 TIME_ARTIFACTS_TLS_KEY 需要同时设置" << std::endl;
+        return nullptr;
+    }
+    return create(cert, key);
+}
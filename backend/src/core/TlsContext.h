@@ -0,0 +1,142 @@
+/**
+ * TlsContext.h
+ *
+ * TLS终止 - wss:// 和 https:// 的握手，握手后把记录加密交给内核TLS（kTLS）
+ *
+ * 【文件作用】：
+ * 1. TlsContext：证书、私钥和协议配置（OpenSSL的SSL_CTX），每个连接创建一个TlsSession
+ * 2. TlsSession：非阻塞握手、读、写；握手完成后OpenSSL尝试为套接字开启kTLS
+ *    （setsockopt TCP_ULP "tls" + 写入会话密钥）
+ * 3. 生成自签名证书（本地测试用，见 --generate-cert）
+ *
+ * 【为什么用kTLS】：用户态TLS要把每个出站帧再拷贝、加密一次，sendfile也无法使用；
+ *   kTLS开启后内核负责加密，事件循环照常对套接字 writev / sendfile，零拷贝路径不变
+ *
+ * 【回退】：内核不支持（没有tls模块、加密套件不支持）时kernelSend()为false，
+ *   发送改走SSL_write（用户态加密）。接收始终通过SSL_read（开启kTLS接收时由内核解密）
+ *
+ * 【配置】（环境变量）：
+ * - TIME_ARTIFACTS_TLS_CERT：PEM证书链文件
+ * - TIME_ARTIFACTS_TLS_KEY：PEM私钥文件
+ * 两者都设置时服务器端口只接受TLS连接
+ *
+ * 【依赖】：编译时找到OpenSSL（TIME_ARTIFACTS_HAS_OPENSSL）才可用
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+struct ssl_st;
+struct ssl_ctx_st;
+
+/**
+ * 一个连接上的TLS会话
+ * 【线程】：同一时刻只在一个线程使用（握手线程完成握手后随连接交给事件循环）
+ */
+class TlsSession {
+public:
+    enum class Result {
+        Ok,         // 完成（读写时至少传输了1字节）
+        WantRead,   // 等待套接字可读
+        WantWrite,  // 等待套接字可写
+        Closed,     // 对端正常关闭（close_notify 或 TCP关闭）
+        Failed      // 协议错误或套接字错误
+    };
+
+    ~TlsSession();
+
+    TlsSession(const TlsSession&) = delete;
+    TlsSession& operator=(const TlsSession&) = delete;
+
+    /**
+     * 推进握手（非阻塞，返回WantRead/WantWrite时等待对应事件后再调用）
+     */
+    Result handshake();
+
+    /**
+     * 读取解密后的数据
+     * 【参数】：transferred - 输出读到的字节数
+     */
+    Result read(char* buffer, size_t length, size_t& transferred);
+
+    /**
+     * 用户态加密并发送（只在kernelSend()为false时使用）
+     * 【说明】：返回WantWrite后必须用相同的数据重试
+     */
+    Result write(const char* data, size_t length, size_t& transferred);
+
+    /**
+     * 发送close_notify（尽力而为，不等待对端回应）
+     */
+    void shutdown();
+
+    /**
+     * 发送方向已由内核加密：直接对套接字 writev / sendfile
+     */
+    bool kernelSend() const;
+
+    /**
+     * 接收方向已由内核解密
+     */
+    bool kernelReceive() const;
+
+    /**
+     * 协商结果（如 "TLSv1.3 TLS_AES_128_GCM_SHA256"）
+     */
+    std::string describe() const;
+
+private:
+    friend class TlsContext;
+    explicit TlsSession(ssl_st* ssl);
+
+    Result classify(int returnCode);
+
+    ssl_st* ssl;
+};
+
+/**
+ * TLS配置
+ */
+class TlsContext {
+public:
+    ~TlsContext();
+
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    /**
+     * 加载证书和私钥
+     * 【返回】：失败（文件无效、私钥不匹配、未编译OpenSSL）时返回nullptr并记录日志
+     */
+    static std::unique_ptr<TlsContext> create(const std::string& certPath, const std::string& keyPath);
+
+    /**
+     * 按环境变量 TIME_ARTIFACTS_TLS_CERT / TIME_ARTIFACTS_TLS_KEY 创建
+     * 【参数】：configured - 输出是否设置了环境变量（设置了但加载失败时服务器不应以明文启动）
+     */
+    static std::unique_ptr<TlsContext> fromEnvironment(bool& configured);
+
+    /**
+     * 生成自签名证书（EC P-256，一年有效，SAN包含 localhost 和 127.0.0.1）
+     */
+    static bool generateSelfSigned(const std::string& certPath, const std::string& keyPath,
+                                   const std::string& commonName);
+
+    /**
+     * 编译时是否启用了TLS
+     */
+    static bool isAvailable();
+
+    /**
+     * 为已接受的套接字创建会话（不转移套接字所有权）
+     */
+    std::unique_ptr<TlsSession> newSession(int fd);
+
+private:
+    explicit TlsContext(ssl_ctx_st* ctx);
+
+    ssl_ctx_st* ctx;
+};
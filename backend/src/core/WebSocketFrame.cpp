@@ -0,0 +1,152 @@
+/**
+ * WebSocketFrame.cpp
+ *
+ * WebSocket帧编解码实现
+ */
+
+#include "WebSocketFrame.h"
+#include "utils/Base64.h"
+#include "utils/Sha1.h"
+#include <cstring>
+
+namespace WebSocketFrame {
+
+    namespace {
+        // RFC 6455 规定的握手GUID
+        const char kHandshakeGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    }
+
+    ParseResult parseHeader(const uint8_t* data, size_t length, FrameHeader& header) {
+        if (length < 2) {
+            return ParseResult::Incomplete;
+        }
+
+        uint8_t b0 = data[0];
+        uint8_t b1 = data[1];
+
+        // 未协商扩展时保留位必须为0
+        if (b0 & 0x70) {
+            return ParseResult::ProtocolError;
+        }
+
+        header.fin = (b0 & 0x80) != 0;
+        header.opcode = static_cast<Opcode>(b0 & 0x0F);
+        header.masked = (b1 & 0x80) != 0;
+
+        uint8_t op = b0 & 0x0F;
+        if ((op > 0x2 && op < 0x8) || op > 0xA) {
+            return ParseResult::ProtocolError;
+        }
+
+        size_t offset = 2;
+        uint64_t payloadLength = b1 & 0x7F;
+        if (payloadLength == 126) {
+            if (length < offset + 2) {
+                return ParseResult::Incomplete;
+            }
+            payloadLength = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+            offset += 2;
+        } else if (payloadLength == 127) {
+            if (length < offset + 8) {
+                return ParseResult::Incomplete;
+            }
+            payloadLength = 0;
+            for (int i = 0; i < 8; ++i) {
+                payloadLength = (payloadLength << 8) | data[2 + i];
+            }
+            if (payloadLength >> 63) {
+                return ParseResult::ProtocolError;
+            }
+            offset += 8;
+        }
+
+        // 控制帧不能分片，负载不超过125字节
+        if (header.isControl() && (!header.fin || payloadLength > 125)) {
+            return ParseResult::ProtocolError;
+        }
+
+        if (header.masked) {
+            if (length < offset + 4) {
+                return ParseResult::Incomplete;
+            }
+            for (int i = 0; i < 4; ++i) {
+                header.maskKey[i] = data[offset + i];
+            }
+            offset += 4;
+        }
+
+        header.payloadLength = payloadLength;
+        header.headerLength = offset;
+        return ParseResult::Ok;
+    }
+
+    size_t encodeHeader(uint8_t* out, Opcode opcode, uint64_t payloadLength, bool fin) {
+        out[0] = static_cast<uint8_t>((fin ? 0x80 : 0x00) | static_cast<uint8_t>(opcode));
+        if (payloadLength < 126) {
+            out[1] = static_cast<uint8_t>(payloadLength);
+            return 2;
+        }
+        if (payloadLength <= 0xFFFF) {
+            out[1] = 126;
+            out[2] = static_cast<uint8_t>(payloadLength >> 8);
+            out[3] = static_cast<uint8_t>(payloadLength);
+            return 4;
+        }
+        out[1] = 127;
+        for (int i = 0; i < 8; ++i) {
+            out[2 + i] = static_cast<uint8_t>(payloadLength >> (56 - 8 * i));
+        }
+        return 10;
+    }
+
+    std::string encodeFrame(Opcode opcode, const std::string& payload) {
+        uint8_t header[10];
+        size_t headerLength = encodeHeader(header, opcode, payload.size());
+
+        std::string frame;
+        frame.reserve(headerLength + payload.size());
+        frame.append(reinterpret_cast<const char*>(header), headerLength);
+        frame.append(payload);
+        return frame;
+    }
+
+    bool isValidCloseCode(uint16_t code) {
+        if (code >= 3000 && code <= 4999) {
+            return true;
+        }
+        switch (code) {
+            case 1000: case 1001: case 1002: case 1003:
+            case 1007: case 1008: case 1009: case 1010: case 1011:
+            case 1012: case 1013: case 1014:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::string encodeClose(uint16_t code, const std::string& reason) {
+        std::string payload;
+        payload.push_back(static_cast<char>(code >> 8));
+        payload.push_back(static_cast<char>(code & 0xFF));
+        payload.append(reason.substr(0, 123));
+        return encodeFrame(Opcode::Close, payload);
+    }
+
+    std::string computeAcceptKey(const std::string& clientKey) {
+        // 合法的客户端key是24个字符，拼上GUID后在栈上只需两块，不做中间的字符串拼接
+        const size_t guidLength = sizeof(kHandshakeGuid) - 1;
+        char input[128];
+        Sha1::Digest digest;
+        if (clientKey.size() + guidLength <= sizeof(input)) {
+            std::memcpy(input, clientKey.data(), clientKey.size());
+            std::memcpy(input + clientKey.size(), kHandshakeGuid, guidLength);
+            digest = Sha1::hash(input, clientKey.size() + guidLength);
+        } else {
+            digest = Sha1::hash(clientKey + kHandshakeGuid);
+        }
+
+        char accept[Base64::encodedLength(sizeof(Sha1::Digest))];
+        return std::string(accept, Base64::encodeTo(digest.data(), digest.size(), accept));
+    }
+
+} // namespace WebSocketFrame
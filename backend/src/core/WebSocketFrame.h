@@ -0,0 +1,104 @@
+/**
+ * WebSocketFrame.h
+ *
+ * WebSocket帧编解码（RFC 6455 第5节）
+ *
+ * 【文件作用】：
+ * 1. 解析客户端帧头（FIN、操作码、掩码、负载长度）
+ * 2. 生成服务器帧头（服务器发出的帧不加掩码）
+ * 3. 计算握手应答中的 Sec-WebSocket-Accept
+ *
+ * 【说明】：负载的解掩码和UTF-8校验由 FrameKernels 完成
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace WebSocketFrame {
+
+    /**
+     * 操作码
+     */
+    enum class Opcode : uint8_t {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xA
+    };
+
+    /**
+     * 关闭状态码（RFC 6455 7.4.1）
+     */
+    enum CloseCode : uint16_t {
+        CloseNormal = 1000,
+        CloseGoingAway = 1001,
+        CloseProtocolError = 1002,
+        CloseUnsupportedData = 1003,
+        CloseInvalidPayload = 1007,
+        CloseMessageTooBig = 1009
+    };
+
+    /**
+     * 解析后的帧头
+     */
+    struct FrameHeader {
+        bool fin = false;
+        Opcode opcode = Opcode::Continuation;
+        bool masked = false;
+        uint8_t maskKey[4] = {0, 0, 0, 0};
+        uint64_t payloadLength = 0;
+        size_t headerLength = 0;    // 帧头占用的字节数
+
+        bool isControl() const { return (static_cast<uint8_t>(opcode) & 0x8) != 0; }
+    };
+
+    /**
+     * 帧头解析结果
+     */
+    enum class ParseResult {
+        Ok,             // 帧头完整
+        Incomplete,     // 数据不足，等待更多字节
+        ProtocolError   // 违反协议（保留位、控制帧过长等）
+    };
+
+    /**
+     * 解析帧头
+     * 【参数】：data/length - 接收缓冲区中尚未处理的字节
+     */
+    ParseResult parseHeader(const uint8_t* data, size_t length, FrameHeader& header);
+
+    /**
+     * 生成服务器帧头（不加掩码）
+     * 【参数】：out - 至少10字节的输出缓冲
+     * 【返回】：帧头长度
+     */
+    size_t encodeHeader(uint8_t* out, Opcode opcode, uint64_t payloadLength, bool fin = true);
+
+    /**
+     * 生成完整的服务器帧
+     */
+    std::string encodeFrame(Opcode opcode, const std::string& payload);
+
+    /**
+     * 对端关闭帧中的状态码是否合法（RFC 6455 7.4）
+     * 【说明】：1005、1006、1015只用于本地报告，不能出现在关闭帧中；
+     *   1000以下、未分配的1xxx和5000以上都不合法；3000-4999留给库和应用使用
+     */
+    bool isValidCloseCode(uint16_t code);
+
+    /**
+     * 生成关闭帧
+     */
+    std::string encodeClose(uint16_t code, const std::string& reason = "");
+
+    /**
+     * 计算 Sec-WebSocket-Accept
+     */
+    std::string computeAcceptKey(const std::string& clientKey);
+
+} // namespace WebSocketFrame
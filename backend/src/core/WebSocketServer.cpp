@@ -1,23 +1,148 @@
 /**
  * WebSocketServer.cpp
- * 
- * WebSocket服务器实现（简化版本）
+ *
+ * WebSocket服务器实现
+ *
+ * 【结构】：
+ * - 公共部分：构造/析构、处理器设置、欢迎消息
+ * - POSIX：ConnectionAcceptor接入并完成握手计算 → poll()事件循环放行，
+ *   HTTP请求 → 静态资源 / /metrics / /stats / WebSocket升级
+ * - 回环模式：连接的读写换成LoopbackChannel的字节环，其余处理与套接字连接相同
+ * - Windows：模拟循环
  */
 
 #include "WebSocketServer.h"
 #include "APIHandler.h"
+#include "ConnectionAcceptor.h"
+#include "LoopbackChannel.h"
+#include "OutboundLanes.h"
+#include "SessionManager.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "HttpRequest.h"
+#include "StaticFileServer.h"
+#include "FrameKernels.h"
+#include "ChoiceStatistics.h"
+#include "TickWatchdog.h"
+#include "TlsContext.h"
 #include <iostream>
 #include <chrono>
+#include <deque>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
 
 // 如果没有nlohmann/json，使用简单的字符串拼接
 #ifndef NLOHMANN_JSON_VERSION_MAJOR
 #define USE_SIMPLE_JSON 1
 #endif
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+    // 单条WebSocket消息（含分片重组后）的最大长度
+    constexpr uint64_t kMaxMessageSize = 1024 * 1024;
+
+    // 每次recv的缓冲大小
+    constexpr size_t kReadChunkSize = 16 * 1024;
+
+    // 接收缓冲的上限：一条最大消息加上帧头和后续帧的余量。达到上限时先处理已收到的数据，
+    // 剩下的留在内核缓冲里（TCP窗口随之收紧），下一轮poll再读
+    constexpr size_t kMaxBufferedInput = kMaxMessageSize + kReadChunkSize;
+
+    // 一次writev最多合并的缓冲数
+    constexpr int kMaxIovecs = 16;
+
+    // sendfile单次最多发送的字节数（避免一个大文件长时间占用事件循环）
+    constexpr size_t kSendfileChunk = 1024 * 1024;
+
+    // 断线会话保留时间（客户端在此期间重连可恢复会话）
+    constexpr auto kResumeWindow = std::chrono::minutes(2);
+
+    /**
+     * 待发送的数据块
+     * 【说明】：三种来源之一 - 自有字符串、共享缓存（静态资源）、文件（sendfile）
+     */
+    struct OutboundChunk {
+        std::string data;
+        std::shared_ptr<const std::string> shared;
+        size_t offset = 0;                  // 内存数据已发送的字节数
+
+        int fileFd = -1;
+        int64_t fileOffset = 0;
+        uint64_t fileRemaining = 0;
+
+        bool isFile() const { return fileFd >= 0; }
+        const std::string& bytes() const { return shared ? *shared : data; }
+    };
+
+} // namespace
+
+/**
+ * 连接状态
+ */
+struct WebSocketServer::Connection {
+    enum class Phase {
+        Http,           // HTTP请求（静态资源、升级前）
+        WebSocket,      // 已完成握手
+        Closing         // 发完剩余数据后关闭
+    };
+
+    int fd = -1;
+    Phase phase = Phase::Http;
+    bool closed = false;                // 已断开，等待清理
+    bool closeAfterWrite = false;       // 发送队列清空后关闭
+    bool peerClosed = false;            // 对端已关闭写方向（不再读取）
+
+    std::string inBuffer;               // 尚未处理的接收数据
+    std::deque<OutboundChunk> outQueue; // 发送队列（控制消息和会话响应直接追加，严格优先）
+    OutboundLanes lanes;                // 可延后的广播和预取消息，发送队列清空后按配额取出
+
+    std::shared_ptr<LoopbackChannel> loopback;  // 回环连接的通道（套接字连接为空）
+    std::unique_ptr<TlsSession> tls;            // TLS连接的会话（明文连接为空）
+
+    std::string sessionId;              // WebSocket连接对应的会话
+    SessionHandle session;              // 会话句柄（消息处理的热路径用它查找，不再按ID查找）
+    bool prefetchPending = false;       // 会话可能有待推送的预取消息（空闲时发送）
+    std::string fragmentBuffer;         // 分片消息重组缓冲
+    bool inFragment = false;
+
+    bool hasOutbound() const { return !outQueue.empty() || !lanes.empty(); }
+
+    ~Connection() {
+#ifndef _WIN32
+        for (auto& chunk : outQueue) {
+            if (chunk.isFile()) {
+                ::close(chunk.fileFd);
+            }
+        }
+#endif
+    }
+};
+
 // 构造函数 - 创建WebSocket服务器对象时调用
-WebSocketServer::WebSocketServer() : isRunning(false), port(8080) {
-    std::cout << "[WebSocket] 正在创建WebSocket服务器（简化版本）" << std::endl;
-    
+WebSocketServer::WebSocketServer()
+    : isRunning(false), port(8080), listenFd(-1), loopbackMode(false), nextLoopbackId(-2), prepared(false),
+      sessionManager(nullptr) {
+    wakeupPipe[0] = wakeupPipe[1] = -1;
+    std::cout << "[WebSocket] 正在创建WebSocket服务器" << std::endl;
+
     // 创建API处理器
     apiHandler = std::make_unique<APIHandler>();
     std::cout << "[WebSocket] API处理器已创建" << std::endl;
@@ -37,23 +162,55 @@ bool WebSocketServer::start(uint16_t serverPort) {
         std::cout << "[WebSocket] 警告: 服务器已经在运行" << std::endl;
         return true;
     }
-    
+
     this->port = serverPort;
-    
+
     try {
+#ifdef _WIN32
         std::cout << "[WebSocket] 正在启动WebSocket服务器（模拟模式），端口: " << port << std::endl;
-        
+
+        isRunning = true;
+
         // 在单独的线程中运行服务器模拟（不阻塞主程序）
         serverThread = std::thread([this]() {
             this->simulateServerLoop();
         });
-        
-        isRunning = true;
+
         std::cout << "[WebSocket] WebSocket服务器启动成功（模拟模式）！" << std::endl;
-        std::cout << "[WebSocket] 注意: 这是用于学习和测试的简化版本" << std::endl;
-        std::cout << "[WebSocket] 真正的WebSocket功能将在后续实现" << std::endl;
         return true;
-        
+#else
+        std::cout << "[WebSocket] 正在启动WebSocket服务器，端口: " << port << std::endl;
+
+        if (!prepare()) {
+            std::cerr << "[WebSocket] TLS配置无效，服务器未启动" << std::endl;
+            return false;
+        }
+
+        if (!openListener()) {
+            return false;
+        }
+
+        acceptor = std::make_unique<ConnectionAcceptor>(listenFd, [this]() {
+            char byte = 2;
+            (void)!::write(wakeupPipe[1], &byte, 1);
+        }, tlsContext.get());
+        if (!acceptor->start()) {
+            acceptor.reset();
+            closeListener();
+            return false;
+        }
+
+        isRunning = true;
+        serverThread = std::thread([this]() {
+            this->runEventLoop();
+        });
+
+        std::cout << "[WebSocket] WebSocket服务器启动成功！" << std::endl;
+        std::cout << "[WebSocket] 浏览器访问: " << (tlsContext ? "https" : "http") << "://localhost:" << port
+                  << "/" << std::endl;
+        return true;
+#endif
+
     } catch (const std::exception& e) {
         std::cerr << "[WebSocket] 服务器启动失败: " << e.what() << std::endl;
         return false;
@@ -65,17 +222,38 @@ void WebSocketServer::stop() {
     if (!isRunning) {
         return;
     }
-    
+
     std::cout << "[WebSocket] 正在停止WebSocket服务器..." << std::endl;
-    
+
     // 停止服务器
     isRunning = false;
-    
+
+#ifndef _WIN32
+    // 先停止接入（之后不会再有新连接交给事件循环），再唤醒事件循环
+    if (acceptor) {
+        acceptor->stop();
+    }
+    if (wakeupPipe[1] >= 0) {
+        char byte = 0;
+        (void)!::write(wakeupPipe[1], &byte, 1);
+    }
+#endif
+
     // 等待服务器线程结束
     if (serverThread.joinable()) {
         serverThread.join();
     }
-    
+
+#ifndef _WIN32
+    while (!connections.empty()) {
+        closeConnection(connections.begin()->first);
+    }
+    acceptor.reset();
+    tlsContext.reset();
+    closeListener();
+    loopbackMode = false;
+#endif
+
     std::cout << "[WebSocket] WebSocket服务器已停止" << std::endl;
 }
 
@@ -85,40 +263,50 @@ void WebSocketServer::setMessageHandler(std::function<void(const std::string&)>
     std::cout << "[WebSocket] 消息处理器已设置" << std::endl;
 }
 
-// 向所有客户端发送消息（模拟版本）
+// 设置会话管理器
+void WebSocketServer::setSessionManager(SessionManager* manager) {
+    sessionManager = manager;
+    std::cout << "[WebSocket] 会话管理器已设置" << std::endl;
+}
+
+// 设置前端静态资源目录
+void WebSocketServer::setStaticRoot(const std::string& directory) {
+    staticRoot = directory;
+}
+
+// 向所有客户端发送消息
 void WebSocketServer::sendToAll(const std::string& message) {
     if (!isRunning) {
         std::cout << "[WebSocket] 警告: 服务器未运行，无法发送消息" << std::endl;
         return;
     }
-    
+
+#ifdef _WIN32
     std::cout << "[WebSocket] [模拟] 向客户端发送消息: " << message.substr(0, 100);
     if (message.length() > 100) {
         std::cout << "...";
     }
     std::cout << std::endl;
+#else
+    {
+        MemoryScope memoryScope(MemoryTag::Network);
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        broadcastOutbox.push_back(message);
+    }
+    if (wakeupPipe[1] >= 0) {
+        char byte = 1;
+        (void)!::write(wakeupPipe[1], &byte, 1);
+    }
+#endif
 }
 
-// 模拟服务器运行循环
-void WebSocketServer::simulateServerLoop() {
-    std::cout << "[WebSocket] 服务器模拟循环已启动，端口: " << port << std::endl;
-    
-    int connectionCount = 0;
-    
-    while (isRunning) {
-        // 模拟每10秒有一个新的"连接"
-        std::this_thread::sleep_for(std::chrono::seconds(10));
-        
-        if (!isRunning) break;
-        
-        connectionCount++;
-        std::cout << "[WebSocket] [模拟] 新客户端连接 #" << connectionCount << std::endl;
-        
-        // 模拟发送欢迎消息
+// 创建欢迎消息
+std::string WebSocketServer::buildWelcomeMessage(const std::string& resumeToken) {
 #ifdef USE_SIMPLE_JSON
-        std::string welcome = R"({
+    return R"({
             "type": "welcome",
             "message": "欢迎来到时光信物游戏世界！",
+            "resumeToken": ")" + resumeToken + R"(",
             "data": {
                 "currentLocation": "bookstore",
                 "description": "你站在时光角落书店门前，温暖的灯光从窗户中透出...",
@@ -136,64 +324,1163 @@ void WebSocketServer::simulateServerLoop() {
             }
         })";
 #else
-        nlohmann::json welcome = {
-            {"type", "welcome"},
-            {"message", "欢迎来到时光信物游戏世界！"},
-            {"data", {
-                {"currentLocation", "bookstore"},
-                {"description", "你站在时光角落书店门前，温暖的灯光从窗户中透出..."},
-                {"playerAttributes", {
-                    {"observation", 1},
-                    {"communication", 1}, 
-                    {"action", 1},
-                    {"empathy", 1}
-                }},
-                {"availableActions", nlohmann::json::array({
-                    "enter_bookstore",
-                    "look_around",
-                    "examine_sign"
-                })}
-            }}
-        };
+    nlohmann::json welcome = {
+        {"type", "welcome"},
+        {"message", "欢迎来到时光信物游戏世界！"},
+        {"resumeToken", resumeToken},
+        {"data", {
+            {"currentLocation", "bookstore"},
+            {"description", "你站在时光角落书店门前，温暖的灯光从窗户中透出..."},
+            {"playerAttributes", {
+                {"observation", 1},
+                {"communication", 1},
+                {"action", 1},
+                {"empathy", 1}
+            }},
+            {"availableActions", nlohmann::json::array({
+                "enter_bookstore",
+                "look_around",
+                "examine_sign"
+            })}
+        }}
+    };
+    return welcome.dump();
 #endif
-        
+}
+
+#ifndef _WIN32
+
+// ==================== POSIX事件循环 ====================
+
+namespace {
+
+    bool setNonBlocking(int fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    void setCloseOnExec(int fd) {
+        int flags = ::fcntl(fd, F_GETFD, 0);
+        if (flags >= 0) {
+            ::fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+        }
+    }
+
+} // namespace
+
+// 创建监听套接字和唤醒管道
+bool WebSocketServer::openListener() {
+    if (::pipe(wakeupPipe) != 0) {
+        std::cerr << "[WebSocket] 创建唤醒管道失败: " << std::strerror(errno) << std::endl;
+        wakeupPipe[0] = wakeupPipe[1] = -1;
+        return false;
+    }
+    for (int fd : wakeupPipe) {
+        setNonBlocking(fd);
+        setCloseOnExec(fd);
+    }
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "[WebSocket] 创建套接字失败: " << std::strerror(errno) << std::endl;
+        closeListener();
+        return false;
+    }
+    setCloseOnExec(listenFd);
+
+    int enable = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0 || !setNonBlocking(listenFd)) {
+        std::cerr << "[WebSocket] 监听端口 " << port << " 失败: " << std::strerror(errno) << std::endl;
+        closeListener();
+        return false;
+    }
+    return true;
+}
+
+// 关闭监听套接字和唤醒管道（启动失败的每条路径和stop都经过这里，重试启动不会泄漏描述符）
+void WebSocketServer::closeListener() {
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+    }
+    for (int& fd : wakeupPipe) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+// 事件循环
+void WebSocketServer::runEventLoop() {
+    std::cout << "[WebSocket] 事件循环已启动，端口: " << port << std::endl;
+
+    // 服务器线程上的分配默认记到网络缓冲
+    MemoryScope memoryScope(MemoryTag::Network);
+
+    std::vector<pollfd> pollFds;
+    lastExpirySweep = std::chrono::steady_clock::now();
+    TickWatchdog::instance().registerCurrentThread("network", std::chrono::milliseconds(16));
+
+    while (isRunning) {
+        // 每秒清理一次断线过久的会话
+        auto now = std::chrono::steady_clock::now();
+        if (sessionManager && now - lastExpirySweep >= std::chrono::seconds(1)) {
+            sessionManager->expireDetachedSessions(kResumeWindow);
+            lastExpirySweep = now;
+        }
+
+        pollFds.clear();
+        pollFds.push_back({wakeupPipe[0], POLLIN, 0});
+        for (const auto& entry : connections) {
+            short events = entry.second->peerClosed ? 0 : POLLIN;
+            if (entry.second->hasOutbound()) {
+                events |= POLLOUT;
+            }
+            pollFds.push_back({entry.first, events, 0});
+        }
+
+        // 有新会话在等放行配额时，按下一个配额到来的时间醒来
+        int ready = ::poll(pollFds.data(), pollFds.size(), acceptor->admissionDelayMillis(200));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "[WebSocket] poll失败: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (!isRunning) {
+            break;
+        }
+
+        // poll返回后到下一次poll之前算作一轮（看门狗据此判断事件循环是否卡住）
+        TickWatchdog::Tick tick;
+
+        if (pollFds[0].revents & POLLIN) {
+            char buffer[64];
+            while (::read(wakeupPipe[0], buffer, sizeof(buffer)) > 0) {
+            }
+            drainBroadcastOutbox();
+        }
+        admitConnections();
+
+        for (size_t i = 1; i < pollFds.size(); ++i) {
+            if (pollFds[i].revents == 0) {
+                continue;
+            }
+            auto it = connections.find(pollFds[i].fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& connection = *it->second;
+            if (pollFds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                handleReadable(connection);
+            }
+            if (!connection.closed && connection.hasOutbound()) {
+                handleWritable(connection);
+            }
+        }
+
+        // 清理已断开的连接
+        std::vector<int> closedFds;
+        for (const auto& entry : connections) {
+            if (entry.second->closed) {
+                closedFds.push_back(entry.first);
+            }
+        }
+        for (int fd : closedFds) {
+            closeConnection(fd);
+        }
+
+        pushPrefetchHints();
+    }
+
+    TickWatchdog::instance().unregisterCurrentThread();
+    std::cout << "[WebSocket] 事件循环已结束" << std::endl;
+}
+
+// 放行接入流水线中就绪的连接
+void WebSocketServer::admitConnections() {
+    std::vector<ConnectionAcceptor::Ready> ready;
+    if (acceptor->takeReady(ready) == 0) {
+        return;
+    }
+
+    for (auto& item : ready) {
+        auto connection = std::make_unique<Connection>();
+        connection->fd = item.fd;
+        connection->inBuffer = std::move(item.buffered);
+        connection->tls = std::move(item.tls);
+        Connection& admitted = *connection;
+        connections[item.fd] = std::move(connection);
+
+        if (item.upgrade) {
+            completeUpgrade(admitted, item.request, item.acceptKey);
+        }
+        processBuffered(admitted);
+        if (!admitted.closed && admitted.hasOutbound()) {
+            handleWritable(admitted);
+        }
+    }
+}
+
+// 预热：加载静态资源和证书（不监听端口）
+bool WebSocketServer::prepare() {
+    if (prepared) {
+        return true;
+    }
+
+    // 加载前端静态资源（找不到前端目录时只提供WebSocket）
+    if (staticRoot.empty()) {
+        staticRoot = StaticFileServer::locateFrontendRoot();
+    }
+    if (!staticRoot.empty()) {
+        staticFiles = std::make_unique<StaticFileServer>(staticRoot);
+        if (!staticFiles->initialize()) {
+            staticFiles.reset();
+        }
+    } else {
+        std::cout << "[WebSocket] 未找到前端目录，不提供静态资源" << std::endl;
+    }
+
+    // 配置了证书却加载失败时不以明文启动
+    bool tlsConfigured = false;
+    tlsContext = TlsContext::fromEnvironment(tlsConfigured);
+    if (tlsConfigured && !tlsContext) {
+        return false;
+    }
+    prepared = true;
+    return true;
+}
+
+// 以回环模式启动
+bool WebSocketServer::startLoopback() {
+    if (isRunning) {
+        std::cout << "[WebSocket] 警告: 服务器已经在运行，不能切换到回环模式" << std::endl;
+        return false;
+    }
+    loopbackMode = true;
+    isRunning = true;
+    lastExpirySweep = std::chrono::steady_clock::now();
+    std::cout << "[WebSocket] 回环模式已启动（不监听端口，由调用者驱动事件循环）" << std::endl;
+    return true;
+}
+
+// 打开一条回环连接（之后的升级请求由pumpLoopback处理）
+std::shared_ptr<LoopbackChannel> WebSocketServer::openLoopback(size_t capacity) {
+    if (!loopbackMode || !isRunning) {
+        return nullptr;
+    }
+    MemoryScope memoryScope(MemoryTag::Network);
+    auto channel = std::make_shared<LoopbackChannel>(capacity);
+    auto connection = std::make_unique<Connection>();
+    connection->fd = nextLoopbackId--;
+    connection->loopback = channel;
+    connections[connection->fd] = std::move(connection);
+    return channel;
+}
+
+// 回环模式的一轮事件循环（对应runEventLoop的一次poll返回）
+size_t WebSocketServer::pumpLoopback() {
+    if (!loopbackMode || !isRunning) {
+        return 0;
+    }
+    MemoryScope memoryScope(MemoryTag::Network);
+
+    auto now = std::chrono::steady_clock::now();
+    if (sessionManager && now - lastExpirySweep >= std::chrono::seconds(1)) {
+        sessionManager->expireDetachedSessions(kResumeWindow);
+        lastExpirySweep = now;
+    }
+    drainBroadcastOutbox();
+
+    size_t moved = 0;
+    std::vector<int> closedIds;
+    for (auto& entry : connections) {
+        Connection& connection = *entry.second;
+        if (!connection.closed) {
+            size_t room = kMaxBufferedInput - std::min(kMaxBufferedInput, connection.inBuffer.size());
+            size_t received = connection.loopback->serverInbound().readAppend(connection.inBuffer, room);
+            moved += received;
+            if (received > 0) {
+                processBuffered(connection);
+            } else if (connection.loopback->isClientClosed()) {
+                connection.closed = true;   // 对端关闭且数据已读完
+            }
+        }
+        if (!connection.closed && connection.hasOutbound()) {
+            moved += writeLoopback(connection);
+        }
+        if (connection.closed) {
+            closedIds.push_back(entry.first);
+        }
+    }
+    for (int id : closedIds) {
+        closeConnection(id);
+    }
+
+    pushPrefetchHints();
+    return moved;
+}
+
+// 把发送队列写入回环通道（环满时保留剩余部分，相当于套接字的EAGAIN）
+size_t WebSocketServer::writeLoopback(Connection& connection) {
+    SpscByteRing& ring = connection.loopback->serverOutbound();
+    size_t written = 0;
+    promoteLanes(connection);
+
+    while (!connection.outQueue.empty()) {
+        OutboundChunk& front = connection.outQueue.front();
+
+        if (front.isFile()) {
+            char buffer[16 * 1024];
+            size_t count = static_cast<size_t>(std::min<uint64_t>(front.fileRemaining,
+                                                                  std::min(sizeof(buffer), ring.writable())));
+            if (count == 0) {
+                return written;
+            }
+            ssize_t readBytes = ::pread(front.fileFd, buffer, count, static_cast<off_t>(front.fileOffset));
+            if (readBytes <= 0) {
+                connection.closed = true;   // 文件被截断
+                return written;
+            }
+            size_t sent = ring.write(buffer, static_cast<size_t>(readBytes));
+            front.fileOffset += static_cast<int64_t>(sent);
+            front.fileRemaining -= sent;
+            written += sent;
+            if (front.fileRemaining == 0) {
+                ::close(front.fileFd);
+                connection.outQueue.pop_front();
+            }
+            continue;
+        }
+
+        const std::string& bytes = front.bytes();
+        size_t sent = ring.write(bytes.data() + front.offset, bytes.size() - front.offset);
+        front.offset += sent;
+        written += sent;
+        if (front.offset < bytes.size()) {
+            return written;
+        }
+        connection.outQueue.pop_front();
+    }
+
+    if (connection.closeAfterWrite) {
+        connection.closed = true;
+    }
+    return written;
+}
+
+// 读取数据并按连接阶段处理
+void WebSocketServer::handleReadable(Connection& connection) {
+    if (connection.peerClosed) {
+        return;
+    }
+    char buffer[kReadChunkSize];
+    bool peerClosed = false;
+    while (connection.tls && connection.inBuffer.size() < kMaxBufferedInput) {
+        size_t received = 0;
+        TlsSession::Result result = connection.tls->read(buffer, sizeof(buffer), received);
+        if (result == TlsSession::Result::Ok) {
+            connection.inBuffer.append(buffer, received);
+            continue;
+        }
+        if (result == TlsSession::Result::Closed) {
+            peerClosed = true;
+        } else if (result == TlsSession::Result::Failed) {
+            connection.closed = true;
+            return;
+        }
+        break;
+    }
+    while (!connection.tls && connection.inBuffer.size() < kMaxBufferedInput) {
+        ssize_t received = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection.inBuffer.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received == 0) {
+            peerClosed = true;          // 对端关闭（已收到的数据仍然处理）
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            connection.closed = true;
+            return;
+        }
+        break;
+    }
+
+    processBuffered(connection);
+
+    if (connection.inBuffer.size() >= kMaxBufferedInput) {
+        // 处理后仍然是满的：请求头或帧超出了任何合法消息的大小
+        connection.closed = true;
+    } else if (peerClosed) {
+        // 对端只关闭了写方向时，已排队的响应发完再关闭
+        connection.peerClosed = true;
+        if (connection.hasOutbound()) {
+            connection.closeAfterWrite = true;
+        } else {
+            connection.closed = true;
+        }
+    }
+}
+
+// 按连接阶段处理接收缓冲中的数据
+void WebSocketServer::processBuffered(Connection& connection) {
+    if (connection.phase == Connection::Phase::Http) {
+        processHttp(connection);
+    }
+    if (connection.phase == Connection::Phase::WebSocket) {
+        processWebSocket(connection);
+    }
+    if (connection.phase == Connection::Phase::Closing) {
+        connection.inBuffer.clear();    // 关闭阶段丢弃后续数据
+    }
+}
+
+// 发送队列中的数据（内存数据用writev合并，文件用sendfile）
+void WebSocketServer::handleWritable(Connection& connection) {
+    static auto& bytesSentCounter = Metrics::instance().counter("network.bytes_sent");
+    static auto& sendfileCounter = Metrics::instance().counter("network.sendfile_bytes");
+
+    if (connection.loopback) {
+        writeLoopback(connection);
+        return;
+    }
+    promoteLanes(connection);
+    // kTLS未生效：用户态加密。kTLS生效时下面的writev/sendfile写入的明文由内核加密
+    if (connection.tls && !connection.tls->kernelSend()) {
+        writeTls(connection);
+        return;
+    }
+
+    while (!connection.outQueue.empty()) {
+        OutboundChunk& front = connection.outQueue.front();
+
+        if (front.isFile()) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(front.fileRemaining, kSendfileChunk));
+#ifdef __linux__
+            off_t offset = static_cast<off_t>(front.fileOffset);
+            ssize_t sent = ::sendfile(connection.fd, front.fileFd, &offset, count);
+            if (sent > 0) {
+                front.fileOffset = offset;
+            }
+#else
+            // 没有Linux sendfile的平台：pread + send
+            char buffer[64 * 1024];
+            ssize_t readBytes = ::pread(front.fileFd, buffer, std::min(count, sizeof(buffer)),
+                                        static_cast<off_t>(front.fileOffset));
+            ssize_t sent = readBytes > 0 ? ::send(connection.fd, buffer, static_cast<size_t>(readBytes), MSG_NOSIGNAL)
+                                         : readBytes;
+            if (sent > 0) {
+                front.fileOffset += sent;
+            }
+#endif
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    connection.closed = true;
+                }
+                return;
+            }
+            if (sent == 0) {
+                connection.closed = true;   // 文件被截断
+                return;
+            }
+            front.fileRemaining -= static_cast<uint64_t>(sent);
+            bytesSentCounter += sent;
+            sendfileCounter += sent;
+            if (front.fileRemaining == 0) {
+                ::close(front.fileFd);
+                connection.outQueue.pop_front();
+            }
+            continue;
+        }
+
+        // 合并连续的内存数据块
+        iovec iov[kMaxIovecs];
+        int iovCount = 0;
+        size_t attempted = 0;
+        for (auto it = connection.outQueue.begin();
+             it != connection.outQueue.end() && !it->isFile() && iovCount < kMaxIovecs; ++it) {
+            const std::string& bytes = it->bytes();
+            iov[iovCount].iov_base = const_cast<char*>(bytes.data() + it->offset);
+            iov[iovCount].iov_len = bytes.size() - it->offset;
+            attempted += iov[iovCount].iov_len;
+            ++iovCount;
+        }
+
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = iovCount;
+        ssize_t sent = ::sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                connection.closed = true;
+            }
+            return;
+        }
+        bytesSentCounter += sent;
+
+        size_t remaining = static_cast<size_t>(sent);
+        while (remaining > 0) {
+            OutboundChunk& chunk = connection.outQueue.front();
+            size_t left = chunk.bytes().size() - chunk.offset;
+            if (remaining < left) {
+                chunk.offset += remaining;
+                break;
+            }
+            remaining -= left;
+            connection.outQueue.pop_front();
+        }
+        if (static_cast<size_t>(sent) < attempted) {
+            return;     // 内核发送缓冲已满，等待POLLOUT
+        }
+    }
+
+    if (connection.closeAfterWrite) {
+        if (connection.tls) {
+            connection.tls->shutdown();
+        }
+        ::shutdown(connection.fd, SHUT_WR);
+        connection.closed = true;
+    }
+}
+
+// 用SSL_write发送队列（内核不支持kTLS时的回退路径；文件块经pread读入后加密）
+void WebSocketServer::writeTls(Connection& connection) {
+    static auto& bytesSentCounter = Metrics::instance().counter("network.bytes_sent");
+
+    while (!connection.outQueue.empty()) {
+        OutboundChunk& front = connection.outQueue.front();
+        size_t sent = 0;
+        TlsSession::Result result;
+
+        if (front.isFile()) {
+            // 一次一个TLS记录；WantWrite后重试时pread读到的是同样的字节
+            char buffer[16 * 1024];
+            size_t count = static_cast<size_t>(std::min<uint64_t>(front.fileRemaining, sizeof(buffer)));
+            ssize_t readBytes = ::pread(front.fileFd, buffer, count, static_cast<off_t>(front.fileOffset));
+            if (readBytes <= 0) {
+                connection.closed = true;   // 文件被截断
+                return;
+            }
+            result = connection.tls->write(buffer, static_cast<size_t>(readBytes), sent);
+            front.fileOffset += static_cast<int64_t>(sent);
+            front.fileRemaining -= sent;
+            if (front.fileRemaining == 0) {
+                ::close(front.fileFd);
+                connection.outQueue.pop_front();
+            }
+        } else {
+            const std::string& bytes = front.bytes();
+            result = connection.tls->write(bytes.data() + front.offset, bytes.size() - front.offset, sent);
+            front.offset += sent;
+            if (front.offset == bytes.size()) {
+                connection.outQueue.pop_front();
+            }
+        }
+        bytesSentCounter += static_cast<int64_t>(sent);
+
+        if (result == TlsSession::Result::WantRead || result == TlsSession::Result::WantWrite) {
+            return;     // 等待POLLOUT后用同样的数据重试
+        }
+        if (result != TlsSession::Result::Ok) {
+            connection.closed = true;
+            return;
+        }
+    }
+
+    if (connection.closeAfterWrite) {
+        connection.tls->shutdown();
+        ::shutdown(connection.fd, SHUT_WR);
+        connection.closed = true;
+    }
+}
+
+// 解析HTTP请求（支持同一连接上的多个请求）
+void WebSocketServer::processHttp(Connection& connection) {
+    while (connection.phase == Connection::Phase::Http && !connection.closeAfterWrite) {
+        HttpRequest request;
+        size_t consumed = 0;
+        Http::ParseResult result = Http::parseRequest(connection.inBuffer, request, consumed);
+
+        if (result == Http::ParseResult::Incomplete) {
+            break;
+        }
+        if (result == Http::ParseResult::BadRequest) {
+            queueResponse(connection, StaticFileServer::makeResponse(
+                400, "text/plain; charset=utf-8", "Bad Request\n", false));
+            connection.closeAfterWrite = true;
+            connection.phase = Connection::Phase::Closing;
+            break;
+        }
+
+        connection.inBuffer.erase(0, consumed);
+        handleHttpRequest(connection, request);
+    }
+}
+
+// 处理一个完整的HTTP请求
+void WebSocketServer::handleHttpRequest(Connection& connection, const HttpRequest& request) {
+    static auto& requestCounter = Metrics::instance().counter("network.http_requests");
+    static auto& notModifiedCounter = Metrics::instance().counter("network.http_not_modified");
+    requestCounter++;
+
+    if (request.isWebSocketUpgrade()) {
+        upgradeToWebSocket(connection, request);
+        return;
+    }
+
+    bool keepAlive = request.keepAlive();
+    StaticResponse response;
+    if (request.path == "/metrics" && (request.method == "GET" || request.method == "HEAD")) {
+        response = StaticFileServer::makeResponse(200, "text/plain; charset=utf-8",
+                                                  Metrics::instance().renderText(), keepAlive,
+                                                  request.method == "HEAD");
+    } else if (request.path == "/stats" && (request.method == "GET" || request.method == "HEAD")) {
+        response = StaticFileServer::makeResponse(200, "application/json; charset=utf-8",
+                                                  ChoiceStatistics::instance().snapshot()->toJson(), keepAlive,
+                                                  request.method == "HEAD");
+    } else if (staticFiles) {
+        response = staticFiles->respond(request);
+    } else {
+        response = StaticFileServer::makeResponse(404, "text/plain; charset=utf-8", "Not Found\n", keepAlive);
+    }
+
+    OutboundChunk file;
+    if (!response.filePath.empty()) {
+        file.fileFd = ::open(response.filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        file.fileRemaining = response.fileSize;
+        if (file.fileFd < 0) {
+            std::cerr << "[WebSocket] 打开静态文件失败: " << response.filePath << std::endl;
+            response = StaticFileServer::makeResponse(500, "text/plain; charset=utf-8",
+                                                      "Internal Server Error\n", false);
+            keepAlive = false;
+        }
+    }
+    if (response.status == 304) {
+        notModifiedCounter++;
+    }
+
+    queueResponse(connection, response);
+    if (file.isFile()) {
+        connection.outQueue.push_back(std::move(file));
+    }
+
+    if (!keepAlive) {
+        connection.closeAfterWrite = true;
+    }
+}
+
+// 把HTTP响应头和内存中的响应体放入发送队列
+void WebSocketServer::queueResponse(Connection& connection, const StaticResponse& response) {
+    OutboundChunk head;
+    head.data = response.head;
+    connection.outQueue.push_back(std::move(head));
+    if (response.body && !response.body->empty()) {
+        OutboundChunk body;
+        body.shared = response.body;    // 共享缓存，不拷贝
+        connection.outQueue.push_back(std::move(body));
+    }
+}
+
+// 完成WebSocket握手，为连接创建会话
+void WebSocketServer::upgradeToWebSocket(Connection& connection, const HttpRequest& request) {
+    std::string key = request.header("sec-websocket-key");
+    if (key.empty() || request.header("sec-websocket-version") != "13") {
+        queueResponse(connection, StaticFileServer::makeResponse(
+            400, "text/plain; charset=utf-8", "Unsupported WebSocket version\n", false));
+        connection.closeAfterWrite = true;
+        connection.phase = Connection::Phase::Closing;
+        return;
+    }
+
+    completeUpgrade(connection, request, WebSocketFrame::computeAcceptKey(key));
+}
+
+// 发送101响应并为连接创建或恢复会话（acceptKey可能已在握手线程上算好）
+void WebSocketServer::completeUpgrade(Connection& connection, const HttpRequest& request, const std::string& acceptKey) {
+    OutboundChunk handshake;
+    handshake.data = "HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: " + acceptKey + "\r\n\r\n";
+    connection.outQueue.push_back(std::move(handshake));
+    connection.phase = Connection::Phase::WebSocket;
+
+#ifdef TCP_NOTSENT_LOWAT
+    // 内核中未发出的数据低于这个值才报告可写：低优先级通道不会塞满发送缓冲，
+    // 之后到达的会话响应不用排在大量已提交的数据后面
+    if (!connection.loopback) {
+        int lowWater = static_cast<int>(OutboundLanes::kPartSize);
+        ::setsockopt(connection.fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowWater, sizeof(lowWater));
+    }
+#endif
+
+    // 带恢复令牌的重连：接管原会话，只补发缺失的消息
+    if (resumeSession(connection, request)) {
+        return;
+    }
+
+    std::string resumeToken;
+    if (sessionManager) {
+        std::string sessionId = sessionManager->createSession();
+        attachSession(connection, sessionId);
+        resumeToken = sessionManager->getResumeToken(sessionId);
+    }
+
+    sendSessionMessage(connection, buildWelcomeMessage(resumeToken));
+}
+
+// 处理 ws://host/?resume=<令牌>&lastSeq=<序号> 形式的重连
+bool WebSocketServer::resumeSession(Connection& connection, const HttpRequest& request) {
+    std::string resumeToken = request.queryParameter("resume");
+    if (!sessionManager || resumeToken.empty()) {
+        return false;
+    }
+
+    uint64_t lastSequence = 0;
+    try {
+        lastSequence = std::stoull(request.queryParameter("lastSeq"));
+    } catch (const std::exception&) {
+        lastSequence = 0;
+    }
+
+    std::string sessionId;
+    std::vector<OutboundRing::Frame> replay;
+    auto result = sessionManager->resumeSession(resumeToken, lastSequence, sessionId, replay);
+    if (result == SessionManager::ResumeResult::NotFound) {
+        std::cout << "[WebSocket] 恢复令牌无效或会话已过期，创建新会话" << std::endl;
+        return false;
+    }
+
+    attachSession(connection, sessionId);
+    bool snapshot = result == SessionManager::ResumeResult::SnapshotRequired;
+
+    // "resumed" 是控制消息，不占用序号
+    sendFrame(connection, WebSocketFrame::Opcode::Text,
+              "{\"type\":\"resumed\",\"data\":{\"replayed\":" + std::to_string(replay.size()) +
+              ",\"snapshot\":" + (snapshot ? "true" : "false") + "}}");
+
+    if (snapshot) {
+        // 缺口超出出站消息环：发送带新序号的完整状态
+        sendSessionMessage(connection, sessionManager->snapshot(sessionId));
+    } else {
+        for (auto& frame : replay) {
+            OutboundChunk chunk;
+            chunk.shared = std::move(frame);    // 直接复用环中已编码的帧
+            connection.outQueue.push_back(std::move(chunk));
+        }
+    }
+
+    std::cout << "[WebSocket] 会话已恢复: " << sessionId << "（"
+              << (snapshot ? "完整快照" : "补发 " + std::to_string(replay.size()) + " 条消息") << "）" << std::endl;
+    return true;
+}
+
+// 把会话绑定到连接（同一会话的旧连接被关闭）
+void WebSocketServer::attachSession(Connection& connection, const std::string& sessionId) {
+    auto existing = sessionConnections.find(sessionId);
+    if (existing != sessionConnections.end() && existing->second != connection.fd) {
+        auto old = connections.find(existing->second);
+        if (old != connections.end()) {
+            old->second->sessionId.clear();
+            old->second->session = SessionHandle();
+            failWebSocket(*old->second, WebSocketFrame::CloseGoingAway);
+        }
+    }
+    sessionConnections[sessionId] = connection.fd;
+    connection.sessionId = sessionId;
+    connection.session = sessionManager->findSession(sessionId);
+    connection.prefetchPending = true;
+}
+
+// 解析WebSocket帧
+void WebSocketServer::processWebSocket(Connection& connection) {
+    using WebSocketFrame::Opcode;
+    static auto& framesReceivedCounter = Metrics::instance().counter("network.frames_received");
+
+    uint8_t* data = reinterpret_cast<uint8_t*>(&connection.inBuffer[0]);
+    size_t length = connection.inBuffer.size();
+    size_t offset = 0;
+
+    while (offset < length && connection.phase == Connection::Phase::WebSocket) {
+        WebSocketFrame::FrameHeader header;
+        auto result = WebSocketFrame::parseHeader(data + offset, length - offset, header);
+        if (result == WebSocketFrame::ParseResult::Incomplete) {
+            break;
+        }
+        if (result == WebSocketFrame::ParseResult::ProtocolError || !header.masked) {
+            // 客户端发出的帧必须加掩码
+            failWebSocket(connection, WebSocketFrame::CloseProtocolError);
+            return;
+        }
+        if (header.payloadLength > kMaxMessageSize ||
+            connection.fragmentBuffer.size() + header.payloadLength > kMaxMessageSize) {
+            failWebSocket(connection, WebSocketFrame::CloseMessageTooBig);
+            return;
+        }
+        if (length - offset < header.headerLength + header.payloadLength) {
+            break;  // 负载尚未收全
+        }
+
+        uint8_t* payload = data + offset + header.headerLength;
+        size_t payloadLength = static_cast<size_t>(header.payloadLength);
+        offset += header.headerLength + payloadLength;
+        framesReceivedCounter++;
+
+        switch (header.opcode) {
+            case Opcode::Text:
+                if (connection.inFragment) {
+                    failWebSocket(connection, WebSocketFrame::CloseProtocolError);
+                    return;
+                }
+                if (header.fin) {
+                    if (!FrameKernels::unmaskAndValidateUtf8(payload, payloadLength, header.maskKey)) {
+                        failWebSocket(connection, WebSocketFrame::CloseInvalidPayload);
+                        return;
+                    }
+                    handleTextMessage(connection, std::string(reinterpret_cast<char*>(payload), payloadLength));
+                } else {
+                    // 分片消息：重组完成后再整体校验UTF-8（字符可能跨分片）
+                    FrameKernels::unmask(payload, payloadLength, header.maskKey);
+                    connection.fragmentBuffer.assign(reinterpret_cast<char*>(payload), payloadLength);
+                    connection.inFragment = true;
+                }
+                break;
+
+            case Opcode::Continuation:
+                if (!connection.inFragment) {
+                    failWebSocket(connection, WebSocketFrame::CloseProtocolError);
+                    return;
+                }
+                FrameKernels::unmask(payload, payloadLength, header.maskKey);
+                connection.fragmentBuffer.append(reinterpret_cast<char*>(payload), payloadLength);
+                if (header.fin) {
+                    connection.inFragment = false;
+                    std::string message;
+                    message.swap(connection.fragmentBuffer);
+                    if (!FrameKernels::validateUtf8(reinterpret_cast<const uint8_t*>(message.data()), message.size())) {
+                        failWebSocket(connection, WebSocketFrame::CloseInvalidPayload);
+                        return;
+                    }
+                    handleTextMessage(connection, message);
+                }
+                break;
+
+            case Opcode::Binary:
+                // 游戏协议只使用文本消息
+                failWebSocket(connection, WebSocketFrame::CloseUnsupportedData);
+                return;
+
+            case Opcode::Ping:
+                FrameKernels::unmask(payload, payloadLength, header.maskKey);
+                sendFrame(connection, Opcode::Pong, std::string(reinterpret_cast<char*>(payload), payloadLength));
+                break;
+
+            case Opcode::Pong:
+                break;
+
+            case Opcode::Close: {
+                // 回应关闭帧后关闭连接：对方的状态码或原因不合法时回1002/1007，否则回1000
+                FrameKernels::unmask(payload, payloadLength, header.maskKey);
+                uint16_t code = WebSocketFrame::CloseNormal;
+                if (payloadLength == 1) {
+                    code = WebSocketFrame::CloseProtocolError;
+                } else if (payloadLength >= 2) {
+                    uint16_t received = static_cast<uint16_t>((payload[0] << 8) | payload[1]);
+                    if (!WebSocketFrame::isValidCloseCode(received)) {
+                        code = WebSocketFrame::CloseProtocolError;
+                    } else if (!FrameKernels::validateUtf8(payload + 2, payloadLength - 2)) {
+                        code = WebSocketFrame::CloseInvalidPayload;
+                    }
+                }
+                failWebSocket(connection, code);
+                return;
+            }
+
+            default:
+                failWebSocket(connection, WebSocketFrame::CloseProtocolError);
+                return;
+        }
+    }
+
+    connection.inBuffer.erase(0, offset);
+}
+
+// 把一条完整的文本消息交给会话处理
+void WebSocketServer::handleTextMessage(Connection& connection, const std::string& message) {
+    TickWatchdog::Context watchdogContext("", connection.sessionId);
+    std::string response;
+    if (sessionManager) {
+        response = sessionManager->handleMessage(connection.session, message);
+    } else if (apiHandler) {
+        response = apiHandler->handleMessage(message);
+    }
+
+    // 如果设置了消息处理器，也调用它
+    if (messageHandler) {
+        messageHandler(message);
+    }
+
+    if (!response.empty()) {
+        sendSessionMessage(connection, response);
+    }
+    connection.prefetchPending = !connection.sessionId.empty();
+}
+
+// 推送预取消息：放入Bulk通道，发送队列清空后才按配额发出，不与正常响应争抢带宽；
+// prefetch消息不占用会话序号，断线重连时也不补发
+void WebSocketServer::pushPrefetchHints() {
+    static auto& hintsCounter = Metrics::instance().counter("prefetch.hints_sent");
+    static auto& bytesCounter = Metrics::instance().counter("prefetch.bytes_sent");
+
+    if (!sessionManager) {
+        return;
+    }
+    for (auto& entry : connections) {
+        Connection& connection = *entry.second;
+        if (!connection.prefetchPending || connection.closed || connection.phase != Connection::Phase::WebSocket) {
+            continue;
+        }
+        connection.prefetchPending = false;
+
+        auto hints = sessionManager->takePrefetchHints(connection.session);
+        for (const auto& hint : hints) {
+            if (connection.lanes.push(OutboundLanes::Lane::Bulk, hint)) {
+                hintsCounter.fetch_add(1, std::memory_order_relaxed);
+                bytesCounter.fetch_add(static_cast<int64_t>(hint->size()), std::memory_order_relaxed);
+            }
+        }
+        if (!hints.empty()) {
+            handleWritable(connection);
+        }
+    }
+}
+
+// 发送队列清空后从优先级通道取出最多一个分片大小的消息
+// （之后到达的会话响应排在这些消息后面，最多等待这么多字节）
+void WebSocketServer::promoteLanes(Connection& connection) {
+    static auto& ambientBytes = Metrics::instance().counter("network.lane_bytes.ambient");
+    static auto& bulkBytes = Metrics::instance().counter("network.lane_bytes.bulk");
+
+    if (!connection.outQueue.empty() || connection.lanes.empty() ||
+        connection.phase != Connection::Phase::WebSocket || connection.closeAfterWrite) {
+        return;
+    }
+    size_t promoted = 0;
+    OutboundLanes::Message message;
+    while (promoted < OutboundLanes::kPartSize && connection.lanes.next(message)) {
+        promoted += message.payload->size();
+        if (message.lane == OutboundLanes::Lane::Ambient) {
+            sendSessionMessage(connection, *message.payload);
+            ambientBytes.fetch_add(static_cast<int64_t>(message.payload->size()), std::memory_order_relaxed);
+        } else {
+            sendFrame(connection, WebSocketFrame::Opcode::Text, *message.payload);
+            bulkBytes.fetch_add(static_cast<int64_t>(message.payload->size()), std::memory_order_relaxed);
+        }
+    }
+}
+
+// 把一个帧放入发送队列
+void WebSocketServer::sendFrame(Connection& connection, WebSocketFrame::Opcode opcode, const std::string& payload) {
+    static auto& framesSentCounter = Metrics::instance().counter("network.frames_sent");
+
+    OutboundChunk chunk;
+    chunk.data = WebSocketFrame::encodeFrame(opcode, payload);
+    connection.outQueue.push_back(std::move(chunk));
+    framesSentCounter++;
+}
+
+// 发送会话消息（带序号，并保存到会话的出站消息环）
+void WebSocketServer::sendSessionMessage(Connection& connection, const std::string& message) {
+    static auto& framesSentCounter = Metrics::instance().counter("network.frames_sent");
+
+    if (!sessionManager || connection.sessionId.empty()) {
+        sendFrame(connection, WebSocketFrame::Opcode::Text, message);
+        return;
+    }
+
+    OutboundChunk chunk;
+    chunk.shared = sessionManager->encodeOutbound(connection.session, message);
+    connection.outQueue.push_back(std::move(chunk));
+    framesSentCounter++;
+}
+
+// 发送关闭帧并进入关闭阶段
+void WebSocketServer::failWebSocket(Connection& connection, uint16_t code) {
+    OutboundChunk chunk;
+    chunk.data = WebSocketFrame::encodeClose(code);
+    connection.outQueue.push_back(std::move(chunk));
+    connection.phase = Connection::Phase::Closing;
+    connection.closeAfterWrite = true;
+    connection.inBuffer.clear();
+}
+
+// 把sendToAll投递的消息发给所有WebSocket连接
+void WebSocketServer::drainBroadcastOutbox() {
+    std::vector<std::string> messages;
+    {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        messages.swap(broadcastOutbox);
+    }
+
+    if (messages.empty()) {
+        return;
+    }
+    std::vector<OutboundLanes::Payload> payloads;
+    payloads.reserve(messages.size());
+    for (auto& message : messages) {
+        payloads.push_back(std::make_shared<const std::string>(std::move(message)));
+    }
+
+    // 放入Ambient通道：发出时才按各会话的序号编码，序号顺序与实际发送顺序一致
+    for (auto& entry : connections) {
+        Connection& connection = *entry.second;
+        if (connection.phase != Connection::Phase::WebSocket || connection.closed) {
+            continue;
+        }
+        for (const auto& payload : payloads) {
+            connection.lanes.push(OutboundLanes::Lane::Ambient, payload);
+        }
+        handleWritable(connection);
+    }
+}
+
+// 关闭连接（会话保留一段时间等待重连）
+void WebSocketServer::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+        return;
+    }
+
+    const std::string& sessionId = it->second->sessionId;
+    if (sessionManager && !sessionId.empty()) {
+        sessionManager->detachSession(sessionId);
+        sessionConnections.erase(sessionId);
+    }
+    if (it->second->loopback) {
+        it->second->loopback->markServerClosed();
+    } else {
+        ::close(fd);
+    }
+    connections.erase(it);
+}
+
+#else
+
+// 模拟模式不提供静态资源和TLS
+bool WebSocketServer::prepare() {
+    prepared = true;
+    return true;
+}
+
+// 回环模式依赖POSIX事件循环的连接处理
+bool WebSocketServer::startLoopback() {
+    std::cerr << "[WebSocket] 当前平台不支持回环模式" << std::endl;
+    return false;
+}
+
+std::shared_ptr<LoopbackChannel> WebSocketServer::openLoopback(size_t) {
+    return nullptr;
+}
+
+size_t WebSocketServer::pumpLoopback() {
+    return 0;
+}
+
+#endif // !_WIN32
+
+// 模拟服务器运行循环
+void WebSocketServer::simulateServerLoop() {
+    std::cout << "[WebSocket] 服务器模拟循环已启动，端口: " << port << std::endl;
+
+    // 服务器线程上的分配默认记到网络缓冲
+    MemoryScope memoryScope(MemoryTag::Network);
+
+    int connectionCount = 0;
+
+    while (isRunning) {
+        // 模拟每10秒有一个新的"连接"
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+
+        if (!isRunning) break;
+
+        connectionCount++;
+        std::cout << "[WebSocket] [模拟] 新客户端连接 #" << connectionCount << std::endl;
+
+        // 为连接创建会话
+        std::string sessionId;
+        if (sessionManager) {
+            sessionId = sessionManager->createSession();
+            std::cout << "[WebSocket] [模拟] 客户端 #" << connectionCount << " 的会话: " << sessionId << std::endl;
+        }
+
+        // 模拟发送欢迎消息
+        std::string welcome = buildWelcomeMessage(sessionManager ? sessionManager->getResumeToken(sessionId) : "");
         std::cout << "[WebSocket] [模拟] 向客户端 #" << connectionCount << " 发送欢迎消息" << std::endl;
-        
+
         // 模拟收到一些消息
         std::this_thread::sleep_for(std::chrono::seconds(5));
-        
+
         if (!isRunning) break;
-        
+
         // 模拟处理客户端消息
         std::vector<std::string> simulatedMessages = {
             R"({"action": "move", "data": {"direction": "north"}})",
             R"({"action": "examine", "data": {"target": "bookshelf"}})",
             R"({"action": "talk", "data": {"target": "owner"}})"
         };
-        
+
         for (const auto& msg : simulatedMessages) {
             if (!isRunning) break;
-            
+
             std::cout << "[WebSocket] [模拟] 收到消息: " << msg << std::endl;
-            
-            // 使用API处理器处理消息
-            if (apiHandler) {
-                std::string response = apiHandler->handleMessage(msg);
+
+            // 有会话时交给会话处理，否则使用共享的API处理器
+            if (sessionManager || apiHandler) {
+                std::string response = sessionManager
+                    ? sessionManager->handleMessage(sessionId, msg)
+                    : apiHandler->handleMessage(msg);
                 std::cout << "[WebSocket] [模拟] 生成的响应: " << response.substr(0, 150);
                 if (response.length() > 150) {
                     std::cout << "...";
                 }
                 std::cout << std::endl;
             }
-            
+
             // 如果设置了消息处理器，也调用它
             if (messageHandler) {
                 messageHandler(msg);
             }
-            
+
             std::this_thread::sleep_for(std::chrono::seconds(2));
         }
+
+        // 模拟客户端断开
+        if (sessionManager) {
+            sessionManager->removeSession(sessionId);
+            std::cout << "[WebSocket] [模拟] 客户端 #" << connectionCount << " 已断开" << std::endl;
+        }
     }
-    
+
     std::cout << "[WebSocket] 服务器模拟循环已结束" << std::endl;
-}
\ No newline at end of file
+}
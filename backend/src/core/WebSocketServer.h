@@ -1,10 +1,20 @@
 /**
  * WebSocketServer.h
  * 
- * WebSocket服务器 - 负责前后端通信（简化版本）
+ * WebSocket服务器 - 负责前后端通信
  * 
  * 这个类就像一个"电话总机"，处理前端和后端的实时通信
- * 注意：这是一个简化版本，用于学习和测试
+ * 
+ * 【实现说明】：
+ * - POSIX平台：基于poll()的单线程事件循环，同一端口上处理
+ *   WebSocket升级、前端静态资源（StaticFileServer）和 /metrics；
+ *   accept和第一个请求的读取/握手计算在ConnectionAcceptor的线程上完成，
+ *   新会话按限速放行进事件循环
+ * - TLS（POSIX，可选）：设置 TIME_ARTIFACTS_TLS_CERT/KEY 后端口只接受 https/wss，
+ *   握手在接入线程完成；内核支持kTLS时发送仍走 writev / sendfile，否则回退到SSL_write
+ * - 回环模式（POSIX）：不监听端口，连接来自进程内的LoopbackChannel，
+ *   由调用者用pumpLoopback()驱动事件循环，供基准和集成测试使用
+ * - Windows平台：仍使用模拟循环，用于学习和测试
  */
 
 #pragma once  // 防止头文件被重复包含
@@ -15,9 +25,22 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "WebSocketFrame.h"
 
 // 前向声明
 class APIHandler;
+class ConnectionAcceptor;
+class LoopbackChannel;
+class SessionManager;
+class StaticFileServer;
+class TlsContext;
+struct HttpRequest;
+struct StaticResponse;
 
 // 尝试包含nlohmann/json，如果失败则使用字符串处理
 #ifdef __has_include
@@ -32,23 +55,49 @@ class APIHandler;
 #endif
 
 /**
- * WebSocket服务器类（简化版本）
+ * WebSocket服务器类
  * 
  * 功能：
- * 1. 模拟启动服务器
- * 2. 输出调试信息
- * 3. 为将来的真实实现做准备
+ * 1. 接受浏览器连接，完成WebSocket握手
+ * 2. 每个WebSocket连接对应一个会话，消息交给会话处理
+ * 3. 在同一端口上提供前端静态资源
  */
 class WebSocketServer {
+public:
+    struct Connection;                  // 连接状态（定义见WebSocketServer.cpp）
+
 private:
     // 私有成员变量（只有这个类内部能访问）
     std::thread serverThread;           // 服务器运行的线程
-    bool isRunning;                     // 服务器是否正在运行
+    std::atomic<bool> isRunning;        // 服务器是否正在运行
     uint16_t port;                      // 服务器端口
     
-    // API处理器
+    // 网络状态（只在服务器线程中访问）
+    int listenFd;                                       // 监听套接字
+    int wakeupPipe[2];                                  // 唤醒事件循环的管道
+    std::map<int, std::unique_ptr<Connection>> connections;
+    std::map<std::string, int> sessionConnections;      // 会话ID -> 当前连接
+    std::chrono::steady_clock::time_point lastExpirySweep;
+    std::unique_ptr<ConnectionAcceptor> acceptor;      // 接入与握手流水线
+    bool loopbackMode;                                  // 回环模式（见startLoopback）
+    int nextLoopbackId;                                 // 回环连接的编号（负数，不与套接字冲突）
+    std::unique_ptr<TlsContext> tlsContext;             // 启用TLS时的证书配置
+    bool prepared;                                      // prepare已完成（静态资源和证书已加载）
+    
+    // 前端静态资源
+    std::string staticRoot;
+    std::unique_ptr<StaticFileServer> staticFiles;
+    
+    // 其他线程投递的广播消息（sendToAll）
+    std::mutex outboxMutex;
+    std::vector<std::string> broadcastOutbox;
+    
+    // API处理器（未设置会话管理器时使用的共享处理器）
     std::unique_ptr<APIHandler> apiHandler;
     
+    // 会话管理器（由GameEngine持有，每个连接对应一个会话）
+    SessionManager* sessionManager;
+    
     // 回调函数 - 当收到消息时要调用的函数
     std::function<void(const std::string&)> messageHandler;
 
@@ -60,12 +109,41 @@ public:
     ~WebSocketServer();
     
     /**
-     * 启动WebSocket服务器（模拟版本）
+     * 预热：加载前端静态资源（小文件读入内存缓存）和TLS证书，不监听端口
+     * 可以在启动阶段与其他初始化并行执行；start时未预热会先调用它
+     * @return 配置了TLS证书但加载失败时返回false
+     */
+    bool prepare();
+    
+    /**
+     * 启动WebSocket服务器
      * @param port 端口号（默认8080）
      * @return 成功返回true，失败返回false
      */
     bool start(uint16_t port = 8080);
     
+    /**
+     * 以回环模式启动：不监听端口、不启动服务器线程
+     * 连接全部来自openLoopback，事件循环由调用者通过pumpLoopback驱动
+     * @return 已经在运行时返回false
+     */
+    bool startLoopback();
+    
+    /**
+     * 打开一条回环连接（与套接字连接走同一套HTTP升级、帧解析和会话处理）
+     * 只能在驱动线程（pumpLoopback的调用者）上调用
+     * @param capacity 每个方向的字节环容量
+     * @return 不在回环模式时返回nullptr
+     */
+    std::shared_ptr<LoopbackChannel> openLoopback(size_t capacity = 256 * 1024);
+    
+    /**
+     * 运行一轮回环事件循环：读取各通道的数据并处理，把发送队列写回通道，
+     * 清理已断开的连接，推送广播和预取消息
+     * @return 本轮读写的字节数（0表示没有进展）
+     */
+    size_t pumpLoopback();
+    
     /**
      * 停止WebSocket服务器
      */
@@ -79,7 +157,23 @@ public:
     void setMessageHandler(std::function<void(const std::string&)> handler);
     
     /**
-     * 向所有连接的客户端发送消息（模拟版本）
+     * 设置会话管理器
+     * 设置后每个新连接都会创建独立的会话，消息交给对应会话处理
+     * @param manager 会话管理器（不转移所有权）
+     */
+    void setSessionManager(SessionManager* manager);
+    
+    /**
+     * 设置前端静态资源目录（在start之前调用）
+     * 未设置时由 StaticFileServer::locateFrontendRoot() 自动查找
+     * @param directory 前端目录
+     */
+    void setStaticRoot(const std::string& directory);
+    
+    /**
+     * 向所有连接的客户端发送消息
+     * 线程安全：消息先放入发件箱，由服务器线程发送
+     * 广播走低优先级的Ambient通道（见OutboundLanes）：排在会话响应之后，拥塞时合并或丢弃
      * @param message 要发送的消息（JSON字符串）
      */
     void sendToAll(const std::string& message);
@@ -94,7 +188,41 @@ private:
     // 私有方法（只有类内部能调用）
     
     /**
-     * 模拟服务器运行循环
+     * 模拟服务器运行循环（Windows）
      */
     void simulateServerLoop();
+    
+    /**
+     * 创建欢迎消息
+     */
+    static std::string buildWelcomeMessage(const std::string& resumeToken);
+    
+#ifndef _WIN32
+    // ===== POSIX事件循环 =====
+    bool openListener();
+    void closeListener();
+    void runEventLoop();
+    void admitConnections();
+    void handleReadable(Connection& connection);
+    void processBuffered(Connection& connection);
+    void handleWritable(Connection& connection);
+    void promoteLanes(Connection& connection);
+    void processHttp(Connection& connection);
+    void processWebSocket(Connection& connection);
+    void handleHttpRequest(Connection& connection, const HttpRequest& request);
+    void queueResponse(Connection& connection, const StaticResponse& response);
+    void upgradeToWebSocket(Connection& connection, const HttpRequest& request);
+    void completeUpgrade(Connection& connection, const HttpRequest& request, const std::string& acceptKey);
+    bool resumeSession(Connection& connection, const HttpRequest& request);
+    void attachSession(Connection& connection, const std::string& sessionId);
+    void handleTextMessage(Connection& connection, const std::string& message);
+    void sendFrame(Connection& connection, WebSocketFrame::Opcode opcode, const std::string& payload);
+    void sendSessionMessage(Connection& connection, const std::string& message);
+    void failWebSocket(Connection& connection, uint16_t code);
+    void pushPrefetchHints();
+    void drainBroadcastOutbox();
+    void closeConnection(int fd);
+    size_t writeLoopback(Connection& connection);
+    void writeTls(Connection& connection);
+#endif
 };
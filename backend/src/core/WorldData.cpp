@@ -0,0 +1,428 @@
+/**
+ * WorldData.cpp
+ *
+ * 游戏世界数据加载实现
+ */
+
+#include "WorldData.h"
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "ScriptCompiler.h"
+#include "utils/SimpleJson.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <set>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    std::unique_ptr<WorldData>& globalWorld() {
+        static std::unique_ptr<WorldData> world;
+        return world;
+    }
+
+    bool readFile(const std::string& path, std::string& content) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    std::vector<std::string> toStringList(const SimpleJson::Value& value) {
+        std::vector<std::string> result;
+        for (const auto& item : value.items()) {
+            if (item.isString()) {
+                result.push_back(item.asString());
+            }
+        }
+        return result;
+    }
+
+    std::map<std::string, int> toAttributeMap(const SimpleJson::Value& value) {
+        std::map<std::string, int> result;
+        for (const auto& member : value.members()) {
+            result[member.first] = static_cast<int>(member.second.asNumber());
+        }
+        return result;
+    }
+
+    Requirement toRequirement(const SimpleJson::Value& value) {
+        Requirement requirement;
+        requirement.attribute = value["attribute"].asString();
+        requirement.threshold = static_cast<int>(value["threshold"].asNumber());
+        return requirement;
+    }
+
+    /**
+     * 编译数据中嵌入的脚本（没有脚本或编译失败时返回nullptr，失败时记录日志，其余结果字段照常生效）
+     */
+    std::shared_ptr<const Script> toScript(const SimpleJson::Value& value, const std::string& owner) {
+        if (!value.isString() || value.asString().empty()) {
+            return nullptr;
+        }
+        std::string error;
+        auto script = ScriptCompiler::compile(value.asString(), &error);
+        if (!script) {
+            std::cerr << "[WorldData] " << owner << " 的脚本编译失败，已忽略: " << error << std::endl;
+        }
+        return script;
+    }
+
+    bool parseText(const std::string& text, const std::string& name, SimpleJson::Value& out) {
+        std::string error;
+        if (!SimpleJson::parse(text, out, &error) || !out.isObject()) {
+            std::cerr << "[WorldData] " << name << " 格式错误: " << error << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+} // namespace
+
+TextId Location::description(const std::string& variant) const {
+    auto it = descriptions.find(variant);
+    if (it == descriptions.end()) {
+        it = descriptions.find("default");
+    }
+    return it != descriptions.end() ? it->second : TextStore::kEmpty;
+}
+
+bool WorldData::loadFromDirectory(const std::string& directory) {
+    std::string locationsJson, dialoguesJson, itemsJson;
+    fs::path root(directory);
+    if (!readFile((root / "locations.json").string(), locationsJson) ||
+        !readFile((root / "dialogues.json").string(), dialoguesJson) ||
+        !readFile((root / "items.json").string(), itemsJson)) {
+        std::cerr << "[WorldData] 无法读取数据文件，目录: " << directory << std::endl;
+        return false;
+    }
+    return loadFromStrings(locationsJson, dialoguesJson, itemsJson);
+}
+
+bool WorldData::loadFromStrings(const std::string& locationsJson, const std::string& dialoguesJson,
+                                const std::string& itemsJson) {
+    MemoryScope memoryScope(MemoryTag::World);
+
+    SimpleJson::Value locationsRoot, dialoguesRoot, itemsRoot;
+    if (!parseText(locationsJson, "locations.json", locationsRoot) ||
+        !parseText(dialoguesJson, "dialogues.json", dialoguesRoot) ||
+        !parseText(itemsJson, "items.json", itemsRoot)) {
+        return false;
+    }
+
+    locations.clear();
+    dialogues.clear();
+    items.clear();
+    texts = std::make_unique<TextStore>();
+    if (!parseLocations(locationsRoot) || !parseDialogues(dialoguesRoot) || !parseItems(itemsRoot)) {
+        return false;
+    }
+
+    // 文本全部收集后按区域压缩；起始场景的块常驻（每个新玩家都会先看到它）
+    partitionRegions();
+    texts->seal();
+    texts->pinGroup(getStartLocation());
+    return true;
+}
+
+void WorldData::partitionRegions() {
+    // 出口按无向边处理：单向出口的两端在空间上同样相邻
+    std::map<std::string, std::vector<std::string>> neighbours;
+    for (const auto& entry : locations) {
+        for (const auto& exit : entry.second.exits) {
+            if (locations.count(exit.second)) {
+                neighbours[entry.first].push_back(exit.second);
+                neighbours[exit.second].push_back(entry.first);
+            }
+        }
+    }
+
+    // 种子按从起始场景出发的广度优先顺序选取；每个区域从种子开始广度优先扩展到kRegionLocations个场景
+    std::vector<std::string> seeds;
+    {
+        std::set<std::string> seen;
+        std::vector<std::string> starts{getStartLocation()};
+        for (const auto& entry : locations) {
+            starts.push_back(entry.first);
+        }
+        for (const auto& start : starts) {
+            if (start.empty() || !seen.insert(start).second) {
+                continue;
+            }
+            std::queue<std::string> frontier;
+            frontier.push(start);
+            while (!frontier.empty()) {
+                std::string current = frontier.front();
+                frontier.pop();
+                seeds.push_back(current);
+                for (const auto& next : neighbours[current]) {
+                    if (seen.insert(next).second) {
+                        frontier.push(next);
+                    }
+                }
+            }
+        }
+    }
+
+    std::set<std::string> assigned;
+    regionCount = 0;
+    for (const auto& seed : seeds) {
+        if (assigned.count(seed)) {
+            continue;
+        }
+        uint32_t region = regionCount++;
+        size_t size = 0;
+        std::queue<std::string> frontier;
+        frontier.push(seed);
+        assigned.insert(seed);
+        while (!frontier.empty() && size < kRegionLocations) {
+            std::string current = frontier.front();
+            frontier.pop();
+            locations[current].region = region;
+            texts->setGroupRegion(current, region);
+            ++size;
+            for (const auto& next : neighbours[current]) {
+                if (!assigned.count(next) && size + frontier.size() < kRegionLocations) {
+                    assigned.insert(next);
+                    frontier.push(next);
+                }
+            }
+        }
+    }
+}
+
+bool WorldData::parseLocations(const SimpleJson::Value& root) {
+    for (const auto& entry : root["locations"].members()) {
+        const SimpleJson::Value& value = entry.second;
+        Location location;
+        location.id = entry.first;
+        location.name = value["name"].asString();
+        for (const auto& description : value["descriptions"].members()) {
+            location.descriptions[description.first] = texts->add(location.id, description.second.asString());
+        }
+        for (const auto& exit : value["exits"].members()) {
+            location.exits[exit.first] = exit.second.asString();
+        }
+        location.musicTrack = value["music"].asString();
+        location.ambientEffects = toStringList(value["ambient_effects"]);
+        location.items = toStringList(value["items"]);
+        location.characters = toStringList(value["characters"]);
+
+        for (const auto& interactionValue : value["interactions"].items()) {
+            Interaction interaction;
+            interaction.id = interactionValue["id"].asString();
+            interaction.name = interactionValue["name"].asString();
+            interaction.description = interactionValue["description"].asString();
+            interaction.requirement = toRequirement(interactionValue["requirements"]);
+            interaction.resultText = texts->add(location.id, interactionValue["results"]["text"].asString());
+            interaction.items = toStringList(interactionValue["results"]["items"]);
+            interaction.insights = toStringList(interactionValue["results"]["insights"]);
+            interaction.script = toScript(interactionValue["results"]["script"],
+                                          location.id + "/" + interaction.id);
+            location.interactions.push_back(std::move(interaction));
+        }
+        locations[location.id] = std::move(location);
+    }
+    return !locations.empty();
+}
+
+bool WorldData::parseDialogues(const SimpleJson::Value& root) {
+    // 对话文本与角色所在场景放在同一分组（对话ID以角色ID开头）
+    std::map<std::string, std::string> characterLocations;
+    for (const auto& location : locations) {
+        for (const auto& character : location.second.characters) {
+            characterLocations.emplace(character, location.first);
+        }
+    }
+
+    for (const auto& entry : root["dialogues"].members()) {
+        const SimpleJson::Value& value = entry.second;
+        DialogueNode node;
+        node.id = entry.first;
+        node.speaker = value["speaker"].asString();
+
+        std::string group = "dialogues";
+        auto character = characterLocations.upper_bound(node.id);
+        if (character != characterLocations.begin() &&
+            node.id.compare(0, std::prev(character)->first.size(), std::prev(character)->first) == 0) {
+            group = std::prev(character)->second;
+        }
+        node.text = texts->add(group, value["text"].asString());
+
+        for (const auto& optionValue : value["options"].items()) {
+            DialogueOption option;
+            option.id = optionValue["id"].asString();
+            option.text = texts->add(group, optionValue["text"].asString());
+            option.requirement = toRequirement(optionValue["requirements"]);
+            const SimpleJson::Value& results = optionValue["results"];
+            option.nextDialogue = results["dialogue"].asString();
+            option.endDialogue = results["end_dialogue"].asBool();
+            option.attributes = toAttributeMap(results["attributes"]);
+            option.insights = toStringList(results["insights"]);
+            option.script = toScript(results["script"], node.id + "/" + option.id);
+            node.options.push_back(std::move(option));
+        }
+        dialogues[node.id] = std::move(node);
+    }
+    return true;
+}
+
+bool WorldData::parseItems(const SimpleJson::Value& root) {
+    // 物品文本与放置它的场景放在同一分组
+    std::map<std::string, std::string> itemLocations;
+    for (const auto& location : locations) {
+        for (const auto& itemId : location.second.items) {
+            itemLocations.emplace(itemId, location.first);
+        }
+    }
+
+    for (const auto& entry : root["items"].members()) {
+        const SimpleJson::Value& value = entry.second;
+        Item item;
+        item.id = entry.first;
+        auto placed = itemLocations.find(item.id);
+        const std::string& group = placed != itemLocations.end() ? placed->second : "items";
+        item.name = value["name"].asString();
+        item.type = value["type"].asString();
+        item.description = texts->add(group, value["description"].asString());
+        item.examinable = value["examinable"].asBool();
+        const SimpleJson::Value& results = value["examine_results"];
+        item.examineText = texts->add(group, results["text"].asString());
+        item.examineInsights = toStringList(results["insights"]);
+        item.examineAttributes = toAttributeMap(results["attributes"]);
+        item.examineScript = toScript(results["script"], item.id);
+        items[item.id] = std::move(item);
+    }
+    return true;
+}
+
+const Location* WorldData::findLocation(const std::string& id) const {
+    auto it = locations.find(id);
+    return it != locations.end() ? &it->second : nullptr;
+}
+
+const DialogueNode* WorldData::findDialogue(const std::string& id) const {
+    auto it = dialogues.find(id);
+    return it != dialogues.end() ? &it->second : nullptr;
+}
+
+const Item* WorldData::findItem(const std::string& id) const {
+    auto it = items.find(id);
+    return it != items.end() ? &it->second : nullptr;
+}
+
+std::string WorldData::startDialogueFor(const std::string& characterId) const {
+    if (dialogues.count(characterId + "_first_meeting")) {
+        return characterId + "_first_meeting";
+    }
+    auto it = dialogues.lower_bound(characterId);
+    if (it != dialogues.end() && it->first.compare(0, characterId.size(), characterId) == 0) {
+        return it->first;
+    }
+    return "";
+}
+
+std::vector<std::string> WorldData::collectInsightIds() const {
+    std::set<std::string> insights;
+    for (const auto& dialogue : dialogues) {
+        for (const auto& option : dialogue.second.options) {
+            insights.insert(option.insights.begin(), option.insights.end());
+        }
+    }
+    for (const auto& location : locations) {
+        for (const auto& interaction : location.second.interactions) {
+            insights.insert(interaction.insights.begin(), interaction.insights.end());
+        }
+    }
+    for (const auto& item : items) {
+        insights.insert(item.second.examineInsights.begin(), item.second.examineInsights.end());
+    }
+    return std::vector<std::string>(insights.begin(), insights.end());
+}
+
+std::string WorldData::getStartLocation() const {
+    if (locations.count("time_corner_bookstore")) {
+        return "time_corner_bookstore";
+    }
+    return locations.empty() ? "" : locations.begin()->first;
+}
+
+std::string WorldData::locateDataDirectory() {
+    if (const char* env = std::getenv("TIME_ARTIFACTS_DATA_DIR")) {
+        return env;
+    }
+
+    std::error_code ec;
+    for (const char* candidate : {"data", "bin/data", "../shared/data", "../../shared/data", "../../../shared/data"}) {
+        if (fs::is_regular_file(fs::path(candidate) / "locations.json", ec)) {
+            return fs::absolute(candidate, ec).lexically_normal().string();
+        }
+    }
+    return "";
+}
+
+bool WorldData::loadGlobal(const std::string& directory) {
+    std::string dataDirectory = directory.empty() ? locateDataDirectory() : directory;
+    if (dataDirectory.empty()) {
+        std::cerr << "[WorldData] 未找到数据目录，使用内置演示内容" << std::endl;
+        return false;
+    }
+
+    MemoryScope memoryScope(MemoryTag::World);
+    auto world = std::make_unique<WorldData>();
+    if (!world->loadFromDirectory(dataDirectory)) {
+        return false;
+    }
+
+    // 文本块缓存容量（KB）：内存紧张的部署可以调小，用更多的解压换取更少的常驻内存
+    if (const char* env = std::getenv("TIME_ARTIFACTS_TEXT_CACHE_KB")) {
+        world->texts->setCacheCapacity(static_cast<size_t>(std::strtoull(env, nullptr, 10)) * 1024);
+        world->texts->pinGroup(world->getStartLocation());
+    }
+
+    std::cout << "[WorldData] 已加载 " << world->locations.size() << " 个场景、"
+              << world->dialogues.size() << " 个对话节点、" << world->items.size()
+              << " 个物品，目录: " << dataDirectory << std::endl;
+    TextStore::Stats textStats = world->texts->stats();
+    std::cout << "[WorldData] 文本: " << textStats.texts << " 段，" << textStats.blocks << " 个块，"
+              << textStats.rawBytes << " 字节压缩为 " << textStats.compressedBytes << " 字节，"
+              << world->regionCount << " 个区域" << std::endl;
+    installGlobal(std::move(world));
+    return true;
+}
+
+void WorldData::installGlobal(std::unique_ptr<WorldData> world) {
+    MemoryScope memoryScope(MemoryTag::World);
+    globalWorld() = std::move(world);
+}
+
+const WorldData* WorldData::global() {
+    return globalWorld().get();
+}
+
+void WorldData::registerMetrics() {
+    Metrics::instance().registerCollector("world_text", [](Metrics::Samples& out) {
+        const WorldData* world = WorldData::global();
+        if (!world) {
+            return;
+        }
+        TextStore::Stats stats = world->getTexts().stats();
+        out["world.text_blocks"] = static_cast<double>(stats.blocks);
+        out["world.text_raw_bytes"] = static_cast<double>(stats.rawBytes);
+        out["world.text_compressed_bytes"] = static_cast<double>(stats.compressedBytes);
+        out["world.text_cache_bytes"] = static_cast<double>(stats.cacheBytes);
+        out["world.text_pinned_bytes"] = static_cast<double>(stats.pinnedBytes);
+        out["world.text_cache_hits"] = static_cast<double>(stats.hits);
+        out["world.text_cache_misses"] = static_cast<double>(stats.misses);
+    });
+}
@@ -0,0 +1,211 @@
+/**
+ * WorldData.h
+ *
+ * 游戏世界数据 - 启动时从 shared/data 加载的只读内容
+ *
+ * 【文件作用】：
+ * 1. 解析 locations.json / dialogues.json / items.json
+ * 2. 提供按ID查找场景、对话节点、物品的接口
+ * 3. 作为全局只读数据，供所有会话共享（加载后不再修改，读取无需加锁）
+ *
+ * 【内存】：世界数据的所有分配记到 MemoryTag::World；长文本（描述、台词）不直接保存在结构体中，
+ *   而是以TextId引用TextStore中的压缩块，用 text(id) 取出
+ *
+ * 【区域】：加载时沿出口图把场景划分为若干区域（每个区域最多kRegionLocations个相连的场景），
+ *   场景的文本按区域存放，供RegionPager按区域换入换出
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextStore.h"
+
+namespace SimpleJson {
+    class Value;
+}
+
+struct Script;
+
+/**
+ * 前置条件（属性达到阈值）
+ */
+struct Requirement {
+    std::string attribute;      // 为空表示没有要求
+    int threshold = 0;
+};
+
+/**
+ * 对话选项
+ */
+struct DialogueOption {
+    std::string id;
+    TextId text = TextStore::kEmpty;
+    Requirement requirement;
+    std::string nextDialogue;               // 选择后进入的对话节点（为空表示无）
+    bool endDialogue = false;
+    std::map<std::string, int> attributes;  // 属性变化
+    std::vector<std::string> insights;      // 获得的洞察
+    std::shared_ptr<const Script> script;   // 结果脚本（results.script，为空表示无）
+};
+
+/**
+ * 对话节点
+ */
+struct DialogueNode {
+    std::string id;
+    std::string speaker;
+    TextId text = TextStore::kEmpty;
+    std::vector<DialogueOption> options;
+};
+
+/**
+ * 场景交互（检查书架等）
+ */
+struct Interaction {
+    std::string id;
+    std::string name;
+    std::string description;
+    Requirement requirement;
+    TextId resultText = TextStore::kEmpty;
+    std::vector<std::string> items;
+    std::vector<std::string> insights;
+    std::shared_ptr<const Script> script;   // 结果脚本（results.script）
+};
+
+/**
+ * 场景
+ */
+struct Location {
+    std::string id;
+    std::string name;
+    std::map<std::string, TextId> descriptions;         // "default" / "evening" / "rainy"
+    std::map<std::string, std::string> exits;           // 方向 -> 场景ID
+    std::string musicTrack;                             // 背景音乐（为空时客户端保持当前音乐）
+    std::vector<std::string> ambientEffects;            // 环境音效
+    std::vector<std::string> items;
+    std::vector<std::string> characters;
+    std::vector<Interaction> interactions;
+    uint32_t region = 0;                                // 所属区域（加载时按出口图划分）
+
+    /**
+     * 获取描述（指定变体不存在时返回default）
+     */
+    TextId description(const std::string& variant = "default") const;
+};
+
+/**
+ * 物品
+ */
+struct Item {
+    std::string id;
+    std::string name;
+    std::string type;
+    TextId description = TextStore::kEmpty;
+    bool examinable = false;
+    TextId examineText = TextStore::kEmpty;
+    std::vector<std::string> examineInsights;
+    std::map<std::string, int> examineAttributes;
+    std::shared_ptr<const Script> examineScript;    // 检查结果脚本（examine_results.script）
+};
+
+/**
+ * 游戏世界数据类
+ */
+class WorldData {
+public:
+    static constexpr size_t kRegionLocations = 16;  // 每个区域最多包含的场景数
+
+    WorldData() = default;
+
+    /**
+     * 从数据目录加载（locations.json、dialogues.json、items.json）
+     * 【返回】：任一文件缺失或格式错误时返回false
+     */
+    bool loadFromDirectory(const std::string& directory);
+
+    /**
+     * 从JSON文本加载（合成世界、测试数据用）
+     */
+    bool loadFromStrings(const std::string& locationsJson, const std::string& dialoguesJson,
+                         const std::string& itemsJson);
+
+    const Location* findLocation(const std::string& id) const;
+    const DialogueNode* findDialogue(const std::string& id) const;
+    const Item* findItem(const std::string& id) const;
+
+    const std::map<std::string, Location>& getLocations() const { return locations; }
+    const std::map<std::string, DialogueNode>& getDialogues() const { return dialogues; }
+    const std::map<std::string, Item>& getItems() const { return items; }
+
+    /**
+     * 取文本（按需从压缩块解压，见TextStore）
+     */
+    std::string text(TextId id) const { return texts->get(id); }
+
+    TextStore& getTexts() const { return *texts; }
+
+    /**
+     * 区域数（场景的region取值为 0 ~ getRegionCount()-1）
+     */
+    uint32_t getRegionCount() const { return regionCount; }
+
+    /**
+     * 角色的起始对话
+     * 【约定】：优先使用 "<角色ID>_first_meeting"，否则取第一个以角色ID开头的对话
+     * 【返回】：找不到时返回空字符串
+     */
+    std::string startDialogueFor(const std::string& characterId) const;
+
+    /**
+     * 世界中出现的所有洞察ID（对话、交互、物品检查结果），已去重排序
+     */
+    std::vector<std::string> collectInsightIds() const;
+
+    /**
+     * 起始场景（按约定为 time_corner_bookstore，不存在时取第一个场景）
+     */
+    std::string getStartLocation() const;
+
+    /**
+     * 查找数据目录
+     * 【顺序】：环境变量 TIME_ARTIFACTS_DATA_DIR → 可执行文件旁的data → 源码树中的shared/data
+     */
+    static std::string locateDataDirectory();
+
+    /**
+     * 加载全局世界数据（GameEngine启动时调用一次）
+     * 【配置】：环境变量 TIME_ARTIFACTS_TEXT_CACHE_KB 设置文本块缓存容量（默认4096）
+     */
+    static bool loadGlobal(const std::string& directory = "");
+
+    /**
+     * 安装全局世界数据（合成世界、测试用）
+     */
+    static void installGlobal(std::unique_ptr<WorldData> world);
+
+    /**
+     * 全局世界数据
+     * 【返回】：未加载时返回nullptr（APIHandler此时使用内置的演示内容）
+     */
+    static const WorldData* global();
+
+    /**
+     * 注册运行指标（全局世界的文本存储：块数、压缩率、缓存命中）
+     */
+    static void registerMetrics();
+
+private:
+    bool parseLocations(const SimpleJson::Value& root);
+    bool parseDialogues(const SimpleJson::Value& root);
+    bool parseItems(const SimpleJson::Value& root);
+    void partitionRegions();
+
+    std::map<std::string, Location> locations;
+    std::map<std::string, DialogueNode> dialogues;
+    std::map<std::string, Item> items;
+    std::unique_ptr<TextStore> texts = std::make_unique<TextStore>();
+    uint32_t regionCount = 0;
+};
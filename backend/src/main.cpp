@@ -8,9 +8,23 @@
 #include <memory>
 #include <exception>
 #include <locale>
+#include <string>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
 
 // 核心系统头文件
 #include "core/GameEngine.h"
+#include "tools/MemoryReport.h"
+#include "tools/FrameBenchmark.h"
+#include "tools/ScriptBenchmark.h"
+#include "tools/TextCacheReport.h"
+#include "tools/HandshakeBenchmark.h"
+#include "tools/AdminClient.h"
+#include "tools/WorldGenerator.h"
+#include "tools/WorldScaleBenchmark.h"
+#include "tools/LoopbackBenchmark.h"
+#include "tools/TlsSetup.h"
 
 // Windows下设置控制台编码
 #ifdef _WIN32
@@ -19,7 +33,7 @@
 #include <fcntl.h>
 #endif
 
-int main() {
+int main(int argc, char* argv[]) {
 #ifdef _WIN32
     // 设置控制台为UTF-8编码 - 增强版
     SetConsoleOutputCP(65001);  // UTF-8 code page
@@ -43,6 +57,53 @@ int main() {
         std::locale::global(std::locale(""));
     }
 #endif
+    // 命令行工具模式（不启动服务器）
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--memory-report") {
+            int sessionCount = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 1000;
+            return runMemoryReport(sessionCount);
+        }
+        if (arg == "--bench-frames") {
+            return runFrameBenchmark();
+        }
+        if (arg == "--bench-scripts") {
+            return runScriptBenchmark();
+        }
+        if (arg == "--bench-handshakes") {
+            int connections = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 2000;
+            return runHandshakeBenchmark(connections);
+        }
+        if (arg == "--bench-loopback") {
+            int messages = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 1000000;
+            return runLoopbackBenchmark(messages);
+        }
+        if (arg == "--text-cache-report") {
+            int scale = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 2000;
+            return runTextCacheReport(scale);
+        }
+        if (arg == "--generate-world") {
+            std::string directory = (i + 1 < argc) ? argv[i + 1] : "";
+            return runWorldGenerator(directory, std::vector<std::string>(argv + std::min(i + 2, argc), argv + argc));
+        }
+        if (arg == "--bench-world-scale") {
+            int maxLocations = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 100000;
+            return runWorldScaleBenchmark(maxLocations > 0 ? static_cast<size_t>(maxLocations) : 0,
+                                          std::vector<std::string>(argv + std::min(i + 2, argc), argv + argc));
+        }
+        if (arg == "--generate-cert") {
+            std::string directory = (i + 1 < argc) ? argv[i + 1] : "";
+            return runGenerateCertificate(directory, (i + 2 < argc) ? argv[i + 2] : "localhost");
+        }
+        if (arg == "--admin") {
+            std::string command;
+            for (int j = i + 1; j < argc; ++j) {
+                command += (command.empty() ? "" : " ") + std::string(argv[j]);
+            }
+            return runAdminClient(command);
+        }
+    }
+    
     try {
         // UTF-8测试输出
         std::cout << "UTF-8 encoding test: 中文测试 中文字符" << std::endl;
@@ -0,0 +1,60 @@
+/**
+ * AdminClient.cpp
+ *
+ * 管理接口客户端实现
+ */
+
+#include "tools/AdminClient.h"
+#include "core/AdminServer.h"
+#include <iostream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+int runAdminClient(const std::string& command) {
+#ifdef _WIN32
+    (void)command;
+    std::cerr << "[AdminClient] 错误: 当前平台不支持Unix套接字" << std::endl;
+    return -1;
+#else
+    std::string path = AdminServer::defaultSocketPath();
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "[AdminClient] 错误: 套接字路径无效: " << path << std::endl;
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "[AdminClient] 错误: 无法连接 " << path << ": " << std::strerror(errno)
+                  << "（服务器是否在运行？）" << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+
+    std::string line = command + "\n";
+    if (::send(fd, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) {
+        std::cerr << "[AdminClient] 错误: 发送命令失败" << std::endl;
+        ::close(fd);
+        return -1;
+    }
+
+    char buffer[4096];
+    ssize_t received;
+    while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        std::cout.write(buffer, received);
+    }
+    std::cout.flush();
+    ::close(fd);
+    return 0;
+#endif
+}
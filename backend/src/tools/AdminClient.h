@@ -0,0 +1,22 @@
+/**
+ * AdminClient.h
+ *
+ * 管理接口客户端 - 连接运行中服务器的Unix套接字，发送一条命令并打印回复
+ *
+ * 【用法】：TimeArtifacts --admin [命令 参数...]
+ *   例如 --admin summary、--admin sessions 20、--admin ticks（不带命令时显示帮助）
+ *
+ * 【说明】：套接字路径与服务器相同（TIME_ARTIFACTS_ADMIN_SOCKET，默认 /tmp/time_artifacts_admin.sock），
+ *   命令列表见 AdminServer.h
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * 发送管理命令
+ * 【参数】：command - 命令行（如 "sessions 20"）
+ * 【返回】：进程退出码（连接失败时为-1）
+ */
+int runAdminClient(const std::string& command);
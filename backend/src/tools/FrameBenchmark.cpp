@@ -0,0 +1,180 @@
+/**
+ * FrameBenchmark.cpp
+ *
+ * 帧处理内核微基准实现
+ */
+
+#include "tools/FrameBenchmark.h"
+#include "core/FrameKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // 典型的中文游戏消息（对话、场景描述），用于拼接不同大小的负载
+    const char* kChinesePayloadSample =
+        R"({"type":"dialogue","data":{"speaker":"书店老板","text":"欢迎来到时光角落，年轻人。)"
+        R"(你看起来像是在寻找什么特别的东西。","options":[{"id":"ask_about_memories",)"
+        R"("text":"我在寻找一些旧物件，关于这个城市过去的记忆。"},{"id":"observe_sadness",)"
+        R"("text":"[观察] 注意到他眼中的忧伤。"}]},"description":"这是一家温馨的旧书店，)"
+        R"(书架上摆满了各个年代的书籍。阳光透过窗户洒在木制地板上，空气中弥漫着纸张的香味。"})";
+
+    const FrameKernels::Isa kAllIsas[] = {
+        FrameKernels::Isa::Scalar, FrameKernels::Isa::Sse4, FrameKernels::Isa::Avx2
+    };
+
+    /**
+     * 生成指定大小的中文负载（在字符边界截断，保证是合法UTF-8）
+     */
+    std::vector<uint8_t> makeChinesePayload(size_t size) {
+        std::string text;
+        while (text.size() < size) {
+            text += kChinesePayloadSample;
+        }
+        size_t cut = size;
+        while (cut > 0 && (static_cast<uint8_t>(text[cut]) & 0xC0) == 0x80) {
+            --cut;
+        }
+        text.resize(cut);
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    /**
+     * 逐字节基线：按字节取模解掩码 + 标量校验
+     */
+    bool byteByByteBaseline(uint8_t* data, size_t length, const uint8_t maskKey[4]) {
+        for (size_t i = 0; i < length; ++i) {
+            data[i] ^= maskKey[i % 4];
+        }
+        FrameKernels::setIsa(FrameKernels::Isa::Scalar);
+        return FrameKernels::validateUtf8(data, length);
+    }
+
+    /**
+     * 一致性检查：随机截断、翻转字节，所有实现必须与标量实现结果相同
+     */
+    bool runConsistencyCheck() {
+        std::mt19937 rng(20240101);
+        std::uniform_int_distribution<int> byteDist(0, 255);
+        const uint8_t maskKey[4] = {0x37, 0xFA, 0x21, 0x3D};
+
+        int samples = 0;
+        int mismatches = 0;
+        int invalidCount = 0;
+
+        for (int round = 0; round < 4000; ++round) {
+            size_t size = 1 + rng() % 300;
+            std::vector<uint8_t> plain = makeChinesePayload(size);
+            if (round % 2 == 1 && !plain.empty()) {
+                // 一半样本注入随机错误字节
+                plain[rng() % plain.size()] = static_cast<uint8_t>(byteDist(rng));
+            }
+            if (round % 7 == 0 && plain.size() > 2) {
+                // 在字符中间截断
+                plain.resize(plain.size() - 1 - rng() % 2);
+            }
+
+            std::vector<uint8_t> masked = plain;
+            for (size_t i = 0; i < masked.size(); ++i) {
+                masked[i] ^= maskKey[i & 3];
+            }
+
+            FrameKernels::setIsa(FrameKernels::Isa::Scalar);
+            bool expected = FrameKernels::validateUtf8(plain.data(), plain.size());
+            invalidCount += expected ? 0 : 1;
+
+            for (auto isa : kAllIsas) {
+                if (!FrameKernels::setIsa(isa)) {
+                    continue;
+                }
+                std::vector<uint8_t> work = masked;
+                bool fused = FrameKernels::unmaskAndValidateUtf8(work.data(), work.size(), maskKey);
+                bool validateOnly = FrameKernels::validateUtf8(plain.data(), plain.size());
+                ++samples;
+                if (fused != expected || validateOnly != expected || work != plain) {
+                    ++mismatches;
+                    std::cerr << "[FrameBenchmark] 不一致: isa=" << FrameKernels::isaName(isa)
+                              << " size=" << plain.size() << std::endl;
+                }
+            }
+        }
+
+        std::cout << "一致性检查: " << samples << " 个样本（其中非法UTF-8 " << invalidCount
+                  << " 个），不一致 " << mismatches << " 个" << std::endl;
+        return mismatches == 0;
+    }
+
+    template <typename Fn>
+    double measureMBps(size_t payloadSize, Fn&& fn) {
+        // 每个用例处理约256MB数据
+        size_t iterations = std::max<size_t>(1, (256u << 20) / payloadSize);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(payloadSize) * iterations / seconds / (1024.0 * 1024.0);
+    }
+
+} // namespace
+
+int runFrameBenchmark() {
+    std::cout << "=== WebSocket帧处理基准 ===" << std::endl;
+    std::cout << "默认实现: " << FrameKernels::isaName(FrameKernels::activeIsa()) << std::endl;
+    FrameKernels::Isa defaultIsa = FrameKernels::activeIsa();
+
+    if (!runConsistencyCheck()) {
+        FrameKernels::setIsa(defaultIsa);
+        return -1;
+    }
+
+    // 全零掩码使负载在多次迭代中保持不变（XOR和写回照常执行），避免每轮重新拷贝
+    const uint8_t zeroMask[4] = {0, 0, 0, 0};
+    const size_t sizes[] = {128, 1024, 16 * 1024, 64 * 1024};
+    volatile bool sink = true;
+
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(10) << "size" << std::setw(10) << "isa"
+              << std::right << std::setw(14) << "unmask" << std::setw(14) << "validate"
+              << std::setw(14) << "fused" << "   (MB/s)" << std::endl;
+
+    for (size_t size : sizes) {
+        std::vector<uint8_t> payload = makeChinesePayload(size);
+        size_t length = payload.size();
+
+        double baseline = measureMBps(length, [&]() {
+            sink = byteByByteBaseline(payload.data(), length, zeroMask);
+        });
+        std::cout << std::left << std::setw(10) << length << std::setw(10) << "bytewise"
+                  << std::right << std::setw(14) << "-" << std::setw(14) << "-"
+                  << std::setw(14) << std::fixed << std::setprecision(0) << baseline << std::endl;
+
+        for (auto isa : kAllIsas) {
+            if (!FrameKernels::setIsa(isa)) {
+                continue;
+            }
+            double unmaskRate = measureMBps(length, [&]() {
+                FrameKernels::unmask(payload.data(), length, zeroMask);
+            });
+            double validateRate = measureMBps(length, [&]() {
+                sink = FrameKernels::validateUtf8(payload.data(), length);
+            });
+            double fusedRate = measureMBps(length, [&]() {
+                sink = FrameKernels::unmaskAndValidateUtf8(payload.data(), length, zeroMask);
+            });
+            std::cout << std::left << std::setw(10) << length << std::setw(10) << FrameKernels::isaName(isa)
+                      << std::right << std::setw(14) << unmaskRate << std::setw(14) << validateRate
+                      << std::setw(14) << fusedRate << std::endl;
+        }
+    }
+
+    (void)sink;
+    FrameKernels::setIsa(defaultIsa);
+    return 0;
+}
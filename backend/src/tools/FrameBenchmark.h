@@ -0,0 +1,20 @@
+/**
+ * FrameBenchmark.h
+ *
+ * 帧处理内核微基准 - 对比标量 / SSE4 / AVX2 的解掩码与UTF-8校验吞吐
+ *
+ * 【用法】：TimeArtifacts --bench-frames
+ *
+ * 【内容】：
+ * 1. 一致性检查：随机合法/非法负载上，各实现结果必须与标量实现一致
+ * 2. 吞吐测试：以中文为主的JSON消息（128B ~ 64KB），分别测试
+ *    逐字节基线、解掩码、UTF-8校验、解掩码+校验
+ */
+
+#pragma once
+
+/**
+ * 运行帧处理基准
+ * 【返回】：进程退出码（一致性检查失败时返回非0）
+ */
+int runFrameBenchmark();
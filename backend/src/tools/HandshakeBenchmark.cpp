@@ -0,0 +1,494 @@
+/**
+ * HandshakeBenchmark.cpp
+ *
+ * 握手基准实现
+ */
+
+#include "tools/HandshakeBenchmark.h"
+#include "core/SessionManager.h"
+#include "core/TickWatchdog.h"
+#include "core/WebSocketFrame.h"
+#include "core/WebSocketServer.h"
+#include "utils/Base64.h"
+#include "utils/Sha1.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * 丢弃所有输出的流缓冲（风暴期间每个会话都会打印日志）
+     */
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    std::vector<std::string> makeClientKeys(size_t count) {
+        std::mt19937 rng(20240601);
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t nonce[16];
+            for (auto& byte : nonce) {
+                byte = static_cast<uint8_t>(rng());
+            }
+            keys.push_back(Base64::encode(nonce, sizeof(nonce)));
+        }
+        return keys;
+    }
+
+    struct KeyMode {
+        const char* name;
+        bool sha;
+        bool base64;
+    };
+
+    /**
+     * 握手计算：各实现结果一致，并输出每次耗时
+     */
+    bool runAcceptKeyBenchmark() {
+        const KeyMode modes[] = {
+            {"scalar", false, false},
+            {"sha-ni", true, false},
+            {"sha-ni+ssse3", true, true},
+        };
+        bool defaultSha = Sha1::hardwareEnabled();
+        bool defaultBase64 = Base64::simdEnabled();
+        std::vector<std::string> keys = makeClientKeys(1024);
+
+        // 一致性：以标量实现为准
+        Sha1::setHardwareEnabled(false);
+        Base64::setSimdEnabled(false);
+        std::vector<std::string> expected;
+        for (const auto& key : keys) {
+            expected.push_back(WebSocketFrame::computeAcceptKey(key));
+        }
+        bool consistent = WebSocketFrame::computeAcceptKey("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=";
+
+        std::cout << std::left << std::setw(16) << "mode" << std::right << std::setw(12) << "ns/key"
+                  << std::setw(14) << "keys/s" << std::endl;
+        const size_t iterations = 1000000;
+        volatile size_t sink = 0;
+        for (const auto& mode : modes) {
+            if (!Sha1::setHardwareEnabled(mode.sha) || !Base64::setSimdEnabled(mode.base64)) {
+                std::cout << std::left << std::setw(16) << mode.name << std::right << std::setw(12) << "-"
+                          << std::setw(14) << "(CPU不支持)" << std::endl;
+                continue;
+            }
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (WebSocketFrame::computeAcceptKey(keys[i]) != expected[i]) {
+                    std::cerr << "[HandshakeBenchmark] 不一致: mode=" << mode.name << " key=" << keys[i] << std::endl;
+                    consistent = false;
+                }
+            }
+
+            auto start = Clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                sink = sink + WebSocketFrame::computeAcceptKey(keys[i & 1023]).size();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::cout << std::left << std::setw(16) << mode.name << std::right << std::setw(12) << std::fixed
+                      << std::setprecision(1) << seconds * 1e9 / iterations << std::setw(14)
+                      << std::setprecision(0) << iterations / seconds << std::endl;
+        }
+
+        (void)sink;
+        Sha1::setHardwareEnabled(defaultSha);
+        Base64::setSimdEnabled(defaultBase64);
+        return consistent;
+    }
+
+#ifndef _WIN32
+
+    constexpr uint16_t kBenchPort = 18090;
+
+    /**
+     * 模拟的客户端连接
+     */
+    struct Client {
+        int fd = -1;
+        std::string request;
+        size_t sent = 0;
+        std::string received;
+        bool upgraded = false;      // 收到101
+        bool ready = false;         // 收到欢迎消息
+        bool failed = false;
+        Clock::time_point start;
+    };
+
+    /**
+     * 单次风暴的结果
+     */
+    struct StormResult {
+        size_t completed = 0;
+        size_t rejected = 0;
+        double seconds = 0;
+        double latencyP50Ms = 0;
+        double latencyP99Ms = 0;
+        size_t pings = 0;
+        double pingAvgMs = 0;
+        double pingMaxMs = 0;
+        double longestTickMs = 0;       // 网络事件循环在风暴期间最长一轮所在桶的上限
+    };
+
+    std::string makeUpgradeRequest(const std::string& key) {
+        return "GET / HTTP/1.1\r\n"
+               "Host: 127.0.0.1\r\n"
+               "Upgrade: websocket\r\n"
+               "Connection: Upgrade\r\n"
+               "Sec-WebSocket-Key: " + key + "\r\n"
+               "Sec-WebSocket-Version: 13\r\n\r\n";
+    }
+
+    int connectLocal() {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(kBenchPort);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 && errno != EINPROGRESS) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /**
+     * 发送未发完的请求、读取响应；返回本次读到的完整服务器帧的操作码
+     */
+    std::vector<uint8_t> pumpClient(Client& client) {
+        std::vector<uint8_t> opcodes;
+        while (client.sent < client.request.size()) {
+            ssize_t sent = ::send(client.fd, client.request.data() + client.sent,
+                                  client.request.size() - client.sent, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                break;
+            }
+            client.sent += static_cast<size_t>(sent);
+        }
+
+        char buffer[4096];
+        while (true) {
+            ssize_t received = ::recv(client.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                client.received.append(buffer, static_cast<size_t>(received));
+                continue;
+            }
+            if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                client.failed = !client.ready;
+            }
+            break;
+        }
+
+        if (!client.upgraded) {
+            size_t end = client.received.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                return opcodes;
+            }
+            if (client.received.compare(0, 12, "HTTP/1.1 101") != 0) {
+                client.failed = true;
+                return opcodes;
+            }
+            client.upgraded = true;
+            client.received.erase(0, end + 4);
+        }
+
+        // 服务器发出的帧不加掩码
+        while (client.received.size() >= 2) {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(client.received.data());
+            size_t headerLength = 2;
+            uint64_t payloadLength = data[1] & 0x7F;
+            if (payloadLength == 126) {
+                headerLength = 4;
+                if (client.received.size() < headerLength) {
+                    break;
+                }
+                payloadLength = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+            } else if (payloadLength == 127) {
+                headerLength = 10;
+                if (client.received.size() < headerLength) {
+                    break;
+                }
+                payloadLength = 0;
+                for (int i = 0; i < 8; ++i) {
+                    payloadLength = (payloadLength << 8) | data[2 + i];
+                }
+            }
+            if (client.received.size() < headerLength + payloadLength) {
+                break;
+            }
+            opcodes.push_back(data[0] & 0x0F);
+            client.received.erase(0, headerLength + static_cast<size_t>(payloadLength));
+        }
+        return opcodes;
+    }
+
+    /**
+     * 网络分片直方图中所有非零桶里最高的那个的上限
+     */
+    std::vector<uint64_t> networkHistogram() {
+        for (const auto& shard : TickWatchdog::instance().shardStats()) {
+            if (shard.name == "network") {
+                return shard.histogram;
+            }
+        }
+        return {};
+    }
+
+    StormResult runStorm(size_t connectionCount) {
+        StormResult result;
+        std::vector<std::string> keys = makeClientKeys(connectionCount + 1);
+
+        // 在线玩家：风暴开始前连上，之后持续Ping（空负载、带掩码的Ping帧）
+        Client probe;
+        probe.fd = connectLocal();
+        probe.request = makeUpgradeRequest(keys.back());
+        auto deadline = Clock::now() + std::chrono::seconds(5);
+        while (probe.fd >= 0 && !probe.ready && !probe.failed && Clock::now() < deadline) {
+            pollfd pfd{probe.fd, POLLIN | POLLOUT, 0};
+            ::poll(&pfd, 1, 50);
+            for (uint8_t opcode : pumpClient(probe)) {
+                probe.ready = probe.ready || opcode == 0x1;
+            }
+            if (probe.sent == probe.request.size()) {
+                probe.request.clear();
+                probe.sent = 0;
+            }
+        }
+        if (!probe.ready) {
+            std::cerr << "[HandshakeBenchmark] 在线玩家连接失败" << std::endl;
+            if (probe.fd >= 0) {
+                ::close(probe.fd);
+            }
+            return result;
+        }
+        const std::string ping = {'\x89', '\x80', '\x01', '\x02', '\x03', '\x04'};
+        bool pingOutstanding = false;
+        Clock::time_point pingSentAt;
+        double pingTotalMs = 0;
+
+        std::vector<uint64_t> histogramBefore = networkHistogram();
+
+        std::vector<Client> clients(connectionCount);
+        auto stormStart = Clock::now();
+        for (size_t i = 0; i < connectionCount; ++i) {
+            clients[i].fd = connectLocal();
+            clients[i].request = makeUpgradeRequest(keys[i]);
+            clients[i].start = Clock::now();
+            clients[i].failed = clients[i].fd < 0;
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<size_t> owners;
+        std::vector<double> latencies;
+        deadline = Clock::now() + std::chrono::seconds(60);
+        size_t finished = 0;
+        for (const auto& client : clients) {
+            finished += client.failed ? 1 : 0;
+        }
+
+        while (finished < connectionCount && Clock::now() < deadline) {
+            if (!pingOutstanding) {
+                if (::send(probe.fd, ping.data(), ping.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(ping.size())) {
+                    pingOutstanding = true;
+                    pingSentAt = Clock::now();
+                }
+            }
+
+            fds.clear();
+            owners.clear();
+            fds.push_back({probe.fd, POLLIN, 0});
+            owners.push_back(SIZE_MAX);
+            for (size_t i = 0; i < clients.size(); ++i) {
+                const Client& client = clients[i];
+                if (client.ready || client.failed) {
+                    continue;
+                }
+                short events = POLLIN;
+                if (client.sent < client.request.size()) {
+                    events |= POLLOUT;
+                }
+                fds.push_back({client.fd, events, 0});
+                owners.push_back(i);
+            }
+            ::poll(fds.data(), fds.size(), 10);
+
+            for (size_t j = 0; j < fds.size(); ++j) {
+                if (fds[j].revents == 0) {
+                    continue;
+                }
+                if (owners[j] == SIZE_MAX) {
+                    for (uint8_t opcode : pumpClient(probe)) {
+                        if (opcode == 0xA && pingOutstanding) {
+                            double ms = std::chrono::duration<double, std::milli>(Clock::now() - pingSentAt).count();
+                            pingOutstanding = false;
+                            pingTotalMs += ms;
+                            result.pingMaxMs = std::max(result.pingMaxMs, ms);
+                            ++result.pings;
+                        }
+                    }
+                    continue;
+                }
+
+                Client& client = clients[owners[j]];
+                for (uint8_t opcode : pumpClient(client)) {
+                    if (opcode == 0x1 && !client.ready) {
+                        client.ready = true;
+                        latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - client.start).count());
+                    }
+                }
+                if (client.failed && client.received.find(" 503 ") != std::string::npos) {
+                    ++result.rejected;
+                }
+                if (client.ready || client.failed) {
+                    ++finished;
+                }
+            }
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - stormStart).count();
+        result.completed = latencies.size();
+
+        std::vector<uint64_t> histogramAfter = networkHistogram();
+        for (size_t i = histogramAfter.size(); i-- > 0;) {
+            uint64_t before = i < histogramBefore.size() ? histogramBefore[i] : 0;
+            if (histogramAfter[i] > before) {
+                double limit = TickWatchdog::bucketLimitMillis(i);
+                result.longestTickMs = limit > 0 ? limit : TickWatchdog::bucketLimitMillis(i - 1) * 2;
+                break;
+            }
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        if (!latencies.empty()) {
+            result.latencyP50Ms = latencies[latencies.size() / 2];
+            result.latencyP99Ms = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+        }
+        result.pingAvgMs = result.pings ? pingTotalMs / result.pings : 0;
+
+        for (auto& client : clients) {
+            if (client.fd >= 0) {
+                ::close(client.fd);
+            }
+        }
+        ::close(probe.fd);
+        return result;
+    }
+
+    /**
+     * 连接数受进程描述符上限约束（客户端和服务器端各占一个）
+     */
+    size_t clampToDescriptorLimit(size_t connections) {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+            ::getrlimit(RLIMIT_NOFILE, &limit);
+            size_t usable = limit.rlim_cur > 128 ? static_cast<size_t>((limit.rlim_cur - 128) / 2) : 0;
+            if (connections > usable) {
+                std::cout << "连接数受描述符上限限制，调整为 " << usable << std::endl;
+                connections = usable;
+            }
+        }
+        return connections;
+    }
+
+#endif // !_WIN32
+
+} // namespace
+
+int runHandshakeBenchmark(int connections) {
+    std::cout << "=== WebSocket握手基准 ===" << std::endl;
+    std::cout << "SHA扩展: " << (Sha1::hardwareEnabled() ? "可用" : "不可用")
+              << "，SSSE3 Base64: " << (Base64::simdEnabled() ? "可用" : "不可用") << std::endl;
+    std::cout << std::endl << "--- 握手计算（computeAcceptKey） ---" << std::endl;
+    if (!runAcceptKeyBenchmark()) {
+        return -1;
+    }
+
+#ifdef _WIN32
+    (void)connections;
+    std::cout << "连接风暴测试只在POSIX平台可用" << std::endl;
+    return 0;
+#else
+    if (connections <= 0) {
+        std::cerr << "[HandshakeBenchmark] 错误: 连接数必须大于0" << std::endl;
+        return -1;
+    }
+    size_t connectionCount = clampToDescriptorLimit(static_cast<size_t>(connections));
+
+    std::cout << std::endl << "--- 连接风暴（" << connectionCount << " 个连接，端口 " << kBenchPort << "） ---" << std::endl;
+    std::cout << std::left << std::setw(12) << "admit/s" << std::right << std::setw(8) << "done"
+              << std::setw(8) << "503" << std::setw(10) << "sec" << std::setw(12) << "hs/s"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(12) << "ping avg"
+              << std::setw(12) << "ping max" << std::setw(12) << "tick max" << std::endl;
+
+    const char* rates[] = {"0", "1000"};
+    const char* originalRate = std::getenv("TIME_ARTIFACTS_ADMIT_RATE");
+    std::string savedRate = originalRate ? originalRate : "";
+
+    for (const char* rate : rates) {
+        ::setenv("TIME_ARTIFACTS_ADMIT_RATE", rate, 1);
+
+        NullBuffer nullBuffer;
+        std::streambuf* originalBuffer = std::cout.rdbuf(&nullBuffer);
+        StormResult result;
+        {
+            auto sessionManager = std::make_unique<SessionManager>();
+            auto server = std::make_unique<WebSocketServer>();
+            server->setSessionManager(sessionManager.get());
+            if (server->start(kBenchPort)) {
+                result = runStorm(connectionCount);
+                server->stop();
+            } else {
+                std::cout.rdbuf(originalBuffer);
+                std::cerr << "[HandshakeBenchmark] 错误: 无法在端口 " << kBenchPort << " 启动服务器" << std::endl;
+                return -1;
+            }
+        }
+        std::cout.rdbuf(originalBuffer);
+
+        std::string rateName = std::string(rate) == "0" ? "unlimited" : rate;
+        std::cout << std::left << std::setw(12) << rateName << std::right << std::setw(8) << result.completed
+                  << std::setw(8) << result.rejected << std::fixed << std::setprecision(2) << std::setw(10)
+                  << result.seconds << std::setprecision(0) << std::setw(12)
+                  << (result.seconds > 0 ? result.completed / result.seconds : 0.0) << std::setprecision(1)
+                  << std::setw(10) << result.latencyP50Ms << std::setw(10) << result.latencyP99Ms
+                  << std::setw(12) << result.pingAvgMs << std::setw(12) << result.pingMaxMs
+                  << std::setw(12) << result.longestTickMs << std::endl;
+    }
+
+    if (originalRate) {
+        ::setenv("TIME_ARTIFACTS_ADMIT_RATE", savedRate.c_str(), 1);
+    } else {
+        ::unsetenv("TIME_ARTIFACTS_ADMIT_RATE");
+    }
+    std::cout << "（tick max：风暴期间网络事件循环最长一轮所在直方图桶的上限，毫秒）" << std::endl;
+    return 0;
+#endif
+}
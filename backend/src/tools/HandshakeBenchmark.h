@@ -0,0 +1,24 @@
+/**
+ * HandshakeBenchmark.h
+ *
+ * 握手基准 - 握手计算的吞吐，以及连接风暴下的握手速率和事件循环延迟
+ *
+ * 【用法】：TimeArtifacts --bench-handshakes [连接数]
+ *
+ * 【内容】：
+ * 1. 握手计算：computeAcceptKey 在标量、SHA扩展、SHA扩展+SSSE3 Base64 下的耗时，
+ *    各实现的结果必须一致
+ * 2. 连接风暴：在本地端口启动服务器，先连上一个"在线玩家"持续发送Ping，
+ *    再同时发起N个WebSocket连接，统计每秒完成的握手数（收到欢迎消息为止）、
+ *    被拒绝（503）的连接数、在线玩家的Ping往返时间和网络事件循环的最长一轮。
+ *    分别在不限速和默认放行速率下各跑一次
+ */
+
+#pragma once
+
+/**
+ * 运行握手基准
+ * 【参数】：connections - 连接风暴的连接数
+ * 【返回】：进程退出码（一致性检查失败时返回非0）
+ */
+int runHandshakeBenchmark(int connections);
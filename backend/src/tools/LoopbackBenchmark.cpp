@@ -0,0 +1,273 @@
+/**
+ * LoopbackBenchmark.cpp
+ *
+ * 回环基准实现
+ */
+
+#include "tools/LoopbackBenchmark.h"
+#include "core/ChoiceStatistics.h"
+#include "core/ContentStore.h"
+#include "core/LoopbackChannel.h"
+#include "core/PrefetchPlanner.h"
+#include "core/RuleNetwork.h"
+#include "core/SessionManager.h"
+#include "core/WebSocketServer.h"
+#include "core/WorldData.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * 丢弃所有输出的流缓冲（每条消息都会产生处理日志）
+     */
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    const size_t kClients = 64;
+    const size_t kWindow = 8;   // 双线程模式每个连接的在途消息上限
+
+    // 起始场景的一圈命令（每条都有且只有一条响应）
+    const std::vector<std::string> kScriptedMessages = {
+        R"({"action": "examine", "data": {"target": "bookshelf"}})",
+        R"({"action": "talk", "data": {"target": "bookstore_owner"}})",
+        R"({"optionId": "ask_about_memories"})",
+        R"({"action": "move", "data": {"direction": "north"}})",
+        R"({"action": "move", "data": {"direction": "south"}})"
+    };
+
+    struct Client {
+        std::shared_ptr<LoopbackChannel> channel;
+        size_t sent = 0;
+        std::deque<std::chrono::steady_clock::time_point> inFlight;
+    };
+
+    /**
+     * 取出一条响应（跳过不占用请求的prefetch推送）
+     * 【返回】：收到的是命令响应时返回true
+     */
+    bool receiveResponse(Client& client, std::string& payload, bool& any) {
+        any = client.channel->receive(payload);
+        return any && payload.find("\"type\":\"prefetch\"") == std::string::npos;
+    }
+
+    /**
+     * 打开连接并完成升级（收到欢迎消息为止）
+     */
+    bool connectClients(WebSocketServer& server, std::vector<Client>& clients) {
+        clients.resize(kClients);
+        for (auto& client : clients) {
+            client.channel = server.openLoopback();
+            if (!client.channel || !client.channel->sendUpgrade()) {
+                return false;
+            }
+        }
+        server.pumpLoopback();
+        std::string payload;
+        for (auto& client : clients) {
+            bool any = false;
+            if (!receiveResponse(client, payload, any) || client.channel->handshakeStatus() != 101 ||
+                payload.find("\"welcome\"") == std::string::npos) {
+                return false;
+            }
+            while (client.channel->receive(payload)) {
+            }
+        }
+        return true;
+    }
+
+    void disconnectClients(WebSocketServer& server, std::vector<Client>& clients) {
+        for (auto& client : clients) {
+            client.channel->disconnect();
+        }
+        server.pumpLoopback();
+        clients.clear();
+    }
+
+    /**
+     * 同步模式：每轮每个客户端发一条，驱动一次事件循环，再收完所有响应
+     */
+    bool runSynchronous(WebSocketServer& server, size_t messages, double& seconds) {
+        std::vector<Client> clients;
+        if (!connectClients(server, clients)) {
+            return false;
+        }
+
+        std::string payload;
+        size_t sent = 0;
+        size_t responses = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (sent < messages) {
+            for (auto& client : clients) {
+                if (sent == messages) {
+                    break;
+                }
+                if (client.channel->sendText(kScriptedMessages[client.sent % kScriptedMessages.size()])) {
+                    client.sent++;
+                    sent++;
+                }
+            }
+            server.pumpLoopback();
+            for (auto& client : clients) {
+                bool any = true;
+                while (any) {
+                    if (receiveResponse(client, payload, any)) {
+                        responses++;
+                    }
+                }
+            }
+        }
+        // 回环通道写满时剩余的响应留在发送队列里，再驱动几轮收完
+        for (size_t before = 0; responses < messages && before != responses;) {
+            before = responses;
+            server.pumpLoopback();
+            for (auto& client : clients) {
+                bool any = true;
+                while (any) {
+                    if (receiveResponse(client, payload, any)) {
+                        responses++;
+                    }
+                }
+            }
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        disconnectClients(server, clients);
+        return responses == messages;
+    }
+
+    /**
+     * 双线程模式：服务器线程驱动事件循环，当前线程作为所有客户端
+     */
+    bool runThreaded(WebSocketServer& server, size_t messages, double& seconds, std::vector<double>& latencies) {
+        std::vector<Client> clients;
+        if (!connectClients(server, clients)) {
+            return false;
+        }
+
+        // 建立连接后由服务器线程接管驱动（之后只在那个线程调用pumpLoopback）
+        std::atomic<bool> done{false};
+        std::thread serverThread([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                if (server.pumpLoopback() == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        std::string payload;
+        size_t sent = 0;
+        size_t responses = 0;
+        latencies.clear();
+        latencies.reserve(messages);
+        auto start = std::chrono::steady_clock::now();
+        while (responses < messages) {
+            bool progressed = false;
+            for (auto& client : clients) {
+                while (sent < messages && client.inFlight.size() < kWindow &&
+                       client.channel->sendText(kScriptedMessages[client.sent % kScriptedMessages.size()])) {
+                    client.sent++;
+                    sent++;
+                    client.inFlight.push_back(std::chrono::steady_clock::now());
+                    progressed = true;
+                }
+                bool any = true;
+                while (any) {
+                    if (receiveResponse(client, payload, any) && !client.inFlight.empty()) {
+                        auto now = std::chrono::steady_clock::now();
+                        latencies.push_back(std::chrono::duration<double, std::micro>(now - client.inFlight.front()).count());
+                        client.inFlight.pop_front();
+                        responses++;
+                        progressed = true;
+                    }
+                }
+            }
+            if (!progressed) {
+                std::this_thread::yield();
+            }
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        done.store(true, std::memory_order_release);
+        serverThread.join();
+        disconnectClients(server, clients);
+        return true;
+    }
+
+    double percentile(std::vector<double>& values, double fraction) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+} // namespace
+
+int runLoopbackBenchmark(int messages) {
+    if (messages <= 0) {
+        std::cerr << "[LoopbackBenchmark] 错误: 消息数必须大于0" << std::endl;
+        return -1;
+    }
+
+    NullBuffer nullBuffer;
+    std::streambuf* originalBuffer = std::cout.rdbuf(&nullBuffer);
+
+    // 与GameEngine一致的世界和索引（没有数据目录时APIHandler使用内置演示内容）
+    bool worldLoaded = WorldData::loadGlobal();
+    if (worldLoaded) {
+        ContentStore::instance().initialize(*WorldData::global());
+        ChoiceStatistics::instance().initialize(*WorldData::global());
+        PrefetchPlanner::instance().initialize(*WorldData::global());
+        RuleNetwork::instance().loadFromDirectory(WorldData::locateDataDirectory());
+    }
+
+    bool started = false;
+    bool syncOk = false;
+    bool threadedOk = false;
+    double syncSeconds = 0.0;
+    double threadedSeconds = 0.0;
+    std::vector<double> latencies;
+    {
+        SessionManager sessionManager;
+        WebSocketServer server;
+        server.setSessionManager(&sessionManager);
+        started = server.startLoopback();
+        syncOk = started && runSynchronous(server, static_cast<size_t>(messages), syncSeconds);
+        threadedOk = syncOk && runThreaded(server, static_cast<size_t>(messages), threadedSeconds, latencies);
+        server.stop();
+    }
+
+    std::cout.rdbuf(originalBuffer);
+
+    if (!syncOk || !threadedOk) {
+        std::cerr << "[LoopbackBenchmark] 错误: " << (started ? "响应数与消息数不一致或升级失败" : "回环模式启动失败")
+                  << std::endl;
+        return -1;
+    }
+
+    std::cout << "=== 回环基准: " << messages << " 条消息，" << kClients << " 个连接 ===" << std::endl;
+    std::cout << "世界数据: " << (worldLoaded ? "已加载" : "未找到，使用内置演示内容") << std::endl;
+    std::cout << std::left << std::setw(12) << "mode" << std::right << std::setw(14) << "msgs/s"
+              << std::setw(12) << "us/msg" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(12) << "sync" << std::right
+              << std::setw(14) << messages / syncSeconds << std::setw(12) << syncSeconds * 1e6 / messages
+              << std::setw(12) << "-" << std::setw(12) << "-" << std::endl;
+    std::cout << std::left << std::setw(12) << "threaded" << std::right
+              << std::setw(14) << messages / threadedSeconds << std::setw(12) << threadedSeconds * 1e6 / messages
+              << std::setw(12) << percentile(latencies, 0.50) << std::setw(12) << percentile(latencies, 0.99) << std::endl;
+    return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ * LoopbackBenchmark.h
+ *
+ * 回环基准 - 不经过内核套接字，测量 帧解析 → 会话/APIHandler → 序列化编码 整条路径的吞吐
+ *
+ * 【用法】：TimeArtifacts --bench-loopback [消息数]
+ *
+ * 【内容】：WebSocketServer以回环模式启动，64个客户端通过LoopbackChannel完成HTTP升级，
+ *   然后循环发送与前端一致的命令（检查书架、对话、选择、离开、返回）
+ * 1. 同步模式：同一线程按轮 发送 → pumpLoopback → 接收，结果可复现；
+ *    检查每条消息恰好收到一条响应
+ * 2. 双线程模式：服务器线程不停地pumpLoopback，客户端线程每个连接最多8条在途消息，
+ *    统计吞吐和往返延迟（p50/p99）
+ */
+
+#pragma once
+
+/**
+ * 运行回环基准
+ * 【参数】：messages - 每种模式发送的消息总数
+ * 【返回】：进程退出码（响应数与消息数不一致时返回非0）
+ */
+int runLoopbackBenchmark(int messages);
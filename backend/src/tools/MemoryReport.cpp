@@ -0,0 +1,192 @@
+/**
+ * MemoryReport.cpp
+ *
+ * 内存报告工具实现
+ */
+
+#include "tools/MemoryReport.h"
+#include "core/ChoiceStatistics.h"
+#include "core/ContentStore.h"
+#include "core/EventManager.h"
+#include "core/Events.h"
+#include "core/LoopbackChannel.h"
+#include "core/MemoryTracker.h"
+#include "core/PrefetchPlanner.h"
+#include "core/RuleNetwork.h"
+#include "core/SessionManager.h"
+#include "core/WebSocketServer.h"
+#include "core/WorldData.h"
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * 丢弃所有输出的流缓冲
+     * 【作用】：合成会话会产生大量日志，报告期间临时屏蔽std::cout
+     */
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    // 每个合成会话执行的命令序列（与前端发送的格式一致，起始场景的一圈操作）
+    const std::vector<std::string> kScriptedMessages = {
+        R"({"action": "examine", "data": {"target": "bookshelf"}})",
+        R"({"action": "talk", "data": {"target": "bookstore_owner"}})",
+        R"({"optionId": "ask_about_memories"})",
+        R"({"action": "move", "data": {"direction": "north"}})"
+    };
+
+    // 每条回环连接每个方向的字节环容量（生产环境中对应内核套接字缓冲，报告中从network行扣除）
+    const size_t kChannelCapacity = 32 * 1024;
+
+    /**
+     * 驱动一轮事件循环并丢弃客户端收到的消息
+     */
+    void pumpAndDrain(WebSocketServer& server, LoopbackChannel& channel) {
+        std::string payload;
+        server.pumpLoopback();
+        while (channel.receive(payload)) {
+        }
+    }
+
+    void printRow(const std::string& name, int64_t deltaBytes, int64_t deltaAllocs, int sessionCount) {
+        std::cout << "  " << std::left << std::setw(14) << name
+                  << std::right << std::setw(14) << deltaBytes
+                  << std::setw(16) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(deltaBytes) / sessionCount
+                  << std::setw(16) << static_cast<double>(deltaAllocs) / sessionCount
+                  << std::endl;
+    }
+
+} // namespace
+
+int runMemoryReport(int sessionCount) {
+    if (sessionCount <= 0) {
+        std::cerr << "[MemoryReport] 错误: 会话数量必须大于0" << std::endl;
+        return -1;
+    }
+
+    if (!MemoryTracker::isEnabled()) {
+        std::cerr << "[MemoryReport] 警告: 编译时未启用ENABLE_MEMORY_TRACKING，"
+                  << "只统计带标签分配器的容器" << std::endl;
+    }
+
+    std::cout << "[MemoryReport] 正在创建 " << sessionCount << " 个合成会话..." << std::endl;
+
+    NullBuffer nullBuffer;
+    std::streambuf* originalBuffer = std::cout.rdbuf(&nullBuffer);
+
+    MemorySnapshot start = MemoryTracker::snapshot();
+
+    // 世界数据和索引（与GameEngine的启动步骤一致），是不随会话数变化的固定成本
+    bool worldLoaded = WorldData::loadGlobal();
+    if (worldLoaded) {
+        ContentStore::instance().initialize(*WorldData::global());
+        ChoiceStatistics::instance().initialize(*WorldData::global());
+        PrefetchPlanner::instance().initialize(*WorldData::global());
+        RuleNetwork::instance().loadFromDirectory(WorldData::locateDataDirectory());
+    }
+    MemorySnapshot loaded = MemoryTracker::snapshot();
+
+    MemorySnapshot before;
+    MemorySnapshot after;
+    MemorySnapshot residual;
+    bool connected = true;
+    {
+        auto eventManager = std::make_unique<EventManager>(sessionCount * static_cast<int>(kScriptedMessages.size()) + 1);
+        auto sessionManager = std::make_unique<SessionManager>();
+        auto server = std::make_unique<WebSocketServer>();
+        server->setSessionManager(sessionManager.get());
+        connected = server->startLoopback();
+
+        // 与GameEngine一致的系统级订阅
+        eventManager->subscribe("LocationChanged", [](const Event&) {}, "GameEngine", 1);
+
+        before = MemoryTracker::snapshot();
+
+        // 每个会话走完整的连接路径：升级握手 → 欢迎消息 → 命令经帧解析、APIHandler、序列化返回
+        std::vector<std::shared_ptr<LoopbackChannel>> channels;
+        channels.reserve(static_cast<size_t>(sessionCount));
+        for (int i = 0; i < sessionCount && connected; ++i) {
+            auto channel = server->openLoopback(kChannelCapacity);
+            if (!channel || !channel->sendUpgrade()) {
+                connected = false;
+                break;
+            }
+            pumpAndDrain(*server, *channel);
+            connected = channel->handshakeStatus() == 101;
+            for (const auto& message : kScriptedMessages) {
+                channel->sendText(message);
+                pumpAndDrain(*server, *channel);
+                // 每条命令产生一个待处理事件（模拟一帧内积压的事件）
+                MemoryScope eventScope(MemoryTag::Events);
+                eventManager->publish(std::make_unique<LocationChangedEvent>("time_corner_bookstore", "old_street"));
+            }
+            channels.push_back(std::move(channel));
+        }
+
+        after = MemoryTracker::snapshot();
+
+        for (auto& channel : channels) {
+            channel->disconnect();
+        }
+        server->pumpLoopback();
+        channels.clear();
+        server->stop();
+        server.reset();
+        eventManager->processEvents();
+    }
+    residual = MemoryTracker::snapshot();
+
+    std::cout.rdbuf(originalBuffer);
+
+    if (!connected) {
+        std::cerr << "[MemoryReport] 错误: 回环连接升级失败" << std::endl;
+        return -1;
+    }
+
+    std::cout << std::endl;
+    std::cout << "=== 内存报告: " << sessionCount << " 个会话 ===" << std::endl;
+    std::cout << "  " << std::left << std::setw(14) << "subsystem"
+              << std::right << std::setw(14) << "delta_bytes"
+              << std::setw(16) << "bytes/session"
+              << std::setw(16) << "allocs/session" << std::endl;
+
+    int64_t totalDelta = 0;
+    for (size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); ++i) {
+        auto tag = static_cast<MemoryTag>(i);
+        int64_t deltaBytes = after[tag].currentBytes - before[tag].currentBytes;
+        int64_t deltaAllocs = after[tag].liveAllocations() - before[tag].liveAllocations();
+        if (tag == MemoryTag::Network) {
+            // 扣除回环通道本身（对象、控制块和两个方向的字节环）
+            deltaBytes -= static_cast<int64_t>(sessionCount) *
+                          static_cast<int64_t>(sizeof(LoopbackChannel) + 2 * kChannelCapacity);
+        }
+        totalDelta += deltaBytes;
+        printRow(MemoryTracker::tagName(tag), deltaBytes, deltaAllocs, sessionCount);
+    }
+    printRow("total", totalDelta, 0, sessionCount);
+
+    std::cout << std::endl;
+    std::cout << "固定成本（世界数据" << (worldLoaded ? "及索引" : "未找到，使用内置演示内容") << "）:" << std::endl;
+    for (size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); ++i) {
+        auto tag = static_cast<MemoryTag>(i);
+        int64_t fixedBytes = loaded[tag].currentBytes - start[tag].currentBytes;
+        if (fixedBytes != 0) {
+            std::cout << "  " << std::left << std::setw(14) << MemoryTracker::tagName(tag)
+                      << std::right << std::setw(14) << fixedBytes << std::endl;
+        }
+    }
+    std::cout << "network 行已扣除回环通道的字节环（生产环境中对应内核套接字缓冲）" << std::endl;
+
+    int64_t leaked = residual.totalBytes() - loaded.totalBytes();
+    std::cout << std::endl;
+    std::cout << "清理后残留: " << leaked << " 字节" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+/**
+ * MemoryReport.h
+ *
+ * 内存报告工具 - 估算每个会话在各子系统上的边际内存
+ *
+ * 【用法】：TimeArtifacts --memory-report [会话数量]
+ *
+ * 【流程】：
+ * 1. 加载世界数据和索引（与服务器启动相同），单独输出这部分固定成本
+ * 2. 以回环模式启动WebSocketServer，记录基线内存快照
+ * 3. 打开N条回环连接，每条完成升级握手后执行一段典型的命令序列（走真实的帧解析、
+ *    APIHandler和序列化路径），每条命令再发布一个事件
+ * 4. 再次记录快照，按子系统输出 (快照差值 / N)
+ * 5. 断开连接、清理所有会话和事件，输出残留字节（用于发现泄漏）
+ */
+
+#pragma once
+
+/**
+ * 运行内存报告
+ * 【参数】：sessionCount - 合成会话数量
+ * 【返回】：进程退出码
+ */
+int runMemoryReport(int sessionCount);
@@ -0,0 +1,332 @@
+/**
+ * ScriptBenchmark.cpp
+ *
+ * 交互脚本微基准实现
+ */
+
+#include "tools/ScriptBenchmark.h"
+#include "core/ScriptCompiler.h"
+#include "core/ScriptVM.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * 基准用宿主：保存一份简化的玩家状态，可选记录每次调用（一致性检查用）
+     */
+    class BenchHost : public ScriptHost {
+    public:
+        std::map<std::string, int> attributes;
+        std::vector<std::string> items;
+        std::set<std::string> insights;
+        std::set<std::string> flags;
+        std::vector<std::string> log;
+        size_t lines = 0;
+        std::string nextDialogue;
+        bool recording = false;
+
+        int getAttribute(const std::string& name) override {
+            record("get " + name);
+            auto it = attributes.find(name);
+            return it != attributes.end() ? it->second : 0;
+        }
+        void setAttribute(const std::string& name, int value) override {
+            record("set " + name + "=" + std::to_string(value));
+            attributes[name] = value;
+        }
+        bool hasItem(const std::string& itemId) override {
+            record("has " + itemId);
+            return std::find(items.begin(), items.end(), itemId) != items.end();
+        }
+        bool knowsInsight(const std::string& insightId) override {
+            record("knows " + insightId);
+            return insights.count(insightId) > 0;
+        }
+        bool hasFlag(const std::string& flag) override {
+            record("flag? " + flag);
+            return flags.count(flag) > 0;
+        }
+        void giveItem(const std::string& itemId) override {
+            record("give " + itemId);
+            if (std::find(items.begin(), items.end(), itemId) == items.end()) {
+                items.push_back(itemId);
+            }
+        }
+        void takeItem(const std::string& itemId) override {
+            record("take " + itemId);
+            items.erase(std::remove(items.begin(), items.end(), itemId), items.end());
+        }
+        void gainInsight(const std::string& insightId) override {
+            record("insight " + insightId);
+            insights.insert(insightId);
+        }
+        void setFlag(const std::string& flag) override {
+            record("flag " + flag);
+            flags.insert(flag);
+        }
+        void say(const std::string& text) override {
+            record("say " + text);
+            lines++;
+        }
+        void gotoDialogue(const std::string& dialogueId) override {
+            record("goto " + dialogueId);
+            nextDialogue = dialogueId;
+        }
+
+    private:
+        void record(const std::string& entry) {
+            if (recording) {
+                log.push_back(entry);
+            }
+        }
+    };
+
+    // 手写版本使用的名称（与脚本常量表一样只构造一次）
+    const std::string kObservation = "observation";
+    const std::string kEmpathy = "empathy";
+    const std::string kCommunication = "communication";
+    const std::string kScore = "score";
+    const std::string kOldDiary = "old_diary";
+    const std::string kHiddenDiary = "hidden_diary";
+    const std::string kDustyPhoto = "dusty_photo";
+    const std::string kStreetLampClue = "street_lamp_clue";
+    const std::string kOwnerPast = "owner_past";
+    const std::string kCityPast = "city_past";
+    const std::string kStreetHistory = "street_history";
+    const std::string kDiaryContent = "diary_content";
+    const std::string kOwnerTrueStory = "owner_true_story";
+    const std::string kMasterDetective = "master_detective";
+    const std::string kArtifactsDialogue = "bookstore_owner_artifacts";
+    const std::string kRememberLine = "你想起了日记里的那一页。";
+    const std::string kDustLine = "书架上落满了灰尘。";
+    const std::string kCloserLine = "你离真相更近了一步。";
+
+    int scriptDiv(int a, int b) { return b != 0 ? a / b : 0; }
+    int scriptMod(int a, int b) { return b != 0 ? a % b : 0; }
+
+    struct BenchCase {
+        const char* name;
+        const char* source;
+        void (*native)(ScriptHost& host);
+    };
+
+    const BenchCase kCases[] = {
+        {
+            "arithmetic",
+            R"(
+                var a = attr.observation
+                var b = attr.empathy
+                var s = a * 3 + b * 2 - 7
+                s = s % 11 + (a - b) * (a + b)
+                var t = (s + a) / (b + 1)
+                if s > 10 && t >= 2 { attr.score = s - t } else { attr.score = -s + t }
+            )",
+            [](ScriptHost& host) {
+                int a = host.getAttribute(kObservation);
+                int b = host.getAttribute(kEmpathy);
+                int s = a * 3 + b * 2 - 7;
+                s = scriptMod(s, 11) + (a - b) * (a + b);
+                int t = scriptDiv(s + a, b + 1);
+                if (s > 10 && t >= 2) {
+                    host.setAttribute(kScore, s - t);
+                } else {
+                    host.setAttribute(kScore, -s + t);
+                }
+            }
+        },
+        {
+            "interaction",
+            R"(
+                if has("old_diary") && attr.empathy >= 3 {
+                    insight "owner_past"
+                    say "你想起了日记里的那一页。"
+                } else if knows("city_past") {
+                    attr.observation += 1
+                    give "dusty_photo"
+                } else {
+                    say "书架上落满了灰尘。"
+                }
+            )",
+            [](ScriptHost& host) {
+                if (host.hasItem(kOldDiary) && host.getAttribute(kEmpathy) >= 3) {
+                    host.gainInsight(kOwnerPast);
+                    host.say(kRememberLine);
+                } else if (host.knowsInsight(kCityPast)) {
+                    host.setAttribute(kObservation, host.getAttribute(kObservation) + 1);
+                    host.giveItem(kDustyPhoto);
+                } else {
+                    host.say(kDustLine);
+                }
+            }
+        },
+        {
+            "branching",
+            R"(
+                var score = attr.observation + attr.communication * 2
+                if flag("owner_true_story") { score += 5 }
+                if has("hidden_diary") { score += 3 }
+                if knows("street_history") || knows("diary_content") { score += 2 }
+                if score >= 12 {
+                    flag "master_detective"
+                    goto "bookstore_owner_artifacts"
+                } else if score >= 6 {
+                    say "你离真相更近了一步。"
+                } else {
+                    take "street_lamp_clue"
+                }
+            )",
+            [](ScriptHost& host) {
+                int score = host.getAttribute(kObservation) + host.getAttribute(kCommunication) * 2;
+                if (host.hasFlag(kOwnerTrueStory)) {
+                    score += 5;
+                }
+                if (host.hasItem(kHiddenDiary)) {
+                    score += 3;
+                }
+                if (host.knowsInsight(kStreetHistory) || host.knowsInsight(kDiaryContent)) {
+                    score += 2;
+                }
+                if (score >= 12) {
+                    host.setFlag(kMasterDetective);
+                    host.gotoDialogue(kArtifactsDialogue);
+                } else if (score >= 6) {
+                    host.say(kCloserLine);
+                } else {
+                    host.takeItem(kStreetLampClue);
+                }
+            }
+        },
+    };
+
+    /**
+     * 随机玩家状态
+     */
+    BenchHost randomHost(std::mt19937& rng) {
+        BenchHost host;
+        std::uniform_int_distribution<int> attributeDist(-1, 6);
+        for (const auto* name : {&kObservation, &kEmpathy, &kCommunication}) {
+            host.attributes[*name] = attributeDist(rng);
+        }
+        for (const auto* item : {&kOldDiary, &kHiddenDiary, &kStreetLampClue}) {
+            if (rng() % 2) {
+                host.items.push_back(*item);
+            }
+        }
+        for (const auto* insight : {&kCityPast, &kStreetHistory, &kDiaryContent}) {
+            if (rng() % 2) {
+                host.insights.insert(*insight);
+            }
+        }
+        if (rng() % 2) {
+            host.flags.insert(kOwnerTrueStory);
+        }
+        host.recording = true;
+        return host;
+    }
+
+    /**
+     * 一致性检查：调用序列和最终状态都必须相同
+     */
+    bool runConsistencyCheck(const std::vector<std::shared_ptr<const Script>>& scripts) {
+        std::mt19937 rng(20240101);
+        int samples = 0;
+        int mismatches = 0;
+
+        for (int round = 0; round < 3000; ++round) {
+            BenchHost initial = randomHost(rng);
+            for (size_t i = 0; i < scripts.size(); ++i) {
+                BenchHost interpreted = initial;
+                BenchHost native = initial;
+                ScriptVM::execute(*scripts[i], interpreted);
+                kCases[i].native(native);
+                ++samples;
+                if (interpreted.log != native.log || interpreted.attributes != native.attributes ||
+                    interpreted.items != native.items || interpreted.insights != native.insights ||
+                    interpreted.flags != native.flags || interpreted.nextDialogue != native.nextDialogue) {
+                    ++mismatches;
+                    if (mismatches <= 5) {
+                        std::cerr << "[ScriptBenchmark] 不一致: script=" << kCases[i].name
+                                  << " round=" << round << std::endl;
+                    }
+                }
+            }
+        }
+
+        std::cout << "一致性检查: " << samples << " 个样本，不一致 " << mismatches << " 个" << std::endl;
+        return mismatches == 0;
+    }
+
+    template <typename Fn>
+    double measureNsPerOp(size_t iterations, Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return seconds * 1e9 / static_cast<double>(iterations);
+    }
+
+} // namespace
+
+int runScriptBenchmark() {
+    std::cout << "=== 交互脚本基准 ===" << std::endl;
+    std::cout << "分派方式: " << ScriptVM::dispatchMode() << std::endl;
+
+    std::vector<std::shared_ptr<const Script>> scripts;
+    for (const auto& benchCase : kCases) {
+        std::string error;
+        auto script = ScriptCompiler::compile(benchCase.source, &error);
+        if (!script) {
+            std::cerr << "[ScriptBenchmark] 编译失败 " << benchCase.name << ": " << error << std::endl;
+            return -1;
+        }
+        scripts.push_back(std::move(script));
+    }
+
+    if (!runConsistencyCheck(scripts)) {
+        return -1;
+    }
+
+    // 每个状态各跑一轮，使分支走向不同路径（避免只测到一条被完美预测的路径）
+    std::mt19937 rng(7);
+    std::vector<BenchHost> hosts;
+    for (int i = 0; i < 16; ++i) {
+        hosts.push_back(randomHost(rng));
+        hosts.back().recording = false;
+    }
+
+    const size_t iterations = 2000000;
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(14) << "script" << std::right << std::setw(8) << "instrs"
+              << std::setw(8) << "regs" << std::setw(14) << "vm ns/op" << std::setw(14) << "native ns/op"
+              << std::setw(10) << "ratio" << std::setw(14) << "vm ops/s" << std::endl;
+
+    for (size_t i = 0; i < scripts.size(); ++i) {
+        const Script& script = *scripts[i];
+        size_t round = 0;
+        double vmNs = measureNsPerOp(iterations, [&]() {
+            ScriptVM::execute(script, hosts[round++ & 15]);
+        });
+        round = 0;
+        double nativeNs = measureNsPerOp(iterations, [&]() {
+            kCases[i].native(hosts[round++ & 15]);
+        });
+        std::cout << std::left << std::setw(14) << kCases[i].name << std::right
+                  << std::setw(8) << script.code.size() << std::setw(8) << int(script.registerCount)
+                  << std::setw(14) << std::fixed << std::setprecision(1) << vmNs
+                  << std::setw(14) << nativeNs
+                  << std::setw(10) << std::setprecision(2) << vmNs / nativeNs
+                  << std::setw(14) << std::setprecision(0) << 1e9 / vmNs << std::endl;
+    }
+
+    std::cout << std::endl << "字节码（interaction）:" << std::endl << scripts[1]->disassemble();
+    return 0;
+}
@@ -0,0 +1,19 @@
+/**
+ * ScriptBenchmark.h
+ *
+ * 交互脚本微基准 - 对比字节码解释执行与等价的手写C++
+ *
+ * 【用法】：TimeArtifacts --bench-scripts
+ *
+ * 【内容】：
+ * 1. 一致性检查：随机玩家状态下，解释执行与手写C++对宿主的调用序列必须完全相同
+ * 2. 吞吐测试：计算型、典型交互、多分支三类脚本，输出每次执行的耗时和解释开销倍数
+ */
+
+#pragma once
+
+/**
+ * 运行脚本基准
+ * 【返回】：进程退出码（编译失败或一致性检查失败时返回非0）
+ */
+int runScriptBenchmark();
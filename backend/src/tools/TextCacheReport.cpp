@@ -0,0 +1,194 @@
+/**
+ * TextCacheReport.cpp
+ *
+ * 文本缓存报告实现
+ */
+
+#include "tools/TextCacheReport.h"
+#include "core/TextStore.h"
+#include "core/WorldData.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * 一个场景被访问时会读到的文本：描述、交互结果、放置的物品、角色台词
+     */
+    std::vector<std::vector<std::string>> collectSceneTexts(const WorldData& world) {
+        std::vector<std::vector<std::string>> scenes;
+        for (const auto& entry : world.getLocations()) {
+            const Location& location = entry.second;
+            std::vector<std::string> texts;
+            auto add = [&](TextId id) {
+                if (id != TextStore::kEmpty) {
+                    texts.push_back(world.text(id));
+                }
+            };
+            for (const auto& description : location.descriptions) {
+                add(description.second);
+            }
+            for (const auto& interaction : location.interactions) {
+                add(interaction.resultText);
+            }
+            for (const auto& itemId : location.items) {
+                if (const Item* item = world.findItem(itemId)) {
+                    add(item->description);
+                    add(item->examineText);
+                }
+            }
+            for (const auto& character : location.characters) {
+                for (const auto& dialogue : world.getDialogues()) {
+                    if (dialogue.first.compare(0, character.size(), character) != 0) {
+                        continue;
+                    }
+                    add(dialogue.second.text);
+                    for (const auto& option : dialogue.second.options) {
+                        add(option.text);
+                    }
+                }
+            }
+            scenes.push_back(std::move(texts));
+        }
+        return scenes;
+    }
+
+    /**
+     * Zipf分布的场景访问序列
+     */
+    std::vector<size_t> makeTrace(size_t sceneCount, size_t visits) {
+        std::vector<double> weights(sceneCount);
+        for (size_t i = 0; i < sceneCount; ++i) {
+            weights[i] = 1.0 / static_cast<double>(i + 1);
+        }
+        std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+        std::mt19937 rng(20240101);
+
+        // 场景编号打乱，热门场景不集中在前几个块里
+        std::vector<size_t> permutation(sceneCount);
+        for (size_t i = 0; i < sceneCount; ++i) {
+            permutation[i] = i;
+        }
+        std::shuffle(permutation.begin(), permutation.end(), rng);
+
+        std::vector<size_t> trace(visits);
+        for (auto& visit : trace) {
+            visit = permutation[pick(rng)];
+        }
+        return trace;
+    }
+
+    void printRow(const std::string& name, double residentKB, double hitRate, uint64_t misses, double nsPerVisit) {
+        std::cout << std::left << std::setw(14) << name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(0) << residentKB;
+        if (hitRate < 0) {
+            std::cout << std::setw(10) << "-" << std::setw(12) << "-";
+        } else {
+            std::cout << std::setw(9) << std::setprecision(1) << hitRate * 100 << "%" << std::setw(12) << misses;
+        }
+        std::cout << std::setw(14) << std::setprecision(0) << nsPerVisit << std::endl;
+    }
+
+} // namespace
+
+int runTextCacheReport(int scale) {
+    if (scale <= 0) {
+        std::cerr << "[TextCacheReport] 错误: 世界倍数必须大于0" << std::endl;
+        return -1;
+    }
+
+    WorldData world;
+    std::string directory = WorldData::locateDataDirectory();
+    if (directory.empty() || !world.loadFromDirectory(directory)) {
+        std::cerr << "[TextCacheReport] 错误: 无法加载世界数据" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::vector<std::string>> templates = collectSceneTexts(world);
+    std::vector<std::vector<std::string>> scenes;
+    for (int copy = 0; copy < scale; ++copy) {
+        for (const auto& sceneTexts : templates) {
+            std::vector<std::string> texts;
+            for (const auto& text : sceneTexts) {
+                texts.push_back(text + "（" + std::to_string(copy) + "）");
+            }
+            scenes.push_back(std::move(texts));
+        }
+    }
+
+    // 基线：全部原文常驻
+    size_t rawBytes = 0;
+    for (const auto& sceneTexts : scenes) {
+        for (const auto& text : sceneTexts) {
+            rawBytes += text.size();
+        }
+    }
+
+    TextStore store(0);
+    std::vector<std::vector<TextId>> sceneIds;
+    auto compressStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scenes.size(); ++i) {
+        std::vector<TextId> ids;
+        for (const auto& text : scenes[i]) {
+            ids.push_back(store.add("scene_" + std::to_string(i), text));
+        }
+        sceneIds.push_back(std::move(ids));
+    }
+    store.seal();
+    double compressMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compressStart).count();
+
+    TextStore::Stats base = store.stats();
+    std::cout << "=== 世界文本缓存报告 ===" << std::endl;
+    std::cout << "场景: " << scenes.size() << "，文本: " << base.texts << " 段，块: " << base.blocks << std::endl;
+    std::cout << "原文: " << rawBytes / 1024 << " KB，压缩后: " << base.compressedBytes / 1024 << " KB（"
+              << std::fixed << std::setprecision(1) << 100.0 * base.compressedBytes / std::max<size_t>(1, rawBytes)
+              << "%），收集+压缩耗时 " << compressMs << " ms" << std::endl;
+
+    const size_t visits = 200000;
+    std::vector<size_t> trace = makeTrace(scenes.size(), visits);
+    volatile size_t sink = 0;
+
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(14) << "cache" << std::right << std::setw(14) << "resident KB"
+              << std::setw(10) << "hit" << std::setw(12) << "misses" << std::setw(14) << "ns/visit" << std::endl;
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t scene : trace) {
+            for (const auto& text : scenes[scene]) {
+                std::string copy = text;
+                sink = sink + copy.size();
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / visits;
+        printRow("uncompressed", rawBytes / 1024.0, -1, 0, ns);
+    }
+
+    const size_t capacities[] = {0, 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20};
+    for (size_t capacity : capacities) {
+        store.setCacheCapacity(capacity);
+        store.resetCounters();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t scene : trace) {
+            for (TextId id : sceneIds[scene]) {
+                sink = sink + store.get(id).size();
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / visits;
+
+        TextStore::Stats stats = store.stats();
+        double resident = (stats.compressedBytes + stats.cacheBytes + stats.pinnedBytes) / 1024.0;
+        double hitRate = static_cast<double>(stats.hits) / std::max<uint64_t>(1, stats.hits + stats.misses);
+        std::string name = capacity == 0 ? "none" : std::to_string(capacity >> 10) + " KB";
+        printRow(name, resident, hitRate, stats.misses, ns);
+    }
+
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,22 @@
+/**
+ * TextCacheReport.h
+ *
+ * 文本缓存报告 - 不同缓存容量下世界文本的常驻内存与解压开销
+ *
+ * 【用法】：TimeArtifacts --text-cache-report [世界倍数]
+ *
+ * 【流程】：
+ * 1. 把数据目录中的世界文本复制N份（每份视为不同的场景，文本略有差异以免被去重），按场景分组压缩
+ * 2. 生成按Zipf分布挑选场景的访问序列（少数热门场景占大部分访问），每次访问读取场景的全部文本
+ * 3. 对每种缓存容量回放同一序列，输出常驻内存、命中率和每次访问耗时；
+ *    第一行为不压缩（全部文本以std::string常驻）的基线
+ */
+
+#pragma once
+
+/**
+ * 运行文本缓存报告
+ * 【参数】：scale - 世界复制份数
+ * 【返回】：进程退出码
+ */
+int runTextCacheReport(int scale);
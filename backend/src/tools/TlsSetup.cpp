@@ -0,0 +1,29 @@
+/**
+ * TlsSetup.cpp
+ *
+ * TLS证书工具实现
+ */
+
+#include "tools/TlsSetup.h"
+#include "core/TlsContext.h"
+#include <iostream>
+
+int runGenerateCertificate(const std::string& directory, const std::string& commonName) {
+    if (directory.empty()) {
+        std::cerr << "[TlsSetup] 用法: --generate-cert <目录> [主机名]" << std::endl;
+        return -1;
+    }
+
+    std::string certPath = directory + "/cert.pem";
+    std::string keyPath = directory + "/key.pem";
+    if (!TlsContext::generateSelfSigned(certPath, keyPath, commonName.empty() ? "localhost" : commonName)) {
+        return -1;
+    }
+
+    std::cout << "[TlsSetup] 已生成自签名证书: " << certPath << std::endl;
+    std::cout << "[TlsSetup] 已生成私钥: " << keyPath << std::endl;
+    std::cout << "启用 https/wss:" << std::endl;
+    std::cout << "  TIME_ARTIFACTS_TLS_CERT=" << certPath << " TIME_ARTIFACTS_TLS_KEY=" << keyPath
+              << " ./TimeArtifacts" << std::endl;
+    return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ * TlsSetup.h
+ *
+ * TLS证书工具 - 生成本地测试用的自签名证书
+ *
+ * 【用法】：TimeArtifacts --generate-cert <目录> [主机名]
+ *
+ * 【输出】：<目录>/cert.pem 和 <目录>/key.pem（私钥权限0600），
+ *   并打印启用 https/wss 所需的环境变量。浏览器会提示证书不受信任，
+ *   正式部署应改用CA签发的证书
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * 生成自签名证书
+ * 【参数】：directory - 输出目录（必须已存在）
+ *          commonName - 证书主机名（默认localhost）
+ * 【返回】：进程退出码
+ */
+int runGenerateCertificate(const std::string& directory, const std::string& commonName);
@@ -0,0 +1,496 @@
+/**
+ * WorldGenerator.cpp
+ *
+ * 合成世界生成器实现
+ */
+
+#include "tools/WorldGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // 常用汉字（按词组取用，压缩率接近真实文本）
+    const char* const kCjkPhrases[] = {
+        "时光", "角落", "旧书", "街灯", "港口", "记忆", "雨夜", "钟声", "信物", "老人",
+        "窗外", "石板", "海风", "灯塔", "褪色", "照片", "日记", "钥匙", "远方", "归来",
+        "沉默", "微笑", "叹息", "尘埃", "木门", "阁楼", "黄昏", "清晨", "潮水", "回声",
+        "书架上", "落满了", "很久以前", "没有人记得", "轻轻地", "仿佛", "依然", "曾经",
+        "这座城市", "他说", "她看着", "你注意到", "一封信", "一段往事", "某个夏天"
+    };
+    const char* const kCjkPunctuation[] = {"，", "。", "、", "……"};
+
+    const char* const kWords[] = {
+        "the", "old", "street", "lamp", "harbor", "memory", "clock", "letter", "dust", "light",
+        "quiet", "rain", "window", "stone", "sea", "wind", "keeper", "photo", "diary", "key",
+        "forgotten", "distant", "evening", "morning", "whisper", "shadow", "door", "attic"
+    };
+
+    const char* const kAttributes[] = {"observation", "communication", "action", "empathy"};
+    const char* const kItemTypes[] = {"clue", "memory", "tool", "story"};
+    const char* const kAmbient[] = {"rain", "wind", "clock_ticking", "distant_crowd", "waves"};
+
+    template <size_t N>
+    const char* pickFrom(const char* const (&list)[N], std::mt19937& rng) {
+        return list[rng() % N];
+    }
+
+    /**
+     * 按长度和中文比例生成文本
+     */
+    class TextSource {
+    public:
+        TextSource(const WorldGenOptions& options, std::mt19937& rng) : options(options), rng(rng) {}
+
+        /**
+         * 平均长度为 scale * textLength 的文本
+         */
+        std::string text(double scale = 1.0) {
+            size_t average = std::max<size_t>(1, static_cast<size_t>(options.textLength * scale));
+            size_t target = average / 2 + rng() % (average + 1);
+            return exact(std::max<size_t>(1, target));
+        }
+
+        std::string exact(size_t target) {
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            std::string out;
+            size_t characters = 0;
+            bool lastCjk = false;
+            while (characters < target) {
+                if (unit(rng) < options.cjkRatio) {
+                    const char* phrase = pickFrom(kCjkPhrases, rng);
+                    out += phrase;
+                    characters += std::char_traits<char>::length(phrase) / 3;
+                    if (rng() % 5 == 0) {
+                        out += pickFrom(kCjkPunctuation, rng);
+                        characters++;
+                    }
+                    lastCjk = true;
+                } else {
+                    if (!out.empty() && !lastCjk) {
+                        out += ' ';
+                        characters++;
+                    }
+                    const char* word = pickFrom(kWords, rng);
+                    out += word;
+                    characters += std::char_traits<char>::length(word);
+                    lastCjk = false;
+                }
+            }
+            return out;
+        }
+
+    private:
+        const WorldGenOptions& options;
+        std::mt19937& rng;
+    };
+
+    /**
+     * 追加JSON字符串（含转义）
+     */
+    void appendQuoted(std::string& out, const std::string& value) {
+        out += '"';
+        for (char c : value) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    void appendList(std::string& out, const std::vector<std::string>& values) {
+        out += '[';
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) {
+                out += ", ";
+            }
+            appendQuoted(out, values[i]);
+        }
+        out += ']';
+    }
+
+    void appendRequirement(std::string& out, bool gated, std::mt19937& rng) {
+        if (!gated) {
+            out += "{}";
+            return;
+        }
+        out += "{\"attribute\": \"";
+        out += pickFrom(kAttributes, rng);
+        out += "\", \"threshold\": " + std::to_string(2 + rng() % 4) + "}";
+    }
+
+    /**
+     * 定宽编号（ID按字典序与生成顺序一致）
+     */
+    std::string makeId(const char* prefix, size_t index, size_t count) {
+        std::string digits = std::to_string(index);
+        size_t width = std::to_string(count > 0 ? count - 1 : 0).size();
+        return prefix + std::string(width > digits.size() ? width - digits.size() : 0, '0') + digits;
+    }
+
+    struct Exit {
+        const char* direction;
+        size_t target;
+    };
+
+    /**
+     * 网格出口图：每行东西相连、第0列南北相连保证连通，其余网格边和对角边按概率补充
+     */
+    std::vector<std::vector<Exit>> buildExits(const WorldGenOptions& options, std::mt19937& rng, size_t& edgeCount) {
+        size_t count = options.locations;
+        size_t width = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count)))));
+        std::vector<std::vector<Exit>> exits(count);
+        edgeCount = 0;
+        auto connect = [&](size_t from, size_t to, const char* forward, const char* backward) {
+            exits[from].push_back({forward, to});
+            exits[to].push_back({backward, from});
+            edgeCount++;
+        };
+
+        for (size_t i = 0; i < count; ++i) {
+            size_t column = i % width;
+            if (column + 1 < width && i + 1 < count) {
+                connect(i, i + 1, "east", "west");
+            }
+            if (column == 0 && i + width < count) {
+                connect(i, i + width, "south", "north");
+            }
+        }
+
+        // 可选的边：非第0列的南北边、两条对角边（每个场景约3条）
+        double wanted = std::max(0.0, options.exitsPerLocation * count / 2.0 - static_cast<double>(edgeCount));
+        double probability = std::min(1.0, wanted / std::max<double>(1.0, 3.0 * count));
+        std::bernoulli_distribution take(probability);
+        for (size_t i = 0; i < count; ++i) {
+            size_t column = i % width;
+            size_t below = i + width;
+            if (column != 0 && below < count && take(rng)) {
+                connect(i, below, "south", "north");
+            }
+            if (column + 1 < width && below + 1 < count && take(rng)) {
+                connect(i, below + 1, "southeast", "northwest");
+            }
+            if (column > 0 && below - 1 < count && take(rng)) {
+                connect(i, below - 1, "southwest", "northeast");
+            }
+        }
+        return exits;
+    }
+
+} // namespace
+
+bool WorldGenOptions::parse(const std::string& argument) {
+    size_t equals = argument.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+    std::string key = argument.substr(0, equals);
+    const char* value = argument.c_str() + equals + 1;
+    char* end = nullptr;
+    double number = std::strtod(value, &end);
+    if (end == value || *end != '\0' || number < 0) {
+        return false;
+    }
+
+    if (key == "locations" && number >= 1) {
+        locations = static_cast<size_t>(number);
+    } else if (key == "items") {
+        items = static_cast<size_t>(number);
+    } else if (key == "dialogues") {
+        dialogues = static_cast<size_t>(number);
+    } else if (key == "exits" && number >= 2 && number <= 8) {
+        exitsPerLocation = number;
+    } else if (key == "text" && number >= 1) {
+        textLength = static_cast<size_t>(number);
+    } else if (key == "cjk" && number <= 1) {
+        cjkRatio = number;
+    } else if (key == "requirements" && number <= 1) {
+        requirementDensity = number;
+    } else if (key == "seed") {
+        seed = static_cast<uint32_t>(number);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+GeneratedWorld generateWorld(const WorldGenOptions& options) {
+    GeneratedWorld world;
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    TextSource texts(options, rng);
+    auto gated = [&]() { return unit(rng) < options.requirementDensity; };
+
+    size_t locationCount = std::max<size_t>(1, options.locations);
+    size_t itemCount = options.items > 0 ? options.items : locationCount;
+    size_t dialogueCount = options.dialogues > 0 ? options.dialogues : locationCount;
+    size_t insightCount = std::max<size_t>(1, locationCount / 4);
+
+    // 每个角色约4个对话节点
+    size_t characterCount = std::max<size_t>(1, (dialogueCount + 3) / 4);
+    world.characterCount = characterCount;
+
+    std::vector<std::string> locationIds(locationCount);
+    for (size_t i = 0; i < locationCount; ++i) {
+        locationIds[i] = makeId("loc_", i, locationCount);
+    }
+    std::vector<std::string> itemIds(itemCount);
+    for (size_t i = 0; i < itemCount; ++i) {
+        itemIds[i] = makeId("item_", i, itemCount);
+    }
+    auto insight = [&]() { return makeId("insight_", rng() % insightCount, insightCount); };
+
+    std::vector<std::vector<std::string>> locationItems(locationCount);
+    for (const auto& itemId : itemIds) {
+        locationItems[rng() % locationCount].push_back(itemId);
+    }
+    std::vector<std::vector<std::string>> locationCharacters(locationCount);
+    std::vector<std::string> characterIds(characterCount);
+    for (size_t i = 0; i < characterCount; ++i) {
+        characterIds[i] = makeId("npc_", i, characterCount);
+        locationCharacters[rng() % locationCount].push_back(characterIds[i]);
+    }
+
+    WorldGenOptions graphOptions = options;
+    graphOptions.locations = locationCount;
+    std::vector<std::vector<Exit>> exits = buildExits(graphOptions, rng, world.exitCount);
+
+    // locations.json
+    std::string& locations = world.locationsJson;
+    locations.reserve(locationCount * (options.textLength * 6 + 512));
+    locations += "{\n  \"locations\": {\n";
+    for (size_t i = 0; i < locationCount; ++i) {
+        locations += "    ";
+        appendQuoted(locations, locationIds[i]);
+        locations += ": {\n      \"name\": ";
+        appendQuoted(locations, texts.exact(2 + rng() % 5));
+        locations += ",\n      \"descriptions\": {\"default\": ";
+        appendQuoted(locations, texts.text());
+        if (rng() % 2 == 0) {
+            locations += ", \"evening\": ";
+            appendQuoted(locations, texts.text());
+        }
+        locations += "},\n      \"music\": \"track_" + std::to_string(i % 16) + "\"";
+        std::vector<std::string> ambient;
+        for (size_t k = rng() % 3; k > 0; --k) {
+            ambient.push_back(pickFrom(kAmbient, rng));
+        }
+        locations += ",\n      \"ambient_effects\": ";
+        appendList(locations, ambient);
+
+        locations += ",\n      \"exits\": {";
+        for (size_t k = 0; k < exits[i].size(); ++k) {
+            locations += k > 0 ? ", \"" : "\"";
+            locations += exits[i][k].direction;
+            locations += "\": ";
+            appendQuoted(locations, locationIds[exits[i][k].target]);
+        }
+        locations += "},\n      \"items\": ";
+        appendList(locations, locationItems[i]);
+        locations += ",\n      \"characters\": ";
+        appendList(locations, locationCharacters[i]);
+
+        // 第一个交互没有门槛，保证每个场景都有可检查的东西
+        locations += ",\n      \"interactions\": [";
+        size_t interactionCount = 1 + rng() % 3;
+        for (size_t k = 0; k < interactionCount; ++k) {
+            locations += k > 0 ? ",\n        {" : "\n        {";
+            locations += "\"id\": \"examine_" + std::to_string(k) + "\", \"name\": ";
+            appendQuoted(locations, texts.exact(2 + rng() % 4));
+            locations += ", \"description\": ";
+            appendQuoted(locations, texts.text(0.25));
+            locations += ", \"requirements\": ";
+            appendRequirement(locations, k > 0 && gated(), rng);
+            locations += ", \"results\": {\"text\": ";
+            appendQuoted(locations, texts.text());
+            std::vector<std::string> rewardItems;
+            if (rng() % 5 == 0) {
+                rewardItems.push_back(itemIds[rng() % itemCount]);
+            }
+            std::vector<std::string> rewardInsights;
+            if (rng() % 5 < 2) {
+                rewardInsights.push_back(insight());
+            }
+            locations += ", \"items\": ";
+            appendList(locations, rewardItems);
+            locations += ", \"insights\": ";
+            appendList(locations, rewardInsights);
+            locations += "}}";
+        }
+        locations += "\n      ]\n    }";
+        locations += i + 1 < locationCount ? ",\n" : "\n";
+    }
+    locations += "  }\n}\n";
+
+    // items.json
+    std::string& items = world.itemsJson;
+    items.reserve(itemCount * (options.textLength * 4 + 256));
+    items += "{\n  \"items\": {\n";
+    for (size_t i = 0; i < itemCount; ++i) {
+        items += "    ";
+        appendQuoted(items, itemIds[i]);
+        items += ": {\"name\": ";
+        appendQuoted(items, texts.exact(2 + rng() % 4));
+        items += ", \"type\": \"";
+        items += pickFrom(kItemTypes, rng);
+        items += "\", \"description\": ";
+        appendQuoted(items, texts.text(0.5));
+        bool examinable = rng() % 10 < 7;
+        items += examinable ? ", \"examinable\": true" : ", \"examinable\": false";
+        if (examinable) {
+            items += ", \"examine_results\": {\"text\": ";
+            appendQuoted(items, texts.text());
+            std::vector<std::string> rewardInsights;
+            if (rng() % 2 == 0) {
+                rewardInsights.push_back(insight());
+            }
+            items += ", \"insights\": ";
+            appendList(items, rewardInsights);
+            items += ", \"attributes\": {";
+            if (rng() % 10 < 3) {
+                items += "\"";
+                items += pickFrom(kAttributes, rng);
+                items += "\": 1";
+            }
+            items += "}}";
+        }
+        items += i + 1 < itemCount ? "},\n" : "}\n";
+    }
+    items += "  }\n}\n";
+
+    // dialogues.json：节点按角色平均分配
+    std::string& dialogues = world.dialoguesJson;
+    dialogues.reserve(dialogueCount * (options.textLength * 10 + 512));
+    dialogues += "{\n  \"dialogues\": {\n";
+    size_t written = 0;
+    for (size_t c = 0; c < characterCount; ++c) {
+        size_t nodeCount = dialogueCount / characterCount + (c < dialogueCount % characterCount ? 1 : 0);
+        std::string speaker = texts.exact(2 + rng() % 3);
+        auto nodeId = [&](size_t node) {
+            return characterIds[c] + (node == 0 ? "_first_meeting" : "_node_" + std::to_string(node));
+        };
+        for (size_t node = 0; node < nodeCount; ++node) {
+            dialogues += "    ";
+            appendQuoted(dialogues, nodeId(node));
+            dialogues += ": {\n      \"speaker\": ";
+            appendQuoted(dialogues, speaker);
+            dialogues += ",\n      \"text\": ";
+            appendQuoted(dialogues, texts.text());
+            dialogues += ",\n      \"options\": [";
+
+            // 第一个选项没有门槛，指向下一个节点，保证对话总能走完
+            size_t optionCount = 2 + rng() % 2;
+            for (size_t k = 0; k < optionCount; ++k) {
+                dialogues += k > 0 ? ",\n        {" : "\n        {";
+                dialogues += "\"id\": \"opt" + std::to_string(k + 1) + "\", \"text\": ";
+                appendQuoted(dialogues, texts.text(0.5));
+                dialogues += ", \"requirements\": ";
+                appendRequirement(dialogues, k > 0 && gated(), rng);
+                size_t next = k == 0 ? node + 1 : node + 1 + rng() % nodeCount;
+                dialogues += ", \"results\": {";
+                if (next < nodeCount) {
+                    dialogues += "\"dialogue\": ";
+                    appendQuoted(dialogues, nodeId(next));
+                } else {
+                    dialogues += "\"end_dialogue\": true";
+                }
+                if (rng() % 3 == 0) {
+                    dialogues += ", \"attributes\": {\"";
+                    dialogues += pickFrom(kAttributes, rng);
+                    dialogues += "\": 1}";
+                }
+                if (rng() % 4 == 0) {
+                    dialogues += ", \"insights\": ";
+                    appendList(dialogues, {insight()});
+                }
+                dialogues += "}}";
+            }
+            dialogues += "\n      ]\n    }";
+            dialogues += ++written < dialogueCount ? ",\n" : "\n";
+        }
+    }
+    dialogues += "  }\n}\n";
+
+    return world;
+}
+
+bool writeGeneratedWorld(const WorldGenOptions& options, const std::string& directory, GeneratedWorld* summary) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "[WorldGenerator] 无法创建目录: " << directory << " (" << ec.message() << ")" << std::endl;
+        return false;
+    }
+
+    GeneratedWorld world = generateWorld(options);
+    const std::pair<const char*, const std::string*> files[] = {
+        {"locations.json", &world.locationsJson},
+        {"items.json", &world.itemsJson},
+        {"dialogues.json", &world.dialoguesJson}
+    };
+    for (const auto& file : files) {
+        std::ofstream out((fs::path(directory) / file.first).string(), std::ios::binary | std::ios::trunc);
+        out.write(file.second->data(), static_cast<std::streamsize>(file.second->size()));
+        if (!out) {
+            std::cerr << "[WorldGenerator] 写入失败: " << file.first << std::endl;
+            return false;
+        }
+    }
+
+    if (summary) {
+        *summary = std::move(world);
+    }
+    return true;
+}
+
+int runWorldGenerator(const std::string& directory, const std::vector<std::string>& arguments) {
+    if (directory.empty()) {
+        std::cerr << "[WorldGenerator] 用法: --generate-world <目录> [locations=N items=N dialogues=N "
+                  << "exits=X text=N cjk=X requirements=X seed=N]" << std::endl;
+        return -1;
+    }
+    WorldGenOptions options;
+    for (const auto& argument : arguments) {
+        if (!options.parse(argument)) {
+            std::cerr << "[WorldGenerator] 错误: 无效的选项 " << argument << std::endl;
+            return -1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    GeneratedWorld world;
+    if (!writeGeneratedWorld(options, directory, &world)) {
+        return -1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t bytes = world.locationsJson.size() + world.itemsJson.size() + world.dialoguesJson.size();
+    std::cout << "[WorldGenerator] 已生成 " << options.locations << " 个场景（" << world.exitCount << " 条双向出口）、"
+              << (options.items > 0 ? options.items : options.locations) << " 个物品、"
+              << (options.dialogues > 0 ? options.dialogues : options.locations) << " 个对话节点（"
+              << world.characterCount << " 个角色），共 " << bytes / 1024 << " KB，耗时 "
+              << std::fixed << std::setprecision(2) << seconds << " 秒" << std::endl;
+    std::cout << "[WorldGenerator] 目录: " << directory << "（用 TIME_ARTIFACTS_DATA_DIR 指向它即可加载）" << std::endl;
+    return 0;
+}
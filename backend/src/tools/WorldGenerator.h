@@ -0,0 +1,75 @@
+/**
+ * WorldGenerator.h
+ *
+ * 合成世界生成器 - 按配置的规模生成合法的 locations.json、items.json、dialogues.json
+ *
+ * 【用法】：TimeArtifacts --generate-world <目录> [key=value ...]
+ *   例：--generate-world /tmp/world locations=100000 exits=3.5 text=200 cjk=0.7 requirements=0.3
+ *
+ * 【生成规则】：
+ * 1. 场景排成网格，先用蛇形路径连通所有场景，再按平均出口数补充网格边和对角边，
+ *    出口都是双向的（north/south、east/west、northeast/southwest ...）
+ * 2. 物品随机放入场景；每个场景有1~3个交互，部分交互会给出物品和洞察
+ * 3. 角色随机放入场景，每个角色有一组对话："<角色>_first_meeting" 起始，
+ *    选项指向同一角色的下一个节点或结束对话
+ * 4. 文本长度按字符计，在 [text/2, text*3/2] 之间均匀分布；cjk 是中文字符所占比例
+ * 5. requirements 是带属性门槛的交互和对话选项所占比例
+ *
+ * 相同的选项和种子总是生成相同的世界
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 生成选项
+ */
+struct WorldGenOptions {
+    size_t locations = 1000;
+    size_t items = 0;                   // 0表示与场景数相同
+    size_t dialogues = 0;               // 对话节点数，0表示与场景数相同
+    double exitsPerLocation = 3.0;      // 平均出口数（2~8）
+    size_t textLength = 120;            // 平均文本长度（字符）
+    double cjkRatio = 0.6;              // 中文字符比例（0~1）
+    double requirementDensity = 0.3;    // 带门槛的交互/选项比例（0~1）
+    uint32_t seed = 20240101;
+
+    /**
+     * 解析一个 key=value 选项（locations、items、dialogues、exits、text、cjk、requirements、seed）
+     * 【返回】：未知的key或无效的值返回false
+     */
+    bool parse(const std::string& argument);
+};
+
+/**
+ * 生成结果（三个数据文件的JSON文本）
+ */
+struct GeneratedWorld {
+    std::string locationsJson;
+    std::string itemsJson;
+    std::string dialoguesJson;
+    size_t exitCount = 0;
+    size_t characterCount = 0;
+};
+
+/**
+ * 生成世界
+ */
+GeneratedWorld generateWorld(const WorldGenOptions& options);
+
+/**
+ * 生成世界并写入目录（目录不存在时创建）
+ * 【返回】：写入失败时返回false
+ */
+bool writeGeneratedWorld(const WorldGenOptions& options, const std::string& directory,
+                         GeneratedWorld* summary = nullptr);
+
+/**
+ * 命令行入口
+ * 【返回】：进程退出码
+ */
+int runWorldGenerator(const std::string& directory, const std::vector<std::string>& arguments);
@@ -0,0 +1,254 @@
+/**
+ * WorldScaleBenchmark.cpp
+ *
+ * 世界规模基准实现
+ */
+
+#include "tools/WorldScaleBenchmark.h"
+#include "tools/WorldGenerator.h"
+#include "core/ChoiceStatistics.h"
+#include "core/ContentStore.h"
+#include "core/PrefetchPlanner.h"
+#include "core/SessionManager.h"
+#include "core/WorldData.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    /**
+     * 丢弃所有输出的流缓冲（会话和加载过程的日志）
+     */
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    const size_t kSessions = 64;
+    const size_t kRoundsPerSession = 40;
+
+    enum CommandKind { Move, Examine, Talk, Choose, CommandKindCount };
+    const char* const kCommandNames[] = {"move", "examine", "talk", "optionId"};
+
+    /**
+     * 进程常驻内存（字节，非Linux返回0）
+     */
+    size_t residentBytes() {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        size_t total = 0, resident = 0;
+        statm >> total >> resident;
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * 把已释放的内存还给系统，使前后两次RSS可比
+     */
+    void trimHeap() {
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+    }
+
+    double percentile(std::vector<double>& values, double fraction) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    struct ScaleResult {
+        size_t locations = 0;
+        size_t jsonBytes = 0;
+        double generateSeconds = 0;
+        double loadMillis = 0;
+        double indexMillis = 0;
+        size_t rssBefore = 0;
+        size_t rssAfter = 0;
+        uint32_t regions = 0;
+        std::vector<double> latency[CommandKindCount];   // 微秒
+        size_t errors = 0;
+    };
+
+    /**
+     * 合成会话随机游走：每轮 移动 → 检查第一个交互 → 有角色时对话并选第一个选项
+     */
+    void walkSessions(const WorldData& world, ScaleResult& result) {
+        SessionManager sessions;
+        std::mt19937 rng(7);
+
+        auto timed = [&](CommandKind kind, const std::string& sessionId, const std::string& message) {
+            auto start = std::chrono::steady_clock::now();
+            std::string response = sessions.handleMessage(sessionId, message);
+            result.latency[kind].push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            if (response.find("\"error\"") != std::string::npos) {
+                result.errors++;
+            }
+        };
+
+        for (size_t s = 0; s < kSessions; ++s) {
+            std::string sessionId = sessions.createSession();
+            const Location* here = world.findLocation(world.getStartLocation());
+            for (size_t round = 0; round < kRoundsPerSession && here; ++round) {
+                if (!here->exits.empty()) {
+                    auto exit = here->exits.begin();
+                    std::advance(exit, rng() % here->exits.size());
+                    timed(Move, sessionId, R"({"action": "move", "data": {"direction": ")" + exit->first + "\"}}");
+                    here = world.findLocation(exit->second);
+                }
+                timed(Examine, sessionId, R"({"action": "examine", "data": {"target": "examine_0"}})");
+                if (!here->characters.empty()) {
+                    timed(Talk, sessionId, R"({"action": "talk", "data": {"target": ")" + here->characters.front() + "\"}}");
+                    timed(Choose, sessionId, R"({"optionId": "opt1"})");
+                }
+            }
+            sessions.removeSession(sessionId);
+        }
+    }
+
+    bool runScale(size_t locations, const WorldGenOptions& baseOptions, ScaleResult& result) {
+        WorldGenOptions options = baseOptions;
+        options.locations = locations;
+        result.locations = locations;
+
+        fs::path directory = fs::temp_directory_path() / ("time_artifacts_world_" + std::to_string(locations));
+        auto generateStart = std::chrono::steady_clock::now();
+        GeneratedWorld generated;
+        if (!writeGeneratedWorld(options, directory.string(), &generated)) {
+            return false;
+        }
+        result.generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generateStart).count();
+        result.jsonBytes = generated.locationsJson.size() + generated.itemsJson.size() + generated.dialoguesJson.size();
+        generated = GeneratedWorld();
+
+        trimHeap();
+        result.rssBefore = residentBytes();
+
+        auto world = std::make_unique<WorldData>();
+        auto loadStart = std::chrono::steady_clock::now();
+        bool loaded = world->loadFromDirectory(directory.string());
+        auto loadEnd = std::chrono::steady_clock::now();
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+        if (!loaded) {
+            std::cerr << "[WorldScaleBenchmark] 错误: 生成的世界无法加载（" << locations << " 个场景）" << std::endl;
+            return false;
+        }
+        ContentStore::instance().initialize(*world);
+        ChoiceStatistics::instance().initialize(*world);
+        PrefetchPlanner::instance().initialize(*world);
+        auto indexEnd = std::chrono::steady_clock::now();
+
+        result.loadMillis = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+        result.indexMillis = std::chrono::duration<double, std::milli>(indexEnd - loadEnd).count();
+        trimHeap();
+        result.rssAfter = residentBytes();
+        result.regions = world->getRegionCount();
+
+        const WorldData& installed = *world;
+        WorldData::installGlobal(std::move(world));
+        walkSessions(installed, result);
+        WorldData::installGlobal(nullptr);
+        return true;
+    }
+
+} // namespace
+
+int runWorldScaleBenchmark(size_t maxLocations, const std::vector<std::string>& arguments) {
+    if (maxLocations < 1000) {
+        std::cerr << "[WorldScaleBenchmark] 错误: 最大场景数不能小于1000" << std::endl;
+        return -1;
+    }
+    WorldGenOptions options;
+    for (const auto& argument : arguments) {
+        if (argument.compare(0, 10, "locations=") == 0 || !options.parse(argument)) {
+            std::cerr << "[WorldScaleBenchmark] 错误: 无效的选项 " << argument << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<size_t> scales;
+    for (size_t scale = 1000; scale < maxLocations; scale *= 10) {
+        scales.push_back(scale);
+    }
+    scales.push_back(maxLocations);
+
+    std::cout << "=== 世界规模基准 ===" << std::endl;
+    std::cout << "平均出口 " << options.exitsPerLocation << "，文本 " << options.textLength << " 字符，中文 "
+              << options.cjkRatio * 100 << "%，门槛 " << options.requirementDensity * 100 << "%；每个规模 "
+              << kSessions << " 个会话 x " << kRoundsPerSession << " 轮" << std::endl;
+
+    std::vector<ScaleResult> results;
+    for (size_t scale : scales) {
+        std::cout << "[WorldScaleBenchmark] " << scale << " 个场景..." << std::endl;
+        NullBuffer nullBuffer;
+        std::streambuf* originalBuffer = std::cout.rdbuf(&nullBuffer);
+        ScaleResult result;
+        bool ok = runScale(scale, options, result);
+        std::cout.rdbuf(originalBuffer);
+        if (!ok) {
+            return -1;
+        }
+        results.push_back(std::move(result));
+    }
+
+    std::cout << std::endl;
+    std::cout << std::right << std::setw(10) << "locations" << std::setw(10) << "JSON MB" << std::setw(10) << "gen s"
+              << std::setw(11) << "load ms" << std::setw(11) << "index ms" << std::setw(10) << "regions"
+              << std::setw(11) << "RSS MB" << std::setw(12) << "+RSS MB" << std::setw(12) << "B/location" << std::endl;
+    for (const auto& result : results) {
+        double delta = static_cast<double>(result.rssAfter) - static_cast<double>(result.rssBefore);
+        std::cout << std::setw(10) << result.locations << std::fixed << std::setprecision(1)
+                  << std::setw(10) << result.jsonBytes / 1048576.0
+                  << std::setw(10) << std::setprecision(2) << result.generateSeconds
+                  << std::setw(11) << std::setprecision(1) << result.loadMillis
+                  << std::setw(11) << result.indexMillis
+                  << std::setw(10) << result.regions
+                  << std::setw(11) << result.rssAfter / 1048576.0
+                  << std::setw(12) << delta / 1048576.0
+                  << std::setw(12) << std::setprecision(0) << delta / result.locations << std::endl;
+    }
+
+    std::cout << std::endl;
+    std::cout << std::setw(10) << "locations" << std::setw(10) << "command" << std::setw(10) << "count"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us" << std::endl;
+    for (auto& result : results) {
+        for (int kind = 0; kind < CommandKindCount; ++kind) {
+            std::vector<double>& samples = result.latency[kind];
+            double maximum = samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+            std::cout << std::setw(10) << result.locations << std::setw(10) << kCommandNames[kind]
+                      << std::setw(10) << samples.size() << std::fixed << std::setprecision(1)
+                      << std::setw(10) << percentile(samples, 0.50)
+                      << std::setw(10) << percentile(samples, 0.99)
+                      << std::setw(10) << maximum << std::endl;
+        }
+        if (result.errors > 0) {
+            std::cout << std::setw(10) << result.locations << "  错误响应: " << result.errors << std::endl;
+        }
+    }
+    return 0;
+}
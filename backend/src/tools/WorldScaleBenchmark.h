@@ -0,0 +1,32 @@
+/**
+ * WorldScaleBenchmark.h
+ *
+ * 世界规模基准 - 世界从一千增长到十万以上场景时的加载时间、常驻内存和命令延迟
+ *
+ * 【用法】：TimeArtifacts --bench-world-scale [最大场景数] [key=value ...]
+ *   key=value 为生成选项（见WorldGenerator.h），locations除外
+ *
+ * 【内容】：规模从1000开始每次乘10，直到最大场景数（默认100000）。每个规模：
+ * 1. 用WorldGenerator生成世界写入临时目录（场景、物品、对话节点数相同）
+ * 2. 加载：loadFromDirectory耗时（解析+文本压缩+区域划分），
+ *    以及内容哈希、选择统计、预取计划的索引建立耗时；加载前后的进程常驻内存（RSS）
+ * 3. 命令延迟：安装为全局世界后，合成会话在世界里随机游走，
+ *    依次执行 move / examine / talk / optionId，分别统计 p50 / p99 / 最大值
+ *
+ * 【说明】：不初始化RegionPager（它持有全局世界的文本存储，不能随规模替换），
+ *   世界文本全部留在内存中
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * 运行世界规模基准
+ * 【参数】：maxLocations - 最大规模（场景数）
+ *          arguments - 生成选项
+ * 【返回】：进程退出码
+ */
+int runWorldScaleBenchmark(size_t maxLocations, const std::vector<std::string>& arguments);
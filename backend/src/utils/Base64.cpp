@@ -0,0 +1,137 @@
+/**
+ * Base64.cpp
+ *
+ * Base64编码实现
+ */
+
+#include "utils/Base64.h"
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#if !defined(_MSC_VER) || defined(__clang__)
+#define TA_BASE64_SSSE3 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace {
+
+    const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t encodeScalar(const uint8_t* data, size_t length, char* out) {
+        char* start = out;
+        size_t i = 0;
+        for (; i + 3 <= length; i += 3) {
+            uint32_t triple = (static_cast<uint32_t>(data[i]) << 16) |
+                              (static_cast<uint32_t>(data[i + 1]) << 8) |
+                              static_cast<uint32_t>(data[i + 2]);
+            *out++ = kAlphabet[(triple >> 18) & 0x3F];
+            *out++ = kAlphabet[(triple >> 12) & 0x3F];
+            *out++ = kAlphabet[(triple >> 6) & 0x3F];
+            *out++ = kAlphabet[triple & 0x3F];
+        }
+
+        size_t rest = length - i;
+        if (rest == 1) {
+            uint32_t triple = static_cast<uint32_t>(data[i]) << 16;
+            *out++ = kAlphabet[(triple >> 18) & 0x3F];
+            *out++ = kAlphabet[(triple >> 12) & 0x3F];
+            *out++ = '=';
+            *out++ = '=';
+        } else if (rest == 2) {
+            uint32_t triple = (static_cast<uint32_t>(data[i]) << 16) | (static_cast<uint32_t>(data[i + 1]) << 8);
+            *out++ = kAlphabet[(triple >> 18) & 0x3F];
+            *out++ = kAlphabet[(triple >> 12) & 0x3F];
+            *out++ = kAlphabet[(triple >> 6) & 0x3F];
+            *out++ = '=';
+        }
+        return static_cast<size_t>(out - start);
+    }
+
+#ifdef TA_BASE64_SSSE3
+
+    /**
+     * 12字节 -> 16个6位索引 -> 16个字符
+     * 【步骤】：
+     * 1. pshufb把每3个字节复制成一个32位字 [b1 b0 b2 b1]
+     * 2. 两次16位乘法把4个6位字段移到各自字节的低位
+     * 3. 索引按范围（A-Z、a-z、0-9、+、/）查pshufb偏移表，加上偏移得到字符
+     */
+    __attribute__((target("ssse3")))
+    size_t encodeSsse3(const uint8_t* data, size_t length, char* out) {
+        const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+        const __m128i shiftTable = _mm_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+        char* start = out;
+        size_t i = 0;
+        // 每次读16字节、用12字节，保证不越界读
+        for (; i + 16 <= length; i += 12) {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            input = _mm_shuffle_epi8(input, shuffle);
+
+            __m128i high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)),
+                                           _mm_set1_epi32(0x04000040));
+            __m128i low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)),
+                                          _mm_set1_epi32(0x01000010));
+            __m128i indices = _mm_or_si128(high, low);
+
+            // 0..51 -> 0（大小写字母，再按是否<26区分），52..61 -> 1..10，62 -> 11，63 -> 12
+            __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+            __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(shiftTable, range), indices);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+            out += 16;
+        }
+        out += encodeScalar(data + i, length - i, out);
+        return static_cast<size_t>(out - start);
+    }
+
+    bool cpuSupportsSsse3() {
+        return __builtin_cpu_supports("ssse3");
+    }
+
+#else
+
+    bool cpuSupportsSsse3() {
+        return false;
+    }
+
+#endif // TA_BASE64_SSSE3
+
+    std::atomic<bool>& useSimd() {
+        static std::atomic<bool> enabled{cpuSupportsSsse3()};
+        return enabled;
+    }
+
+} // namespace
+
+size_t Base64::encodeTo(const uint8_t* data, size_t length, char* out) {
+#ifdef TA_BASE64_SSSE3
+    if (useSimd().load(std::memory_order_relaxed)) {
+        return encodeSsse3(data, length, out);
+    }
+#endif
+    return encodeScalar(data, length, out);
+}
+
+std::string Base64::encode(const uint8_t* data, size_t length) {
+    std::string out(encodedLength(length), '\0');
+    out.resize(encodeTo(data, length, &out[0]));
+    return out;
+}
+
+bool Base64::setSimdEnabled(bool enabled) {
+    if (enabled && !cpuSupportsSsse3()) {
+        return false;
+    }
+    useSimd().store(enabled, std::memory_order_relaxed);
+    return true;
+}
+
+bool Base64::simdEnabled() {
+    return useSimd().load(std::memory_order_relaxed);
+}
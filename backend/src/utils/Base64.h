@@ -0,0 +1,55 @@
+/**
+ * Base64.h
+ *
+ * Base64编码（RFC 4648，标准字母表，带填充）
+ *
+ * 【实现】：CPU支持SSSE3时每次把12字节编码为16个字符（Muła的pshufb方法），
+ *   其余部分和不支持的CPU走标量实现；运行时分派
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Base64 {
+
+    /**
+     * 编码后的长度
+     */
+    constexpr size_t encodedLength(size_t length) {
+        return (length + 2) / 3 * 4;
+    }
+
+    /**
+     * 编码到调用方提供的缓冲（不分配内存）
+     * 【参数】：out - 至少 encodedLength(length) 字节
+     * 【返回】：写入的字符数
+     */
+    size_t encodeTo(const uint8_t* data, size_t length, char* out);
+
+    /**
+     * 编码任意字节
+     */
+    std::string encode(const uint8_t* data, size_t length);
+
+    /**
+     * 编码字符串
+     */
+    inline std::string encode(const std::string& data) {
+        return encode(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    /**
+     * 启用/禁用SIMD实现（用于基准测试和对比验证）
+     * 【返回】：要求启用但CPU不支持时返回false
+     */
+    bool setSimdEnabled(bool enabled);
+
+    /**
+     * 当前是否使用SIMD实现
+     */
+    bool simdEnabled();
+
+} // namespace Base64
@@ -0,0 +1,78 @@
+/**
+ * HyperLogLog.cpp
+ *
+ * HyperLogLog基数估计实现
+ */
+
+#include "HyperLogLog.h"
+#include <cmath>
+
+HyperLogLog::HyperLogLog() {
+    clear();
+}
+
+void HyperLogLog::add(uint64_t hashValue) {
+    size_t index = static_cast<size_t>(hashValue >> (64 - kPrecision));
+    uint64_t rest = (hashValue << kPrecision) | (uint64_t(1) << (kPrecision - 1));  // 保证非零
+
+    uint8_t rank = 1;
+    while ((rest & (uint64_t(1) << 63)) == 0) {
+        ++rank;
+        rest <<= 1;
+    }
+
+    std::atomic<uint8_t>& slot = registers[index];
+    uint8_t current = slot.load(std::memory_order_relaxed);
+    while (rank > current && !slot.compare_exchange_weak(current, rank, std::memory_order_relaxed)) {
+    }
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < kRegisterCount; ++i) {
+        uint8_t rank = other.registers[i].load(std::memory_order_relaxed);
+        uint8_t current = registers[i].load(std::memory_order_relaxed);
+        while (rank > current && !registers[i].compare_exchange_weak(current, rank, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(kRegisterCount);
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (const auto& slot : registers) {
+        uint8_t rank = slot.load(std::memory_order_relaxed);
+        sum += std::ldexp(1.0, -rank);
+        zeros += rank == 0 ? 1 : 0;
+    }
+
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        // 小基数时使用线性计数
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return estimate;
+}
+
+void HyperLogLog::clear() {
+    for (auto& slot : registers) {
+        slot.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t HyperLogLog::hash(const std::string& value) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : value) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    // splitmix64 终结混合
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
@@ -0,0 +1,63 @@
+/**
+ * HyperLogLog.h
+ *
+ * HyperLogLog基数估计 - 用固定的1KB内存估计"有多少个不同的玩家"
+ *
+ * 【原理】：
+ * - 对玩家ID取64位哈希，高10位选寄存器，剩余位中前导零的个数+1作为秩
+ * - 每个寄存器只保留见过的最大秩，调和平均后估计基数（标准误差约3.2%）
+ *
+ * 【线程安全】：add() 可以从任意线程并发调用（寄存器用原子"取最大值"更新）。
+ *   大多数add不会提高寄存器的值，只需一次读取，所以多线程共享一个草图几乎没有争用。
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class HyperLogLog {
+public:
+    static constexpr int kPrecision = 10;
+    static constexpr size_t kRegisterCount = size_t(1) << kPrecision;
+
+    HyperLogLog();
+
+    HyperLogLog(const HyperLogLog&) = delete;
+    HyperLogLog& operator=(const HyperLogLog&) = delete;
+
+    /**
+     * 加入一个元素（参数为元素的64位哈希）
+     */
+    void add(uint64_t hash);
+
+    /**
+     * 加入一个字符串元素
+     */
+    void add(const std::string& value) { add(hash(value)); }
+
+    /**
+     * 合并另一个草图（取各寄存器的最大值）
+     */
+    void merge(const HyperLogLog& other);
+
+    /**
+     * 估计不同元素的个数
+     */
+    double estimate() const;
+
+    /**
+     * 清空
+     */
+    void clear();
+
+    /**
+     * 64位字符串哈希（FNV-1a + 混合，保证高位分布均匀）
+     */
+    static uint64_t hash(const std::string& value);
+
+private:
+    std::array<std::atomic<uint8_t>, kRegisterCount> registers;
+};
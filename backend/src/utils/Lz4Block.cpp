@@ -0,0 +1,194 @@
+/**
+ * Lz4Block.cpp
+ *
+ * LZ4块格式压缩/解压实现
+ */
+
+#include "Lz4Block.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    constexpr size_t kMinMatch = 4;
+    constexpr size_t kLastLiterals = 5;     // 结尾至少5个字节是字面量
+    constexpr size_t kMatchFindLimit = 12;  // 最后一次匹配至少在结尾前12字节开始
+    constexpr int kHashLog = 12;
+    constexpr size_t kMaxOffset = 65535;
+
+    inline uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t hashSequence(uint32_t sequence) {
+        return (sequence * 2654435761U) >> (32 - kHashLog);
+    }
+
+    void writeLength(std::string& out, size_t length) {
+        while (length >= 255) {
+            out.push_back(static_cast<char>(255));
+            length -= 255;
+        }
+        out.push_back(static_cast<char>(length));
+    }
+
+    /**
+     * 输出一个序列（matchLength为0表示只有字面量的最后一个序列）
+     */
+    void writeSequence(std::string& out, const uint8_t* literals, size_t literalLength,
+                       size_t offset, size_t matchLength) {
+        size_t tokenPos = out.size();
+        out.push_back(0);
+        uint8_t token = 0;
+
+        if (literalLength >= 15) {
+            token = 15 << 4;
+            writeLength(out, literalLength - 15);
+        } else {
+            token = static_cast<uint8_t>(literalLength << 4);
+        }
+        out.append(reinterpret_cast<const char*>(literals), literalLength);
+
+        if (matchLength > 0) {
+            out.push_back(static_cast<char>(offset & 0xFF));
+            out.push_back(static_cast<char>(offset >> 8));
+            size_t code = matchLength - kMinMatch;
+            if (code >= 15) {
+                token |= 15;
+                writeLength(out, code - 15);
+            } else {
+                token |= static_cast<uint8_t>(code);
+            }
+        }
+        out[tokenPos] = static_cast<char>(token);
+    }
+
+    /**
+     * 读取扩展长度
+     */
+    bool readLength(const uint8_t* in, size_t length, size_t& pos, size_t& value) {
+        uint8_t byte;
+        do {
+            if (pos >= length) {
+                return false;
+            }
+            byte = in[pos++];
+            value += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+} // namespace
+
+namespace Lz4Block {
+
+    std::string compress(const char* data, size_t length) {
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+        std::string out;
+        out.reserve(length + length / 255 + 16);
+
+        size_t anchor = 0;
+        if (length > kMatchFindLimit) {
+            std::vector<int32_t> table(size_t(1) << kHashLog, -1);
+            const size_t searchEnd = length - kMatchFindLimit;
+            const size_t matchEnd = length - kLastLiterals;
+
+            size_t pos = 0;
+            while (pos < searchEnd) {
+                uint32_t sequence = read32(in + pos);
+                uint32_t slot = hashSequence(sequence);
+                int32_t candidate = table[slot];
+                table[slot] = static_cast<int32_t>(pos);
+
+                if (candidate < 0 || pos - candidate > kMaxOffset || read32(in + candidate) != sequence) {
+                    ++pos;
+                    continue;
+                }
+
+                // 向前扩展（字面量区内相同的字节并入匹配）
+                size_t matchStart = pos;
+                size_t reference = static_cast<size_t>(candidate);
+                while (matchStart > anchor && reference > 0 && in[matchStart - 1] == in[reference - 1]) {
+                    --matchStart;
+                    --reference;
+                }
+
+                size_t matchLength = pos - matchStart + kMinMatch;
+                while (matchStart + matchLength < matchEnd &&
+                       in[matchStart + matchLength] == in[reference + matchLength]) {
+                    ++matchLength;
+                }
+
+                writeSequence(out, in + anchor, matchStart - anchor, matchStart - reference, matchLength);
+                pos = matchStart + matchLength;
+                anchor = pos;
+                if (pos >= 2 && pos - 2 < searchEnd) {
+                    table[hashSequence(read32(in + pos - 2))] = static_cast<int32_t>(pos - 2);
+                }
+            }
+        }
+
+        writeSequence(out, in + anchor, length - anchor, 0, 0);
+        return out;
+    }
+
+    bool decompress(const char* data, size_t length, size_t originalLength, std::string& out) {
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+        out.resize(originalLength);
+        char* dest = &out[0];
+        size_t written = 0;
+        size_t pos = 0;
+
+        while (pos < length) {
+            uint8_t token = in[pos++];
+
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !readLength(in, length, pos, literalLength)) {
+                return false;
+            }
+            if (literalLength > length - pos || literalLength > originalLength - written) {
+                return false;
+            }
+            std::memcpy(dest + written, in + pos, literalLength);
+            written += literalLength;
+            pos += literalLength;
+
+            if (pos == length) {
+                break;  // 最后一个序列只有字面量
+            }
+
+            if (length - pos < 2) {
+                return false;
+            }
+            size_t offset = in[pos] | (static_cast<size_t>(in[pos + 1]) << 8);
+            pos += 2;
+            if (offset == 0 || offset > written) {
+                return false;
+            }
+
+            size_t matchLength = token & 15;
+            if (matchLength == 15 && !readLength(in, length, pos, matchLength)) {
+                return false;
+            }
+            matchLength += kMinMatch;
+            if (matchLength > originalLength - written) {
+                return false;
+            }
+
+            // 引用可能与输出重叠（offset < matchLength），逐字节复制
+            const char* source = dest + written - offset;
+            if (offset >= matchLength) {
+                std::memcpy(dest + written, source, matchLength);
+            } else {
+                for (size_t i = 0; i < matchLength; ++i) {
+                    dest[written + i] = source[i];
+                }
+            }
+            written += matchLength;
+        }
+        return written == originalLength;
+    }
+
+} // namespace Lz4Block
@@ -0,0 +1,39 @@
+/**
+ * Lz4Block.h
+ *
+ * LZ4块格式压缩/解压（与liblz4的LZ4_compress_default / LZ4_decompress_safe块格式兼容）
+ *
+ * 【格式】：一串序列，每个序列为
+ *   token(高4位字面量长度，低4位匹配长度-4) [扩展长度] 字面量 偏移(2字节小端) [扩展长度]
+ *   最后一个序列只有字面量；最后5个字节总是字面量，最后一次匹配至少在结尾前12字节开始
+ *
+ * 【说明】：只实现单遍贪心哈希匹配，压缩率略低于liblz4，解压速度相同量级；
+ *   不依赖外部库，构建环境没有liblz4/zstd时也能使用
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Lz4Block {
+
+    /**
+     * 压缩
+     * 【返回】：压缩后的字节（不含原始长度，调用方需要自己记录）
+     */
+    std::string compress(const char* data, size_t length);
+
+    inline std::string compress(const std::string& data) {
+        return compress(data.data(), data.size());
+    }
+
+    /**
+     * 解压
+     * 【参数】：originalLength - 压缩前的长度
+     * 【返回】：数据损坏（越界引用、长度不符）时返回false
+     */
+    bool decompress(const char* data, size_t length, size_t originalLength, std::string& out);
+
+} // namespace Lz4Block
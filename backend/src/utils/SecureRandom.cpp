@@ -0,0 +1,86 @@
+/**
+ * SecureRandom.cpp
+ *
+ * 密码学安全随机数实现
+ */
+
+#include "SecureRandom.h"
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+
+#if defined(TIME_ARTIFACTS_HAS_OPENSSL)
+#include <openssl/rand.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <bcrypt.h>
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+#endif
+
+namespace SecureRandom {
+
+    bool fill(void* out, size_t length) {
+#if defined(TIME_ARTIFACTS_HAS_OPENSSL)
+        return RAND_bytes(static_cast<unsigned char*>(out), static_cast<int>(length)) == 1;
+#elif defined(_WIN32)
+        return BCryptGenRandom(nullptr, static_cast<PUCHAR>(out), static_cast<ULONG>(length),
+                               BCRYPT_USE_SYSTEM_PREFERRED_RNG) == 0;
+#else
+        auto* bytes = static_cast<uint8_t*>(out);
+        size_t filled = 0;
+#if defined(__linux__)
+        while (filled < length) {
+            ssize_t got = getrandom(bytes + filled, length - filled, 0);
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;      // 内核太旧（ENOSYS）等：改读/dev/urandom
+            }
+            filled += static_cast<size_t>(got);
+        }
+        if (filled == length) {
+            return true;
+        }
+#endif
+        int fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        while (filled < length) {
+            ssize_t got = ::read(fd, bytes + filled, length - filled);
+            if (got <= 0) {
+                if (got < 0 && errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            filled += static_cast<size_t>(got);
+        }
+        ::close(fd);
+        return filled == length;
+#endif
+    }
+
+    std::string hex(size_t bytes) {
+        static const char kDigits[] = "0123456789abcdef";
+        std::vector<uint8_t> random(bytes);
+        if (!fill(random.data(), random.size())) {
+            return std::string();
+        }
+        std::string result;
+        result.reserve(bytes * 2);
+        for (uint8_t byte : random) {
+            result.push_back(kDigits[byte >> 4]);
+            result.push_back(kDigits[byte & 0x0F]);
+        }
+        return result;
+    }
+
+} // namespace SecureRandom
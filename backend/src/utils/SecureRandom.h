@@ -0,0 +1,31 @@
+/**
+ * SecureRandom.h
+ *
+ * 操作系统提供的密码学安全随机数
+ *
+ * 【用途】：会话恢复令牌等必须不可猜测的值。std::mt19937_64之类的伪随机数生成器
+ *   从少量输出就能还原内部状态，种子也只有32位，不能用于这类场景
+ * 【来源】：有OpenSSL时用RAND_bytes；否则Linux用getrandom(2)，其他POSIX系统读/dev/urandom，
+ *   Windows用BCryptGenRandom
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace SecureRandom {
+
+    /**
+     * 填充随机字节
+     * 【返回】：随机源不可用时返回false（out的内容不可使用）
+     */
+    bool fill(void* out, size_t length);
+
+    /**
+     * 生成 bytes 个随机字节的十六进制表示
+     * 【返回】：随机源不可用时返回空字符串
+     */
+    std::string hex(size_t bytes);
+
+} // namespace SecureRandom
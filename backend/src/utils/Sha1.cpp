@@ -0,0 +1,278 @@
+/**
+ * Sha1.cpp
+ *
+ * SHA-1摘要实现
+ */
+
+#include "utils/Sha1.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#if !defined(_MSC_VER) || defined(__clang__)
+#define TA_SHA1_SHANI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace {
+
+    const uint32_t kInitialState[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    inline uint32_t rotl(uint32_t value, int bits) {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    inline uint32_t loadBigEndian32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    }
+
+    void processBlocksScalar(uint32_t* state, const uint8_t* block, size_t count) {
+        for (; count > 0; --count, block += 64) {
+            uint32_t w[80];
+            for (int i = 0; i < 16; ++i) {
+                w[i] = loadBigEndian32(block + i * 4);
+            }
+            for (int i = 16; i < 80; ++i) {
+                w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+            for (int i = 0; i < 80; ++i) {
+                uint32_t f, k;
+                if (i < 20) {
+                    f = (b & c) | (~b & d);
+                    k = 0x5A827999;
+                } else if (i < 40) {
+                    f = b ^ c ^ d;
+                    k = 0x6ED9EBA1;
+                } else if (i < 60) {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8F1BBCDC;
+                } else {
+                    f = b ^ c ^ d;
+                    k = 0xCA62C1D6;
+                }
+                uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+                e = d;
+                d = c;
+                c = rotl(b, 30);
+                b = a;
+                a = temp;
+            }
+
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+        }
+    }
+
+#ifdef TA_SHA1_SHANI
+
+#define TA_TARGET_SHA __attribute__((target("sha,ssse3,sse4.1")))
+
+    /**
+     * 一组4轮（第4G..4G+3轮）
+     * 【说明】：sha1rnds4一次完成4轮；消息扩展（msg1/xor/msg2）与轮计算交错，
+     *   m[]以4个寄存器轮换保存最近16个消息字。e[0]/e[1]交替保存下一组的E
+     */
+    template <int G>
+    TA_TARGET_SHA inline __attribute__((always_inline))
+    void shaRoundGroup(__m128i& abcd, __m128i (&e)[2], __m128i (&m)[4]) {
+        __m128i& current = e[G % 2];
+        if (G == 0) {
+            current = _mm_add_epi32(current, m[0]);
+        } else {
+            current = _mm_sha1nexte_epu32(current, m[G % 4]);
+        }
+        e[(G + 1) % 2] = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, current, G / 5);
+
+        if (G >= 3 && G <= 18) {
+            m[(G + 1) % 4] = _mm_sha1msg2_epu32(m[(G + 1) % 4], m[G % 4]);
+        }
+        if (G >= 2 && G <= 17) {
+            m[(G + 2) % 4] = _mm_xor_si128(m[(G + 2) % 4], m[G % 4]);
+        }
+        if (G >= 1 && G <= 16) {
+            m[(G + 3) % 4] = _mm_sha1msg1_epu32(m[(G + 3) % 4], m[G % 4]);
+        }
+    }
+
+    template <int... G>
+    TA_TARGET_SHA inline __attribute__((always_inline))
+    void shaAllRounds(__m128i& abcd, __m128i (&e)[2], __m128i (&m)[4], std::integer_sequence<int, G...>) {
+        (shaRoundGroup<G>(abcd, e, m), ...);
+    }
+
+    TA_TARGET_SHA
+    void processBlocksShaNi(uint32_t* state, const uint8_t* block, size_t count) {
+        const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+
+        __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+        __m128i e[2];
+        e[0] = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+        for (; count > 0; --count, block += 64) {
+            const __m128i abcdSaved = abcd;
+            const __m128i eSaved = e[0];
+
+            __m128i m[4];
+            for (int i = 0; i < 4; ++i) {
+                m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16)), byteSwap);
+            }
+
+            shaAllRounds(abcd, e, m, std::make_integer_sequence<int, 20>());
+
+            e[0] = _mm_sha1nexte_epu32(e[0], eSaved);
+            abcd = _mm_add_epi32(abcd, abcdSaved);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+        state[4] = static_cast<uint32_t>(_mm_extract_epi32(e[0], 3));
+    }
+
+    bool cpuSupportsShaNi() {
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        bool ssse3 = (ecx & (1u << 9)) != 0;
+        bool sse41 = (ecx & (1u << 19)) != 0;
+        if (!ssse3 || !sse41 || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        return (ebx & (1u << 29)) != 0;
+    }
+
+#else
+
+    bool cpuSupportsShaNi() {
+        return false;
+    }
+
+#endif // TA_SHA1_SHANI
+
+    std::atomic<bool>& useShaNi() {
+        static std::atomic<bool> enabled{cpuSupportsShaNi()};
+        return enabled;
+    }
+
+} // namespace
+
+Sha1::Sha1() : bufferLength(0), totalLength(0) {
+    std::memcpy(state, kInitialState, sizeof(state));
+}
+
+void Sha1::update(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    totalLength += length;
+
+    if (bufferLength > 0) {
+        size_t take = std::min(length, sizeof(buffer) - bufferLength);
+        std::memcpy(buffer + bufferLength, bytes, take);
+        bufferLength += take;
+        bytes += take;
+        length -= take;
+        if (bufferLength == sizeof(buffer)) {
+            processBlocks(state, buffer, 1);
+            bufferLength = 0;
+        }
+    }
+
+    if (length >= 64) {
+        size_t count = length / 64;
+        processBlocks(state, bytes, count);
+        bytes += count * 64;
+        length -= count * 64;
+    }
+
+    if (length > 0) {
+        std::memcpy(buffer, bytes, length);
+        bufferLength = length;
+    }
+}
+
+Sha1::Digest Sha1::finish() {
+    uint64_t bitLength = totalLength * 8;
+
+    uint8_t padding[72] = {0x80};
+    size_t padLength = (bufferLength < 56) ? (56 - bufferLength) : (120 - bufferLength);
+    update(padding, padLength);
+
+    uint8_t lengthBytes[8];
+    for (int i = 0; i < 8; ++i) {
+        lengthBytes[i] = static_cast<uint8_t>(bitLength >> (56 - 8 * i));
+    }
+    update(lengthBytes, 8);
+
+    return toDigest(state);
+}
+
+Sha1::Digest Sha1::hash(const std::string& data) {
+    return hash(data.data(), data.size());
+}
+
+Sha1::Digest Sha1::hash(const void* data, size_t length) {
+    // 补位（0x80 + 0 + 8字节长度）后不超过两块：直接在栈上拼好整块
+    if (length + 9 > 128) {
+        Sha1 sha;
+        sha.update(data, length);
+        return sha.finish();
+    }
+
+    uint8_t blocks[128];
+    size_t total = (length + 9 > 64) ? 128 : 64;
+    std::memcpy(blocks, data, length);
+    blocks[length] = 0x80;
+    std::memset(blocks + length + 1, 0, total - length - 1);
+    uint64_t bitLength = static_cast<uint64_t>(length) * 8;
+    for (int i = 0; i < 8; ++i) {
+        blocks[total - 8 + i] = static_cast<uint8_t>(bitLength >> (56 - 8 * i));
+    }
+
+    uint32_t state[5];
+    std::memcpy(state, kInitialState, sizeof(state));
+    processBlocks(state, blocks, total / 64);
+    return toDigest(state);
+}
+
+bool Sha1::setHardwareEnabled(bool enabled) {
+    if (enabled && !cpuSupportsShaNi()) {
+        return false;
+    }
+    useShaNi().store(enabled, std::memory_order_relaxed);
+    return true;
+}
+
+bool Sha1::hardwareEnabled() {
+    return useShaNi().load(std::memory_order_relaxed);
+}
+
+void Sha1::processBlocks(uint32_t* state, const uint8_t* blocks, size_t count) {
+#ifdef TA_SHA1_SHANI
+    if (useShaNi().load(std::memory_order_relaxed)) {
+        processBlocksShaNi(state, blocks, count);
+        return;
+    }
+#endif
+    processBlocksScalar(state, blocks, count);
+}
+
+Sha1::Digest Sha1::toDigest(const uint32_t* state) {
+    Digest digest;
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    }
+    return digest;
+}
@@ -0,0 +1,67 @@
+/**
+ * Sha1.h
+ *
+ * SHA-1摘要（FIPS 180-4）
+ *
+ * 【用途】：WebSocket握手需要计算 base64(SHA-1(Sec-WebSocket-Key + GUID))
+ * 【注意】：SHA-1在这里只用于协议要求，不要用于任何安全相关的场景
+ * 【实现】：CPU支持SHA扩展（SHA-NI）时用sha1rnds4等指令处理块，否则用标量实现；运行时分派。
+ *   握手用的短消息（不超过119字节，补位后不超过两块）走 hash(data, length)，不分配内存
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * SHA-1计算器
+ */
+class Sha1 {
+public:
+    using Digest = std::array<uint8_t, 20>;
+
+    Sha1();
+
+    /**
+     * 追加数据
+     */
+    void update(const void* data, size_t length);
+
+    /**
+     * 结束计算并返回摘要（调用后对象不可再用）
+     */
+    Digest finish();
+
+    /**
+     * 一次性计算
+     */
+    static Digest hash(const std::string& data);
+
+    /**
+     * 一次性计算（短消息在栈上补位，不分配内存）
+     */
+    static Digest hash(const void* data, size_t length);
+
+    /**
+     * 启用/禁用SHA扩展指令（用于基准测试和对比验证）
+     * 【返回】：要求启用但CPU不支持时返回false
+     */
+    static bool setHardwareEnabled(bool enabled);
+
+    /**
+     * 当前是否使用SHA扩展指令
+     */
+    static bool hardwareEnabled();
+
+private:
+    static void processBlocks(uint32_t* state, const uint8_t* blocks, size_t count);
+    static Digest toDigest(const uint32_t* state);
+
+    uint32_t state[5];
+    uint8_t buffer[64];
+    size_t bufferLength;
+    uint64_t totalLength;
+};
@@ -0,0 +1,93 @@
+/**
+ * ShardedMap.h
+ *
+ * 分片并发哈希表 - 网络线程按键（如恢复令牌）查找句柄，不经过全局锁
+ *
+ * 【结构】：按键的哈希分成Shards个分片，每个分片一把互斥锁和一个unordered_map；
+ *   不同分片上的操作互不阻塞。分片按缓存行对齐，相邻分片的锁不会伪共享
+ *
+ * 【说明】：值按拷贝返回，适合存放句柄等小对象（见SlotMap）
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+template <typename Key, typename Value, size_t Shards = 16, typename Hash = std::hash<Key>>
+class ShardedMap {
+public:
+    /**
+     * 插入或覆盖
+     */
+    void assign(const Key& key, const Value& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.map[key] = value;
+    }
+
+    /**
+     * 查找
+     * 【返回】：找到时返回true并写入value
+     */
+    bool find(const Key& key, Value& value) const {
+        const Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+    /**
+     * 删除
+     * 【返回】：键存在时返回true
+     */
+    bool erase(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.map.erase(key) > 0;
+    }
+
+    /**
+     * 键的总数（逐个分片加锁统计，并发修改时只是近似值）
+     */
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.map.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.map.clear();
+        }
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Value, Hash> map;
+    };
+
+    // 用哈希的高位选分片（低位留给分片内的unordered_map选桶）
+    size_t shardIndex(const Key& key) const {
+        uint64_t hash = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash >> 32) % Shards;
+    }
+
+    Shard& shardFor(const Key& key) { return shards[shardIndex(key)]; }
+    const Shard& shardFor(const Key& key) const { return shards[shardIndex(key)]; }
+
+    std::array<Shard, Shards> shards;
+};
@@ -0,0 +1,530 @@
+/**
+ * SimpleJson.cpp
+ *
+ * 轻量JSON解析与生成实现
+ */
+
+#include "SimpleJson.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace SimpleJson {
+
+    namespace {
+
+        // 嵌套深度上限，防止恶意输入耗尽栈
+        constexpr int kMaxDepth = 64;
+
+        const Value& nullValue() {
+            static const Value value;
+            return value;
+        }
+
+        /**
+         * 递归下降解析器
+         */
+        class Parser {
+        public:
+            Parser(const std::string& input, size_t maxKeys) : text(input), pos(0), keysLeft(maxKeys), limited(maxKeys > 0) {}
+
+            bool parseDocument(Value& out, std::string* error) {
+                skipWhitespace();
+                if (!parseValue(out, 0)) {
+                    return fail(error);
+                }
+                skipWhitespace();
+                if (pos != text.size()) {
+                    message = "trailing characters";
+                    return fail(error);
+                }
+                return true;
+            }
+
+        private:
+            bool fail(std::string* error) {
+                if (error) {
+                    *error = message + " at offset " + std::to_string(pos);
+                }
+                return false;
+            }
+
+            void skipWhitespace() {
+                while (pos < text.size() &&
+                       (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+                    ++pos;
+                }
+            }
+
+            bool consume(char expected) {
+                if (pos < text.size() && text[pos] == expected) {
+                    ++pos;
+                    return true;
+                }
+                return false;
+            }
+
+            bool consumeLiteral(const char* literal) {
+                size_t i = 0;
+                while (literal[i] != '\0') {
+                    if (pos + i >= text.size() || text[pos + i] != literal[i]) {
+                        message = "invalid literal";
+                        return false;
+                    }
+                    ++i;
+                }
+                pos += i;
+                return true;
+            }
+
+            bool parseValue(Value& out, int depth) {
+                if (depth > kMaxDepth) {
+                    message = "nesting too deep";
+                    return false;
+                }
+                if (pos >= text.size()) {
+                    message = "unexpected end of input";
+                    return false;
+                }
+
+                switch (text[pos]) {
+                    case '{': return parseObject(out, depth);
+                    case '[': return parseArray(out, depth);
+                    case '"': {
+                        std::string value;
+                        if (!parseString(value)) {
+                            return false;
+                        }
+                        out = Value(std::move(value));
+                        return true;
+                    }
+                    case 't':
+                        out = Value(true);
+                        return consumeLiteral("true");
+                    case 'f':
+                        out = Value(false);
+                        return consumeLiteral("false");
+                    case 'n':
+                        out = Value();
+                        return consumeLiteral("null");
+                    default:
+                        return parseNumber(out);
+                }
+            }
+
+            bool parseObject(Value& out, int depth) {
+                ++pos;  // '{'
+                out = Value::object();
+                skipWhitespace();
+                if (consume('}')) {
+                    return true;
+                }
+                // 成员先全部追加，结束时一次性处理重复的键并建立索引
+                std::vector<Value::Member> members;
+                while (true) {
+                    skipWhitespace();
+                    if (limited && keysLeft-- == 0) {
+                        message = "too many object keys";
+                        return false;
+                    }
+                    std::string key;
+                    if (pos >= text.size() || text[pos] != '"' || !parseString(key)) {
+                        if (message.empty()) {
+                            message = "expected object key";
+                        }
+                        return false;
+                    }
+                    skipWhitespace();
+                    if (!consume(':')) {
+                        message = "expected ':'";
+                        return false;
+                    }
+                    skipWhitespace();
+                    Value member;
+                    if (!parseValue(member, depth + 1)) {
+                        return false;
+                    }
+                    members.emplace_back(std::move(key), std::move(member));
+                    skipWhitespace();
+                    if (consume('}')) {
+                        out = Value::object(std::move(members));
+                        return true;
+                    }
+                    if (!consume(',')) {
+                        message = "expected ',' or '}'";
+                        return false;
+                    }
+                }
+            }
+
+            bool parseArray(Value& out, int depth) {
+                ++pos;  // '['
+                out = Value::array();
+                skipWhitespace();
+                if (consume(']')) {
+                    return true;
+                }
+                while (true) {
+                    skipWhitespace();
+                    Value item;
+                    if (!parseValue(item, depth + 1)) {
+                        return false;
+                    }
+                    out.push(std::move(item));
+                    skipWhitespace();
+                    if (consume(']')) {
+                        return true;
+                    }
+                    if (!consume(',')) {
+                        message = "expected ',' or ']'";
+                        return false;
+                    }
+                }
+            }
+
+            bool parseHex4(unsigned& code) {
+                if (pos + 4 > text.size()) {
+                    return false;
+                }
+                code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    char c = text[pos++];
+                    code <<= 4;
+                    if (c >= '0' && c <= '9') code |= static_cast<unsigned>(c - '0');
+                    else if (c >= 'a' && c <= 'f') code |= static_cast<unsigned>(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F') code |= static_cast<unsigned>(c - 'A' + 10);
+                    else return false;
+                }
+                return true;
+            }
+
+            static void appendUtf8(std::string& out, unsigned code) {
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            bool parseString(std::string& out) {
+                ++pos;  // '"'
+                while (pos < text.size()) {
+                    char c = text[pos++];
+                    if (c == '"') {
+                        return true;
+                    }
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        message = "control character in string";
+                        return false;
+                    }
+                    if (c != '\\') {
+                        out += c;
+                        continue;
+                    }
+                    if (pos >= text.size()) {
+                        break;
+                    }
+                    char escape = text[pos++];
+                    switch (escape) {
+                        case '"': out += '"'; break;
+                        case '\\': out += '\\'; break;
+                        case '/': out += '/'; break;
+                        case 'b': out += '\b'; break;
+                        case 'f': out += '\f'; break;
+                        case 'n': out += '\n'; break;
+                        case 'r': out += '\r'; break;
+                        case 't': out += '\t'; break;
+                        case 'u': {
+                            unsigned code = 0;
+                            if (!parseHex4(code)) {
+                                message = "invalid \\u escape";
+                                return false;
+                            }
+                            // 代理对
+                            if (code >= 0xD800 && code <= 0xDBFF && pos + 1 < text.size() &&
+                                text[pos] == '\\' && text[pos + 1] == 'u') {
+                                pos += 2;
+                                unsigned low = 0;
+                                if (!parseHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                                    message = "invalid surrogate pair";
+                                    return false;
+                                }
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            appendUtf8(out, code);
+                            break;
+                        }
+                        default:
+                            message = "invalid escape";
+                            return false;
+                    }
+                }
+                message = "unterminated string";
+                return false;
+            }
+
+            bool parseNumber(Value& out) {
+                size_t start = pos;
+                if (pos < text.size() && text[pos] == '-') {
+                    ++pos;
+                }
+                while (pos < text.size() && ((text[pos] >= '0' && text[pos] <= '9') || text[pos] == '.' ||
+                                             text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' ||
+                                             text[pos] == '-')) {
+                    ++pos;
+                }
+                if (pos == start) {
+                    message = "unexpected character";
+                    return false;
+                }
+                std::string token = text.substr(start, pos - start);
+                char* end = nullptr;
+                double value = std::strtod(token.c_str(), &end);
+                if (end != token.c_str() + token.size()) {
+                    message = "invalid number";
+                    pos = start;
+                    return false;
+                }
+                out = Value(value);
+                return true;
+            }
+
+            const std::string& text;
+            size_t pos;
+            size_t keysLeft;    // 还允许的对象键数（limited时）
+            bool limited;
+            std::string message;
+        };
+
+    } // namespace
+
+    const std::string& Value::asString() const {
+        static const std::string empty;
+        return valueType == Type::String ? stringValue : empty;
+    }
+
+    Value Value::object(std::vector<Member> members) {
+        Value v;
+        v.valueType = Type::Object;
+        v.objectMembers = std::move(members);
+        if (v.objectMembers.size() > kIndexedMembers) {
+            v.buildIndex();
+            return v;
+        }
+        // 成员少：逐个与前面保留的成员比较
+        size_t kept = 0;
+        for (size_t i = 0; i < v.objectMembers.size(); ++i) {
+            size_t j = 0;
+            while (j < kept && v.objectMembers[j].first != v.objectMembers[i].first) {
+                ++j;
+            }
+            if (j < kept) {
+                v.objectMembers[j].second = std::move(v.objectMembers[i].second);
+            } else {
+                if (kept != i) {
+                    v.objectMembers[kept] = std::move(v.objectMembers[i]);
+                }
+                ++kept;
+            }
+        }
+        v.objectMembers.resize(kept);
+        return v;
+    }
+
+    // 建立键索引，同时合并重复的键
+    void Value::buildIndex() {
+        memberIndex.clear();
+        memberIndex.reserve(objectMembers.size());
+        size_t kept = 0;
+        for (size_t i = 0; i < objectMembers.size(); ++i) {
+            auto inserted = memberIndex.emplace(objectMembers[i].first, kept);
+            if (!inserted.second) {
+                objectMembers[inserted.first->second].second = std::move(objectMembers[i].second);
+                continue;
+            }
+            if (kept != i) {
+                objectMembers[kept] = std::move(objectMembers[i]);
+            }
+            ++kept;
+        }
+        objectMembers.resize(kept);
+    }
+
+    const Value* Value::find(const std::string& key) const {
+        if (!memberIndex.empty()) {
+            auto it = memberIndex.find(key);
+            return it == memberIndex.end() ? nullptr : &objectMembers[it->second].second;
+        }
+        for (const auto& member : objectMembers) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    const Value& Value::operator[](const std::string& key) const {
+        const Value* value = find(key);
+        return value ? *value : nullValue();
+    }
+
+    void Value::push(Value value) {
+        valueType = Type::Array;
+        arrayItems.push_back(std::move(value));
+    }
+
+    void Value::set(const std::string& key, Value value) {
+        valueType = Type::Object;
+        if (!memberIndex.empty()) {
+            auto inserted = memberIndex.emplace(key, objectMembers.size());
+            if (!inserted.second) {
+                objectMembers[inserted.first->second].second = std::move(value);
+                return;
+            }
+            objectMembers.emplace_back(key, std::move(value));
+            return;
+        }
+        for (auto& member : objectMembers) {
+            if (member.first == key) {
+                member.second = std::move(value);
+                return;
+            }
+        }
+        objectMembers.emplace_back(key, std::move(value));
+        if (objectMembers.size() > kIndexedMembers) {
+            buildIndex();
+        }
+    }
+
+    bool Value::erase(const std::string& key) {
+        for (auto it = objectMembers.begin(); it != objectMembers.end(); ++it) {
+            if (it->first == key) {
+                objectMembers.erase(it);
+                if (!memberIndex.empty()) {
+                    buildIndex();   // 后面成员的下标都变了
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string Value::dump() const {
+        std::string out;
+        dumpTo(out);
+        return out;
+    }
+
+    void Value::dumpTo(std::string& out) const {
+        switch (valueType) {
+            case Type::Null:
+                out += "null";
+                break;
+            case Type::Bool:
+                out += boolValue ? "true" : "false";
+                break;
+            case Type::Number: {
+                char buffer[32];
+                if (std::isfinite(numberValue) && numberValue == std::floor(numberValue) &&
+                    std::fabs(numberValue) < 9007199254740992.0) {
+                    std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(numberValue));
+                } else if (std::isfinite(numberValue)) {
+                    std::snprintf(buffer, sizeof(buffer), "%.17g", numberValue);
+                } else {
+                    std::snprintf(buffer, sizeof(buffer), "null");
+                }
+                out += buffer;
+                break;
+            }
+            case Type::String:
+                out += quote(stringValue);
+                break;
+            case Type::Array:
+                out += '[';
+                for (size_t i = 0; i < arrayItems.size(); ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    arrayItems[i].dumpTo(out);
+                }
+                out += ']';
+                break;
+            case Type::Object:
+                out += '{';
+                for (size_t i = 0; i < objectMembers.size(); ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    out += quote(objectMembers[i].first);
+                    out += ':';
+                    objectMembers[i].second.dumpTo(out);
+                }
+                out += '}';
+                break;
+        }
+    }
+
+    bool parse(const std::string& text, Value& out, std::string* error, size_t maxKeys) {
+        Parser parser(text, maxKeys);
+        return parser.parseDocument(out, error);
+    }
+
+    std::string quote(const std::string& text) {
+        std::string out;
+        out.reserve(text.size() + 2);
+        out += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buffer[8];
+                        std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                        out += buffer;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+        return out;
+    }
+
+    std::string prependField(const std::string& objectText, const std::string& key, const std::string& rawValue) {
+        size_t brace = objectText.find('{');
+        if (brace == std::string::npos) {
+            return objectText;
+        }
+        size_t next = objectText.find_first_not_of(" \t\r\n", brace + 1);
+        bool emptyObject = next != std::string::npos && objectText[next] == '}';
+
+        std::string result;
+        result.reserve(objectText.size() + key.size() + rawValue.size() + 8);
+        result.append(objectText, 0, brace + 1);
+        result += quote(key);
+        result += ':';
+        result += rawValue;
+        if (!emptyObject) {
+            result += ',';
+        }
+        result.append(objectText, brace + 1, std::string::npos);
+        return result;
+    }
+
+} // namespace SimpleJson
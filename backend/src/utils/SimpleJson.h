@@ -0,0 +1,142 @@
+/**
+ * SimpleJson.h
+ *
+ * 轻量JSON解析与生成 - 不依赖nlohmann/json，所有平台都可用
+ *
+ * 【用途】：
+ * 1. 解析客户端的批量命令信封
+ * 2. 读取 shared/data 下的游戏数据
+ * 3. 在已生成的JSON对象前插入字段（序号、命令ID）
+ *
+ * 【限制】：数字统一按double保存；对象成员保持原始顺序，成员较少时查找为线性扫描，
+ *   成员多时另建哈希索引（解析N个键的对象为O(N)）
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SimpleJson {
+
+    /**
+     * 值类型
+     */
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    /**
+     * JSON值
+     */
+    class Value {
+    public:
+        using Member = std::pair<std::string, Value>;
+
+        Value() = default;
+        explicit Value(bool value) : valueType(Type::Bool), boolValue(value) {}
+        explicit Value(double value) : valueType(Type::Number), numberValue(value) {}
+        explicit Value(int value) : Value(static_cast<double>(value)) {}
+        explicit Value(std::string value) : valueType(Type::String), stringValue(std::move(value)) {}
+        explicit Value(const char* value) : Value(std::string(value)) {}
+
+        static Value array() { Value v; v.valueType = Type::Array; return v; }
+        static Value object() { Value v; v.valueType = Type::Object; return v; }
+
+        /**
+         * 由成员列表构造对象
+         * 【说明】：重复的键保留最后一个值，位置取第一次出现处（与逐个set相同），整体为O(N)
+         */
+        static Value object(std::vector<Member> members);
+
+        Type type() const { return valueType; }
+        bool isNull() const { return valueType == Type::Null; }
+        bool isString() const { return valueType == Type::String; }
+        bool isNumber() const { return valueType == Type::Number; }
+        bool isArray() const { return valueType == Type::Array; }
+        bool isObject() const { return valueType == Type::Object; }
+
+        bool asBool(bool fallback = false) const { return valueType == Type::Bool ? boolValue : fallback; }
+        double asNumber(double fallback = 0.0) const { return valueType == Type::Number ? numberValue : fallback; }
+        const std::string& asString() const;
+
+        /**
+         * 数组元素 / 对象成员（类型不符时为空）
+         */
+        const std::vector<Value>& items() const { return arrayItems; }
+        const std::vector<Member>& members() const { return objectMembers; }
+
+        /**
+         * 查找对象成员
+         * 【返回】：不存在或不是对象时返回nullptr
+         */
+        const Value* find(const std::string& key) const;
+
+        /**
+         * 取对象成员（不存在时返回空值，便于链式访问）
+         */
+        const Value& operator[](const std::string& key) const;
+
+        /**
+         * 追加数组元素 / 设置对象成员
+         */
+        void push(Value value);
+        void set(const std::string& key, Value value);
+
+        /**
+         * 删除对象成员
+         * 【返回】：成员存在时返回true
+         */
+        bool erase(const std::string& key);
+
+        /**
+         * 序列化为紧凑的JSON文本
+         */
+        std::string dump() const;
+        void dumpTo(std::string& out) const;
+
+    private:
+        // 成员数超过这个值时建立哈希索引
+        static constexpr size_t kIndexedMembers = 16;
+
+        void buildIndex();
+
+        Type valueType = Type::Null;
+        bool boolValue = false;
+        double numberValue = 0.0;
+        std::string stringValue;
+        std::vector<Value> arrayItems;
+        std::vector<Member> objectMembers;
+        std::unordered_map<std::string, size_t> memberIndex;   // 键 -> 成员下标（成员少时为空）
+    };
+
+    /**
+     * 解析JSON文本
+     * 【参数】：
+     *   - error: 失败时写入错误描述（可为nullptr）
+     *   - maxKeys: 整个文档最多允许的对象键数（0表示不限制），用于不可信的客户端输入
+     * 【返回】：成功返回true
+     */
+    bool parse(const std::string& text, Value& out, std::string* error = nullptr, size_t maxKeys = 0);
+
+    /**
+     * 生成带引号并转义的JSON字符串
+     */
+    std::string quote(const std::string& text);
+
+    /**
+     * 在JSON对象文本的最前面插入一个字段
+     * 【参数】：rawValue - 已经是JSON格式的值（数字、带引号的字符串等）
+     * 【说明】：不解析整个对象，只找第一个'{'；不是对象时原样返回
+     */
+    std::string prependField(const std::string& objectText, const std::string& key, const std::string& rawValue);
+
+} // namespace SimpleJson
@@ -0,0 +1,354 @@
+/**
+ * SlabPool.h
+ *
+ * 分页对象池 - 同类对象按固定大小的页存放，可以增量整理，空页直接还给操作系统
+ *
+ * 【用途】：长时间运行、对象不断创建删除的存储（如会话）。通用分配器里，删除留下的
+ *   空洞分散在各处，页里只要还有一个活对象就不能归还，RSS只增不减，相邻对象也越来越分散
+ *
+ * 【结构】：
+ * - 每页PageBytes字节（mmap分配），存放kPerPage个对象，每页有占用位图和活对象数
+ * - 创建对象时放进最满的未满页（稀疏的页不再接收新对象，会自然变空）；
+ *   页按活对象数分桶，另有非空桶位图，选最满/最稀疏的页只查位图，不遍历所有页
+ * - 删除后变空的页立即归还（保留一个空页备用，避免反复映射）
+ * - compact：从最稀疏的页把对象移动（移动构造 + 析构原对象）到较满的页，
+ *   每移动一个对象调用relocated回调，由使用者修正指向它的间接引用（如SlotMap中的指针）；
+ *   源页移空后归还
+ *
+ * 【要求】：T可移动构造，且除了使用者在relocated中修正的引用外没有别处保存它的地址
+ *
+ * 【内存记账】：映射的页记到模板参数Tag（MemoryTracker），会话页不会漏出内存报告
+ *
+ * 【线程安全】：不加锁，由使用者保护
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <new>
+#include <set>
+#include <utility>
+#include <vector>
+#include "core/MemoryTracker.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+template <typename T, MemoryTag Tag, size_t PageBytes = 16 * 1024>
+class SlabPool {
+public:
+    static constexpr size_t kPerPage = PageBytes / sizeof(T);
+    static_assert(kPerPage > 0, "SlabPool: 对象比页还大");
+
+    /**
+     * 统计信息
+     */
+    struct Stats {
+        size_t pages = 0;               // 已映射的页（含备用空页）
+        size_t live = 0;                // 活对象数
+        size_t capacity = 0;            // 所有页的对象容量
+        uint64_t reclaimedBytes = 0;    // 累计归还给操作系统的字节数
+        uint64_t moves = 0;             // 累计整理移动的对象数
+
+        // 碎片率：空闲槽位占容量的比例（0表示所有页都是满的）
+        double fragmentation() const {
+            return capacity == 0 ? 0.0 : 1.0 - static_cast<double>(live) / static_cast<double>(capacity);
+        }
+    };
+
+    SlabPool() = default;
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    ~SlabPool() {
+        for (auto& entry : pages) {
+            Page& page = *entry.second;
+            for (size_t slot = 0; slot < kPerPage; ++slot) {
+                if (page.occupied(slot)) {
+                    page.object(slot)->~T();
+                }
+            }
+            releaseMemory(page.memory);
+        }
+    }
+
+    /**
+     * 在最满的未满页中构造对象
+     * 【返回】：映射新页失败时返回nullptr
+     */
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Page* page = densestOpenPage(nullptr);
+        if (!page) {
+            page = mapPage();
+            if (!page) {
+                return nullptr;
+            }
+        }
+        size_t slot = page->freeSlot();
+        T* object = new (page->memory + slot * sizeof(T)) T(std::forward<Args>(args)...);
+        mark(page, slot, true);
+        ++live;
+        return object;
+    }
+
+    /**
+     * 析构对象并释放槽位（页变空时归还）
+     */
+    void destroy(T* object) {
+        Page* page = pageOf(object);
+        if (!page) {
+            return;
+        }
+        size_t slot = static_cast<size_t>(reinterpret_cast<char*>(object) - page->memory) / sizeof(T);
+        object->~T();
+        mark(page, slot, false);
+        --live;
+        if (page->live == 0) {
+            unmapPage(page);
+        }
+    }
+
+    /**
+     * 整理：把最稀疏页中的对象移到较满的页，最多移动maxMoves个
+     * 【参数】：relocated - 每移动一个对象调用一次 relocated(T& 新位置的对象)
+     * 【返回】：本次移动的对象数（其他页的空位装不下最稀疏页的对象时不移动）
+     */
+    template <typename Relocated>
+    size_t compact(size_t maxMoves, Relocated&& relocated) {
+        Page* source = sparsestPage();
+        if (!source || freeSlotsOutside(*source) < source->live) {
+            return 0;
+        }
+        size_t moved = 0;
+        for (size_t slot = 0; slot < kPerPage && moved < maxMoves; ++slot) {
+            if (!source->occupied(slot)) {
+                continue;
+            }
+            Page* target = densestOpenPage(source);
+            size_t targetSlot = target->freeSlot();
+            T* from = source->object(slot);
+            T* to = new (target->memory + targetSlot * sizeof(T)) T(std::move(*from));
+            mark(target, targetSlot, true);
+            from->~T();
+            mark(source, slot, false);
+            relocated(*to);
+            ++moved;
+        }
+        totalMoves += moved;
+        if (source->live == 0) {
+            unmapPage(source);
+        }
+        return moved;
+    }
+
+    /**
+     * 是否值得整理：空闲槽位至少能装下一整页，即整理后至少能归还一页
+     */
+    bool fragmented() const {
+        return pages.size() > 1 && capacity() - live >= kPerPage + (spare ? kPerPage : 0);
+    }
+
+    Stats stats() const {
+        Stats result;
+        result.pages = pages.size();
+        result.live = live;
+        result.capacity = capacity() - (spare ? kPerPage : 0);
+        result.reclaimedBytes = reclaimed;
+        result.moves = totalMoves;
+        return result;
+    }
+
+    size_t mappedBytes() const { return pages.size() * PageBytes; }
+
+private:
+    struct Page {
+        char* memory = nullptr;
+        std::array<uint64_t, (kPerPage + 63) / 64> bits{};  // 占用位图
+        size_t live = 0;
+
+        bool occupied(size_t slot) const { return (bits[slot / 64] >> (slot % 64)) & 1u; }
+        T* object(size_t slot) { return std::launder(reinterpret_cast<T*>(memory + slot * sizeof(T))); }
+        void mark(size_t slot, bool used) {
+            if (used) {
+                bits[slot / 64] |= uint64_t(1) << (slot % 64);
+                ++live;
+            } else {
+                bits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+                --live;
+            }
+        }
+        size_t freeSlot() const {
+            for (size_t word = 0; word < bits.size(); ++word) {
+                if (~bits[word] != 0) {
+                    size_t slot = word * 64;
+                    for (uint64_t free = ~bits[word]; (free & 1u) == 0; free >>= 1) {
+                        ++slot;
+                    }
+                    return slot < kPerPage ? slot : kPerPage;
+                }
+            }
+            return kPerPage;
+        }
+    };
+
+    size_t capacity() const { return pages.size() * kPerPage; }
+
+    // 页按地址排序（同一个桶里优先用地址低的页，活对象向低地址聚集）
+    struct ByAddress {
+        bool operator()(const Page* a, const Page* b) const { return a->memory < b->memory; }
+    };
+
+    static constexpr size_t kBucketWords = (kPerPage + 1 + 63) / 64;
+
+    // 页的活对象数变化：从原来的桶移到新桶
+    void mark(Page* page, size_t slot, bool used) {
+        unlink(page);
+        page->mark(slot, used);
+        link(page);
+    }
+
+    void link(Page* page) {
+        buckets[page->live].insert(page);
+        nonEmpty[page->live / 64] |= uint64_t(1) << (page->live % 64);
+    }
+
+    void unlink(Page* page) {
+        auto& bucket = buckets[page->live];
+        bucket.erase(page);
+        if (bucket.empty()) {
+            nonEmpty[page->live / 64] &= ~(uint64_t(1) << (page->live % 64));
+        }
+    }
+
+    // 活对象数小于below的非空桶中最满的一个；没有时返回kPerPage + 1
+    size_t highestBucketBelow(size_t below) const {
+        for (size_t word = (below + 63) / 64; word-- > 0;) {
+            uint64_t bits = nonEmpty[word];
+            if (word * 64 + 64 > below) {
+                bits &= (uint64_t(1) << (below % 64)) - 1;
+            }
+            for (size_t bit = 64; bits != 0 && bit-- > 0;) {
+                if ((bits >> bit) & 1u) {
+                    return word * 64 + bit;
+                }
+            }
+        }
+        return kPerPage + 1;
+    }
+
+    // 活对象数不小于from的非空桶中最稀疏的一个；没有时返回kPerPage + 1
+    size_t lowestBucketFrom(size_t from) const {
+        for (size_t word = from / 64; word < kBucketWords; ++word) {
+            uint64_t bits = nonEmpty[word];
+            if (word == from / 64) {
+                bits &= ~((uint64_t(1) << (from % 64)) - 1);
+            }
+            for (size_t bit = 0; bits != 0 && bit < 64; ++bit) {
+                if ((bits >> bit) & 1u) {
+                    return word * 64 + bit;
+                }
+            }
+        }
+        return kPerPage + 1;
+    }
+
+    // 最满的未满页（排除exclude）；同样满时取地址低的，活对象向低地址聚集
+    Page* densestOpenPage(const Page* exclude) {
+        Page* best = nullptr;
+        for (size_t count = highestBucketBelow(kPerPage); count <= kPerPage && !best;
+             count = count == 0 ? kPerPage + 1 : highestBucketBelow(count)) {
+            for (Page* page : buckets[count]) {
+                if (page != exclude) {
+                    best = page;
+                    break;
+                }
+            }
+        }
+        if (best == spare) {
+            spare = nullptr;        // 备用空页开始使用
+        }
+        return best;
+    }
+
+    // 活对象最少的非空未满页（同样稀疏时取地址高的）
+    Page* sparsestPage() {
+        size_t count = lowestBucketFrom(1);
+        return count < kPerPage ? *buckets[count].rbegin() : nullptr;
+    }
+
+    size_t freeSlotsOutside(const Page& page) const {
+        return capacity() - live - (kPerPage - page.live) - (spare ? kPerPage : 0);
+    }
+
+    Page* pageOf(const T* object) {
+        const char* address = reinterpret_cast<const char*>(object);
+        auto it = pages.upper_bound(address);
+        if (it == pages.begin()) {
+            return nullptr;
+        }
+        --it;
+        return address < it->first + PageBytes ? it->second.get() : nullptr;
+    }
+
+    Page* mapPage() {
+        char* memory = static_cast<char*>(acquireMemory());
+        if (!memory) {
+            return nullptr;
+        }
+        auto page = std::make_unique<Page>();
+        page->memory = memory;
+        Page* raw = page.get();
+        pages.emplace(memory, std::move(page));
+        link(raw);
+        return raw;
+    }
+
+    // 空页：第一个留作备用，再有空页就归还
+    void unmapPage(Page* page) {
+        if (!spare) {
+            spare = page;
+            return;
+        }
+        char* memory = page->memory;
+        unlink(page);
+        pages.erase(memory);
+        releaseMemory(memory);
+        reclaimed += PageBytes;
+    }
+
+    static void* acquireMemory() {
+#ifdef _WIN32
+        return MemoryTracker::allocate(PageBytes, Tag);
+#else
+        void* memory = mmap(nullptr, PageBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return nullptr;
+        }
+        MemoryTracker::recordMapped(Tag, PageBytes);
+        return memory;
+#endif
+    }
+
+    static void releaseMemory(void* memory) {
+#ifdef _WIN32
+        MemoryTracker::deallocate(memory);
+#else
+        munmap(memory, PageBytes);
+        MemoryTracker::recordUnmapped(Tag, PageBytes);
+#endif
+    }
+
+    std::map<const char*, std::unique_ptr<Page>> pages;            // 按地址排序，删除时按地址找到所在页
+    std::array<std::set<Page*, ByAddress>, kPerPage + 1> buckets;  // 按活对象数分桶
+    std::array<uint64_t, kBucketWords> nonEmpty{};                 // 非空桶位图
+    Page* spare = nullptr;                                         // 备用空页
+    size_t live = 0;
+    uint64_t reclaimed = 0;
+    uint64_t totalMoves = 0;
+};
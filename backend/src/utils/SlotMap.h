@@ -0,0 +1,171 @@
+/**
+ * SlotMap.h
+ *
+ * 代际槽位表 - 用 32位索引 + 32位代数 的句柄引用对象，句柄过期可以检测出来
+ *
+ * 【用途】：定时器、事件、异步完成回调里保存的引用（而不是裸指针或字符串ID），
+ *   对象删除后旧句柄查找失败，不会访问到已释放或被复用的对象
+ *
+ * 【结构】：
+ * - values：对象紧凑存放在连续数组里，遍历时没有空洞
+ * - slots：句柄索引 -> (代数, 对象在values中的位置)；空闲槽位串成链表
+ * - 删除时把最后一个对象移到空出的位置，插入、删除、查找都是O(1)
+ * - 槽位删除时代数加一，旧句柄的代数对不上即为过期
+ *
+ * 【线程安全】：不加锁，由使用者保护（见ShardedMap用于跨线程的键 -> 句柄查找）
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * 槽位句柄（8字节，可按值传递、存入其他结构或编码为64位整数）
+ * 【说明】：默认构造的句柄无效（代数从1开始，0永远不会被分配）
+ */
+struct SlotHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool valid() const { return generation != 0; }
+
+    uint64_t bits() const { return (static_cast<uint64_t>(generation) << 32) | index; }
+
+    static SlotHandle fromBits(uint64_t bits) {
+        SlotHandle handle;
+        handle.index = static_cast<uint32_t>(bits);
+        handle.generation = static_cast<uint32_t>(bits >> 32);
+        return handle;
+    }
+
+    bool operator==(const SlotHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    /**
+     * 插入对象
+     * 【返回】：新对象的句柄
+     */
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (freeHead != kNone) {
+            index = freeHead;
+            freeHead = slots[index].link;
+        } else {
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot());
+        }
+
+        Slot& slot = slots[index];
+        slot.link = static_cast<uint32_t>(values.size());
+        values.push_back(std::move(value));
+        denseToSlot.push_back(index);
+
+        SlotHandle handle;
+        handle.index = index;
+        handle.generation = slot.generation;
+        return handle;
+    }
+
+    /**
+     * 删除对象（最后一个对象移到空出的位置）
+     * 【返回】：句柄有效并删除了对象时返回true
+     */
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots[handle.index];
+        uint32_t position = slot.link;
+        uint32_t last = static_cast<uint32_t>(values.size() - 1);
+        if (position != last) {
+            values[position] = std::move(values[last]);
+            denseToSlot[position] = denseToSlot[last];
+            slots[denseToSlot[position]].link = position;
+        }
+        values.pop_back();
+        denseToSlot.pop_back();
+
+        // 代数回绕时跳过0，保证默认构造的句柄始终无效
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+        slot.link = freeHead;
+        freeHead = handle.index;
+        return true;
+    }
+
+    /**
+     * 查找对象
+     * 【返回】：句柄已过期或无效时返回nullptr
+     */
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &values[slots[handle.index].link] : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values[slots[handle.index].link] : nullptr;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots.size() && handle.valid() && slots[handle.index].generation == handle.generation;
+    }
+
+    /**
+     * 紧凑数组中第position个对象的句柄（配合按位置遍历时删除）
+     */
+    SlotHandle handleAt(size_t position) const {
+        SlotHandle handle;
+        handle.index = denseToSlot[position];
+        handle.generation = slots[handle.index].generation;
+        return handle;
+    }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+    /**
+     * 删除所有对象（所有已发出的句柄都过期）
+     */
+    void clear() {
+        for (size_t position = values.size(); position > 0; --position) {
+            erase(handleAt(position - 1));
+        }
+    }
+
+    void reserve(size_t count) {
+        values.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    // 按紧凑数组顺序遍历（顺序在删除后会变化）
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    struct Slot {
+        uint32_t generation = 1;
+        uint32_t link = kNone;      // 使用中：对象在values中的位置；空闲：下一个空闲槽位
+    };
+
+    std::vector<Slot> slots;
+    std::vector<T> values;
+    std::vector<uint32_t> denseToSlot;  // values中的位置 -> 槽位索引
+    uint32_t freeHead = kNone;
+};
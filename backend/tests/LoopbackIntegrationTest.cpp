@@ -0,0 +1,262 @@
+/**
+ * LoopbackIntegrationTest.cpp
+ *
+ * 回环集成测试 - 经LoopbackChannel驱动 帧解析 → 会话处理 → 序列化/编码 的真实路径
+ *
+ * 【覆盖】：
+ * 1. 升级握手和欢迎消息（恢复令牌）
+ * 2. 单条命令的响应和会话序号
+ * 3. 命令ID原样写回；批量命令按顺序执行，批次ID和每条命令的ID都写回，没有响应的命令占一个ack
+ * 4. 错误消息中回显的客户端输入经过转义，响应仍是合法JSON
+ * 5. 内容引用：预取消息带原文和哈希，之后的响应只发哈希，contentRequest取回原文
+ *
+ * 【运行】：ctest（需要 -DBUILD_TESTS=ON），数据目录由 TIME_ARTIFACTS_DATA_DIR 指定
+ */
+
+#include "core/ContentStore.h"
+#include "core/LoopbackChannel.h"
+#include "core/PrefetchPlanner.h"
+#include "core/SessionManager.h"
+#include "core/WebSocketServer.h"
+#include "core/WorldData.h"
+#include "utils/SimpleJson.h"
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+    int failures = 0;
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << " 检查失败: " #condition << std::endl;   \
+            ++failures;                                                                         \
+        }                                                                                       \
+    } while (0)
+
+    /**
+     * 丢弃服务器的处理日志
+     */
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    /**
+     * 一个回环客户端：发送消息、驱动服务器、收集解析后的服务器消息
+     */
+    class TestClient {
+    public:
+        explicit TestClient(WebSocketServer& server) : server(server), channel(server.openLoopback()) {}
+
+        bool valid() const { return channel != nullptr; }
+        LoopbackChannel& loopback() { return *channel; }
+
+        /**
+         * 驱动服务器直到没有进展，返回这期间收到的所有消息
+         */
+        std::vector<SimpleJson::Value> pump() {
+            std::vector<SimpleJson::Value> messages;
+            std::string payload;
+            for (int round = 0; round < 16; ++round) {
+                size_t moved = server.pumpLoopback();
+                bool any = false;
+                while (channel->receive(payload)) {
+                    any = true;
+                    SimpleJson::Value message;
+                    if (SimpleJson::parse(payload, message)) {
+                        messages.push_back(std::move(message));
+                    } else {
+                        std::cerr << "无法解析的服务器消息: " << payload << std::endl;
+                        ++failures;
+                    }
+                }
+                if (moved == 0 && !any) {
+                    break;
+                }
+            }
+            return messages;
+        }
+
+        std::vector<SimpleJson::Value> send(const std::string& text) {
+            CHECK(channel->sendText(text));
+            return pump();
+        }
+
+    private:
+        WebSocketServer& server;
+        std::shared_ptr<LoopbackChannel> channel;
+    };
+
+    const SimpleJson::Value* findType(const std::vector<SimpleJson::Value>& messages, const std::string& type) {
+        for (const auto& message : messages) {
+            if (message["type"].asString() == type) {
+                return &message;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * 升级握手
+     * 【返回】：握手后收到的消息（欢迎消息、起始场景的预取消息）
+     */
+    std::vector<SimpleJson::Value> testHandshake(TestClient& client) {
+        CHECK(client.loopback().sendUpgrade());
+        auto messages = client.pump();
+        CHECK(client.loopback().handshakeStatus() == 101);
+        const SimpleJson::Value* welcome = findType(messages, "welcome");
+        CHECK(welcome != nullptr);
+        if (welcome) {
+            CHECK((*welcome)["seq"].asNumber() == 1);
+            CHECK((*welcome)["resumeToken"].asString().size() == 32);
+        }
+        return messages;
+    }
+
+    void testCommandResponse(TestClient& client) {
+        auto messages = client.send(R"({"action": "talk", "data": {"target": "bookstore_owner"}})");
+        const SimpleJson::Value* response = findType(messages, "dialogue");
+        CHECK(response != nullptr);
+        if (response) {
+            CHECK((*response)["seq"].asNumber() > 1);
+            CHECK((*response).find("id") == nullptr);   // 没有命令ID时不写回
+            CHECK((*response)["data"]["speaker"].isString());
+        }
+
+        // 不认识的消息返回游戏状态，连接保持可用
+        messages = client.send("not json");
+        CHECK(findType(messages, "gameState") != nullptr);
+    }
+
+    void testCommandIds(TestClient& client) {
+        auto messages = client.send(R"({"id": 7, "action": "talk", "data": {"target": "bookstore_owner"}})");
+        const SimpleJson::Value* response = findType(messages, "dialogue");
+        CHECK(response != nullptr);
+        if (response) {
+            CHECK((*response)["id"].asNumber() == 7);
+        }
+
+        messages = client.send(R"({"id": "batch-1", "commands": [)"
+                               R"({"id": 1, "action": "talk", "data": {"target": "bookstore_owner"}},)"
+                               R"({"id": "two", "optionId": "ask_about_memories"},)"
+                               R"(42,)"
+                               R"({"id": 4, "type": "cacheManifest", "hashes": []}]})");
+        const SimpleJson::Value* batch = findType(messages, "batchResult");
+        CHECK(batch != nullptr);
+        if (batch) {
+            CHECK((*batch)["id"].asString() == "batch-1");
+            const auto& results = (*batch)["results"].items();
+            CHECK(results.size() == 4);
+            if (results.size() == 4) {
+                CHECK(results[0]["id"].asNumber() == 1);
+                CHECK(results[0]["type"].asString() == "dialogue");
+                CHECK(results[1]["id"].asString() == "two");
+                CHECK(results[1]["type"].asString() != "error");
+                CHECK(results[2]["type"].asString() == "error");    // 不是对象的条目
+                CHECK(results[3]["id"].asNumber() == 4);             // 没有响应的命令占一个ack
+                CHECK(results[3]["type"].asString() == "ack");
+            }
+        }
+    }
+
+    void testErrorEscaping(TestClient& client) {
+        auto messages = client.send(R"({"action": "move", "data": {"direction": "no\"rth"}})");
+        const SimpleJson::Value* error = findType(messages, "error");
+        CHECK(error != nullptr);
+        if (error) {
+            CHECK((*error)["data"]["message"].asString() == "Cannot move to 'no\"rth' from here");
+        }
+
+        messages = client.send(R"({"action": "examine", "data": {"target": "shelf\\\"}"}})");
+        error = findType(messages, "error");
+        CHECK(error != nullptr);
+        if (error) {
+            CHECK((*error)["data"]["message"].asString() == "Nothing to examine: 'shelf\\\"}'");
+        }
+    }
+
+    void testContentRefs(TestClient& client, const std::vector<SimpleJson::Value>& initial) {
+        // 起始场景的预取消息带着相邻场景的原文和哈希
+        std::string ref;
+        std::string body;
+        for (const auto& message : initial) {
+            if (message["type"].asString() != "prefetch") {
+                continue;
+            }
+            for (const auto& scene : message["data"]["scenes"].items()) {
+                if (scene["location"].asString() == "old_street") {
+                    ref = scene["descriptionRef"].asString();
+                    body = scene["description"].asString();
+                }
+            }
+        }
+        CHECK(!ref.empty() && !body.empty());
+
+        // 移动过去：客户端已经从预取消息中得到原文，场景更新只发哈希
+        auto messages = client.send(R"({"action": "move", "data": {"direction": "north"}})");
+        const SimpleJson::Value* scene = findType(messages, "sceneUpdate");
+        CHECK(scene != nullptr);
+        if (scene) {
+            CHECK((*scene)["data"]["location"].asString() == "old_street");
+            CHECK((*scene)["data"]["descriptionRef"].asString() == ref);
+            CHECK((*scene)["data"].find("description") == nullptr);
+        }
+
+        // 按哈希取回原文
+        messages = client.send(R"({"type": "contentRequest", "hashes": [")" + ref + R"(", "0000000000000000"]})");
+        const SimpleJson::Value* content = findType(messages, "content");
+        CHECK(content != nullptr);
+        if (content) {
+            CHECK((*content)["data"][ref].asString() == body);
+            CHECK((*content)["data"].find("0000000000000000") == nullptr);    // 不认识的哈希忽略
+        }
+    }
+
+} // namespace
+
+int main() {
+    NullBuffer nullBuffer;
+    std::streambuf* originalBuffer = std::cout.rdbuf(&nullBuffer);
+
+    bool worldLoaded = WorldData::loadGlobal();
+    if (worldLoaded) {
+        ContentStore::instance().initialize(*WorldData::global());
+        PrefetchPlanner::instance().initialize(*WorldData::global());
+    }
+    CHECK(worldLoaded);
+
+    {
+        SessionManager sessionManager;
+        WebSocketServer server;
+        server.setSessionManager(&sessionManager);
+        CHECK(server.startLoopback());
+
+        TestClient client(server);
+        CHECK(client.valid());
+        if (worldLoaded && client.valid()) {
+            auto initial = testHandshake(client);
+            testCommandResponse(client);
+            testCommandIds(client);
+            testErrorEscaping(client);
+            testContentRefs(client, initial);
+
+            client.loopback().disconnect();
+            client.pump();
+            CHECK(client.loopback().isClosedByServer());
+        }
+        server.stop();
+    }
+
+    std::cout.rdbuf(originalBuffer);
+    if (failures > 0) {
+        std::cerr << "[LoopbackIntegrationTest] " << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "[LoopbackIntegrationTest] 全部通过" << std::endl;
+    return 0;
+}
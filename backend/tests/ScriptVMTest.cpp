@@ -0,0 +1,103 @@
+/**
+ * ScriptVMTest.cpp
+ *
+ * 脚本虚拟机测试 - 整数运算的边界情况
+ *
+ * 【覆盖】：
+ * 1. INT32_MIN / -1 和 INT32_MIN % -1 不会让进程收到SIGFPE，结果按补码回绕
+ * 2. 加、减、乘、取负、加常量溢出时按32位补码回绕
+ * 3. 除数为0时结果为0
+ *
+ * 【运行】：ctest（需要 -DBUILD_TESTS=ON）
+ */
+
+#include "core/ScriptCompiler.h"
+#include "core/ScriptVM.h"
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+
+    int failures = 0;
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << " 检查失败: " #condition << std::endl;   \
+            ++failures;                                                                         \
+        }                                                                                       \
+    } while (0)
+
+    /**
+     * 只记录属性的宿主
+     */
+    class AttributeHost : public ScriptHost {
+    public:
+        std::map<std::string, int> attributes;
+
+        int getAttribute(const std::string& name) override { return attributes[name]; }
+        void setAttribute(const std::string& name, int value) override { attributes[name] = value; }
+        bool hasItem(const std::string&) override { return false; }
+        bool knowsInsight(const std::string&) override { return false; }
+        bool hasFlag(const std::string&) override { return false; }
+        void giveItem(const std::string&) override {}
+        void takeItem(const std::string&) override {}
+        void gainInsight(const std::string&) override {}
+        void setFlag(const std::string&) override {}
+        void say(const std::string&) override {}
+        void gotoDialogue(const std::string&) override {}
+    };
+
+    /**
+     * 编译并执行脚本，返回执行后的属性
+     */
+    std::map<std::string, int> run(const std::string& source) {
+        AttributeHost host;
+        std::string error;
+        auto script = ScriptCompiler::compile(source, &error);
+        CHECK(script != nullptr);
+        if (!script) {
+            std::cerr << "编译失败: " << error << std::endl;
+            return host.attributes;
+        }
+        ScriptVM::execute(*script, host);
+        return host.attributes;
+    }
+
+    void testDivisionOverflow() {
+        auto attributes = run("var a = -2147483647 - 1; var b = -1; attr.q = a / b; attr.r = a % b;");
+        CHECK(attributes["q"] == INT32_MIN);
+        CHECK(attributes["r"] == 0);
+
+        attributes = run("var a = 7; var zero = 0; attr.q = a / zero; attr.r = a % zero;");
+        CHECK(attributes["q"] == 0);
+        CHECK(attributes["r"] == 0);
+    }
+
+    void testArithmeticWraps() {
+        auto attributes = run("var m = 2147483647; var one = 1; var low = -m - 1;"
+                              "attr.add = m + one; attr.addk = m + 1; attr.sub = low - one;"
+                              "attr.mul = m * m; attr.neg = -low; attr.subk = low - 1;");
+        CHECK(attributes["add"] == INT32_MIN);
+        CHECK(attributes["addk"] == INT32_MIN);
+        CHECK(attributes["sub"] == INT32_MAX);
+        CHECK(attributes["mul"] == 1);
+        CHECK(attributes["neg"] == INT32_MIN);
+        CHECK(attributes["subk"] == INT32_MAX);
+    }
+
+} // namespace
+
+int main() {
+    testDivisionOverflow();
+    testArithmeticWraps();
+
+    if (failures > 0) {
+        std::cerr << "[ScriptVMTest] " << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "[ScriptVMTest] 全部通过" << std::endl;
+    return 0;
+}
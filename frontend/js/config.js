@@ -8,8 +8,9 @@
 window.GameConfig = {
     // 网络配置
     network: {
-        // WebSocket服务器地址
-        serverUrl: 'ws://localhost:8080',
+        // WebSocket服务器地址（页面经https打开时使用wss，与服务器是否启用TLS一致）
+        serverUrl: (window.location.protocol === 'https:' ? 'wss://' : 'ws://') +
+                   (window.location.host || 'localhost:8080'),
         
         // 重连配置
         reconnect: {
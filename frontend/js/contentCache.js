@@ -0,0 +1,99 @@
+/**
+ * 内容缓存
+ * 按内容哈希保存服务器发来的静态文本（场景描述、对话台词、检查结果），持久化到IndexedDB
+ *
+ * 消息中的文本字段带有 "<字段>Ref" 哈希：
+ *   - 同时带原文时存入缓存
+ *   - 只有哈希时从缓存补回原文，缓存缺失的哈希交给调用方向服务器取回
+ */
+
+class ContentCache {
+    constructor() {
+        this.entries = new Map();       // 哈希 -> 原文
+        this.db = null;
+        this.maxManifestSize = 16384;   // 连接时声明的最大条目数（与服务器的 kMaxClientContent 一致）
+    }
+
+    /**
+     * 打开IndexedDB并载入已缓存的内容（浏览器不支持时只使用内存缓存）
+     */
+    open() {
+        if (typeof indexedDB === 'undefined') {
+            return Promise.resolve();
+        }
+
+        return new Promise(resolve => {
+            const request = indexedDB.open('timeArtifacts', 1);
+            request.onupgradeneeded = () => {
+                request.result.createObjectStore('content');
+            };
+            request.onerror = () => {
+                console.warn('[ContentCache] 无法打开IndexedDB，仅使用内存缓存');
+                resolve();
+            };
+            request.onsuccess = () => {
+                this.db = request.result;
+                const store = this.db.transaction('content', 'readonly').objectStore('content');
+                const cursorRequest = store.openCursor();
+                cursorRequest.onsuccess = () => {
+                    const cursor = cursorRequest.result;
+                    if (cursor) {
+                        this.entries.set(cursor.key, cursor.value);
+                        cursor.continue();
+                    } else {
+                        console.log(`[ContentCache] 已载入 ${this.entries.size} 条缓存内容`);
+                        resolve();
+                    }
+                };
+                cursorRequest.onerror = () => resolve();
+            };
+        });
+    }
+
+    /**
+     * 保存一段内容
+     */
+    put(hash, text) {
+        if (this.entries.get(hash) === text) {
+            return;
+        }
+        this.entries.set(hash, text);
+        if (this.db) {
+            this.db.transaction('content', 'readwrite').objectStore('content').put(text, hash);
+        }
+    }
+
+    /**
+     * 连接时声明的缓存清单
+     */
+    manifest() {
+        return Array.from(this.entries.keys()).slice(-this.maxManifestSize);
+    }
+
+    /**
+     * 处理消息中的内容引用：带原文的存入缓存，只有哈希的从缓存补回原文
+     * @returns 缓存中缺失的哈希
+     */
+    resolve(value, missing = []) {
+        if (Array.isArray(value)) {
+            value.forEach(item => this.resolve(item, missing));
+        } else if (value && typeof value === 'object') {
+            for (const key of Object.keys(value)) {
+                const field = value[key];
+                if (key.endsWith('Ref') && typeof field === 'string') {
+                    const textKey = key.slice(0, -3);
+                    if (typeof value[textKey] === 'string') {
+                        this.put(field, value[textKey]);
+                    } else if (this.entries.has(field)) {
+                        value[textKey] = this.entries.get(field);
+                    } else {
+                        missing.push(field);
+                    }
+                } else if (typeof field === 'object') {
+                    this.resolve(field, missing);
+                }
+            }
+        }
+        return missing;
+    }
+}
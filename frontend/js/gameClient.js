@@ -10,6 +10,31 @@ class GameClient {
         this.reconnectAttempts = 0;
         this.maxReconnectAttempts = 5;
         this.uiManager = null;
+        this.serverUrl = null;
+        this.nextCommandId = 0;
+        
+        // 会话恢复：重连时带上令牌和最后收到的序号，服务器只补发缺失的消息
+        this.resumeToken = sessionStorage.getItem('timeArtifacts.resumeToken');
+        this.lastSeq = Number(sessionStorage.getItem('timeArtifacts.lastSeq')) || 0;
+        
+        // 预取缓存：服务器在空闲时推送玩家接下来可能需要的场景和对话
+        this.prefetchCache = {
+            exits: {},              // 场景ID -> {方向: 相邻场景ID}
+            scenes: new Map(),      // 场景ID -> sceneUpdate数据
+            dialogues: new Map(),   // 对话节点ID -> dialogue数据
+            audio: new Set()        // 音乐和环境音效
+        };
+        this.currentLocation = null;
+        this.predictedLocation = null;
+        
+        // 内容缓存：静态文本按哈希缓存，服务器只发送客户端没有的原文
+        this.contentCache = new ContentCache();
+        this.contentReady = this.contentCache.open();
+        this.pendingMessages = [];      // 等待取回缺失内容的消息（保持到达顺序）
+        this.pendingContentRequests = 0;
+        
+        // 大块低优先级消息（预取）被服务器切成分片，与其他消息交错到达：分片ID -> 已收到的片段
+        this.partialMessages = new Map();
         
         console.log('[GameClient] 游戏客户端已创建');
     }
@@ -25,11 +50,18 @@ class GameClient {
     /**
      * 连接到游戏服务器
      */
-    connect(serverUrl = 'ws://localhost:8080') {
-        console.log('[GameClient] 尝试连接到:', serverUrl);
+    connect(serverUrl = this.serverUrl || 'ws://localhost:8080') {
+        this.serverUrl = serverUrl;
+        
+        let url = serverUrl;
+        if (this.resumeToken) {
+            const separator = url.includes('?') ? '&' : '?';
+            url += `${separator}resume=${encodeURIComponent(this.resumeToken)}&lastSeq=${this.lastSeq}`;
+        }
+        console.log('[GameClient] 尝试连接到:', url);
         
         try {
-            this.ws = new WebSocket(serverUrl);
+            this.ws = new WebSocket(url);
             this.setupEventHandlers();
         } catch (error) {
             console.error('[GameClient] 连接失败:', error);
@@ -54,9 +86,16 @@ class GameClient {
         
         this.ws.onmessage = (event) => {
             try {
-                const message = JSON.parse(event.data);
+                const message = this.assemblePart(JSON.parse(event.data));
+                if (!message) {
+                    return;     // 分片尚未收齐
+                }
                 console.log('[GameClient] 收到消息:', message);
-                this.handleGameMessage(message);
+                if (typeof message.seq === 'number') {
+                    this.lastSeq = message.seq;
+                    sessionStorage.setItem('timeArtifacts.lastSeq', String(this.lastSeq));
+                }
+                this.receiveMessage(message);
             } catch (error) {
                 console.error('[GameClient] 解析消息失败:', error);
             }
@@ -65,6 +104,7 @@ class GameClient {
         this.ws.onclose = () => {
             console.log('[GameClient] 与服务器断开连接');
             this.isConnectedFlag = false;
+            this.partialMessages.clear();     // 分片ID按连接编号，重连后不再有后续分片
             this.updateConnectionStatus('连接断开', 'disconnected');
             
             if (this.uiManager) {
@@ -80,6 +120,77 @@ class GameClient {
         };
     }
     
+    /**
+     * 拼接分片消息：不是分片时原样返回；收齐最后一片时返回解析后的原消息，否则返回null
+     */
+    assemblePart(message) {
+        if (message.type !== 'part') {
+            return message;
+        }
+        let pieces = this.partialMessages.get(message.id);
+        if (!pieces) {
+            pieces = [];
+            this.partialMessages.set(message.id, pieces);
+        }
+        pieces[message.index] = message.data;
+        if (pieces.filter(piece => piece !== undefined).length < message.count) {
+            return null;
+        }
+        this.partialMessages.delete(message.id);
+        return JSON.parse(pieces.join(''));
+    }
+    
+    /**
+     * 补全内容引用后处理消息；缺失的内容先向服务器取回，期间后续消息按顺序排队
+     */
+    receiveMessage(message) {
+        if (message.type === 'content') {
+            for (const [hash, text] of Object.entries(message.data || {})) {
+                this.contentCache.put(hash, text);
+            }
+            this.pendingContentRequests = Math.max(0, this.pendingContentRequests - 1);
+            this.flushPendingMessages();
+            return;
+        }
+        
+        const missing = this.contentCache.resolve(message);
+        if (missing.length === 0 && this.pendingMessages.length === 0) {
+            this.handleGameMessage(message);
+            return;
+        }
+        
+        this.pendingMessages.push(message);
+        if (missing.length > 0 && this.isConnected()) {
+            this.pendingContentRequests++;
+            this.ws.send(JSON.stringify({ type: 'contentRequest', hashes: missing }));
+        }
+    }
+    
+    /**
+     * 依次处理内容已齐全的排队消息
+     * 所有取回请求都已答复后，服务器也不认识的内容不再等待
+     */
+    flushPendingMessages() {
+        while (this.pendingMessages.length > 0) {
+            if (this.contentCache.resolve(this.pendingMessages[0]).length > 0 && this.pendingContentRequests > 0) {
+                break;
+            }
+            this.handleGameMessage(this.pendingMessages.shift());
+        }
+    }
+    
+    /**
+     * 向服务器声明本地已缓存的内容
+     */
+    sendCacheManifest() {
+        this.contentReady.then(() => {
+            const hashes = this.contentCache.manifest();
+            if (hashes.length > 0 && this.isConnected()) {
+                this.ws.send(JSON.stringify({ type: 'cacheManifest', hashes: hashes }));
+            }
+        });
+    }
+    
     /**
      * 处理游戏消息
      */
@@ -89,8 +200,43 @@ class GameClient {
             return;
         }
         
+        // 对话选择触发的脚本旁白附在响应顶层，先于新的对话或状态显示
+        if (message.narration) {
+            this.uiManager.showNarration(message.narration);
+        }
+
         switch (message.type) {
+            case 'welcome':
+                // 新会话：保存恢复令牌
+                this.resumeToken = message.resumeToken || null;
+                if (this.resumeToken) {
+                    sessionStorage.setItem('timeArtifacts.resumeToken', this.resumeToken);
+                }
+                this.sendCacheManifest();
+                break;
+                
+            case 'resumed':
+                console.log(`[GameClient] 会话已恢复，补发 ${message.data.replayed} 条消息` +
+                            (message.data.snapshot ? '（完整快照）' : ''));
+                this.uiManager.showNotification('已恢复之前的游戏进度', 'info');
+                this.sendCacheManifest();
+                break;
+                
+            case 'batchResult':
+                // 批量命令的响应按提交顺序排列，逐条处理
+                message.results.forEach(result => this.handleGameMessage(result));
+                break;
+                
+            case 'prefetch':
+                this.storePrefetch(message.data);
+                break;
+
+            case 'ack':
+                // 批量结果中没有响应的命令（如缓存清单）的占位
+                break;
+                
             case 'gameState':
+                this.currentLocation = message.data.currentLocation || this.currentLocation;
                 this.uiManager.updateGameState(message.data);
                 break;
                 
@@ -99,6 +245,13 @@ class GameClient {
                 break;
                 
             case 'sceneUpdate':
+                this.currentLocation = message.data.location || this.currentLocation;
+                if (this.predictedLocation && this.predictedLocation === message.data.location) {
+                    // 已经从预取缓存渲染过，服务器的确认不再重复显示
+                    this.predictedLocation = null;
+                    break;
+                }
+                this.predictedLocation = null;
                 this.uiManager.updateScene(message.data);
                 break;
                 
@@ -111,6 +264,7 @@ class GameClient {
                 break;
                 
             case 'error':
+                this.predictedLocation = null;
                 this.uiManager.showNotification(message.data.errorMessage, 'error');
                 break;
                 
@@ -119,6 +273,31 @@ class GameClient {
         }
     }
     
+    /**
+     * 保存预取内容
+     */
+    storePrefetch(data) {
+        if (data.location && data.exits) {
+            this.prefetchCache.exits[data.location] = data.exits;
+        }
+        (data.scenes || []).forEach(scene => this.prefetchCache.scenes.set(scene.location, scene));
+        (data.dialogues || []).forEach(dialogue => this.prefetchCache.dialogues.set(dialogue.dialogueId, dialogue));
+        (data.audio || []).forEach(track => this.prefetchCache.audio.add(track));
+    }
+    
+    /**
+     * 预测移动后的场景（预取缓存中有时返回场景数据，否则返回null）
+     */
+    predictMove(direction) {
+        const exits = this.prefetchCache.exits[this.currentLocation] || {};
+        const scene = this.prefetchCache.scenes.get(exits[direction]);
+        if (!scene) {
+            return null;
+        }
+        this.predictedLocation = scene.location;
+        return scene;
+    }
+    
     /**
      * 发送命令到服务器
      */
@@ -132,6 +311,7 @@ class GameClient {
         }
         
         const command = {
+            id: ++this.nextCommandId,
             action: action,
             data: data,
             timestamp: Date.now()
@@ -139,6 +319,33 @@ class GameClient {
         
         console.log('[GameClient] 发送命令:', command);
         this.ws.send(JSON.stringify(command));
+        return command.id;
+    }
+    
+    /**
+     * 批量发送命令（服务器按顺序执行，一次返回全部结果）
+     * @param commands [{action, data}, ...]
+     * @returns 批次ID
+     */
+    sendBatch(commands) {
+        if (!this.isConnected()) {
+            console.warn('[GameClient] 未连接到服务器，无法发送命令');
+            return null;
+        }
+        
+        const batch = {
+            id: ++this.nextCommandId,
+            commands: commands.map(command => ({
+                id: ++this.nextCommandId,
+                action: command.action,
+                data: command.data || {},
+                timestamp: Date.now()
+            }))
+        };
+        
+        console.log('[GameClient] 发送批量命令:', batch);
+        this.ws.send(JSON.stringify(batch));
+        return batch.id;
     }
     
     /**
@@ -138,6 +138,14 @@ class UIManager {
                 button.title = `需要: ${option.requirement}`;
             }
             
+            // 其他旅人的选择比例（服务器统计快照，-1表示还没有人选过）
+            if (typeof option.chosenPercent === 'number' && option.chosenPercent >= 0) {
+                const share = document.createElement('span');
+                share.className = 'option-share';
+                share.textContent = ` · ${option.chosenPercent}%的旅人选择了这里`;
+                button.appendChild(share);
+            }
+            
             button.addEventListener('click', () => {
                 this.selectDialogueOption(option.id);
             });
@@ -189,6 +197,14 @@ class UIManager {
         
         // 添加到故事日志
         this.addToStoryLog('检查', examData.description);
+        this.showNarration(examData.narration);
+    }
+
+    /**
+     * 显示交互脚本输出的旁白
+     */
+    showNarration(lines) {
+        (lines || []).forEach(line => this.addToStoryLog('旁白', line));
     }
     
     /**
@@ -322,6 +338,11 @@ class UIManager {
             this.gameClient.sendCommand('talk', { target: target });
         } else if (action.startsWith('move_')) {
             const direction = action.replace('move_', '');
+            // 预取缓存中有目标场景时立即渲染，服务器的确认随后到达
+            const predicted = this.gameClient.predictMove(direction);
+            if (predicted) {
+                this.updateScene(predicted);
+            }
             this.gameClient.sendCommand('move', { direction: direction });
         } else {
             // 通用操作